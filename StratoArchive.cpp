@@ -0,0 +1,409 @@
+/*
+ *  StratoArchive.cpp
+ *  Author:  StratoCore contributors
+ *  Created: October 2026
+ *
+ *  This file implements a time-indexed binary archive built on the SD logger
+ */
+
+#include "StratoArchive.h"
+#include "StratoGroundPort.h"
+#include "StratoClock.h"
+#include <string.h>
+
+// Format helpers -----------------------------------------
+
+// CRC-16/CCITT (polynomial 0x1021), start with 0xFFFF
+uint16_t ArchiveCRC(uint16_t crc, const uint8_t * data, uint32_t size)
+{
+    for (uint32_t i = 0; i < size; i++) {
+        crc ^= (uint16_t) data[i] << 8;
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (uint16_t) ((crc << 1) ^ 0x1021) : (uint16_t) (crc << 1);
+        }
+    }
+
+    return crc;
+}
+
+void ArchivePackHeader(uint8_t type, uint32_t time, const uint8_t * data, uint16_t length, uint8_t * header)
+{
+    ArchivePut16(&header[0], ARCHIVE_SYNC);
+    header[2] = ARCHIVE_VERSION;
+    header[3] = type;
+    ArchivePut32(&header[4], time);
+    ArchivePut16(&header[8], length);
+    ArchivePut16(&header[10], ArchiveCRC(ArchiveCRC(0xFFFF, header, 10), data, length));
+}
+
+bool ArchiveUnpackHeader(const uint8_t * header, ArchiveRecordHeader_t * record)
+{
+    if (ARCHIVE_SYNC != ArchiveGet16(&header[0]) || ARCHIVE_VERSION != header[2]) return false;
+
+    record->type = header[3];
+    record->time = ArchiveGet32(&header[4]);
+    record->length = ArchiveGet16(&header[8]);
+    record->crc = ArchiveGet16(&header[10]);
+
+    return true;
+}
+
+bool ArchiveCheckRecord(const uint8_t * header, const uint8_t * data)
+{
+    return ArchiveGet16(&header[10]) == ArchiveCRC(ArchiveCRC(0xFFFF, header, 10), data, ArchiveGet16(&header[8]));
+}
+
+void ArchivePut32(uint8_t * buffer, uint32_t value)
+{
+    buffer[0] = (uint8_t) value;
+    buffer[1] = (uint8_t) (value >> 8);
+    buffer[2] = (uint8_t) (value >> 16);
+    buffer[3] = (uint8_t) (value >> 24);
+}
+
+void ArchivePut16(uint8_t * buffer, uint16_t value)
+{
+    buffer[0] = (uint8_t) value;
+    buffer[1] = (uint8_t) (value >> 8);
+}
+
+uint32_t ArchiveGet32(const uint8_t * buffer)
+{
+    return (uint32_t) buffer[0] | ((uint32_t) buffer[1] << 8) | ((uint32_t) buffer[2] << 16) | ((uint32_t) buffer[3] << 24);
+}
+
+uint16_t ArchiveGet16(const uint8_t * buffer)
+{
+    return (uint16_t) (buffer[0] | (buffer[1] << 8));
+}
+
+// Lookup -------------------------------------------------
+
+bool ArchiveFindFile(const char * prefix, uint32_t time, char * filename, uint16_t filename_size, uint32_t * entry_number)
+{
+    char catalog_name[SD_LOG_PREFIX_SIZE + 8] = {0};
+    uint8_t entry[ARCHIVE_CATALOG_ENTRY_SIZE] = {0};
+    uint32_t low = 0, high = 0;
+
+    if (NULL == prefix || NULL == filename || filename_size < ARCHIVE_CATALOG_NAME_SIZE) return false;
+
+    snprintf(catalog_name, sizeof(catalog_name), "%s.cat", prefix);
+
+    File catalog = SD.open(catalog_name, O_READ);
+    if (!catalog) return false;
+
+    high = catalog.fileSize() / ARCHIVE_CATALOG_ENTRY_SIZE;
+    if (high == 0) {
+        catalog.close();
+        return false;
+    }
+
+    // find the last file started at or before the time (or the first file if the time is earlier)
+    while (high - low > 1) {
+        uint32_t mid = low + (high - low) / 2;
+        if (!catalog.seekSet(mid * ARCHIVE_CATALOG_ENTRY_SIZE) || ARCHIVE_CATALOG_ENTRY_SIZE != catalog.read(entry, ARCHIVE_CATALOG_ENTRY_SIZE)) {
+            catalog.close();
+            return false;
+        }
+
+        if (ArchiveGet32(entry) <= time) {
+            low = mid;
+        } else {
+            high = mid;
+        }
+    }
+
+    bool success = catalog.seekSet(low * ARCHIVE_CATALOG_ENTRY_SIZE)
+                   && ARCHIVE_CATALOG_ENTRY_SIZE == catalog.read(entry, ARCHIVE_CATALOG_ENTRY_SIZE);
+    catalog.close();
+
+    if (!success) return false;
+
+    memcpy(filename, &entry[4], ARCHIVE_CATALOG_NAME_SIZE);
+    filename[ARCHIVE_CATALOG_NAME_SIZE - 1] = '\0';
+
+    if (NULL != entry_number) *entry_number = low;
+
+    return true;
+}
+
+bool ArchiveCatalogEntry(const char * prefix, uint32_t entry_number, uint32_t * time, char * filename, uint16_t filename_size)
+{
+    char catalog_name[SD_LOG_PREFIX_SIZE + 8] = {0};
+    uint8_t entry[ARCHIVE_CATALOG_ENTRY_SIZE] = {0};
+
+    if (NULL == prefix || NULL == time || NULL == filename || filename_size < ARCHIVE_CATALOG_NAME_SIZE) return false;
+
+    snprintf(catalog_name, sizeof(catalog_name), "%s.cat", prefix);
+
+    File catalog = SD.open(catalog_name, O_READ);
+    if (!catalog) return false;
+
+    bool success = catalog.seekSet(entry_number * ARCHIVE_CATALOG_ENTRY_SIZE)
+                   && ARCHIVE_CATALOG_ENTRY_SIZE == catalog.read(entry, ARCHIVE_CATALOG_ENTRY_SIZE);
+    catalog.close();
+
+    if (!success) return false;
+
+    *time = ArchiveGet32(entry);
+    memcpy(filename, &entry[4], ARCHIVE_CATALOG_NAME_SIZE);
+    filename[ARCHIVE_CATALOG_NAME_SIZE - 1] = '\0';
+
+    return true;
+}
+
+bool ArchiveFindOffset(const char * data_filename, uint32_t time, uint32_t * offset)
+{
+    char index_name[SD_LOG_NAME_SIZE] = {0};
+    uint8_t buffer[ARCHIVE_INDEX_HEADER_SIZE] = {0};
+    uint32_t low = 0, high = 0;
+    uint16_t name_length = 0;
+
+    if (NULL == data_filename || NULL == offset) return false;
+
+    // the index has the data file's name with .idx in place of .dat
+    name_length = strlen(data_filename);
+    if (name_length < 4 || name_length >= SD_LOG_NAME_SIZE) return false;
+    strcpy(index_name, data_filename);
+    strcpy(&index_name[name_length - 4], ".idx");
+
+    *offset = 0;
+
+    File index_file = SD.open(index_name, O_READ);
+    if (!index_file) return false;
+
+    if (ARCHIVE_INDEX_HEADER_SIZE != index_file.read(buffer, ARCHIVE_INDEX_HEADER_SIZE)
+        || 0 != memcmp(buffer, ARCHIVE_INDEX_MAGIC, 4)
+        || ARCHIVE_INDEX_ENTRY_SIZE != ArchiveGet16(&buffer[6])) {
+        index_file.close();
+        return false;
+    }
+
+    // the count is updated after the entries are appended, so it's never past the end unless the file is damaged
+    high = ArchiveGet32(&buffer[8]);
+    if (high > (index_file.fileSize() - ARCHIVE_INDEX_HEADER_SIZE) / ARCHIVE_INDEX_ENTRY_SIZE) {
+        high = (index_file.fileSize() - ARCHIVE_INDEX_HEADER_SIZE) / ARCHIVE_INDEX_ENTRY_SIZE;
+    }
+
+    // find the last entry at or before the time, the offset stays 0 if the time is before the first
+    while (high > low) {
+        uint32_t mid = low + (high - low) / 2;
+        if (!index_file.seekSet(ARCHIVE_INDEX_HEADER_SIZE + mid * ARCHIVE_INDEX_ENTRY_SIZE)
+            || ARCHIVE_INDEX_ENTRY_SIZE != index_file.read(buffer, ARCHIVE_INDEX_ENTRY_SIZE)) {
+            index_file.close();
+            return false;
+        }
+
+        if (ArchiveGet32(buffer) <= time) {
+            *offset = ArchiveGet32(&buffer[4]);
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    index_file.close();
+
+    return true;
+}
+
+static bool WriteIndexHeader(File & index_file, uint32_t entries)
+{
+    uint8_t buffer[ARCHIVE_INDEX_HEADER_SIZE] = {0};
+
+    memcpy(buffer, ARCHIVE_INDEX_MAGIC, 4);
+    ArchivePut16(&buffer[4], ARCHIVE_VERSION);
+    ArchivePut16(&buffer[6], ARCHIVE_INDEX_ENTRY_SIZE);
+    ArchivePut32(&buffer[8], entries);
+    ArchivePut32(&buffer[12], 0);
+
+    return index_file.seekSet(0) && ARCHIVE_INDEX_HEADER_SIZE == index_file.write(buffer, ARCHIVE_INDEX_HEADER_SIZE);
+}
+
+// Archive ------------------------------------------------
+
+StratoArchive::StratoArchive(uint8_t * buffer, uint32_t buffer_size)
+    : StratoSDLogger(buffer, buffer_size)
+{
+    index_size = 0;
+    have_last_entry = false;
+    last_entry_file = 0;
+    last_entry.time = 0;
+    last_entry.offset = 0;
+    index_spacing = 1;
+    index_written = 0;
+    index_decimations = 0;
+}
+
+bool StratoArchive::WriteRecord(uint8_t type, uint32_t time, const uint8_t * data, uint16_t size)
+{
+    uint8_t header[ARCHIVE_HEADER_SIZE];
+
+    if (NULL == data && size > 0) return false;
+
+    ArchivePackHeader(type, time, data, size, header);
+
+    if (!Write(header, ARCHIVE_HEADER_SIZE, data, size)) return false;
+
+    AddIndexEntry(LastWriteFile(), time, LastWriteOffset());
+
+    return true;
+}
+
+void StratoArchive::AddIndexEntry(uint32_t file, uint32_t time, uint32_t offset)
+{
+    // keep the index sparse: the first record in each file, then one every so often
+    if (have_last_entry && last_entry_file == file) {
+        if (time < last_entry.time + ARCHIVE_INDEX_SECONDS * index_spacing
+            && offset < last_entry.offset + ARCHIVE_INDEX_BYTES * index_spacing) return;
+
+        // the index must stay sorted, so records from before a backwards time correction aren't indexed
+        if (time < last_entry.time) return;
+    }
+
+    // the card is falling behind, so keep a coarser index rather than none
+    if (index_size >= ARCHIVE_INDEX_ENTRIES) DecimateIndex();
+
+    index[index_size].file = file;
+    index[index_size].entry.time = time;
+    index[index_size].entry.offset = offset;
+    index_size++;
+
+    have_last_entry = true;
+    last_entry_file = file;
+    last_entry.time = time;
+    last_entry.offset = offset;
+}
+
+// drop every other entry of each file, keeping its first (the time in the catalog), and double the spacing
+void StratoArchive::DecimateIndex()
+{
+    uint16_t kept = 0;
+    uint16_t position = 0;
+
+    for (uint16_t i = 0; i < index_size; i++) {
+        if (i > 0 && index[i].file != index[i - 1].file) position = 0;
+        if (0 == position++ % 2) index[kept++] = index[i];
+    }
+
+    index_size = kept;
+
+    // up to 2^15 keeps the byte spacing within 32 bits
+    if (index_spacing < 0x8000) index_spacing *= 2;
+    index_decimations++;
+}
+
+// a new file goes in the catalog under the time of its first record
+void StratoArchive::FileOpened(uint32_t number, const char * name)
+{
+    char catalog_name[SD_LOG_PREFIX_SIZE + 8] = {0};
+    uint8_t entry[ARCHIVE_CATALOG_ENTRY_SIZE] = {0};
+    uint32_t first_time = (uint32_t) StratoNow();
+
+    for (uint16_t i = 0; i < index_size; i++) {
+        if (index[i].file == number) {
+            first_time = index[i].entry.time;
+            break;
+        }
+    }
+
+    ArchivePut32(entry, first_time);
+    strncpy((char *) &entry[4], name, ARCHIVE_CATALOG_NAME_SIZE - 1);
+
+    snprintf(catalog_name, sizeof(catalog_name), "%s.cat", Prefix());
+
+    File catalog = SD.open(catalog_name, FILE_WRITE);
+    if (!catalog || ARCHIVE_CATALOG_ENTRY_SIZE != catalog.write(entry, ARCHIVE_CATALOG_ENTRY_SIZE)) {
+        log_error("Unable to update archive catalog");
+    }
+    catalog.close();
+
+    // the new file's index starts empty, at the base spacing
+    index_written = 0;
+    index_spacing = 1;
+}
+
+// append the entries for records that are now on the card
+void StratoArchive::FileWritten(uint32_t number, const char * name, uint32_t position)
+{
+    if (index_size > 0 && index[0].file == number && index[0].entry.offset < position) {
+        AppendIndex(number, name, position);
+    }
+}
+
+void StratoArchive::FileSynced(uint32_t number, const char * name)
+{
+    AppendIndex(number, name, 0xFFFFFFFF);
+}
+
+// write the rest of the file's index for the records on the card and drop its entries, including any for
+// records lost to a write error, leaving any for the next file
+void StratoArchive::FileClosing(uint32_t number, const char * name, uint32_t position)
+{
+    uint16_t kept = 0;
+
+    AppendIndex(number, name, position);
+
+    for (uint16_t i = 0; i < index_size; i++) {
+        if (index[i].file != number) index[kept++] = index[i];
+    }
+
+    index_size = kept;
+}
+
+// append the file's entries for records before position, then update the count in the header, the entries
+// are removed from RAM once they're on the card
+bool StratoArchive::AppendIndex(uint32_t file, const char * name, uint32_t position)
+{
+    char index_name[SD_LOG_NAME_SIZE] = {0};
+    uint8_t buffer[ARCHIVE_INDEX_ENTRY_SIZE] = {0};
+    uint16_t entries = 0;
+    uint16_t name_length = strlen(name);
+    bool success = true;
+
+    if (name_length < 4 || name_length >= SD_LOG_NAME_SIZE) return false;
+
+    strcpy(index_name, name);
+    strcpy(&index_name[name_length - 4], ".idx");
+
+    // the open file's entries come first
+    while (entries < index_size && index[entries].file == file && index[entries].entry.offset < position) {
+        entries++;
+    }
+
+    File index_file = SD.open(index_name, O_RDWR | O_CREAT);
+    if (!index_file) {
+        log_error("Unable to open archive index");
+        return false;
+    }
+
+    // a new index needs its header before the entries can be placed after it
+    if (0 == index_written && !WriteIndexHeader(index_file, 0)) success = false;
+
+    if (!index_file.seekSet(ARCHIVE_INDEX_HEADER_SIZE + index_written * ARCHIVE_INDEX_ENTRY_SIZE)) success = false;
+
+    for (uint16_t i = 0; i < entries && success; i++) {
+        ArchivePut32(buffer, index[i].entry.time);
+        ArchivePut32(&buffer[4], index[i].entry.offset);
+        if (ARCHIVE_INDEX_ENTRY_SIZE != index_file.write(buffer, ARCHIVE_INDEX_ENTRY_SIZE)) success = false;
+    }
+
+    if (success && !WriteIndexHeader(index_file, index_written + entries)) success = false;
+
+    // closing syncs the directory entry, so the new size survives a reset
+    index_file.close();
+
+    if (!success) {
+        // the entries stay in RAM to be tried again
+        log_error("Unable to write archive index");
+        return false;
+    }
+
+    index_written += entries;
+    for (uint16_t i = entries; i < index_size; i++) {
+        index[i - entries] = index[i];
+    }
+    index_size -= entries;
+
+    return true;
+}
@@ -0,0 +1,134 @@
+/*
+ *  StratoArchive.h
+ *  Author:  StratoCore contributors
+ *  Created: October 2026
+ *
+ *  This file declares a time-indexed binary archive built on the SD logger,
+ *  and the helpers for its format that are shared with the host tools
+ */
+
+#ifndef STRATOARCHIVE_H
+#define STRATOARCHIVE_H
+
+#include "StratoSD.h"
+#include <stdint.h>
+
+// Archive data files (<prefix>_<time>.dat) are a sequence of records, each a fixed header and
+// its data. All values are little-endian.
+//   record header: uint16_t sync, uint8_t version, uint8_t type, uint32_t time, uint16_t length,
+//                  uint16_t crc (CRC-16/CCITT over the first 10 header bytes and the data)
+#define ARCHIVE_SYNC            0xA55A
+#define ARCHIVE_VERSION         1
+#define ARCHIVE_HEADER_SIZE     12
+
+// record types, instruments can use any other value for their own records
+#define ARCHIVE_TYPE_TM         1
+#define ARCHIVE_TYPE_LOG        2   // tokenized log frames (StratoLogToken.h)
+
+// Each data file has a sparse index (<prefix>_<time>.idx) of fixed entries sorted by time,
+// so finding a time is a binary search of the index and one seek in the data file. Entries are
+// appended (and the header's count updated) as the records they point to are written to the
+// card, so the index is as current as the data even after a reset.
+//   index header: char magic[4] "SIDX", uint16_t version, uint16_t entry size, uint32_t entries, uint32_t reserved
+//   index entry:  uint32_t time, uint32_t offset (of a record in the data file)
+#define ARCHIVE_INDEX_MAGIC         "SIDX"
+#define ARCHIVE_INDEX_HEADER_SIZE   16
+#define ARCHIVE_INDEX_ENTRY_SIZE    8
+
+// a record is indexed if it's the first in its file, or this far in time or bytes from the last entry
+// (multiplied by the spacing, which doubles each time the RAM index fills)
+#define ARCHIVE_INDEX_SECONDS   60
+#define ARCHIVE_INDEX_BYTES     (64UL * 1024UL)
+
+// maximum index entries held in RAM until their records reach the card, when full every other entry is dropped
+#define ARCHIVE_INDEX_ENTRIES   256
+
+// The catalog (<prefix>.cat) lists the data files in the order they were started, so the file
+// holding a time is also found by binary search.
+//   catalog entry: uint32_t time (of the file's first record), char name[36] (nul-padded)
+#define ARCHIVE_CATALOG_ENTRY_SIZE  40
+#define ARCHIVE_CATALOG_NAME_SIZE   36
+
+struct ArchiveRecordHeader_t {
+    uint8_t type;
+    uint32_t time;
+    uint16_t length;
+    uint16_t crc;
+};
+
+struct ArchiveIndexEntry_t {
+    uint32_t time;
+    uint32_t offset;
+};
+
+// format helpers, also used by the host tools
+uint16_t ArchiveCRC(uint16_t crc, const uint8_t * data, uint32_t size);
+void ArchivePackHeader(uint8_t type, uint32_t time, const uint8_t * data, uint16_t length, uint8_t * header);
+bool ArchiveUnpackHeader(const uint8_t * header, ArchiveRecordHeader_t * record); // false if not a record header
+bool ArchiveCheckRecord(const uint8_t * header, const uint8_t * data); // true if the CRC matches
+
+void ArchivePut32(uint8_t * buffer, uint32_t value);
+void ArchivePut16(uint8_t * buffer, uint16_t value);
+uint32_t ArchiveGet32(const uint8_t * buffer);
+uint16_t ArchiveGet16(const uint8_t * buffer);
+
+// find the data file holding a time from the catalog (the last file started at or before it),
+// optionally returning its position in the catalog
+bool ArchiveFindFile(const char * prefix, uint32_t time, char * filename, uint16_t filename_size, uint32_t * entry_number = NULL);
+
+// read an entry of the catalog by position, to step through the files in order
+bool ArchiveCatalogEntry(const char * prefix, uint32_t entry_number, uint32_t * time, char * filename, uint16_t filename_size);
+
+// find where to start reading a data file for a time: the offset of the last indexed record at or before it
+bool ArchiveFindOffset(const char * data_filename, uint32_t time, uint32_t * offset);
+
+class StratoArchive : public StratoSDLogger {
+public:
+    ~StratoArchive() { };
+
+    // append a record, all-or-nothing
+    bool WriteRecord(uint8_t type, uint32_t time, const uint8_t * data, uint16_t size);
+
+    uint32_t IndexDecimations() { return index_decimations; }
+
+protected:
+    StratoArchive(uint8_t * buffer, uint32_t buffer_size);
+
+    void FileOpened(uint32_t number, const char * name);
+    void FileSynced(uint32_t number, const char * name);
+    void FileClosing(uint32_t number, const char * name, uint32_t position);
+    void FileWritten(uint32_t number, const char * name, uint32_t position);
+
+private:
+    void AddIndexEntry(uint32_t file, uint32_t time, uint32_t offset);
+    void DecimateIndex();
+    bool AppendIndex(uint32_t file, const char * name, uint32_t position);
+
+    // entries not yet on the card, in file order, at most two files (the one being written and the next) are present
+    struct {
+        uint32_t file;
+        ArchiveIndexEntry_t entry;
+    } index[ARCHIVE_INDEX_ENTRIES];
+    uint16_t index_size;
+
+    // the last entry added, which may already be on the card
+    bool have_last_entry;
+    uint32_t last_entry_file;
+    ArchiveIndexEntry_t last_entry;
+
+    uint32_t index_spacing; // multiplier on ARCHIVE_INDEX_SECONDS and ARCHIVE_INDEX_BYTES
+    uint32_t index_written; // entries in the open data file's index on the card
+    uint32_t index_decimations; // times the RAM index filled
+};
+
+// statically-allocated archive with a compile-time buffer size (a multiple of SD_SECTOR_SIZE)
+template <uint32_t BUFFER_SIZE>
+class StaticArchive : public StratoArchive {
+public:
+    StaticArchive() : StratoArchive(buffer_storage, BUFFER_SIZE) { }
+
+private:
+    uint8_t buffer_storage[BUFFER_SIZE];
+};
+
+#endif /* STRATOARCHIVE_H */
@@ -0,0 +1,83 @@
+/*
+ *  StratoClock.cpp
+ *  Author:  StratoCore contributors
+ *  Created: October 2026
+ *
+ *  This file implements the clock that StratoCore keeps time with
+ */
+
+#include "StratoClock.h"
+
+// NULL for the hardware clock, which is never virtual so that flight builds only pay for the check
+static StratoClock * strato_clock = NULL;
+
+VirtualClock::VirtualClock(time_t start_time)
+{
+    elapsed_us = 0;
+    time_base_us = (int64_t) start_time * 1000000LL;
+    time_set_us = 0;
+    drift_ppm = 0;
+}
+
+void VirtualClock::SetTime(time_t time)
+{
+    time_base_us = (int64_t) time * 1000000LL;
+    time_set_us = elapsed_us;
+}
+
+void VirtualClock::SetDrift(int32_t ppm)
+{
+    // the drift so far is kept, the new rate applies from here
+    time_base_us = TimeOfDayMicros();
+    time_set_us = elapsed_us;
+    drift_ppm = ppm;
+}
+
+int64_t VirtualClock::TimeOfDayMicros()
+{
+    int64_t since_set = (int64_t) (elapsed_us - time_set_us);
+
+    return time_base_us + since_set + since_set * drift_ppm / 1000000LL;
+}
+
+void SetStratoClock(StratoClock * clock)
+{
+    strato_clock = clock;
+}
+
+time_t StratoNow()
+{
+    return (NULL != strato_clock) ? strato_clock->Now() : now();
+}
+
+void StratoSetTime(time_t time)
+{
+    if (NULL != strato_clock) {
+        strato_clock->SetTime(time);
+        return;
+    }
+
+    noInterrupts();
+    setTime(time);
+    interrupts();
+}
+
+uint32_t StratoMillis()
+{
+    return (NULL != strato_clock) ? strato_clock->Millis() : millis();
+}
+
+uint32_t StratoMicros()
+{
+    return (NULL != strato_clock) ? strato_clock->Micros() : micros();
+}
+
+void StratoIdleWait(uint32_t max_ms)
+{
+    if (NULL != strato_clock) {
+        strato_clock->IdleWait(max_ms);
+        return;
+    }
+
+    STRATO_IDLE_WAIT(max_ms);
+}
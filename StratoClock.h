@@ -0,0 +1,81 @@
+/*
+ *  StratoClock.h
+ *  Author:  StratoCore contributors
+ *  Created: October 2026
+ *
+ *  This file declares the clock that StratoCore keeps time with, normally
+ *  the Teensy's millis() and TimeLib, which a virtual clock can replace so
+ *  that long flight profiles can be simulated faster than real time.
+ */
+
+#ifndef STRATOCLOCK_H
+#define STRATOCLOCK_H
+
+#include "Arduino.h"
+#include "TimeLib.h"
+#include <stdint.h>
+
+// waits for the next interrupt, at most the 1 ms systick on the Teensy (the host build defines its own)
+#ifndef STRATO_IDLE_WAIT
+#define STRATO_IDLE_WAIT(max_ms)    asm volatile ("wfi")
+#endif
+
+// The time of day (set from GPS) and the monotonic ms clock that schedules, timeouts, task delays,
+// Idle and the watchdog budget are measured on. The execution time of the loop phases (the profiler
+// and the per-loop limits) is always measured with micros(), since it's CPU time being limited.
+class StratoClock {
+public:
+    virtual ~StratoClock() { }
+
+    virtual time_t Now() = 0;
+    virtual void SetTime(time_t time) = 0;
+    virtual uint32_t Millis() = 0;
+    virtual uint32_t Micros() = 0;
+
+    // Idle's wait for an interrupt, returning after at most max_ms
+    virtual void IdleWait(uint32_t max_ms) = 0;
+};
+
+// A clock that only moves when advanced, or when StratoCore idles (which passes the whole wait at once),
+// so a simulation runs as fast as the CPU allows. The time of day advances with the ms clock, as TimeLib's
+// does, optionally running fast or slow by a drift rate so that GPS corrections can be exercised.
+class VirtualClock : public StratoClock {
+public:
+    VirtualClock(time_t start_time = 0);
+    ~VirtualClock() { };
+
+    time_t Now() { return (time_t) (TimeOfDayMicros() / 1000000LL); }
+    void SetTime(time_t time);
+    uint32_t Millis() { return (uint32_t) (elapsed_us / 1000ULL); }
+    uint32_t Micros() { return (uint32_t) elapsed_us; }
+    void IdleWait(uint32_t max_ms) { Advance(max_ms); }
+
+    void Advance(uint32_t ms) { elapsed_us += (uint64_t) ms * 1000ULL; }
+    void AdvanceMicros(uint32_t us) { elapsed_us += us; }
+
+    // parts per million that the time of day gains (positive) or loses relative to the ms clock
+    void SetDrift(int32_t ppm);
+
+    // total time advanced, which doesn't wrap like Millis
+    uint64_t ElapsedMicros() { return elapsed_us; }
+
+private:
+    int64_t TimeOfDayMicros();
+
+    uint64_t elapsed_us;
+    int64_t time_base_us; // the time of day when it was last set or the drift changed
+    uint64_t time_set_us; // elapsed_us at that point
+    int32_t drift_ppm;
+};
+
+// use a clock in place of the hardware clock (NULL to return to it), before the instrument is set up
+void SetStratoClock(StratoClock * clock);
+
+// StratoCore's timekeeping goes through these instead of now(), setTime(), millis() and micros()
+time_t StratoNow();
+void StratoSetTime(time_t time);
+uint32_t StratoMillis();
+uint32_t StratoMicros();
+void StratoIdleWait(uint32_t max_ms);
+
+#endif /* STRATOCLOCK_H */
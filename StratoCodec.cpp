@@ -0,0 +1,313 @@
+/*
+ *  StratoCodec.cpp
+ *  Author:  StratoCore contributors
+ *  Created: October 2026
+ *
+ *  This file implements an optional codec for TM buffers
+ */
+
+#include "StratoCodec.h"
+#include <string.h>
+
+// Helpers ------------------------------------------------
+
+static uint32_t GetBigEndian(const uint8_t * buffer, uint8_t width)
+{
+    uint32_t value = 0;
+
+    for (uint8_t i = 0; i < width; i++) {
+        value = (value << 8) | buffer[i];
+    }
+
+    return value;
+}
+
+static void PutBigEndian(uint8_t * buffer, uint8_t width, uint32_t value)
+{
+    for (uint8_t i = width; i > 0; i--) {
+        buffer[i - 1] = (uint8_t) value;
+        value >>= 8;
+    }
+}
+
+static uint16_t LZHash(const uint8_t * data)
+{
+    uint32_t bytes = ((uint32_t) data[0] << 16) | ((uint32_t) data[1] << 8) | data[2];
+
+    return (uint16_t) (((bytes * 2654435761UL) >> 16) % CODEC_LZ_HASH_SIZE);
+}
+
+// Delta + varint -----------------------------------------
+
+bool CodecDeltaEncode(uint8_t width, uint8_t stride, const uint8_t * input, uint16_t size,
+                      uint8_t * output, uint16_t output_size, uint16_t * encoded_size)
+{
+    uint16_t count = 0;
+    uint16_t out = 0;
+    uint8_t shift = 0;
+
+    if (width < 1 || width > 4 || 0 == stride || NULL == input || NULL == output || NULL == encoded_size) return false;
+
+    count = size / width;
+    shift = (uint8_t) (32 - 8 * width);
+
+    for (uint16_t i = 0; i < count; i++) {
+        uint32_t value = GetBigEndian(&input[i * width], width);
+        uint32_t previous = (i >= stride) ? GetBigEndian(&input[(i - stride) * width], width) : 0;
+
+        // the difference as a signed value of the width, then zigzag so small magnitudes are small varints
+        int32_t difference = (int32_t) ((value - previous) << shift) >> shift;
+        uint32_t zigzag = ((uint32_t) difference << 1) ^ (uint32_t) (difference >> 31);
+
+        while (zigzag >= 0x80) {
+            if (out >= output_size) return false;
+            output[out++] = (uint8_t) (zigzag | 0x80);
+            zigzag >>= 7;
+        }
+
+        if (out >= output_size) return false;
+        output[out++] = (uint8_t) zigzag;
+    }
+
+    // any bytes left over that don't make up a value are copied as they are
+    for (uint16_t i = count * width; i < size; i++) {
+        if (out >= output_size) return false;
+        output[out++] = input[i];
+    }
+
+    *encoded_size = out;
+
+    return true;
+}
+
+bool CodecDeltaDecode(uint8_t width, uint8_t stride, const uint8_t * input, uint16_t size, uint8_t * output, uint16_t raw_size)
+{
+    uint16_t count = 0;
+    uint16_t in = 0;
+    uint32_t mask = 0;
+
+    if (width < 1 || width > 4 || 0 == stride || NULL == input || NULL == output) return false;
+
+    count = raw_size / width;
+    mask = (4 == width) ? 0xFFFFFFFFUL : ((1UL << (8 * width)) - 1);
+
+    for (uint16_t i = 0; i < count; i++) {
+        uint32_t zigzag = 0;
+        uint8_t bits = 0;
+
+        while (true) {
+            if (in >= size || bits > 28) return false;
+            zigzag |= (uint32_t) (input[in] & 0x7F) << bits;
+            bits += 7;
+            if (0 == (input[in++] & 0x80)) break;
+        }
+
+        uint32_t difference = (zigzag >> 1) ^ (0 - (zigzag & 1));
+        uint32_t previous = (i >= stride) ? GetBigEndian(&output[(i - stride) * width], width) : 0;
+
+        PutBigEndian(&output[i * width], width, (previous + difference) & mask);
+    }
+
+    // the leftover bytes must be exactly the rest of the input
+    if (size - in != raw_size - count * width) return false;
+    memcpy(&output[count * width], &input[in], size - in);
+
+    return true;
+}
+
+// LZSS ---------------------------------------------------
+
+bool CodecLZDecode(const uint8_t * input, uint16_t size, uint8_t * output, uint16_t output_size, uint16_t * decoded_size)
+{
+    uint16_t in = 0;
+    uint16_t out = 0;
+
+    if (NULL == input || NULL == output || NULL == decoded_size) return false;
+
+    while (in < size) {
+        uint8_t flags = input[in++];
+
+        for (uint8_t bit = 0; bit < 8 && in < size; bit++) {
+            if (0 == (flags & (1 << bit))) {
+                if (out >= output_size) return false;
+                output[out++] = input[in++];
+                continue;
+            }
+
+            if (in + 2 > size) return false;
+            uint16_t match = (uint16_t) ((input[in] << 8) | input[in + 1]);
+            uint16_t distance = (uint16_t) ((match >> 4) + 1);
+            uint16_t length = (uint16_t) ((match & 0x0F) + CODEC_LZ_MIN_MATCH);
+            in += 2;
+
+            if (0x0F == (match & 0x0F)) {
+                if (in >= size) return false;
+                length += input[in++];
+            }
+
+            if (distance > out || length > output_size - out) return false;
+
+            // byte by byte, a match can overlap the bytes it produces
+            for (uint16_t i = 0; i < length; i++, out++) {
+                output[out] = output[out - distance];
+            }
+        }
+    }
+
+    *decoded_size = out;
+
+    return true;
+}
+
+bool CodecDecode(const uint8_t * input, uint16_t size, uint8_t * output, uint16_t output_size, uint16_t * decoded_size,
+                 uint8_t * scratch, uint16_t scratch_size)
+{
+    uint16_t raw_size = 0;
+    uint16_t lz_size = 0;
+
+    if (NULL == input || NULL == output || NULL == decoded_size || size < CODEC_HEADER_SIZE) return false;
+
+    uint8_t codec = input[0];
+    uint8_t width = input[1];
+    uint8_t stride = input[2];
+    const uint8_t * payload = &input[CODEC_HEADER_SIZE];
+    uint16_t payload_size = (uint16_t) (size - CODEC_HEADER_SIZE);
+
+    raw_size = (uint16_t) GetBigEndian(&input[3], 2);
+    if (0 != (codec & ~CODEC_MASK) || raw_size > output_size) return false;
+
+    switch (codec) {
+    case CODEC_NONE:
+        if (payload_size != raw_size) return false;
+        memcpy(output, payload, raw_size);
+        break;
+    case CODEC_DELTA:
+        if (!CodecDeltaDecode(width, stride, payload, payload_size, output, raw_size)) return false;
+        break;
+    case CODEC_LZ:
+        if (!CodecLZDecode(payload, payload_size, output, output_size, &lz_size) || lz_size != raw_size) return false;
+        break;
+    case CODEC_DELTA | CODEC_LZ:
+    default:
+        if (NULL == scratch || !CodecLZDecode(payload, payload_size, scratch, scratch_size, &lz_size)) return false;
+        if (!CodecDeltaDecode(width, stride, scratch, lz_size, output, raw_size)) return false;
+        break;
+    }
+
+    *decoded_size = raw_size;
+
+    return true;
+}
+
+// StratoCodec --------------------------------------------
+
+StratoCodec::StratoCodec(uint8_t * output_buffer, uint8_t * work_buffer, uint16_t buffer_size)
+{
+    output = output_buffer;
+    work = work_buffer;
+    capacity = buffer_size;
+}
+
+uint16_t StratoCodec::Encode(uint8_t codec, uint8_t width, uint8_t stride, const uint8_t * input, uint16_t size)
+{
+    const uint8_t * stage = input;
+    uint16_t stage_size = size;
+    bool encoded = true;
+
+    if (NULL == input || capacity < CODEC_HEADER_SIZE || 0 != (codec & ~CODEC_MASK)) return 0;
+    if ((codec & CODEC_DELTA) && (width < 1 || width > 4 || 0 == stride)) return 0;
+
+    if (codec & CODEC_DELTA) {
+        // straight into the output, or into the work buffer for the LZ stage
+        uint8_t * destination = (codec & CODEC_LZ) ? work : &output[CODEC_HEADER_SIZE];
+        uint16_t destination_size = (codec & CODEC_LZ) ? capacity : (uint16_t) (capacity - CODEC_HEADER_SIZE);
+
+        encoded = CodecDeltaEncode(width, stride, input, size, destination, destination_size, &stage_size);
+        stage = destination;
+    }
+
+    if (encoded && (codec & CODEC_LZ)) {
+        encoded = LZEncode(stage, stage_size, &output[CODEC_HEADER_SIZE], (uint16_t) (capacity - CODEC_HEADER_SIZE), &stage_size);
+    }
+
+    // send it raw if the codec didn't help
+    if (CODEC_NONE == codec || !encoded || stage_size >= size) {
+        if (size > capacity - CODEC_HEADER_SIZE) return 0;
+
+        memcpy(&output[CODEC_HEADER_SIZE], input, size);
+        stage_size = size;
+        codec = CODEC_NONE;
+    }
+
+    output[0] = codec;
+    output[1] = (codec & CODEC_DELTA) ? width : 0;
+    output[2] = (codec & CODEC_DELTA) ? stride : 0;
+    PutBigEndian(&output[3], 2, size);
+
+    return (uint16_t) (CODEC_HEADER_SIZE + stage_size);
+}
+
+// greedy LZSS: take the longest match at the most recent position with the same hash
+bool StratoCodec::LZEncode(const uint8_t * input, uint16_t size, uint8_t * output, uint16_t output_size, uint16_t * encoded_size)
+{
+    uint16_t pos = 0;
+    uint16_t out = 0;
+    uint16_t flag_index = 0;
+    uint8_t bit = 8;
+
+    if (NULL == input || NULL == output || NULL == encoded_size) return false;
+
+    memset(hash_table, 0xFF, sizeof(hash_table));
+
+    while (pos < size) {
+        uint16_t length = 0;
+        uint16_t distance = 0;
+
+        // a flag byte precedes each group of 8 items
+        if (8 == bit) {
+            if (out >= output_size) return false;
+            flag_index = out;
+            output[out++] = 0;
+            bit = 0;
+        }
+
+        if (size - pos >= CODEC_LZ_MIN_MATCH) {
+            uint16_t hash = LZHash(&input[pos]);
+            uint16_t candidate = hash_table[hash];
+            hash_table[hash] = pos;
+
+            if (0xFFFF != candidate && pos - candidate <= CODEC_LZ_WINDOW) {
+                uint16_t limit = (size - pos < CODEC_LZ_MAX_MATCH) ? (uint16_t) (size - pos) : (uint16_t) CODEC_LZ_MAX_MATCH;
+                while (length < limit && input[candidate + length] == input[pos + length]) length++;
+                distance = (uint16_t) (pos - candidate);
+            }
+        }
+
+        if (length >= CODEC_LZ_MIN_MATCH) {
+            uint16_t extra = (uint16_t) (length - CODEC_LZ_MIN_MATCH);
+            uint8_t nibble = (extra >= 15) ? 15 : (uint8_t) extra;
+            uint16_t match = (uint16_t) (((distance - 1) << 4) | nibble);
+
+            if (out + ((15 == nibble) ? 3 : 2) > output_size) return false;
+            output[out++] = (uint8_t) (match >> 8);
+            output[out++] = (uint8_t) match;
+            if (15 == nibble) output[out++] = (uint8_t) (extra - 15);
+            output[flag_index] |= (uint8_t) (1 << bit);
+
+            // index the positions inside the match too
+            for (uint16_t i = 1; i < length && size - (pos + i) >= CODEC_LZ_MIN_MATCH; i++) {
+                hash_table[LZHash(&input[pos + i])] = (uint16_t) (pos + i);
+            }
+            pos += length;
+        } else {
+            if (out >= output_size) return false;
+            output[out++] = input[pos++];
+        }
+
+        bit++;
+    }
+
+    *encoded_size = out;
+
+    return true;
+}
@@ -0,0 +1,85 @@
+/*
+ *  StratoCodec.h
+ *  Author:  StratoCore contributors
+ *  Created: October 2026
+ *
+ *  This file declares an optional codec for TM buffers: delta + varint
+ *  encoding for time series and a small LZSS compressor with fixed RAM.
+ *  The decoder is shared with the host tools.
+ */
+
+#ifndef STRATOCODEC_H
+#define STRATOCODEC_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// An encoded buffer starts with a header that says how to decode it:
+//   uint8_t codec (CODEC_* flags), uint8_t delta width, uint8_t delta stride, uint16_t raw length (big-endian)
+#define CODEC_HEADER_SIZE   5
+
+// codec flags, delta and LZ can be combined (delta first)
+#define CODEC_NONE          0x00 // raw data, also used when encoding wouldn't make the data smaller
+#define CODEC_DELTA         0x01 // big-endian integers of the delta width, each the zigzag varint of its
+                                 // difference from the value delta stride values before (for interleaved channels)
+#define CODEC_LZ            0x02 // LZSS: a flag byte for each 8 items (LSB first), 1 = match, 0 = literal byte
+#define CODEC_MASK          (CODEC_DELTA | CODEC_LZ)
+
+// LZ matches are two bytes, a 12 bit distance - 1 and a 4 bit length - CODEC_LZ_MIN_MATCH, big-endian,
+// and a length of 15 is followed by a byte to add to it
+#define CODEC_LZ_WINDOW     4096
+#define CODEC_LZ_MIN_MATCH  3
+#define CODEC_LZ_MAX_MATCH  (CODEC_LZ_MIN_MATCH + 15 + 255)
+
+// entries in the LZ hash table (uint16_t each)
+#ifndef CODEC_LZ_HASH_SIZE
+#define CODEC_LZ_HASH_SIZE  1024
+#endif
+
+// the stages on their own, also used by the host tools (false if the output doesn't fit or the input is invalid)
+bool CodecDeltaEncode(uint8_t width, uint8_t stride, const uint8_t * input, uint16_t size,
+                      uint8_t * output, uint16_t output_size, uint16_t * encoded_size);
+bool CodecDeltaDecode(uint8_t width, uint8_t stride, const uint8_t * input, uint16_t size, uint8_t * output, uint16_t raw_size);
+bool CodecLZDecode(const uint8_t * input, uint16_t size, uint8_t * output, uint16_t output_size, uint16_t * decoded_size);
+
+// decode a buffer with a codec header, the scratch buffer is only needed for CODEC_DELTA | CODEC_LZ
+bool CodecDecode(const uint8_t * input, uint16_t size, uint8_t * output, uint16_t output_size, uint16_t * decoded_size,
+                 uint8_t * scratch = NULL, uint16_t scratch_size = 0);
+
+class StratoCodec {
+public:
+    ~StratoCodec() { };
+
+    // encode a buffer with a header into Output(), returns the encoded size (0 on error). If the codec doesn't
+    // make the data smaller, it's stored raw with CODEC_NONE, so the output is at most size + CODEC_HEADER_SIZE.
+    uint16_t Encode(uint8_t codec, uint8_t width, uint8_t stride, const uint8_t * input, uint16_t size);
+
+    // LZSS stage on its own, false if the output doesn't fit
+    bool LZEncode(const uint8_t * input, uint16_t size, uint8_t * output, uint16_t output_size, uint16_t * encoded_size);
+
+    const uint8_t * Output() { return output; }
+
+protected:
+    StratoCodec(uint8_t * output_buffer, uint8_t * work_buffer, uint16_t buffer_size);
+
+private:
+    uint8_t * output;
+    uint8_t * work; // delta output before LZ
+    uint16_t capacity;
+
+    // most recent position of each 3 byte hash
+    uint16_t hash_table[CODEC_LZ_HASH_SIZE];
+};
+
+// statically-allocated codec for buffers up to MAX_SIZE bytes, including the header
+template <uint16_t MAX_SIZE>
+class StaticCodec : public StratoCodec {
+public:
+    StaticCodec() : StratoCodec(output_storage, work_storage, MAX_SIZE) { }
+
+private:
+    uint8_t output_storage[MAX_SIZE];
+    uint8_t work_storage[MAX_SIZE];
+};
+
+#endif /* STRATOCODEC_H */
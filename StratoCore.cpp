@@ -18,21 +18,54 @@ StratoCore::StratoCore(Stream * zephyr_serial, Instrument_t instrument, Stream *
     new_inst_mode = MODE_STANDBY;
     inst_substate = MODE_ENTRY; // substate starts as mode entry
 
+    for (uint8_t i = 0; i < NUM_MODES; i++) {
+        mode_tables[i] = NULL;
+        mode_table_sizes[i] = 0;
+    }
+
+    active_mode = NUM_MODES; // nothing run yet
+    active_substate = MODE_ENTRY;
+    active_since_ms = 0;
+
     RA_ack_flag = NO_ACK;
     S_ack_flag = NO_ACK;
     TM_ack_flag = NO_ACK;
 
     time_valid = false;
 
-    debug_serial = dbg_serial; // located in StratoGroundPort
+    // debug_serial is the buffered ground port, located in StratoGroundPort
+    ground_serial = dbg_serial;
+    ground_port.SetPort(ground_serial);
 
-    last_zephyr = now();
+    last_zephyr = StratoNow();
+
+    zephyr_port = zephyr_serial;
+    router_stats = {{0}, 0, 0, 0};
 
     tcs_remaining = 0;
+
+    downlink_tm = NO_TM_HANDLE;
+    downlink_resends = 0;
+
+    sd_drops_reported = 0;
+    last_sd_report = 0;
+
+    // generic TCs, registered first so that an instrument can't take their numbers
+    RegisterTCMethod(RESET_INST, &StratoCore::TCResetInst, "");
+    RegisterTCMethod(GETTMBUFFER, &StratoCore::TCGetTMBuffer, "");
+    RegisterTCMethod(SENDSTATE, &StratoCore::TCSendState, "");
+    RegisterTCMethod(GETPROFILE, &StratoCore::TCGetProfile, "");
+    RegisterTCMethod(DOWNLINKFILE, &StratoCore::TCDownlink, ""); // parameters checked by StartDownlink
+    RegisterTCMethod(DOWNLINKARCHIVE, &StratoCore::TCDownlink, "");
+    RegisterTCMethod(DOWNLINKSTOP, &StratoCore::TCDownlinkStop, "");
+    RegisterTCMethod(GETTCSTATS, &StratoCore::TCGetTCStats, "");
 }
 
 void StratoCore::InitializeCore()
 {
+    // again, in case the instrument is a global constructed before ground_port
+    ground_port.SetPort(ground_serial);
+
     if (!StartSD()) {
         log_error("StratoCore unable to start SD card");
     } else {
@@ -45,8 +78,19 @@ void StratoCore::InitializeCore()
 // initialize the watchdog using the 1kHz LPO clock source to achieve a 10s WDOG
 void StratoCore::InitializeWatchdog()
 {
+    Breadcrumb_t last;
+    bool have_breadcrumb = watchdog_monitor.Start(&last);
+
     if ((RCM_SRS0 & RCM_SRS0_WDOG) != 0) {
-        ZephyrLogCrit("Reset caused by watchdog");
+        if (have_breadcrumb) {
+            // report where the loop was when it stopped kicking
+            snprintf(log_array, LOG_ARRAY_SIZE, "Watchdog reset in %s, mode %u/%u, TC %u, action %u, loop %lu at %lu ms",
+                     StratoProfiler::PhaseName(last.phase), last.mode, last.substate, last.tc, last.action,
+                     (unsigned long) last.loop_count, (unsigned long) last.loop_ms);
+            ZephyrLogCrit(log_array);
+        } else {
+            ZephyrLogCrit("Reset caused by watchdog");
+        }
     }
 
     noInterrupts(); // disable interrupts
@@ -73,50 +117,169 @@ void StratoCore::KickWatchdog()
     WDOG_REFRESH = 0xA602;
     WDOG_REFRESH = 0xB480;
     interrupts();
+
+    profiler.EndLoop();
+
+    uint8_t level = watchdog_monitor.Kick();
+    if (level) WatchdogWarning(level, "at", "watchdog kick");
+}
+
+// record the phase in the breadcrumb and warn if the loop is running long, finished is the phase that just ended
+void StratoCore::WatchdogCheckpoint(uint8_t phase, uint8_t finished)
+{
+    uint8_t level = watchdog_monitor.EnterPhase(phase);
+
+    if (level == 0) return;
+
+    if (finished != BREADCRUMB_NO_PHASE) {
+        WatchdogWarning(level, "after", StratoProfiler::PhaseName(finished));
+    } else {
+        WatchdogWarning(level, "entering", StratoProfiler::PhaseName(phase));
+    }
+}
+
+void StratoCore::WatchdogWarning(uint8_t level, const char * when, const char * where)
+{
+    snprintf(log_array, LOG_ARRAY_SIZE, "Loop over %lu ms (of %u) %s %s, mode %u/%u",
+             (unsigned long) watchdog_monitor.GetThreshold(level), WATCHDOG_PERIOD_MS, when, where, inst_mode, inst_substate);
+    ZephyrLogWarn(log_array);
 }
 
 void StratoCore::RunMode()
 {
+    uint32_t phase_start = micros();
+
+    WatchdogCheckpoint(PHASE_MODE);
+
     // check for a new mode
     if (inst_mode != new_inst_mode) {
         // call the last mode after setting the substate to exit
         inst_substate = MODE_EXIT;
-        (this->*(mode_array[inst_mode]))();
+        RunSubstate();
 
-        // clear any scheduled items from the old mode
+        // clear any scheduled items and tasks from the old mode
         scheduler.ClearSchedule();
+        highres_scheduler.ClearSchedule();
+        tasks.Clear();
 
         // update the mode and set the substate to entry
         inst_mode = new_inst_mode;
         inst_substate = MODE_ENTRY;
     }
 
-    // run the current mode
-    (this->*(mode_array[inst_mode]))();
+    RunSubstate();
+
+    profiler.Record(PHASE_MODE, phase_start);
+    WatchdogCheckpoint(BREADCRUMB_NO_PHASE, PHASE_MODE);
+}
+
+// runs the current mode/substate from its table or mode function, recording the substate it was called in
+void StratoCore::RunSubstate()
+{
+    const SubstateEntry_t * entry = NULL;
+    uint8_t substate = inst_substate;
+    uint8_t next = 0;
+    uint32_t mode_start = 0;
+    uint32_t now_ms = StratoMillis();
+
+    // time spent and entries counted by mode/substate, whether transitions come from a table or the mode function
+    if (inst_mode != active_mode || substate != active_substate) {
+        if (active_mode < NUM_MODES) profiler.RecordModeDwell(active_mode, active_substate, now_ms - active_since_ms);
+        profiler.RecordModeEntry(inst_mode, substate);
+        active_mode = inst_mode;
+        active_substate = substate;
+        active_since_ms = now_ms;
+    }
+
+    for (uint8_t i = 0; i < mode_table_sizes[inst_mode]; i++) {
+        if (mode_tables[inst_mode][i].substate == substate) {
+            entry = &mode_tables[inst_mode][i];
+            break;
+        }
+    }
+
+    watchdog_monitor.SetMode(inst_mode, substate);
+    mode_start = micros();
+    if (NULL != entry) {
+        next = (this->*(entry->handler))();
+    } else {
+        (this->*(mode_array[inst_mode]))();
+    }
+    profiler.RecordMode(inst_mode, substate, micros() - mode_start);
+
+    // the exit substate's result is ignored, the new mode starts at MODE_ENTRY
+    if (NULL == entry || MODE_EXIT == substate) return;
+
+    if (MODE_ERROR == next) {
+        next = entry->on_error;
+    } else if (next == substate && 0 != entry->timeout_s && StratoMillis() - active_since_ms >= entry->timeout_s * 1000UL) {
+        log_nominalf("Mode %u substate %u timed out", (unsigned int) inst_mode, (unsigned int) substate);
+        next = entry->on_timeout;
+    }
+
+    inst_substate = next;
 }
 
-void StratoCore::RunRouter()
+void StratoCore::SetModeTable(InstMode_t mode, const SubstateEntry_t * table, uint8_t size)
 {
-    // process as many messages as are available
+    if (mode >= NUM_MODES) return;
+
+    mode_tables[mode] = table;
+    mode_table_sizes[mode] = (NULL != table) ? size : 0;
+}
+
+void StratoCore::RunRouter(uint16_t max_msgs, uint32_t max_us)
+{
+    uint32_t route_start = 0;
+    uint16_t routed = 0;
+
+    uint32_t phase_start = micros();
+
+    WatchdogCheckpoint(PHASE_ROUTER);
+
+    // catch up on ground port output that the port couldn't take earlier
+    ground_port.Drain();
+
+    // route messages within the per-loop limits (0 for no limit), a burst or noisy line is left on the port for later loops
+    route_start = micros();
     while (zephyrRX.GetNewMessage()) {
         RouteRXMessage(zephyrRX.zephyr_message);
-    }
+        routed++;
 
-    // handle one TC per loop
-    if (tcs_remaining > 0) {
-        tcs_remaining--;
-        NextTelecommand();
+        // unqueued TCs are run from zephyrRX, so they run before another message can replace them
+        if (tcs_remaining > 0) break;
+
+        if ((0 != max_msgs && routed >= max_msgs) || (0 != max_us && micros() - route_start >= max_us)) {
+            if (zephyr_port->available() > 0) router_stats.loops_deferred++;
+            break;
+        }
     }
 
+    if (routed > router_stats.max_per_loop) router_stats.max_per_loop = routed;
+
+    // resend a TM that was NAKed or whose TMAck is overdue, or send the next queued TM
+    ServiceTM();
+
+    // run queued TCs within the per-loop limits
+    RunTelecommands();
+
+    // send the next downlink chunk once the last is acknowledged (TMAcks were routed above)
+    if (downlink.IsActive()) ServiceDownlink();
+
     // check for Zephyr no contact timeout
-    if (now() > last_zephyr + ZEPHYR_TIMEOUT) {
+    if (StratoNow() > last_zephyr + ZEPHYR_TIMEOUT) {
         ZephyrLogCrit("Zephyr comm loss timeout");
         new_inst_mode = MODE_SAFETY;
     }
+
+    profiler.Record(PHASE_ROUTER, phase_start);
+    WatchdogCheckpoint(BREADCRUMB_NO_PHASE, PHASE_ROUTER);
 }
 
 void StratoCore::RouteRXMessage(ZephyrMessage_t message)
 {
+    router_stats.routed[(message <= UNKNOWN) ? message : UNKNOWN]++;
+
     switch (message) {
     case IM:
         new_inst_mode = zephyrRX.zephyr_mode;
@@ -128,13 +291,21 @@ void StratoCore::RouteRXMessage(ZephyrMessage_t message)
     case SW:
         // set the substate to shutdown and let the mode functions handle it
         inst_substate = MODE_SHUTDOWN;
+
+        // get buffered data onto the card before power is lost, from StratoCore's logs and the instrument's
+        if (!SyncSDLoggers()) log_error("SD sync failed on shutdown warning");
         break;
     case TC:
-        if (tcs_remaining > 0) ZephyrLogWarn("TC received too quickly! Last TC overwritten");
-        tcs_remaining = zephyrRX.num_tcs;
-
-        // we've successfully parsed the TC
-        zephyrTX.TCAck(true);
+        if (tc_queue.Enabled()) {
+            // queued whole behind any TCs still waiting, and ACKed if there was room
+            QueueTelecommands();
+        } else {
+            // run from zephyrRX by RunRouter before the next message is read, and in later loops past the
+            // per-loop limits or a null TC unless another TC message replaces them
+            if (tcs_remaining > 0) ZephyrLogWarn("TC received too quickly! Last TC overwritten");
+            tcs_remaining = zephyrRX.num_tcs;
+            zephyrTX.TCAck(true);
+        }
         break;
     case SAck:
         S_ack_flag = (zephyrRX.zephyr_ack == 1) ? ACK : NAK;
@@ -144,93 +315,539 @@ void StratoCore::RouteRXMessage(ZephyrMessage_t message)
         break;
     case TMAck:
         TM_ack_flag = (zephyrRX.zephyr_ack == 1) ? ACK : NAK;
+        tm_manager.Ack(zephyrRX.zephyr_ack == 1);
         break;
     case NO_ZEPHYR_MSG:
         break;
     default:
+        router_stats.unknown++;
         log_error("Unknown message to route");
         break;
     }
 
-    last_zephyr = now();
+    last_zephyr = StratoNow();
 }
 
 void StratoCore::RunScheduler()
 {
-    uint8_t scheduled_action = scheduler.CheckSchedule();
+    uint32_t phase_start = micros();
+    uint32_t action_start = 0;
+    uint8_t scheduled_action = 0;
 
+    WatchdogCheckpoint(PHASE_SCHEDULER);
+
+    scheduled_action = scheduler.CheckSchedule();
     while (scheduled_action != NO_SCHEDULED_ACTION) {
+        watchdog_monitor.SetAction(scheduled_action);
+        WatchdogCheckpoint(PHASE_ACTION);
+        action_start = micros();
         ActionHandler(scheduled_action);
+        profiler.Record(PHASE_ACTION, action_start);
+        WatchdogCheckpoint(PHASE_SCHEDULER, PHASE_ACTION);
         scheduled_action = scheduler.CheckSchedule();
     }
+
+    profiler.Record(PHASE_SCHEDULER, phase_start);
+    WatchdogCheckpoint(BREADCRUMB_NO_PHASE, PHASE_SCHEDULER);
+}
+
+void StratoCore::RunHighResScheduler()
+{
+    uint32_t phase_start = micros();
+    uint32_t lateness = 0;
+    uint8_t scheduled_action = 0;
+
+    WatchdogCheckpoint(PHASE_HIGHRES);
+
+    scheduled_action = highres_scheduler.CheckSchedule(&lateness);
+    while (scheduled_action != NO_SCHEDULED_ACTION) {
+        watchdog_monitor.SetAction(scheduled_action);
+        HighResActionHandler(scheduled_action, lateness);
+        scheduled_action = highres_scheduler.CheckSchedule(&lateness);
+    }
+
+    profiler.Record(PHASE_HIGHRES, phase_start);
+    WatchdogCheckpoint(BREADCRUMB_NO_PHASE, PHASE_HIGHRES);
+}
+
+void StratoCore::RunTasks(uint32_t max_us)
+{
+    uint32_t phase_start = micros();
+    uint32_t task_start = 0;
+    uint8_t task = NO_TASK;
+    TaskControl_t * control = NULL;
+    TaskResult_t result = TASK_DONE;
+
+    WatchdogCheckpoint(PHASE_TASKS);
+
+    // each ready task runs to its next yield at most once per loop, starting after the last one run
+    tasks.BeginLoop();
+    while (NO_TASK != (task = tasks.NextReady())) {
+        control = tasks.Begin(task);
+        task_start = micros();
+        result = (this->*(control->method))(control);
+        tasks.Finish(task, result, micros() - task_start);
+
+        if (0 != max_us && micros() - phase_start >= max_us) {
+            if (NO_TASK != tasks.NextReady()) tasks.LoopLimited();
+            break;
+        }
+    }
+
+    profiler.Record(PHASE_TASKS, phase_start);
+    WatchdogCheckpoint(BREADCRUMB_NO_PHASE, PHASE_TASKS);
+}
+
+void StratoCore::RunSDWriter(uint32_t max_bytes, uint32_t max_us)
+{
+    uint32_t phase_start = micros();
+
+    WatchdogCheckpoint(PHASE_SD);
+
+    ServiceSDLoggers(max_bytes, max_us);
+
+    // report back-pressure if the card isn't keeping up and data is being dropped
+    const SDWriteStats_t & sd_stats = GetSDWriteStats();
+    if (sd_stats.bytes_dropped > sd_drops_reported && StratoNow() - last_sd_report >= SD_DROP_REPORT_INTERVAL) {
+        snprintf(log_array, LOG_ARRAY_SIZE, "SD behind: %lu B dropped, %lu B queued (max %lu), %lu loops over budget",
+                 (unsigned long) (sd_stats.bytes_dropped - sd_drops_reported), (unsigned long) sd_stats.queue_depth,
+                 (unsigned long) sd_stats.max_queue_depth, (unsigned long) sd_stats.budget_exhausted);
+        ZephyrLogWarn(log_array);
+
+        sd_drops_reported = sd_stats.bytes_dropped;
+        last_sd_report = StratoNow();
+    }
+
+    profiler.Record(PHASE_SD, phase_start);
+    WatchdogCheckpoint(BREADCRUMB_NO_PHASE, PHASE_SD);
+}
+
+void StratoCore::RunInstrumentLoop()
+{
+    uint32_t phase_start = micros();
+
+    WatchdogCheckpoint(PHASE_INSTRUMENT);
+
+    InstrumentLoop();
+
+    profiler.Record(PHASE_INSTRUMENT, phase_start);
+    WatchdogCheckpoint(BREADCRUMB_NO_PHASE, PHASE_INSTRUMENT);
+}
+
+IdleWake_t StratoCore::Idle(uint32_t max_ms)
+{
+    IdleWake_t reason = IDLE_WAKE_TIMEOUT;
+    uint32_t sleep_ms = max_ms;
+    uint32_t highres_ms = 0;
+    time_t schedule_s = 0;
+    uint32_t watchdog_ms = WATCHDOG_PERIOD_MS - IDLE_WATCHDOG_MARGIN_MS;
+    uint32_t since_kick = watchdog_monitor.SinceKick();
+    uint32_t idle_start = 0;
+
+    // work that is already waiting for the loop
+    if (zephyr_port->available() > 0) {
+        sleep_ms = 0;
+        reason = IDLE_WAKE_INPUT;
+    } else if (tc_queue.Count() > 0 || tcs_remaining > 0) {
+        sleep_ms = 0;
+        reason = IDLE_WAKE_TC;
+    }
+
+    // otherwise, the earliest deadline (1 Hz actions are only known to the second)
+    if (scheduler.TimeUntilNext(&schedule_s) && schedule_s <= (time_t) (sleep_ms / 1000) && (uint32_t) schedule_s * 1000 < sleep_ms) {
+        sleep_ms = (uint32_t) schedule_s * 1000;
+        reason = IDLE_WAKE_SCHEDULE;
+    }
+
+    if (highres_scheduler.TimeUntilNext(&highres_ms) && highres_ms < sleep_ms) {
+        sleep_ms = highres_ms;
+        reason = IDLE_WAKE_HIGHRES;
+    }
+
+    watchdog_ms = (since_kick < watchdog_ms) ? watchdog_ms - since_kick : 0;
+    if (watchdog_ms < sleep_ms) {
+        sleep_ms = watchdog_ms;
+        reason = IDLE_WAKE_WATCHDOG;
+    }
+
+    idle_start = StratoMillis();
+    reason = idle.Sleep(sleep_ms, reason, zephyr_port);
+
+    // sleeping isn't loop work, so it doesn't count toward the watchdog warnings
+    watchdog_monitor.ExcludeIdle(StratoMillis() - idle_start);
+
+    return reason;
 }
 
 void StratoCore::ZephyrLogFine(const char * log_info)
 {
     if (NULL == log_info) return;
 
+    ground_port.BeginLine(LOG_NOMINAL);
     debug_serial->print("Zephyr-FINE: ");
     debug_serial->println(log_info);
-    zephyrTX.TM_String(FINE, log_info);
-    TM_ack_flag = NO_ACK;
+    QueueTM(true, FINE, log_info, tm_manager.MaxRetries());
 }
 
 void StratoCore::ZephyrLogWarn(const char * log_info)
 {
     if (NULL == log_info) return;
 
+    ground_port.BeginLine(LOG_ERROR);
     debug_serial->print("Zephyr-WARN: ");
     debug_serial->println(log_info);
-    zephyrTX.TM_String(WARN, log_info);
-    TM_ack_flag = NO_ACK;
+    QueueTM(true, WARN, log_info, tm_manager.MaxRetries());
 }
 
 void StratoCore::ZephyrLogCrit(const char * log_info)
 {
     if (NULL == log_info) return;
 
+    ground_port.BeginLine(LOG_ERROR);
     debug_serial->print("Zephyr-CRIT: ");
     debug_serial->println(log_info);
-    zephyrTX.TM_String(CRIT, log_info);
-    TM_ack_flag = NO_ACK;
+    QueueTM(true, CRIT, log_info, tm_manager.MaxRetries());
 }
 
 void StratoCore::SendTMBuffer()
 {
     // use only the first flag to report the motion
-    zephyrTX.setStateDetails(1, "TM buffer as requested");
-    zephyrTX.setStateFlagValue(1, FINE);
-    zephyrTX.setStateFlagValue(2, NOMESS);
-    zephyrTX.setStateFlagValue(3, NOMESS);
+    SendTM(FINE, "TM buffer as requested");
+}
+
+bool StratoCore::SendTM(StateFlag_t flag, const char * details)
+{
+    return NO_TM_HANDLE != QueueTM(false, flag, details, tm_manager.MaxRetries());
+}
+
+// copy the zephyrTX TM buffer (or, for a text TM, nothing) into a TM manager buffer, and send it if nothing
+// is waiting for a TMAck
+TMHandle_t StratoCore::QueueTM(bool text, StateFlag_t flag, const char * details, uint8_t max_retries, bool keep)
+{
+    uint8_t * tm_buffer = NULL;
+    uint16_t tm_size = text ? 0 : zephyrTX.getTmBuffer(&tm_buffer);
+    TMHandle_t handle = tm_manager.Queue(tm_buffer, tm_size, flag, details, text, max_retries, keep);
+
+    if (NO_TM_HANDLE == handle) {
+        log_error("No TM buffer free, TM dropped");
+        return NO_TM_HANDLE;
+    }
+
+    ServiceTM();
+    return handle;
+}
+
+// queue a TM composed in a TM manager buffer (see TMBuilder), so StratoCore's own TMs never use zephyrTX's
+// TM buffer
+TMHandle_t StratoCore::QueueTM(TMBuilder & builder, StateFlag_t flag, const char * details, uint8_t max_retries, bool keep)
+{
+    TMHandle_t handle = tm_manager.Queue(builder, flag, details, max_retries, keep);
+
+    if (NO_TM_HANDLE == handle) {
+        log_error("TM too large for a TM buffer, TM dropped");
+        return NO_TM_HANDLE;
+    }
+
+    ServiceTM();
+    return handle;
+}
+
+// resend or send the next TM once nothing is waiting for a TMAck. TMs are sent with zephyrTX, the only writer
+// on the port, so that Zephyr sees one sequence of message IDs. Whatever the instrument has in the zephyrTX
+// TM buffer is put back afterwards: a data TM's buffer is swapped with the TM buffer for the send and swapped
+// back, and the length is restored by re-adding the bytes in place. This relies on XMLWriter::clearTm and
+// TM_String only resetting the length, not the contents, of the TM buffer. State flags and details set on
+// zephyrTX directly are overwritten, TMs carry theirs through SendTM.
+void StratoCore::ServiceTM()
+{
+    uint8_t slot = NO_TM_SLOT;
+    uint8_t * tm_buffer = NULL;
+    uint16_t filled = 0;
+    uint16_t swapped = 0;
+
+    tm_manager.CheckTimeout(StratoMillis());
+
+    if (NO_TM_SLOT == (slot = tm_manager.NextToSend(StratoMillis()))) return;
+
+    const TMSlot_t & tm = tm_manager.Slot(slot);
 
     TM_ack_flag = NO_ACK;
+
+    filled = zephyrTX.getTmBuffer(&tm_buffer);
+
+    if (tm.text) {
+        zephyrTX.TM_String((StateFlag_t) tm.flag, tm.details);
+        SetTMLength(tm_buffer, filled);
+        return;
+    }
+
+    // TM_SLOT_SIZE >= TM_BUFFER_SIZE, so the larger of the two always fits in the slot
+    swapped = (filled > tm.size) ? filled : tm.size;
+    tm_manager.SwapData(slot, tm_buffer, swapped);
+    SetTMLength(tm_buffer, tm.size);
+
+    zephyrTX.setStateDetails(1, tm.details);
+    zephyrTX.setStateFlagValue(1, (StateFlag_t) tm.flag);
+    zephyrTX.setStateFlagValue(2, NOMESS);
+    zephyrTX.setStateFlagValue(3, NOMESS);
     zephyrTX.TM();
+
+    tm_manager.SwapData(slot, tm_buffer, swapped);
+    SetTMLength(tm_buffer, filled);
+}
+
+// XMLWriter has no way to set the length of its TM buffer, so clear it and add each byte back onto itself
+void StratoCore::SetTMLength(uint8_t * tm_buffer, uint16_t size)
+{
+    zephyrTX.clearTm();
+
+    for (uint16_t i = 0; i < size; i++) {
+        zephyrTX.addTm(tm_buffer[i]);
+    }
+}
+
+bool StratoCore::EncodeTMBuffer(StratoCodec & codec, uint8_t codec_flags, uint8_t delta_width, uint8_t delta_stride)
+{
+    uint8_t * tm_buffer = NULL;
+    uint16_t tm_size = zephyrTX.getTmBuffer(&tm_buffer);
+    uint16_t encoded_size = codec.Encode(codec_flags, delta_width, delta_stride, tm_buffer, tm_size);
+
+    // on an error (or without room for the header) the TM buffer is left as it was
+    if (0 == encoded_size || encoded_size > TM_BUFFER_SIZE) {
+        log_error("Unable to encode TM buffer");
+        return false;
+    }
+
+    zephyrTX.clearTm();
+
+    return zephyrTX.addTm(codec.Output(), encoded_size);
 }
 
 bool StratoCore::WriteFileTM(const char * file_prefix)
 {
-    char filename[64] = {0};
     uint8_t * tm_buffer = NULL;
     uint16_t tm_size = 0;
 
     if (NULL == file_prefix) return false;
 
-    // prep the filename and check it was created correctly
-    if (63 < snprintf(filename, 64, "%s_%ld.dat", file_prefix, now())) return false;
+    // records are appended to one archive per prefix, start a new one if the prefix changes
+    if (!tm_log.IsLogging() || 0 != strcmp(file_prefix, tm_log.Prefix())) {
+        if (!tm_log.Open(file_prefix)) return false;
+    }
 
     // get a pointer to the TM buffer and its size
     tm_size = zephyrTX.getTmBuffer(&tm_buffer);
 
-    bool success = FileWrite(filename, (const char *) tm_buffer, tm_size);
+    return tm_log.WriteRecord(ARCHIVE_TYPE_TM, (uint32_t) StratoNow(), tm_buffer, tm_size);
+}
 
-    return success;
+void StratoCore::SendProfileTM()
+{
+    TMBuilder builder;
+    bool building = tm_manager.Build(builder);
+
+    // per phase: count, min, mean, max, overruns, histogram (all uint32_t)
+    for (uint8_t i = 0; i < NUM_PHASES; i++) {
+        const PhaseStats_t & stats = profiler.GetPhase((ProfilePhase_t) i);
+        builder.Add(stats.count);
+        builder.Add(stats.min_us);
+        builder.Add(stats.count ? (uint32_t) (stats.total_us / stats.count) : (uint32_t) 0);
+        builder.Add(stats.max_us);
+        builder.Add(stats.overruns);
+        for (uint8_t j = 0; j < PROFILE_BUCKETS; j++) {
+            builder.Add(stats.histogram[j]);
+        }
+    }
+
+    // per mode/substate pair: mode, substate (uint8_t), count, mean, max, entries, ms spent (uint32_t)
+    for (uint8_t i = 0; i < profiler.NumModeSlots(); i++) {
+        const ModeStats_t & slot = profiler.GetModeSlot(i);
+        builder.Add(slot.mode);
+        builder.Add(slot.substate);
+        builder.Add(slot.count);
+        builder.Add(slot.count ? (uint32_t) (slot.total_us / slot.count) : (uint32_t) 0);
+        builder.Add(slot.max_us);
+        builder.Add(slot.entries);
+        builder.Add(slot.dwell_ms);
+    }
+
+    // time awake in tenths of a percent (uint16_t), sleeps and wakes by IdleWake_t (uint32_t)
+    const IdleStats_t & idle_stats = idle.GetStats();
+    uint16_t duty_cycle = idle.DutyCycle();
+    builder.Add(duty_cycle);
+    builder.Add(idle_stats.sleeps);
+    for (uint8_t i = 0; i < NUM_IDLE_WAKES; i++) {
+        builder.Add(idle_stats.wakes[i]);
+    }
+
+    // TMs since boot: sent, acked, retried, dropped, rejected, merged (uint32_t)
+    const TMStats_t & tm_stats = tm_manager.GetStats();
+    builder.Add(tm_stats.sent);
+    builder.Add(tm_stats.acked);
+    builder.Add(tm_stats.retried);
+    builder.Add(tm_stats.dropped);
+    builder.Add(tm_stats.rejected);
+    builder.Add(tm_stats.merged);
+
+    // built in a TM manager buffer so the instrument's TM buffer is left alone
+    if (building) {
+        QueueTM(builder, FINE, "Loop profile", tm_manager.MaxRetries());
+    } else {
+        log_error("No TM buffer free, profile TM dropped");
+    }
+
+    profiler.PrintProfile();
+
+    // routing counts aren't reset with the profile, they cover the time since boot
+    log_nominalf("Router: %lu IM, %lu GPS, %lu SW, %lu TC, %lu ack, %lu unknown, %lu loops deferred, max %u/loop",
+                 (unsigned long) router_stats.routed[IM], (unsigned long) router_stats.routed[GPS],
+                 (unsigned long) router_stats.routed[SW], (unsigned long) router_stats.routed[TC],
+                 (unsigned long) (router_stats.routed[SAck] + router_stats.routed[RAAck] + router_stats.routed[TMAck]),
+                 (unsigned long) router_stats.unknown, (unsigned long) router_stats.loops_deferred,
+                 (unsigned int) router_stats.max_per_loop);
+
+    log_nominalf("Idle: awake %u.%u%% of %lu s, %lu sleeps (max %lu ms), wakes: %lu timeout, %lu input, %lu TC, %lu schedule, %lu high-res, %lu watchdog",
+                 (unsigned int) (duty_cycle / 10), (unsigned int) (duty_cycle % 10), (unsigned long) (idle.Window() / 1000),
+                 (unsigned long) idle_stats.sleeps, (unsigned long) idle_stats.max_sleep_ms,
+                 (unsigned long) idle_stats.wakes[IDLE_WAKE_TIMEOUT], (unsigned long) idle_stats.wakes[IDLE_WAKE_INPUT],
+                 (unsigned long) idle_stats.wakes[IDLE_WAKE_TC], (unsigned long) idle_stats.wakes[IDLE_WAKE_SCHEDULE],
+                 (unsigned long) idle_stats.wakes[IDLE_WAKE_HIGHRES], (unsigned long) idle_stats.wakes[IDLE_WAKE_WATCHDOG]);
+
+    log_nominalf("TM: %lu sent, %lu acked, %lu retried (%lu NAK, %lu timeout), %lu dropped, %lu rejected, %lu merged, %lu unmatched acks, max %u queued",
+                 (unsigned long) tm_stats.sent, (unsigned long) tm_stats.acked, (unsigned long) tm_stats.retried,
+                 (unsigned long) tm_stats.naks, (unsigned long) tm_stats.timeouts, (unsigned long) tm_stats.dropped,
+                 (unsigned long) tm_stats.rejected, (unsigned long) tm_stats.merged, (unsigned long) tm_stats.unmatched_acks,
+                 (unsigned int) tm_stats.max_queued);
+
+    // each report covers the time since the last one
+    profiler.Reset();
+    idle.Reset();
+}
+
+void StratoCore::SendTCStatsTM()
+{
+    TMBuilder builder;
+    bool building = tm_manager.Build(builder);
+
+    // TCs without an entry (uint32_t), then per TC: number (uint16_t), count, parameter errors, mean, max (uint32_t)
+    builder.Add(tc_dispatch.Untracked());
+    for (uint8_t i = 0; i < tc_dispatch.NumEntries(); i++) {
+        const TCStats_t & stats = tc_dispatch.GetStats(i);
+        builder.Add(stats.telecommand);
+        builder.Add(stats.count);
+        builder.Add(stats.param_errors);
+        builder.Add(stats.count ? (uint32_t) (stats.total_us / stats.count) : (uint32_t) 0);
+        builder.Add(stats.max_us);
+
+        if (stats.count > 0 || stats.param_errors > 0) {
+            log_nominalf("TC %u: %lu run, %lu bad parameters, mean/max %lu/%lu us", (unsigned int) stats.telecommand,
+                         (unsigned long) stats.count, (unsigned long) stats.param_errors,
+                         (unsigned long) (stats.count ? stats.total_us / stats.count : 0), (unsigned long) stats.max_us);
+        }
+    }
+
+    if (building) {
+        QueueTM(builder, FINE, "TC stats", tm_manager.MaxRetries());
+    } else {
+        log_error("No TM buffer free, TC stats TM dropped");
+    }
+}
+
+void StratoCore::StartDownlink(uint16_t telecommand)
+{
+    const char * name = tc_queue.GetTCParam(0);
+    uint32_t start = 0, end = 0, offset = 0;
+    bool started = false;
+
+    // the offset is optional for both, it comes from a previous DOWNLINKSTOP or the last chunk received
+    if (DOWNLINKFILE == telecommand) {
+        started = (NULL != name)
+                  && (tc_queue.NumTCParams() < 2 || tc_queue.GetTCParam(1, &offset))
+                  && downlink.StartFile(name, offset);
+    } else {
+        started = (NULL != name)
+                  && tc_queue.GetTCParam(1, &start) && tc_queue.GetTCParam(2, &end)
+                  && (tc_queue.NumTCParams() < 4 || tc_queue.GetTCParam(3, &offset))
+                  && downlink.StartArchive(name, start, end, offset);
+    }
+
+    // a chunk of an earlier downlink still in the TM manager is no longer needed
+    tm_manager.Release(downlink_tm);
+    downlink_tm = NO_TM_HANDLE;
+    downlink_resends = 0;
+
+    if (!started) {
+        snprintf(log_array, LOG_ARRAY_SIZE, "Unable to start downlink of %s", (NULL != name) ? name : "(no name)");
+        ZephyrLogWarn(log_array);
+        return;
+    }
+
+    log_nominal("Downlink started");
+}
+
+// one chunk is in the TM manager at a time, which resends it on a NAK or timeout: advance once it's acked
+void StratoCore::ServiceDownlink()
+{
+    if (NO_TM_HANDLE != downlink_tm) {
+        TMStatus_t status = tm_manager.Status(downlink_tm);
+
+        if (TM_QUEUED == status || TM_IN_FLIGHT == status) return;
+
+        downlink_resends += tm_manager.Tries(downlink_tm) - 1;
+        tm_manager.Release(downlink_tm);
+        downlink_tm = NO_TM_HANDLE;
+
+        if (TM_ACKED != status) {
+            snprintf(log_array, LOG_ARRAY_SIZE, "Downlink of %s failed, resume at offset %lu",
+                     downlink.FileName(), (unsigned long) downlink.StreamOffset());
+            downlink.Stop();
+            ZephyrLogWarn(log_array);
+            return;
+        }
+
+        downlink.Advance();
+
+        if (!downlink.IsActive()) {
+            const DownlinkStats_t & stats = downlink.GetStats();
+            snprintf(log_array, LOG_ARRAY_SIZE, "Downlink complete: %lu chunks, %lu bytes, %lu resends",
+                     (unsigned long) stats.chunks_acked, (unsigned long) stats.bytes_acked, (unsigned long) downlink_resends);
+            ZephyrLogFine(log_array);
+            return;
+        }
+    }
+
+    // reading the chunk can take more than one loop on a slow card, and it waits for a free TM buffer
+    if (downlink.Prepare(DOWNLINK_US_PER_LOOP)) {
+        SendDownlinkTM();
+    } else if (downlink.Failed()) {
+        snprintf(log_array, LOG_ARRAY_SIZE, "Downlink of %s read error, resume at offset %lu",
+                 downlink.FileName(), (unsigned long) downlink.StreamOffset());
+        ZephyrLogWarn(log_array);
+    }
+}
+
+// the chunk is built in a TM manager buffer, so a downlink doesn't disturb the instrument's TMs; with no
+// buffer free, the chunk is sent on a later loop
+void StratoCore::SendDownlinkTM()
+{
+    TMBuilder builder;
+
+    if (!tm_manager.Build(builder)) return;
+
+    // chunk header: offset in the downlink, offset in the file (uint32_t), flags (uint8_t), then the data
+    builder.Add(downlink.ChunkStreamOffset());
+    builder.Add(downlink.ChunkFileOffset());
+    builder.Add(downlink.ChunkFlags());
+    builder.Add(downlink.Chunk(), downlink.ChunkSize());
+
+    snprintf(log_array, LOG_ARRAY_SIZE, "Downlink %s", downlink.FileName());
+    downlink_tm = QueueTM(builder, FINE, log_array, DOWNLINK_MAX_RETRIES, true);
 }
 
 void StratoCore::UpdateTime()
 {
     int32_t before, new_time, difference;
     TimeElements new_time_elements;
-    char gps_string[100] = {0};
 
     new_time_elements.Hour = zephyrRX.zephyr_gps.hour;
     new_time_elements.Minute = zephyrRX.zephyr_gps.minute;
@@ -239,64 +856,273 @@ void StratoCore::UpdateTime()
     new_time_elements.Month = zephyrRX.zephyr_gps.month;
     new_time_elements.Year = (uint8_t) (zephyrRX.zephyr_gps.year - 1970);
 
-    before = now();
+    before = StratoNow();
     new_time = makeTime(new_time_elements);
     difference = new_time - before;
 
     // if the time difference is greater than the configured maximum, update
     if (difference > MAX_TIME_DRIFT || difference < -MAX_TIME_DRIFT) {
-        log_nominal("Correcting time drift");
+        log_nominalf("Correcting time drift of %ld s", (long) difference);
 
-        noInterrupts();
-        setTime(new_time);
-        interrupts();
+        StratoSetTime(new_time);
 
         scheduler.UpdateScheduleTime(difference);
     }
 
     time_valid = true;
 
-    snprintf(gps_string, 100, "%u:%u:%u %u/%u/%u, SZA: %f", new_time_elements.Hour, new_time_elements.Minute, new_time_elements.Second,
-             new_time_elements.Month, new_time_elements.Day, new_time_elements.Year + 1970, zephyrRX.zephyr_gps.solar_zenith_angle);
+    log_nominalf("%u:%u:%u %u/%u/%u, SZA: %f", new_time_elements.Hour, new_time_elements.Minute, new_time_elements.Second,
+                 new_time_elements.Month, new_time_elements.Day, new_time_elements.Year + 1970, zephyrRX.zephyr_gps.solar_zenith_angle);
+}
+
+// parse a TC message's batch into the queue, reporting bad commands now rather than when they'd run
+void StratoCore::QueueTelecommands()
+{
+    char batch[TC_PAYLOAD_SIZE];
+    char tc[TC_TEXT_SIZE];
+    uint16_t length = 0;
+    uint8_t count = 0;
+    bool truncated = false;
+    TCParseStatus_t tc_status = NO_TCs;
+
+    while (NO_TCs != (tc_status = zephyrRX.GetTelecommand())) {
+        if (TC_ERROR == tc_status) {
+            snprintf(log_array, LOG_ARRAY_SIZE, "Bad command at TC position %u", zephyrRX.curr_tc);
+            ZephyrLogWarn(log_array);
+            continue;
+        }
+
+        uint16_t tc_length = FormatTelecommand(tc, sizeof(tc));
+        if (0 == tc_length) continue;
+
+        // the batch is ACKed whole or not at all, so one that doesn't fit is NAKed below
+        if (truncated || length + tc_length + 1 > (int) sizeof(batch)) {
+            truncated = true;
+            continue;
+        }
+
+        memcpy(&batch[length], tc, tc_length);
+        length += tc_length;
+        batch[length++] = ';';
+        count++;
+    }
+
+    if (truncated) {
+        zephyrTX.TCAck(false);
+        tc_queue.BatchRejected();
+        snprintf(log_array, LOG_ARRAY_SIZE, "TC batch too long after %u TCs, rejected", count);
+        ZephyrLogWarn(log_array);
+        return;
+    }
+
+    if (0 == count) {
+        zephyrTX.TCAck(true);
+        return;
+    }
 
-    log_nominal(gps_string);
+    if (tc_queue.PushBatch(batch, length, count)) {
+        zephyrTX.TCAck(true);
+    } else {
+        zephyrTX.TCAck(false);
+        snprintf(log_array, LOG_ARRAY_SIZE, "TC queue full (%u waiting), batch of %u rejected", tc_queue.Count(), count);
+        ZephyrLogWarn(log_array);
+    }
 }
 
-void StratoCore::NextTelecommand()
+// the parsed TC and its parameters as text in tc, or 0 (reported like a bad command) if it's too long
+uint16_t StratoCore::FormatTelecommand(char * tc, uint16_t size)
 {
-    TCParseStatus_t tc_status = zephyrRX.GetTelecommand();
+    uint16_t tc_length = (uint16_t) snprintf(tc, size, "%u", (uint16_t) zephyrRX.zephyr_tc);
 
-    switch (tc_status) {
-    case READ_TC:
-        // check for generic TCs before routing to the instrument
-        switch (zephyrRX.zephyr_tc) {
-        case NULL_TELECOMMAND:
-            log_nominal("Null telecommand");
-            break;
-        case RESET_INST:
-            zephyrTX.TCAck(true);
-            delay(100);
-            SCB_AIRCR = 0x5FA0004; // write the reset key and bit to the ARM AIRCR register
-            break;
-        case GETTMBUFFER:
-            SendTMBuffer();
-            break;
-        case SENDSTATE:
-            snprintf(log_array, LOG_ARRAY_SIZE, "Current mode: %u, substate: %u", inst_mode, inst_substate);
-            ZephyrLogFine(log_array);
-            break;
-        default:
-            TCHandler(zephyrRX.zephyr_tc);
+    for (uint8_t i = 0; i < zephyrRX.num_tc_params && tc_length < size; i++) {
+        tc_length += (uint16_t) snprintf(&tc[tc_length], size - tc_length, ",%s", zephyrRX.GetTCParam(i));
+    }
+
+    if (tc_length >= size) {
+        snprintf(log_array, LOG_ARRAY_SIZE, "TC too long at TC position %u", zephyrRX.curr_tc);
+        ZephyrLogWarn(log_array);
+        return 0;
+    }
+
+    return tc_length;
+}
+
+// run TCs in order until the per-loop count or time limit, or a null TC, which spaces out the TCs around
+// it by ending the loop's TCs
+void StratoCore::RunTelecommands()
+{
+    uint32_t start = micros();
+    uint8_t run = 0;
+
+    while (PopTelecommand()) {
+        run++;
+        tc_queue.TCRun();
+
+        if (!NextTelecommand()) break;
+
+        if ((0 != tc_queue.MaxPerLoop() && run >= tc_queue.MaxPerLoop())
+            || (0 != tc_queue.MaxMicros() && micros() - start >= tc_queue.MaxMicros())) {
+            if (tc_queue.Count() > 0 || tcs_remaining > 0) tc_queue.LoopLimited();
             break;
         }
-        break;
-    case TC_ERROR:
-        snprintf(log_array, LOG_ARRAY_SIZE, "Bad command at TC position %u", zephyrRX.curr_tc);
+    }
+}
+
+// make the next TC the current TC, from the queue or, if TCs aren't queued, zephyrRX
+bool StratoCore::PopTelecommand()
+{
+    if (tc_queue.Pop()) return true;
+
+    return tcs_remaining > 0 && ReadTelecommand();
+}
+
+// parse the next TC left in zephyrRX, which holds its parameters while it runs, reporting bad commands
+bool StratoCore::ReadTelecommand()
+{
+    char tc[TC_TEXT_SIZE];
+    TCParseStatus_t tc_status = NO_TCs;
+
+    while (tcs_remaining > 0) {
+        if (NO_TCs == (tc_status = zephyrRX.GetTelecommand())) break;
+        tcs_remaining--;
+
+        if (TC_ERROR == tc_status) {
+            snprintf(log_array, LOG_ARRAY_SIZE, "Bad command at TC position %u", zephyrRX.curr_tc);
+            ZephyrLogWarn(log_array);
+            continue;
+        }
+
+        if (0 == FormatTelecommand(tc, sizeof(tc))) continue;
+
+        tc_queue.SetCurrent(tc);
+        return true;
+    }
+
+    tcs_remaining = 0;
+    return false;
+}
+
+// run the queue's current TC, returns false if this loop's TCs should end here
+bool StratoCore::NextTelecommand()
+{
+    uint16_t telecommand = tc_queue.Telecommand();
+    TCArg_t args[MAX_TC_PARAMS];
+    TCMethod_t handler = NULL;
+    uint8_t entry = NO_TC_ENTRY;
+    uint32_t tc_start = 0;
+    uint32_t elapsed = 0;
+
+    watchdog_monitor.SetTC(telecommand);
+
+    if (NULL_TELECOMMAND == telecommand) {
+        log_nominalf("Null telecommand");
+        return false;
+    }
+
+    // registered handlers (including the generic TCs) by table lookup, everything else to the instrument's TCHandler
+    entry = tc_dispatch.Track(telecommand);
+    if (NO_TC_ENTRY != entry) handler = tc_dispatch.Handler(entry);
+
+    if (NULL != handler && !tc_dispatch.ParseArgs(entry, tc_queue, args)) {
+        snprintf(log_array, LOG_ARRAY_SIZE, "Bad parameters for TC %u", (unsigned int) telecommand);
         ZephyrLogWarn(log_array);
-        break;
-    case NO_TCs:
-    default:
-        tcs_remaining = 0;
-        break;
+        return true;
+    }
+
+    WatchdogCheckpoint(PHASE_TC);
+    tc_start = micros();
+    if (NULL != handler) {
+        (this->*handler)(args);
+    } else {
+        TCHandler((Telecommand_t) telecommand);
+    }
+    elapsed = profiler.Record(PHASE_TC, tc_start);
+    WatchdogCheckpoint(PHASE_ROUTER, PHASE_TC);
+
+    if (NO_TC_ENTRY != entry) {
+        tc_dispatch.Record(entry, elapsed);
+    } else {
+        tc_dispatch.CountUntracked();
+    }
+
+    return true;
+}
+
+bool StratoCore::RegisterTCMethod(Telecommand_t telecommand, TCMethod_t handler, const char * params)
+{
+    uint8_t entry = tc_dispatch.Find((uint16_t) telecommand);
+
+    if (NO_TC_ENTRY != entry && NULL != tc_dispatch.Handler(entry)) {
+        log_errorf("TC %u registered twice", (unsigned int) telecommand);
+        return false;
+    }
+
+    if (!tc_dispatch.Register((uint16_t) telecommand, handler, params)) {
+        log_errorf("Unable to register TC %u", (unsigned int) telecommand);
+        return false;
+    }
+
+    return true;
+}
+
+void StratoCore::TCResetInst(const TCArg_t * args)
+{
+    (void) args;
+
+    downlink.Stop();
+    tm_log.Close();
+    ground_port.Flush();
+    zephyrTX.TCAck(true);
+    delay(100);
+    SCB_AIRCR = 0x5FA0004; // write the reset key and bit to the ARM AIRCR register
+}
+
+void StratoCore::TCGetTMBuffer(const TCArg_t * args)
+{
+    (void) args;
+
+    SendTMBuffer();
+}
+
+void StratoCore::TCSendState(const TCArg_t * args)
+{
+    (void) args;
+
+    snprintf(log_array, LOG_ARRAY_SIZE, "Current mode: %u, substate: %u", inst_mode, inst_substate);
+    ZephyrLogFine(log_array);
+}
+
+void StratoCore::TCGetProfile(const TCArg_t * args)
+{
+    (void) args;
+
+    SendProfileTM();
+}
+
+void StratoCore::TCDownlink(const TCArg_t * args)
+{
+    (void) args;
+
+    StartDownlink(tc_queue.Telecommand());
+}
+
+void StratoCore::TCDownlinkStop(const TCArg_t * args)
+{
+    (void) args;
+
+    if (downlink.IsActive()) {
+        snprintf(log_array, LOG_ARRAY_SIZE, "Downlink of %s stopped, resume at offset %lu",
+                 downlink.FileName(), (unsigned long) downlink.StreamOffset());
+        downlink.Stop();
+        tm_manager.Release(downlink_tm);
+        downlink_tm = NO_TM_HANDLE;
+        ZephyrLogFine(log_array);
     }
+}
+
+void StratoCore::TCGetTCStats(const TCArg_t * args)
+{
+    (void) args;
+
+    SendTCStatsTM();
 }
\ No newline at end of file
@@ -12,7 +12,19 @@
 
 #include "StratoGroundPort.h"
 #include "StratoScheduler.h"
+#include "StratoHighResScheduler.h"
+#include "StratoProfiler.h"
+#include "StratoWatchdog.h"
 #include "StratoSD.h"
+#include "StratoArchive.h"
+#include "StratoDownlink.h"
+#include "StratoCodec.h"
+#include "StratoTCQueue.h"
+#include "StratoTCDispatch.h"
+#include "StratoModeTable.h"
+#include "StratoTask.h"
+#include "StratoIdle.h"
+#include "StratoTMManager.h"
 #include "XMLReader_v5.h"
 #include "XMLWriter_v5.h"
 #include "Arduino.h"
@@ -39,6 +51,33 @@
 // a statically-allocated log array is maintained by StratoCore
 #define LOG_ARRAY_SIZE  101
 
+// RAM buffer for the TM archive written by WriteFileTM, must hold at least one full TM buffer and record header
+#ifndef TM_LOG_BUFFER_SIZE
+#define TM_LOG_BUFFER_SIZE  16384 // multiple of SD_SECTOR_SIZE
+#endif
+
+// minimum seconds between WARN TMs reporting that SD log data is being dropped
+#define SD_DROP_REPORT_INTERVAL 60
+
+// default per-loop routing limits, at least one message is routed each loop that any are waiting, and
+// input past the limits is left on the port (or in the reader) for the next loop
+#define ROUTER_MSGS_PER_LOOP    16
+#define ROUTER_US_PER_LOOP      50000
+
+struct RouterStats_t {
+    uint32_t routed[UNKNOWN + 1]; // indexed by ZephyrMessage_t
+    uint32_t unknown; // messages of any type the router doesn't handle
+    uint32_t loops_deferred; // loops that ended at the limits with input still waiting
+    uint16_t max_per_loop; // messages
+};
+
+// generic telecommands handled by StratoCore in addition to those defined in XMLReader
+#define GETPROFILE      ((Telecommand_t) 204) // send the loop profile as TM and reset it
+#define DOWNLINKFILE    ((Telecommand_t) 205) // params: file name, optional offset; send the file as chunk TMs
+#define DOWNLINKARCHIVE ((Telecommand_t) 206) // params: prefix, start time, end time, optional offset; send archive records
+#define DOWNLINKSTOP    ((Telecommand_t) 207) // stop a downlink and report the offset to resume from
+#define GETTCSTATS      ((Telecommand_t) 208) // send per-TC run counts and times as TM
+
 class StratoCore {
 public:
     // constructors/destructors
@@ -49,9 +88,34 @@ public:
     void InitializeCore();
     void KickWatchdog();
     void RunMode();
-    void RunRouter();
+    void RunRouter(uint16_t max_msgs = ROUTER_MSGS_PER_LOOP, uint32_t max_us = ROUTER_US_PER_LOOP);
     void RunScheduler();
 
+    // services due high-resolution actions, can be called any number of times between the 1 Hz phases
+    void RunHighResScheduler();
+
+    // runs ready cooperative tasks within a per-loop budget, call once per loop after RunScheduler
+    void RunTasks(uint32_t max_us = TASK_US_PER_LOOP);
+
+    // writes buffered SD logs to the card within a per-loop budget, call once per loop before InstrumentLoop
+    void RunSDWriter(uint32_t max_bytes = SD_WRITE_BYTES_PER_LOOP, uint32_t max_us = SD_WRITE_US_PER_LOOP);
+
+    // per-type routing counts since boot, for the profile report or an instrument's own TM
+    const RouterStats_t & GetRouterStats() { return router_stats; }
+
+    // calls InstrumentLoop with profiling, use in place of calling InstrumentLoop directly
+    void RunInstrumentLoop();
+
+    // sleeps for up to max_ms (e.g. the rest of the loop period), waking early when Zephyr input arrives, for a
+    // due scheduled or high-res action, or before the watchdog deadline, and not at all if TCs are waiting
+    IdleWake_t Idle(uint32_t max_ms);
+
+    // time asleep in Idle and awake, reset with the loop profile
+    const IdleStats_t & GetIdleStats() { return idle.GetStats(); }
+
+    // TMs sent, acknowledged, resent and dropped since boot
+    const TMStats_t & GetTMStats() { return tm_manager.GetStats(); }
+
     // Pure virtual function definition for the instrument setup function, called publicly before the loop begins
     virtual void InstrumentSetup() = 0;
 
@@ -63,7 +127,19 @@ protected: // available to StratoCore and instrument classes
     XMLReader zephyrRX;
 
     // Scheduler
-    StratoScheduler scheduler;
+    StaticScheduler<MAX_SCHEDULE_SIZE> scheduler;
+
+    // Millisecond-resolution scheduler, serviced by RunHighResScheduler
+    StaticHighResScheduler<MAX_HIGHRES_SCHEDULE_SIZE> highres_scheduler;
+
+    // Per-phase timing of the loop, reported with the GETPROFILE telecommand
+    StratoProfiler profiler;
+
+    // Watchdog budget warnings and the reset-surviving breadcrumb
+    StratoWatchdog watchdog_monitor;
+
+    // Sleep between loops and the duty cycle, see Idle
+    StratoIdle idle;
 
     // Set to determine the substate within a mode (always set to MODE_ENTRY when a mode is started)
     uint8_t inst_substate;
@@ -82,9 +158,70 @@ protected: // available to StratoCore and instrument classes
     // generic method to send whatever's in the TM buffer, meant for debugging
     void SendTMBuffer();
 
-    // write the current TM buffer to a file on the SD card
+    // send the TM buffer with a state message (state flag 1), or queue it to follow the TM waiting for its
+    // TMAck. A copy is kept and resent on a NAK or ack timeout, so the TM buffer can be filled for the next
+    // TM at once. Queued TMs and resends are sent from their copies, without touching the TM buffer. False
+    // if all TM_SLOTS buffers are in use (the TM is dropped).
+    bool SendTM(StateFlag_t flag, const char * details);
+
+    // the buffers SendTM and the ZephyrLog functions send from, set the ack timeout and retries with SetPolicy()
+    static_assert(TM_SLOT_SIZE >= TM_BUFFER_SIZE, "a full TM buffer wouldn't fit in a TM manager buffer");
+    StaticTMManager<TM_SLOTS, TM_SLOT_SIZE> tm_manager;
+
+    // encode the TM buffer in place with a codec header (CODEC_* flags, and the integer width and channel stride
+    // for CODEC_DELTA), before sending or writing it. The TM buffer must have CODEC_HEADER_SIZE bytes free.
+    bool EncodeTMBuffer(StratoCodec & codec, uint8_t codec_flags, uint8_t delta_width = 1, uint8_t delta_stride = 1);
+
+    // append the current TM buffer as a record to the TM archive on the SD card (<file_prefix>_<time>.dat)
     bool WriteFileTM(const char * file_prefix);
 
+    // buffered TM archive used by WriteFileTM, synced to the card on a shutdown warning or reset TC
+    StaticArchive<TM_LOG_BUFFER_SIZE> tm_log;
+
+    // send the loop profile as TM and print it on the ground port, then reset it
+    void SendProfileTM();
+
+    // SD file and archive downlink, started by the DOWNLINK telecommands and sent from RunRouter
+    StratoDownlink downlink;
+
+    // the TC being run, and received TCs waiting to run once enabled with tc_queue.Enable(true); set the
+    // per-loop limits with tc_queue.SetPolicy()
+    StratoTCQueue tc_queue;
+
+    // handlers and stats by TC number, TCs without a registered handler go to TCHandler
+    StratoTCDispatch tc_dispatch;
+
+    // register an instrument method, void Method(const TCArg_t * args), to run for a TC instead of TCHandler
+    // (e.g. in InstrumentSetup), with the format of its required parameters ('u' uint32_t, 'f' float, 's' string)
+    template <class Instrument>
+    bool RegisterTC(Telecommand_t telecommand, void (Instrument::*handler)(const TCArg_t * args), const char * params = "")
+    {
+        return RegisterTCMethod(telecommand, static_cast<TCMethod_t>(handler), params);
+    }
+
+    // send the per-TC stats as TM and print them on the ground port
+    void SendTCStatsTM();
+
+    // cooperative tasks run by RunTasks, stopped on a mode change like the schedules
+    StratoTaskList tasks;
+
+    // start an instrument method, TaskResult_t Method(TaskControl_t * task), as a task (see StratoTask.h),
+    // returns the task's number for StopTask, or NO_TASK if TASK_SLOTS tasks are already running
+    template <class Instrument>
+    uint8_t StartTask(TaskResult_t (Instrument::*method)(TaskControl_t * task), uint32_t arg = 0)
+    {
+        return tasks.Start(static_cast<TaskMethod_t>(method), arg);
+    }
+
+    void StopTask(uint8_t task) { tasks.Stop(task); }
+
+    // run a substate table for a mode instead of its mode function, typically set in InstrumentSetup and checked
+    // with static_assert(SubstateTableValid(table), ...). Substates not in the table (e.g. MODE_SHUTDOWN or
+    // MODE_EXIT) still go to the mode function, and a NULL table restores the mode function for every substate.
+    template <size_t N>
+    void SetModeTable(InstMode_t mode, const SubstateEntry_t (&table)[N]) { SetModeTable(mode, table, N); }
+    void SetModeTable(InstMode_t mode, const SubstateEntry_t * table, uint8_t size);
+
     // Pure virtual mode functions (implemented entirely in instrument classes)
     // Using these, the StratoCore can call the mode functions of derived classes, but the
     // derived classes (other instruments) must implement them themselves
@@ -94,12 +231,15 @@ protected: // available to StratoCore and instrument classes
     virtual void SafetyMode() = 0;
     virtual void EndOfFlightMode() = 0;
 
-    // Pure virtual function definition for the instrument telecommand handler - returns ACK/NAK
+    // Pure virtual function definition for the instrument telecommand handler, for TCs without a RegisterTC handler
     virtual void TCHandler(Telecommand_t telecommand) = 0;
 
     // Pure virtual function definition for the instrument action handler
     virtual void ActionHandler(uint8_t action) = 0;
 
+    // Handler for high-resolution actions with how late (ms) the action is, optional for instruments
+    virtual void HighResActionHandler(uint8_t action, uint32_t lateness_ms) { (void) action; (void) lateness_ms; }
+
     enum ACK_t {
         NAK,
         ACK,
@@ -119,19 +259,69 @@ protected: // available to StratoCore and instrument classes
 
 private: // available only to StratoCore
     void InitializeWatchdog();
+    void WatchdogCheckpoint(uint8_t phase, uint8_t finished = BREADCRUMB_NO_PHASE);
+    void WatchdogWarning(uint8_t level, const char * when, const char * where);
     void RouteRXMessage(ZephyrMessage_t message);
+    void RunSubstate();
     void UpdateTime();
-    void NextTelecommand();
+    void QueueTelecommands();
+    void RunTelecommands();
+    bool PopTelecommand();
+    bool ReadTelecommand();
+    uint16_t FormatTelecommand(char * tc, uint16_t size);
+    bool NextTelecommand();
+    bool RegisterTCMethod(Telecommand_t telecommand, TCMethod_t handler, const char * params);
+    TMHandle_t QueueTM(bool text, StateFlag_t flag, const char * details, uint8_t max_retries, bool keep = false);
+    TMHandle_t QueueTM(TMBuilder & builder, StateFlag_t flag, const char * details, uint8_t max_retries, bool keep = false);
+    void ServiceTM();
+    void SetTMLength(uint8_t * tm_buffer, uint16_t size);
+    void StartDownlink(uint16_t telecommand);
+    void ServiceDownlink();
+    void SendDownlinkTM();
+
+    // generic TC handlers, registered by the constructor
+    void TCResetInst(const TCArg_t * args);
+    void TCGetTMBuffer(const TCArg_t * args);
+    void TCSendState(const TCArg_t * args);
+    void TCGetProfile(const TCArg_t * args);
+    void TCDownlink(const TCArg_t * args);
+    void TCDownlinkStop(const TCArg_t * args);
+    void TCGetTCStats(const TCArg_t * args);
 
     time_t last_zephyr;
 
+    // the Zephyr port given to the constructor, checked for input left past the routing limits
+    Stream * zephyr_port;
+    RouterStats_t router_stats;
+
+    // the port for the ground port given to the constructor
+    Stream * ground_serial;
+
+    // SD drops already reported by RunSDWriter
+    uint32_t sd_drops_reported;
+    time_t last_sd_report;
+
+    // TCs of the last TC message still in zephyrRX, when TCs aren't queued
     uint8_t tcs_remaining;
 
+    // downlink chunk waiting for a TMAck, and resends of this downlink's chunks
+    TMHandle_t downlink_tm;
+    uint32_t downlink_resends;
+
     // Only the Zephyr can change mode, unless 2 hr pass without comms (REQ461) -> Safety
     // InstMode_t defined in XMLReader
     InstMode_t inst_mode;
     InstMode_t new_inst_mode; // set this to change mode, StratoCore handles the rest
 
+    // substate tables set with SetModeTable, NULL to use the mode function
+    const SubstateEntry_t * mode_tables[NUM_MODES];
+    uint8_t mode_table_sizes[NUM_MODES];
+
+    // the mode/substate last run and when it was entered, for substate timeouts and the profile
+    uint8_t active_mode;
+    uint8_t active_substate;
+    uint32_t active_since_ms;
+
     // Array of mode functions indexed by InstMode_t enum in XMLReader (don't change order)
 	void (StratoCore::*mode_array[NUM_MODES])(void) = {
 		&StratoCore::StandbyMode,
@@ -0,0 +1,258 @@
+/*
+ *  StratoDownlink.cpp
+ *  Author:  StratoCore contributors
+ *  Created: October 2026
+ *
+ *  This file implements the SD side of the file downlink
+ */
+
+#include "StratoDownlink.h"
+#include "StratoGroundPort.h"
+#include <string.h>
+
+StratoDownlink::StratoDownlink()
+{
+    file_name[0] = '\0';
+    file_size = 0;
+
+    archive = false;
+    prefix[0] = '\0';
+    start_time = 0;
+    end_time = 0;
+    catalog_entry = 0;
+
+    position = {0, 0, 0};
+    chunk_start = {0, 0, 0};
+    skip_remaining = 0;
+
+    chunk_size = 0;
+    chunk_ready = false;
+    finished = false;
+
+    active = false;
+    failed = false;
+
+    stats = {0, 0};
+}
+
+bool StratoDownlink::StartFile(const char * filename, uint32_t offset)
+{
+    Stop();
+
+    if (!sd_state || NULL == filename || strlen(filename) >= SD_LOG_NAME_SIZE) return false;
+
+    archive = false;
+    strcpy(file_name, filename);
+
+    if (!OpenFile()) return false;
+
+    if (offset > file_size) {
+        file.close();
+        return false;
+    }
+
+    stats = {0, 0};
+    position = {offset, offset, 0};
+    chunk_start = position;
+    skip_remaining = 0;
+    active = true;
+
+    return true;
+}
+
+bool StratoDownlink::StartArchive(const char * archive_prefix, uint32_t start, uint32_t end, uint32_t offset)
+{
+    uint32_t file_offset = 0;
+
+    Stop();
+
+    if (!sd_state || NULL == archive_prefix || strlen(archive_prefix) >= SD_LOG_PREFIX_SIZE || end < start) return false;
+
+    if (!ArchiveFindFile(archive_prefix, start, file_name, sizeof(file_name), &catalog_entry)) return false;
+
+    // without an index (not yet synced), the records before the range are skipped from the start of the file
+    if (!ArchiveFindOffset(file_name, start, &file_offset)) file_offset = 0;
+
+    if (!OpenFile()) return false;
+
+    archive = true;
+    strcpy(prefix, archive_prefix);
+    start_time = start;
+    end_time = end;
+
+    stats = {0, 0};
+    position = {0, file_offset, 0};
+    chunk_start = position;
+    skip_remaining = offset;
+    active = true;
+
+    return true;
+}
+
+void StratoDownlink::Stop()
+{
+    if (file) file.close();
+
+    // an unacknowledged chunk wasn't sent as far as the resume offset is concerned
+    if (chunk_ready || chunk_size > 0) position = chunk_start;
+
+    chunk_size = 0;
+    chunk_ready = false;
+    finished = false;
+    active = false;
+    failed = false;
+}
+
+// a chunk never spans two files, so a chunk can always be restarted from a position in the open file
+bool StratoDownlink::Prepare(uint32_t max_us)
+{
+    uint32_t start_us = micros();
+    ArchiveRecordHeader_t record;
+
+    if (!active) return false;
+
+    while (!chunk_ready) {
+        // a new chunk starts here, after anything skipped
+        if (0 == chunk_size) chunk_start = position;
+
+        if (archive && 0 == position.record_remaining) {
+            // the header of the next record goes at the end of the chunk (it's only kept if the record is sent)
+            if (chunk_size + ARCHIVE_HEADER_SIZE > DOWNLINK_CHUNK_SIZE) {
+                chunk_ready = true;
+                break;
+            }
+
+            if (position.file_offset + ARCHIVE_HEADER_SIZE > file_size
+                || !ReadInto(ARCHIVE_HEADER_SIZE)
+                || !ArchiveUnpackHeader(&chunk[chunk_size], &record)
+                || position.file_offset + ARCHIVE_HEADER_SIZE + record.length > file_size) {
+                // the end of the records in this file (the rest may be unused pre-allocation)
+                if (chunk_size > 0) {
+                    chunk_ready = true;
+                } else if (!NextFile()) {
+                    if (!active) return false; // read error
+                    finished = true;
+                    chunk_ready = true;
+                }
+            } else if (record.time < start_time) {
+                position.file_offset += ARCHIVE_HEADER_SIZE + record.length;
+            } else if (record.time > end_time) {
+                finished = true;
+                chunk_ready = true;
+            } else if (skip_remaining > 0) {
+                // skip whole records while the resume offset allows, then the start of a record if it falls inside one
+                uint32_t skip = (uint32_t) ARCHIVE_HEADER_SIZE + record.length;
+                if (skip > skip_remaining) {
+                    position.record_remaining = skip - skip_remaining;
+                    skip = skip_remaining;
+                }
+                position.file_offset += skip;
+                position.stream_offset += skip;
+                skip_remaining -= skip;
+            } else {
+                chunk_size += ARCHIVE_HEADER_SIZE;
+                position.file_offset += ARCHIVE_HEADER_SIZE;
+                position.stream_offset += ARCHIVE_HEADER_SIZE;
+                position.record_remaining = record.length;
+            }
+        } else {
+            uint32_t available = archive ? position.record_remaining : file_size - position.file_offset;
+            uint32_t size = DOWNLINK_CHUNK_SIZE - chunk_size;
+
+            if (available < size) size = available;
+
+            if (0 == size) {
+                // only a whole file (the archive moves between records above) runs out here
+                finished = (DOWNLINK_CHUNK_SIZE != chunk_size);
+                chunk_ready = true;
+                break;
+            }
+
+            if (!ReadInto(size)) {
+                Fail();
+                return false;
+            }
+
+            chunk_size += size;
+            position.file_offset += size;
+            position.stream_offset += size;
+            if (archive) position.record_remaining -= size;
+        }
+
+        // finish the chunk next loop if the card is slow
+        if (!chunk_ready && micros() - start_us >= max_us) return false;
+    }
+
+    return true;
+}
+
+void StratoDownlink::Advance()
+{
+    if (!chunk_ready) return;
+
+    stats.chunks_acked++;
+    stats.bytes_acked += chunk_size;
+
+    chunk_size = 0;
+    chunk_ready = false;
+
+    if (finished) Stop();
+}
+
+uint32_t StratoDownlink::StreamOffset()
+{
+    // an unacknowledged chunk will be sent again, anything before it has been acknowledged (or skipped)
+    return (chunk_ready || chunk_size > 0) ? chunk_start.stream_offset : position.stream_offset;
+}
+
+bool StratoDownlink::OpenFile()
+{
+    file = SD.open(file_name, O_READ);
+    if (!file) {
+        log_error("Downlink unable to open file");
+        return false;
+    }
+
+    file_size = file.fileSize();
+
+    return true;
+}
+
+// move to the next file in the catalog, false at the end of the archive range (the current file stays open)
+bool StratoDownlink::NextFile()
+{
+    char next_name[SD_LOG_NAME_SIZE] = {0};
+    uint32_t next_time = 0;
+
+    if (!ArchiveCatalogEntry(prefix, catalog_entry + 1, &next_time, next_name, sizeof(next_name)) || next_time > end_time) {
+        return false;
+    }
+
+    file.close();
+    strcpy(file_name, next_name);
+    catalog_entry++;
+
+    if (!OpenFile()) {
+        Fail();
+        return false;
+    }
+
+    position.file_offset = 0;
+    position.record_remaining = 0;
+
+    return true;
+}
+
+// read from the current position into the end of the chunk
+bool StratoDownlink::ReadInto(uint32_t size)
+{
+    return file.seekSet(position.file_offset) && (int) size == file.read(&chunk[chunk_size], size);
+}
+
+void StratoDownlink::Fail()
+{
+    log_error("Downlink read error");
+
+    Stop();
+    failed = true;
+}
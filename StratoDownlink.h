@@ -0,0 +1,113 @@
+/*
+ *  StratoDownlink.h
+ *  Author:  StratoCore contributors
+ *  Created: October 2026
+ *
+ *  This file declares the SD side of the file downlink: it reads a file, or
+ *  the records of an archive time range, in TM-sized chunks that can be resent
+ *  until they're acknowledged. StratoCore sends the chunks and paces them.
+ */
+
+#ifndef STRATODOWNLINK_H
+#define STRATODOWNLINK_H
+
+#include "StratoSD.h"
+#include "StratoArchive.h"
+#include <stdint.h>
+
+// bytes of file data in each chunk TM
+#ifndef DOWNLINK_CHUNK_SIZE
+#define DOWNLINK_CHUNK_SIZE     1024
+#endif
+
+// maximum time spent reading the card for a chunk in one loop, the chunk is finished next loop
+#define DOWNLINK_US_PER_LOOP    50000
+
+// resends of one chunk by the TM manager (after a NAK or ack timeout) before StratoCore stops the downlink
+#define DOWNLINK_MAX_RETRIES    5
+
+// chunk TM flags
+#define DOWNLINK_FLAG_LAST      0x01 // last chunk of the downlink (can be empty)
+
+struct DownlinkStats_t {
+    uint32_t chunks_acked;
+    uint32_t bytes_acked;
+};
+
+class StratoDownlink {
+public:
+    StratoDownlink();
+    ~StratoDownlink() { };
+
+    // send a file from a byte offset to its end
+    bool StartFile(const char * filename, uint32_t offset = 0);
+
+    // send the archive records (headers included) from start to end time inclusive, across files,
+    // skipping the first offset bytes of the range so that an interrupted downlink can be resumed
+    bool StartArchive(const char * archive_prefix, uint32_t start, uint32_t end, uint32_t offset = 0);
+
+    void Stop();
+
+    // read toward the next chunk for up to max_us, true once it's ready to send
+    bool Prepare(uint32_t max_us = DOWNLINK_US_PER_LOOP);
+
+    // the chunk was acknowledged, move on to the next (the downlink ends after the last chunk), until then
+    // the same chunk stays prepared (resends are sent from the TM manager's copy)
+    void Advance();
+
+    bool IsActive() { return active; }
+    bool Failed() { return failed; } // stopped on a card read error
+
+    // the prepared chunk: the data, its position in the downlink and its file, and the DOWNLINK_FLAG_* flags
+    const uint8_t * Chunk() { return chunk; }
+    uint16_t ChunkSize() { return chunk_size; }
+    uint32_t ChunkStreamOffset() { return chunk_start.stream_offset; }
+    uint32_t ChunkFileOffset() { return chunk_start.file_offset; }
+    uint8_t ChunkFlags() { return finished ? DOWNLINK_FLAG_LAST : 0; }
+    const char * FileName() { return file_name; }
+
+    // bytes of the downlink sent and acknowledged so far, the offset to resume from
+    uint32_t StreamOffset();
+
+    const DownlinkStats_t & GetStats() { return stats; }
+
+private:
+    // a position in the downlink, enough to restart a chunk
+    struct Position_t {
+        uint32_t stream_offset; // bytes of the downlink before this point
+        uint32_t file_offset;
+        uint32_t record_remaining; // bytes left of the archive record at this point (0 between records)
+    };
+
+    bool OpenFile();
+    bool NextFile();
+    bool ReadInto(uint32_t size);
+    void Fail();
+
+    File file;
+    char file_name[SD_LOG_NAME_SIZE];
+    uint32_t file_size;
+
+    // archive range, if sending an archive
+    bool archive;
+    char prefix[SD_LOG_PREFIX_SIZE];
+    uint32_t start_time;
+    uint32_t end_time;
+    uint32_t catalog_entry;
+
+    Position_t position;
+    Position_t chunk_start;
+    uint32_t skip_remaining;
+
+    uint8_t chunk[DOWNLINK_CHUNK_SIZE];
+    uint16_t chunk_size;
+    bool chunk_ready;
+    bool finished;
+
+    bool active;
+    bool failed;
+
+    DownlinkStats_t stats;
+};
+
+#endif /* STRATODOWNLINK_H */
@@ -8,45 +8,242 @@
  */
 
 #include "StratoGroundPort.h"
+#include <stdio.h>
 
-Stream * debug_serial = &Serial;
+#define ENTRY_HEADER_SIZE   3 // level, uint16_t length
 
-// definitions of functions for internal GroundPort use only
-void print_log(LOG_LEVEL_t log_level, const char * log_info);
+StratoGroundPort ground_port(&Serial);
+Stream * debug_serial = &ground_port;
+
+const char * log_prefix(LOG_LEVEL_t log_level)
+{
+    switch (log_level) {
+    case LOG_DEBUG:
+        return "DBG: ";
+    case LOG_NOMINAL:
+        return "NOM: ";
+    case LOG_ERROR:
+        return "ERR: ";
+    default:
+        return "";
+    }
+}
 
 // Log functions ------------------------------------------
-void log_debug(const char * log_info)
+// the level checks are done at compile time by the log_xxxx macros
+
+void print_log(LOG_LEVEL_t log_level, const char * log_info)
 {
-    print_log(LOG_DEBUG, log_info);
+    ground_port.BeginLine(log_level);
+    ground_port.print(log_prefix(log_level));
+    ground_port.println(log_info);
 }
 
-void log_nominal(const char * log_info)
+void print_logf(LOG_LEVEL_t log_level, const char * format, ...)
 {
-    print_log(LOG_NOMINAL, log_info);
+    va_list args;
+
+    va_start(args, format);
+    ground_port.PrintLine(log_level, log_prefix(log_level), format, args);
+    va_end(args);
 }
 
-void log_error(const char * log_info)
+// Buffered ground port -----------------------------------
+
+StratoGroundPort::StratoGroundPort(Stream * serial_port)
 {
-    print_log(LOG_ERROR, log_info);
+    port = serial_port;
+
+    head = 0;
+    used = 0;
+    head_written = 0;
+
+    line_length = 0;
+    line_level = LOG_NOMINAL;
+
+    drops_reported = 0;
+
+    stats = {0, 0, {0, 0, 0}, 0, 0};
 }
 
-void print_log(LOG_LEVEL_t log_level, const char * log_info)
+void StratoGroundPort::BeginLine(LOG_LEVEL_t level)
 {
-    if (log_level < LOG_LEVEL) return;
+    if (line_length > 0) CommitLine();
 
-    switch (log_level) {
-    case LOG_DEBUG:
-        debug_serial->print("DBG: ");
-        break;
-    case LOG_NOMINAL:
-        debug_serial->print("NOM: ");
-        break;
-    case LOG_ERROR:
-        debug_serial->print("ERR: ");
-        break;
-    default:
-        break;
+    line_level = (level < LOG_NONE) ? level : LOG_ERROR;
+}
+
+void StratoGroundPort::PrintLine(LOG_LEVEL_t level, const char * prefix, const char * format, va_list args)
+{
+    BeginLine(level);
+    print(prefix);
+
+    // leave room for the line ending, the prefix is always shorter than a line
+    uint16_t space = (uint16_t) (GROUND_PORT_LINE_SIZE - 2 - line_length);
+    int length = vsnprintf(&line[line_length], space + 1, format, args);
+
+    if (length > 0) line_length = (uint16_t) (line_length + ((length < space) ? length : space));
+
+    line[line_length++] = '\r';
+    line[line_length++] = '\n';
+    CommitLine();
+    line_level = LOG_NOMINAL;
+}
+
+size_t StratoGroundPort::write(uint8_t b)
+{
+    line[line_length++] = (char) b;
+
+    // a line is queued at its newline, or in pieces if it's too long
+    if ('\n' == b) {
+        CommitLine();
+        line_level = LOG_NOMINAL;
+    } else if (GROUND_PORT_LINE_SIZE == line_length) {
+        CommitLine();
+    }
+
+    return 1;
+}
+
+size_t StratoGroundPort::write(const uint8_t * buffer, size_t size)
+{
+    if (NULL == buffer) return 0;
+
+    for (size_t i = 0; i < size; i++) {
+        write(buffer[i]);
+    }
+
+    return size;
+}
+
+void StratoGroundPort::CommitLine()
+{
+    uint32_t size = ENTRY_HEADER_SIZE + line_length;
+
+    if (MakeRoom(size, line_level)) {
+        uint32_t tail = used;
+        RingPut(tail, (uint8_t) line_level);
+        RingPut(tail + 1, (uint8_t) (line_length >> 8));
+        RingPut(tail + 2, (uint8_t) line_length);
+        for (uint16_t i = 0; i < line_length; i++) {
+            RingPut(tail + ENTRY_HEADER_SIZE + i, (uint8_t) line[i]);
+        }
+
+        used += size;
+        stats.lines_queued++;
+        if (used > stats.max_queued) stats.max_queued = used;
+    } else {
+        stats.lines_dropped[line_level]++;
+    }
+
+    line_length = 0;
+
+    Drain();
+}
+
+// free up size bytes for a line at level by evicting lines of lower levels, lowest and oldest first
+bool StratoGroundPort::MakeRoom(uint32_t size, LOG_LEVEL_t level)
+{
+    uint8_t victim = LOG_DEBUG;
+
+    while (GROUND_PORT_BUFFER_SIZE - used < size && victim < level) {
+        uint32_t deficit = size - (GROUND_PORT_BUFFER_SIZE - used);
+        if (Evict(deficit, (LOG_LEVEL_t) victim) < deficit) victim++;
+    }
+
+    return GROUND_PORT_BUFFER_SIZE - used >= size;
+}
+
+// remove the oldest lines of one level until size bytes are freed, compacting the queue in place
+uint32_t StratoGroundPort::Evict(uint32_t size, LOG_LEVEL_t victim)
+{
+    uint32_t read = 0;
+    uint32_t write = 0;
+    uint32_t freed = 0;
+
+    while (read < used) {
+        uint32_t entry_size = ENTRY_HEADER_SIZE + (((uint32_t) RingGet(read + 1) << 8) | RingGet(read + 2));
+
+        // the first line can't be removed once it's partly written
+        bool evict = (freed < size && victim == RingGet(read) && !(0 == read && head_written > 0));
+
+        if (evict) {
+            freed += entry_size;
+            stats.lines_dropped[victim]++;
+        } else {
+            // the kept lines move toward the head, so a forward copy is safe
+            if (write != read) {
+                for (uint32_t i = 0; i < entry_size; i++) RingPut(write + i, RingGet(read + i));
+            }
+            write += entry_size;
+        }
+
+        read += entry_size;
+    }
+
+    used = write;
+
+    return freed;
+}
+
+void StratoGroundPort::Drain()
+{
+    if (NULL == port) return;
+
+    int space = port->availableForWrite();
+
+    while (space > 0 && used > 0) {
+        uint16_t length = (uint16_t) ((RingGet(1) << 8) | RingGet(2));
+        uint32_t start = (head + ENTRY_HEADER_SIZE + head_written) % GROUND_PORT_BUFFER_SIZE;
+        uint32_t count = length - head_written;
+
+        // one contiguous piece of the ring at a time
+        if (count > (uint32_t) space) count = (uint32_t) space;
+        if (count > GROUND_PORT_BUFFER_SIZE - start) count = GROUND_PORT_BUFFER_SIZE - start;
+
+        port->write(&ring[start], count);
+        head_written += count;
+        space -= count;
+        stats.bytes_written += count;
+
+        if (head_written == length) {
+            head = (head + ENTRY_HEADER_SIZE + length) % GROUND_PORT_BUFFER_SIZE;
+            used -= ENTRY_HEADER_SIZE + length;
+            head_written = 0;
+            stats.lines_written++;
+        }
+    }
+
+    // once caught up, say how many lines were lost
+    uint32_t dropped = stats.lines_dropped[LOG_DEBUG] + stats.lines_dropped[LOG_NOMINAL] + stats.lines_dropped[LOG_ERROR];
+    if (0 == used && 0 == line_length && dropped != drops_reported) {
+        uint32_t since_report = dropped - drops_reported;
+        drops_reported = dropped;
+
+        BeginLine(LOG_ERROR);
+        print("ERR: ground port dropped ");
+        print(since_report);
+        println(" lines");
+    }
+}
+
+void StratoGroundPort::Flush()
+{
+    if (line_length > 0) CommitLine();
+
+    while (NULL != port && used > 0) {
+        uint16_t length = (uint16_t) ((RingGet(1) << 8) | RingGet(2));
+
+        for (uint16_t i = head_written; i < length; i++) {
+            port->write(RingGet(ENTRY_HEADER_SIZE + i));
+        }
+        stats.bytes_written += length - head_written;
+        stats.lines_written++;
+
+        head = (head + ENTRY_HEADER_SIZE + length) % GROUND_PORT_BUFFER_SIZE;
+        used -= ENTRY_HEADER_SIZE + length;
+        head_written = 0;
     }
 
-    debug_serial->println(log_info);
+    if (NULL != port) port->flush();
 }
@@ -13,12 +13,26 @@
 #include "Arduino.h"
 #include "HardwareSerial.h"
 #include "WProgram.h"
+#include <stdarg.h>
 #include <stdint.h>
 
-// display all logs at or above this level
+// default level for all modules: logs below it are compiled out (override with -DLOG_LEVEL=...)
+#ifndef LOG_LEVEL
 #define LOG_LEVEL   LOG_NOMINAL
+#endif
 
-extern Stream * debug_serial;
+// a module can set its own level by defining LOG_MODULE_LEVEL before including any Strato header
+#ifndef LOG_MODULE_LEVEL
+#define LOG_MODULE_LEVEL    LOG_LEVEL
+#endif
+
+// RAM queue for ground port output, so that a slow or stalled terminal never blocks the loop
+#ifndef GROUND_PORT_BUFFER_SIZE
+#define GROUND_PORT_BUFFER_SIZE 4096
+#endif
+
+// longest line queued as one entry, longer lines are split
+#define GROUND_PORT_LINE_SIZE   160
 
 // importance levels in increasing order
 enum LOG_LEVEL_t {
@@ -28,13 +42,117 @@ enum LOG_LEVEL_t {
     LOG_NONE    = 3
 };
 
-// functions for logging information to the terminal at different levels
-// to add values to print, either use a char array and snprintf, or
-// create a String, and log this way: log_xxxx(string_name.c_str())
-void log_debug(const char * log_info);
-void log_nominal(const char * log_info);
-void log_error(const char * log_info);
+struct GroundPortStats_t {
+    uint32_t lines_queued;
+    uint32_t lines_written;
+    uint32_t lines_dropped[LOG_NONE]; // by level, whether evicted for a more important line or not queued
+    uint32_t bytes_written;
+    uint32_t max_queued;  // bytes
+};
+
+// Everything printed to debug_serial is queued as lines, each with a level (LOG_NOMINAL unless
+// set with BeginLine), and written to the port only as fast as it accepts without blocking. When
+// the queue is full, a new line evicts the oldest queued lines of lower levels (debug first), and
+// is dropped if that doesn't make room.
+class StratoGroundPort : public Stream {
+public:
+    StratoGroundPort(Stream * serial_port);
+    ~StratoGroundPort() { };
+
+    void SetPort(Stream * serial_port) { port = serial_port; }
+    Stream * Port() { return port; }
+
+    // set the level of the line being printed (a partial line already printed is queued first)
+    void BeginLine(LOG_LEVEL_t level);
+
+    // format a whole line straight into the line buffer, truncated to fit GROUND_PORT_LINE_SIZE
+    void PrintLine(LOG_LEVEL_t level, const char * prefix, const char * format, va_list args);
+
+    // write as much of the queue as the port can take without blocking, called for each line and each loop
+    void Drain();
+
+    // write everything now, blocking (before a reset)
+    void Flush();
+
+    uint32_t Queued() { return used; }
+    const GroundPortStats_t & GetStats() { return stats; }
+
+    // Print interface
+    size_t write(uint8_t b);
+    size_t write(const uint8_t * buffer, size_t size);
+    using Print::write;
+    int availableForWrite() { return (int) (GROUND_PORT_BUFFER_SIZE - used); }
+    void flush() { Flush(); }
+
+    // reads go straight to the port
+    int available() { return port->available(); }
+    int read() { return port->read(); }
+    int peek() { return port->peek(); }
+
+private:
+    void CommitLine();
+    bool MakeRoom(uint32_t size, LOG_LEVEL_t level);
+    uint32_t Evict(uint32_t size, LOG_LEVEL_t victim);
+    uint8_t RingGet(uint32_t offset) { return ring[(head + offset) % GROUND_PORT_BUFFER_SIZE]; }
+    void RingPut(uint32_t offset, uint8_t value) { ring[(head + offset) % GROUND_PORT_BUFFER_SIZE] = value; }
+
+    Stream * port;
+
+    // queued lines, each a level byte, a big-endian uint16_t length and the text
+    uint8_t ring[GROUND_PORT_BUFFER_SIZE];
+    uint32_t head;
+    uint32_t used;
+    uint16_t head_written; // bytes of the first line already written to the port
+
+    // the line being printed
+    char line[GROUND_PORT_LINE_SIZE];
+    uint16_t line_length;
+    LOG_LEVEL_t line_level;
+
+    // lines dropped before the last notice on the port
+    uint32_t drops_reported;
+
+    GroundPortStats_t stats;
+};
+
+extern StratoGroundPort ground_port;
+
+// the buffered ground port, StratoCore points it at the port given to its constructor
+extern Stream * debug_serial;
+
+// Logging to the terminal at different levels. Calls below the module's level compile to
+// nothing: the arguments aren't evaluated and the strings aren't linked in.
+//   log_xxxx(string)            logs the string as it is
+//   log_xxxxf(format, ...)      printf-style, formatted directly into the ground port (no String
+//                               or shared buffer), truncated to GROUND_PORT_LINE_SIZE, or sent as
+//                               a binary token if LOG_TOKENIZED is defined
+#define log_debug(log_info)     STRATO_LOG(LOG_DEBUG, print_log(LOG_DEBUG, log_info))
+#define log_nominal(log_info)   STRATO_LOG(LOG_NOMINAL, print_log(LOG_NOMINAL, log_info))
+#define log_error(log_info)     STRATO_LOG(LOG_ERROR, print_log(LOG_ERROR, log_info))
+
+#define log_debugf(...)         STRATO_LOGF(LOG_DEBUG, __VA_ARGS__)
+#define log_nominalf(...)       STRATO_LOGF(LOG_NOMINAL, __VA_ARGS__)
+#define log_errorf(...)         STRATO_LOGF(LOG_ERROR, __VA_ARGS__)
+
+// the level is a constant, so the optimizer removes a disabled call entirely
+#define STRATO_LOG(level, call) do { if ((level) >= (LOG_MODULE_LEVEL)) call; } while (0)
+
+// with LOG_TOKENIZED, formats must be string literals and are sent as tokens (see StratoLogToken.h)
+#ifdef LOG_TOKENIZED
+#define STRATO_LOGF(level, format, ...) \
+    STRATO_LOG(level, { if (false) LogTokenCheck(format, ##__VA_ARGS__); print_logt(level, LOG_TOKEN(format), ##__VA_ARGS__); })
+#else
+#define STRATO_LOGF(level, ...) STRATO_LOG(level, print_logf(level, __VA_ARGS__))
+#endif
+
+void print_log(LOG_LEVEL_t log_level, const char * log_info);
+const char * log_prefix(LOG_LEVEL_t log_level); // "DBG: " etc.
+void print_logf(LOG_LEVEL_t log_level, const char * format, ...) __attribute__((format(printf, 2, 3)));
+
+#ifdef LOG_TOKENIZED
+#include "StratoLogToken.h"
+#endif
 
 // note: ZephyrLog functions are defined/implemented in StratoCore for XMLWriter access
 
-#endif /* STRATOGROUNDPORT_H */
\ No newline at end of file
+#endif /* STRATOGROUNDPORT_H */
@@ -0,0 +1,151 @@
+/*
+ *  StratoHighResScheduler.cpp
+ *  Author:  StratoCore contributors
+ *  Created: October 2026
+ *
+ *  This file implements a class to perform millisecond-resolution scheduling
+ *  through the StratoCore, alongside the 1 Hz StratoScheduler.
+ */
+
+#include "StratoHighResScheduler.h"
+#include "StratoGroundPort.h"
+
+StratoHighResScheduler::StratoHighResScheduler(HighResItem_t * items, uint16_t * heap_array, uint16_t max_size)
+{
+    // the storage belongs to the derived class, don't touch it until it's used
+    item_array = items;
+    pool.Init(items, max_size);
+    heap.Init(items, heap_array);
+
+    next_sequence = 0;
+
+    ResetStats();
+}
+
+uint8_t StratoHighResScheduler::CheckSchedule(uint32_t * lateness_ms)
+{
+    uint8_t action = NO_SCHEDULED_ACTION;
+    uint32_t current_time = StratoMillis();
+
+    if (heap.Size() == 0 || ScheduleMillisOrder::Before(current_time, item_array[heap.Top()].time)) return action;
+
+    uint16_t index = heap.Top();
+    HighResItem_t * item = &item_array[index];
+    uint32_t lateness = current_time - item->time;
+    action = item->action;
+
+    // record the lateness before the item is re-armed or removed
+    stats.fired++;
+    stats.lateness_total += lateness;
+    if (lateness > HIGHRES_LATE_MS) stats.late++;
+    if (lateness > stats.lateness_max) {
+        stats.lateness_max = lateness;
+        stats.lateness_max_action = action;
+    }
+
+    if (NULL != lateness_ms) *lateness_ms = lateness;
+
+    if (item->period == 0 || item->runs_remaining == 1) {
+        ScheduleRemove(index);
+    } else {
+        // phase-locked: step from the scheduled time, skipping any slots that were missed
+        item->time += (lateness / item->period + 1) * item->period;
+        if (item->runs_remaining > 1) item->runs_remaining--;
+        item->sequence = next_sequence++;
+        heap.Update(index);
+    }
+
+    return action;
+}
+
+ScheduleHandle_t StratoHighResScheduler::AddAction(uint8_t action, uint32_t ms_from_now)
+{
+    return SchedulePush(action, StratoMillis() + ms_from_now, 0, 0);
+}
+
+ScheduleHandle_t StratoHighResScheduler::AddPeriodicAction(uint8_t action, uint32_t period_ms, uint32_t ms_from_now, uint16_t count)
+{
+    if (period_ms == 0) return NO_SCHEDULE_HANDLE;
+
+    return SchedulePush(action, StratoMillis() + ms_from_now, period_ms, count);
+}
+
+bool StratoHighResScheduler::CancelAction(ScheduleHandle_t handle)
+{
+    uint16_t index = pool.Find(handle);
+
+    if (index == NO_SCHEDULE_ITEM) return false;
+
+    ScheduleRemove(index);
+
+    return true;
+}
+
+uint16_t StratoHighResScheduler::CancelAction(uint8_t action)
+{
+    return heap.RemoveAction(action, pool);
+}
+
+bool StratoHighResScheduler::IsPending(ScheduleHandle_t handle)
+{
+    return pool.Find(handle) != NO_SCHEDULE_ITEM;
+}
+
+bool StratoHighResScheduler::TimeUntilNext(uint32_t * ms)
+{
+    if (heap.Size() == 0 || NULL == ms) return false;
+
+    uint32_t current_time = StratoMillis();
+    uint32_t next_time = item_array[heap.Top()].time;
+
+    *ms = ScheduleMillisOrder::Before(current_time, next_time) ? next_time - current_time : 0;
+
+    return true;
+}
+
+void StratoHighResScheduler::ClearSchedule()
+{
+    for (uint16_t i = 0; i < heap.Size(); i++) {
+        pool.Release(heap.At(i));
+    }
+
+    heap.Clear();
+}
+
+void StratoHighResScheduler::ResetStats()
+{
+    stats.fired = 0;
+    stats.late = 0;
+    stats.lateness_total = 0;
+    stats.lateness_max = 0;
+    stats.lateness_max_action = NO_SCHEDULED_ACTION;
+}
+
+// ------- schedule queue functions -------
+ScheduleHandle_t StratoHighResScheduler::SchedulePush(uint8_t action, uint32_t schedule_time, uint32_t period, uint16_t count)
+{
+    uint16_t index = pool.Allocate();
+
+    if (index == NO_SCHEDULE_ITEM) {
+        log_error("High-res schedule queue full");
+        return NO_SCHEDULE_HANDLE;
+    }
+
+    HighResItem_t * new_item = &item_array[index];
+    new_item->action = action;
+    new_item->time = schedule_time;
+    new_item->period = period;
+    new_item->runs_remaining = count;
+    new_item->sequence = next_sequence++;
+    new_item->in_use = true;
+
+    heap.Push(index);
+
+    return pool.Handle(index);
+}
+
+void StratoHighResScheduler::ScheduleRemove(uint16_t index)
+{
+    heap.Remove(index);
+    pool.Release(index);
+}
@@ -0,0 +1,107 @@
+/*
+ *  StratoHighResScheduler.h
+ *  Author:  StratoCore contributors
+ *  Created: October 2026
+ *
+ *  This file declares a class to perform millisecond-resolution scheduling
+ *  through the StratoCore, alongside the 1 Hz StratoScheduler.
+ */
+
+#ifndef STRATOHIGHRESSCHEDULER_H
+#define STRATOHIGHRESSCHEDULER_H
+
+#include "StratoScheduler.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// default capacity of the StratoCore high-resolution schedule, can be overridden at compile time
+#ifndef MAX_HIGHRES_SCHEDULE_SIZE
+#define MAX_HIGHRES_SCHEDULE_SIZE   ((uint16_t) 32) // must be 1-65534
+#endif
+
+// define a struct for use only as a container for high-resolution scheduled actions
+struct HighResItem_t {
+    uint32_t time; // StratoMillis() value, compared wrap-safe
+    uint32_t sequence; // insertion order, keeps ties FIFO
+    uint32_t period; // milliseconds between runs of a periodic action, 0 for a one-time action
+    uint16_t runs_remaining; // for periodic actions, 0 runs forever
+    uint16_t heap_index; // position in the heap, or next free item if not in use
+    uint16_t generation; // incremented on release so that old handles are rejected
+    uint8_t action;
+    bool in_use;
+};
+
+// lateness of fired actions relative to their scheduled millis() time
+struct HighResStats_t {
+    uint32_t fired;
+    uint32_t late; // fired more than HIGHRES_LATE_MS after their scheduled time
+    uint32_t lateness_total; // ms, mean = lateness_total / fired
+    uint32_t lateness_max; // ms
+    uint8_t lateness_max_action;
+};
+
+// actions firing more than this many ms after their scheduled time are counted as late
+#define HIGHRES_LATE_MS     5
+
+// The high-resolution schedule is keyed on the monotonic millis() clock, so it is not
+// affected by GPS time corrections and rolls over safely (any pending action must be within
+// ~24 days). It is a single binary min-heap with a free list, and uses the same heap, pool,
+// and handles as StratoScheduler (see StratoScheduleHeap.h). Times are only as precise as the rate at which the loop services it.
+class StratoHighResScheduler {
+public:
+    ~StratoHighResScheduler() { };
+
+    // returns 0 if no action ready, or the id if one is ready (and optionally how late it is in ms)
+    uint8_t CheckSchedule(uint32_t * lateness_ms = NULL);
+
+    // schedule a one-time action, returns NO_SCHEDULE_HANDLE (false) if the push failed
+    ScheduleHandle_t AddAction(uint8_t action, uint32_t ms_from_now);
+
+    // schedule a phase-locked periodic action (see StratoScheduler), a count of 0 runs until cancelled
+    ScheduleHandle_t AddPeriodicAction(uint8_t action, uint32_t period_ms, uint32_t ms_from_now, uint16_t count = 0);
+
+    // remove a single pending action by handle, or every pending instance of an action ID
+    bool CancelAction(ScheduleHandle_t handle);
+    uint16_t CancelAction(uint8_t action);
+
+    bool IsPending(ScheduleHandle_t handle);
+
+    // milliseconds until the next action is due (0 if overdue), false if nothing is scheduled
+    bool TimeUntilNext(uint32_t * ms);
+
+    void ClearSchedule();
+
+    const HighResStats_t & GetStats() { return stats; }
+    void ResetStats();
+
+    uint16_t ScheduleSize() { return heap.Size(); }
+    uint16_t ScheduleCapacity() { return pool.Capacity(); }
+
+protected:
+    StratoHighResScheduler(HighResItem_t * items, uint16_t * heap_array, uint16_t max_size);
+
+private:
+    ScheduleHandle_t SchedulePush(uint8_t action, uint32_t schedule_time, uint32_t period, uint16_t count);
+    void ScheduleRemove(uint16_t index); // remove (and free!) an item
+
+    HighResItem_t * item_array;
+    SchedulePool<HighResItem_t> pool;
+    ScheduleHeap<HighResItem_t, ScheduleMillisOrder> heap;
+
+    uint32_t next_sequence;
+
+    HighResStats_t stats;
+};
+
+// statically-allocated high-resolution scheduler with a compile-time capacity
+template <uint16_t MAX_SIZE>
+class StaticHighResScheduler : public StratoHighResScheduler {
+public:
+    StaticHighResScheduler() : StratoHighResScheduler(items, heap_storage, MAX_SIZE) { }
+
+private:
+    HighResItem_t items[MAX_SIZE];
+    uint16_t heap_storage[MAX_SIZE];
+};
+
+#endif /* STRATOHIGHRESSCHEDULER_H */
@@ -0,0 +1,80 @@
+/*
+ *  StratoIdle.cpp
+ *  Author:  StratoCore contributors
+ *  Created: October 2026
+ *
+ *  This file implements the sleep used by StratoCore::Idle and its duty cycle statistics
+ */
+
+#include "StratoIdle.h"
+
+static const char * wake_names[NUM_IDLE_WAKES] = {
+    "timeout",
+    "input",
+    "TC",
+    "schedule",
+    "high-res",
+    "watchdog"
+};
+
+StratoIdle::StratoIdle()
+{
+    Reset();
+}
+
+IdleWake_t StratoIdle::Sleep(uint32_t sleep_ms, IdleWake_t reason, Stream * input)
+{
+    uint32_t start_ms = StratoMillis();
+    uint32_t start_us = StratoMicros();
+    uint32_t elapsed_ms = 0;
+    uint32_t slept_us = 0;
+
+    stats.calls++;
+
+    // each wait ends at the next interrupt (at least every ms), so input is noticed within a tick of arriving
+    while ((elapsed_ms = StratoMillis() - start_ms) < sleep_ms) {
+        if (NULL != input && input->available() > 0) {
+            reason = IDLE_WAKE_INPUT;
+            break;
+        }
+
+        StratoIdleWait(sleep_ms - elapsed_ms);
+    }
+
+    slept_us = StratoMicros() - start_us;
+
+    if (elapsed_ms > 0) stats.sleeps++;
+    if (elapsed_ms > stats.max_sleep_ms) stats.max_sleep_ms = elapsed_ms;
+    stats.idle_us += slept_us;
+    stats.wakes[reason]++;
+
+    return reason;
+}
+
+uint16_t StratoIdle::DutyCycle()
+{
+    uint64_t window_us = (uint64_t) Window() * 1000;
+
+    if (0 == window_us || stats.idle_us >= window_us) return 0;
+
+    return (uint16_t) (1000 - (stats.idle_us * 1000) / window_us);
+}
+
+void StratoIdle::Reset()
+{
+    stats.calls = 0;
+    stats.sleeps = 0;
+    stats.idle_us = 0;
+    stats.max_sleep_ms = 0;
+
+    for (uint8_t i = 0; i < NUM_IDLE_WAKES; i++) {
+        stats.wakes[i] = 0;
+    }
+
+    window_start_ms = StratoMillis();
+}
+
+const char * StratoIdle::WakeName(uint8_t reason)
+{
+    return (reason < NUM_IDLE_WAKES) ? wake_names[reason] : "unknown";
+}
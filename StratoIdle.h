@@ -0,0 +1,65 @@
+/*
+ *  StratoIdle.h
+ *  Author:  StratoCore contributors
+ *  Created: October 2026
+ *
+ *  This file declares the sleep used by StratoCore::Idle between loop phases,
+ *  which waits for the next deadline or for Zephyr input instead of spinning,
+ *  and keeps the duty cycle statistics.
+ */
+
+#ifndef STRATOIDLE_H
+#define STRATOIDLE_H
+
+#include "StratoClock.h"
+#include "Arduino.h"
+#include <stdint.h>
+
+// Idle doesn't sleep into the last part of the watchdog period after a kick
+#define IDLE_WATCHDOG_MARGIN_MS     1000
+
+// why Idle returned, the deadline that ended the sleep or the work that was already waiting
+enum IdleWake_t {
+    IDLE_WAKE_TIMEOUT = 0,  // the time given to Idle passed
+    IDLE_WAKE_INPUT,        // Zephyr input is waiting to be routed
+    IDLE_WAKE_TC,           // queued TCs are waiting to run
+    IDLE_WAKE_SCHEDULE,     // a 1 Hz scheduled action is due
+    IDLE_WAKE_HIGHRES,      // a high-resolution action is due
+    IDLE_WAKE_WATCHDOG,     // the watchdog is due to be kicked
+    NUM_IDLE_WAKES
+};
+
+struct IdleStats_t {
+    uint32_t calls;
+    uint32_t sleeps; // calls that slept at all
+    uint64_t idle_us;
+    uint32_t max_sleep_ms;
+    uint32_t wakes[NUM_IDLE_WAKES]; // indexed by IdleWake_t
+};
+
+class StratoIdle {
+public:
+    StratoIdle();
+    ~StratoIdle() { };
+
+    // sleep for up to sleep_ms, ending early if input arrives, returns the reason for waking (reason if the time ran out)
+    IdleWake_t Sleep(uint32_t sleep_ms, IdleWake_t reason, Stream * input);
+
+    // time awake since the last reset, in tenths of a percent
+    uint16_t DutyCycle();
+
+    const IdleStats_t & GetStats() { return stats; }
+
+    // ms covered by the stats
+    uint32_t Window() { return StratoMillis() - window_start_ms; }
+
+    void Reset();
+
+    static const char * WakeName(uint8_t reason);
+
+private:
+    IdleStats_t stats;
+    uint32_t window_start_ms;
+};
+
+#endif /* STRATOIDLE_H */
@@ -0,0 +1,146 @@
+/*
+ *  StratoLogToken.cpp
+ *  Author:  StratoCore contributors
+ *  Created: October 2026
+ *
+ *  This file implements tokenized binary logging
+ */
+
+#include "StratoLogToken.h"
+#include "StratoArchive.h"
+#include "StratoClock.h"
+#include <string.h>
+
+static uint8_t token_outputs = LOG_TOKEN_GROUND_PORT;
+static StratoArchive * token_archive = NULL;
+
+static const char base64_table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// returns the encoded length, output must hold 4 * ((size + 2) / 3) characters
+static uint16_t Base64Encode(const uint8_t * data, uint16_t size, char * output)
+{
+    uint16_t out = 0;
+
+    for (uint16_t i = 0; i < size; i += 3) {
+        uint32_t group = (uint32_t) data[i] << 16;
+        if (i + 1 < size) group |= (uint32_t) data[i + 1] << 8;
+        if (i + 2 < size) group |= data[i + 2];
+
+        output[out++] = base64_table[(group >> 18) & 0x3F];
+        output[out++] = base64_table[(group >> 12) & 0x3F];
+        output[out++] = (i + 1 < size) ? base64_table[(group >> 6) & 0x3F] : '=';
+        output[out++] = (i + 2 < size) ? base64_table[group & 0x3F] : '=';
+    }
+
+    return out;
+}
+
+void LogTokenOutputs(uint8_t outputs, StratoArchive * archive)
+{
+    token_outputs = outputs;
+    token_archive = archive;
+}
+
+void LogTokenWrite(LOG_LEVEL_t log_level, const uint8_t * frame, uint16_t size)
+{
+    if (NULL == frame || size > LOG_TOKEN_FRAME_SIZE) return;
+
+    if (token_outputs & LOG_TOKEN_GROUND_PORT) {
+        char line[4 * ((LOG_TOKEN_FRAME_SIZE + 2) / 3) + 1];
+
+        line[Base64Encode(frame, size, line)] = '\0';
+
+        ground_port.BeginLine(log_level);
+        ground_port.print(log_prefix(log_level));
+        ground_port.print(LOG_TOKEN_PREFIX);
+        ground_port.println(line);
+    }
+
+    if ((token_outputs & LOG_TOKEN_ARCHIVE) && NULL != token_archive && token_archive->IsLogging()) {
+        uint8_t record[1 + LOG_TOKEN_FRAME_SIZE];
+
+        record[0] = (uint8_t) log_level;
+        memcpy(&record[1], frame, size);
+        token_archive->WriteRecord(ARCHIVE_TYPE_LOG, (uint32_t) StratoNow(), record, (uint16_t) (size + 1));
+    }
+}
+
+void LogTokenCheck(const char * format, ...)
+{
+    (void) format;
+}
+
+// LogTokenFrame ------------------------------------------
+
+LogTokenFrame::LogTokenFrame(uint32_t token)
+{
+    data[0] = (uint8_t) token;
+    data[1] = (uint8_t) (token >> 8);
+    data[2] = (uint8_t) (token >> 16);
+    data[3] = (uint8_t) (token >> 24);
+    size = 4;
+    full = false;
+}
+
+void LogTokenFrame::AddInteger(int64_t value)
+{
+    uint8_t varint[10];
+    uint8_t length = 0;
+    uint64_t zigzag = ((uint64_t) value << 1) ^ (uint64_t) (value >> 63);
+
+    while (zigzag >= 0x80) {
+        varint[length++] = (uint8_t) (zigzag | 0x80);
+        zigzag >>= 7;
+    }
+    varint[length++] = (uint8_t) zigzag;
+
+    if (full || size + length > LOG_TOKEN_FRAME_SIZE) {
+        full = true;
+        return;
+    }
+
+    memcpy(&data[size], varint, length);
+    size += length;
+}
+
+void LogTokenFrame::AddFloat(float value)
+{
+    uint32_t bits = 0;
+
+    if (full || size + 4 > LOG_TOKEN_FRAME_SIZE) {
+        full = true;
+        return;
+    }
+
+    memcpy(&bits, &value, 4);
+    data[size++] = (uint8_t) bits;
+    data[size++] = (uint8_t) (bits >> 8);
+    data[size++] = (uint8_t) (bits >> 16);
+    data[size++] = (uint8_t) (bits >> 24);
+}
+
+// a string is cut to fit the frame, with its truncation flag set
+void LogTokenFrame::AddString(const char * value)
+{
+    uint32_t length = (NULL != value) ? strlen(value) : 0;
+    uint8_t flag = 0;
+
+    if (full || size + 1 > LOG_TOKEN_FRAME_SIZE) {
+        full = true;
+        return;
+    }
+
+    if (length > 0x7F) {
+        length = 0x7F;
+        flag = 0x80;
+    }
+
+    if (size + 1 + length > LOG_TOKEN_FRAME_SIZE) {
+        length = LOG_TOKEN_FRAME_SIZE - size - 1;
+        flag = 0x80;
+    }
+
+    data[size++] = (uint8_t) (flag | length);
+    if (length > 0) memcpy(&data[size], value, length);
+    size += (uint16_t) length;
+}
@@ -0,0 +1,120 @@
+/*
+ *  StratoLogToken.h
+ *  Author:  StratoCore contributors
+ *  Created: October 2026
+ *
+ *  This file declares tokenized binary logging: each printf-style log site
+ *  is sent as a compile-time token of its format string and its raw
+ *  arguments, and expanded on the ground from a dictionary of the formats
+ */
+
+#ifndef STRATOLOGTOKEN_H
+#define STRATOLOGTOKEN_H
+
+#include "StratoGroundPort.h"
+#include <stdint.h>
+
+class StratoArchive;
+
+// When LOG_TOKENIZED is defined (for the whole build, or before the includes in a source file), the
+// log_xxxxf macros send each log as a frame of the format's token and the encoded arguments, which
+// is formatted on the ground instead of on the instrument. All values are little-endian.
+//   frame:     uint32_t token (FNV-1a hash of the format string), then each argument in order
+//   integers:  zigzag varint of the value as an int64_t (char, bool, enums, and pointers included)
+//   floats:    float (doubles are sent as floats)
+//   strings:   uint8_t length (bit 7 set if truncated), then the characters without the nul
+// The ground port gets one line per frame, "<level prefix>$<base64 frame>", and an archive (if set)
+// gets an ARCHIVE_TYPE_LOG record per frame: uint8_t level, then the frame.
+
+// largest frame, arguments that don't fit are left off and shown as missing by the decoder
+#ifndef LOG_TOKEN_FRAME_SIZE
+#define LOG_TOKEN_FRAME_SIZE    64
+#endif
+
+// marks a frame line on the ground port, after the level prefix
+#define LOG_TOKEN_PREFIX        '$'
+
+// where frames are sent
+#define LOG_TOKEN_GROUND_PORT   0x01
+#define LOG_TOKEN_ARCHIVE       0x02
+
+// FNV-1a, evaluated by the compiler for the literal format at each log site (the dictionary tool matches it)
+constexpr uint32_t LogTokenHash(const char * format, uint32_t hash = 2166136261UL)
+{
+    return ('\0' == *format) ? hash : LogTokenHash(format + 1, (hash ^ (uint8_t) *format) * 16777619UL);
+}
+
+// forces the hash to be a compile-time constant
+template <uint32_t TOKEN>
+struct LogToken_t {
+    static const uint32_t value = TOKEN;
+};
+
+#define LOG_TOKEN(format)   (LogToken_t<LogTokenHash(format)>::value)
+
+// choose the outputs (LOG_TOKEN_GROUND_PORT by default), archive is needed for LOG_TOKEN_ARCHIVE
+void LogTokenOutputs(uint8_t outputs, StratoArchive * archive = NULL);
+
+// send an encoded frame to the outputs
+void LogTokenWrite(LOG_LEVEL_t log_level, const uint8_t * frame, uint16_t size);
+
+// Argument encoding --------------------------------------
+
+class LogTokenFrame {
+public:
+    LogTokenFrame(uint32_t token);
+
+    void AddInteger(int64_t value);
+    void AddFloat(float value);
+    void AddString(const char * value);
+
+    // an exact overload for each type, so no argument is ambiguous
+    void Add(bool value) { AddInteger(value); }
+    void Add(char value) { AddInteger(value); }
+    void Add(signed char value) { AddInteger(value); }
+    void Add(unsigned char value) { AddInteger(value); }
+    void Add(short value) { AddInteger(value); }
+    void Add(unsigned short value) { AddInteger(value); }
+    void Add(int value) { AddInteger(value); }
+    void Add(unsigned int value) { AddInteger(value); }
+    void Add(long value) { AddInteger(value); }
+    void Add(unsigned long value) { AddInteger((int64_t) value); }
+    void Add(long long value) { AddInteger(value); }
+    void Add(unsigned long long value) { AddInteger((int64_t) value); }
+    void Add(float value) { AddFloat(value); }
+    void Add(double value) { AddFloat((float) value); }
+    void Add(const char * value) { AddString(value); }
+    void Add(char * value) { AddString(value); }
+    void Add(const void * value) { AddInteger((int64_t) (uintptr_t) value); }
+
+    const uint8_t * Data() { return data; }
+    uint16_t Size() { return size; }
+
+private:
+    uint8_t data[LOG_TOKEN_FRAME_SIZE];
+    uint16_t size;
+    bool full; // once an argument doesn't fit, later ones are left off too
+};
+
+inline void LogTokenAdd(LogTokenFrame & frame) { (void) frame; }
+
+template <typename T, typename... Args>
+inline void LogTokenAdd(LogTokenFrame & frame, T value, Args... args)
+{
+    frame.Add(value);
+    LogTokenAdd(frame, args...);
+}
+
+template <typename... Args>
+void print_logt(LOG_LEVEL_t log_level, uint32_t token, Args... args)
+{
+    LogTokenFrame frame(token);
+
+    LogTokenAdd(frame, args...);
+    LogTokenWrite(log_level, frame.Data(), frame.Size());
+}
+
+// never called, lets the compiler check the arguments against the format
+void LogTokenCheck(const char * format, ...) __attribute__((format(printf, 1, 2)));
+
+#endif /* STRATOLOGTOKEN_H */
@@ -0,0 +1,58 @@
+/*
+ *  StratoModeTable.h
+ *  Author:  StratoCore contributors
+ *  Created: October 2026
+ *
+ *  This file declares the substate table that StratoCore can run for a mode
+ *  in place of the mode function, and compile-time checks for it
+ */
+
+#ifndef STRATOMODETABLE_H
+#define STRATOMODETABLE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+class StratoCore;
+
+// substate handlers are StratoCore or instrument methods that return the next substate, the current one
+// to stay, or MODE_ERROR to take the table's error transition
+typedef uint8_t (StratoCore::*SubstateMethod_t)();
+
+struct SubstateEntry_t {
+    uint8_t substate;
+    SubstateMethod_t handler;
+    uint32_t timeout_s; // time in the substate before moving to on_timeout, 0 for no timeout
+    uint8_t on_timeout;
+    uint8_t on_error;
+};
+
+// one entry of a substate table, with an instrument method as the handler
+#define SUBSTATE(substate, method, timeout_s, on_timeout, on_error) \
+    {(substate), static_cast<SubstateMethod_t>(&method), (timeout_s), (on_timeout), (on_error)}
+
+// compile-time checks of a substate table, for use in static_assert (recursive for C++11 constexpr)
+constexpr bool SubstateInTable(const SubstateEntry_t * table, size_t size, uint8_t substate)
+{
+    return size > 0 && (table[0].substate == substate || SubstateInTable(table + 1, size - 1, substate));
+}
+
+constexpr bool SubstateEntriesValid(const SubstateEntry_t * table, size_t size, const SubstateEntry_t * all, size_t all_size)
+{
+    return 0 == size
+           || (nullptr != table[0].handler
+               && !SubstateInTable(table + 1, size - 1, table[0].substate) // no duplicates
+               && (0 == table[0].timeout_s || SubstateInTable(all, all_size, table[0].on_timeout))
+               && SubstateInTable(all, all_size, table[0].on_error)
+               && SubstateEntriesValid(table + 1, size - 1, all, all_size));
+}
+
+// the table must have a MODE_ENTRY (0) substate, each substate once with a handler, and every timeout and
+// error transition must lead to a substate in the table
+template <size_t N>
+constexpr bool SubstateTableValid(const SubstateEntry_t (&table)[N])
+{
+    return SubstateInTable(table, N, 0) && SubstateEntriesValid(table, N, table, N);
+}
+
+#endif /* STRATOMODETABLE_H */
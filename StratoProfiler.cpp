@@ -0,0 +1,192 @@
+/*
+ *  StratoProfiler.cpp
+ *  Author:  StratoCore contributors
+ *  Created: October 2026
+ *
+ *  This file implements a low-overhead profiler for the StratoCore loop phases
+ */
+
+#include "StratoProfiler.h"
+#include "StratoGroundPort.h"
+
+static const uint32_t bucket_limits[PROFILE_BUCKETS - 1] = PROFILE_BUCKET_LIMITS;
+
+static const char * phase_names[NUM_PHASES] = {
+    "RunRouter",
+    "RunMode",
+    "RunScheduler",
+    "RunHighResScheduler",
+    "RunSDWriter",
+    "RunTasks",
+    "InstrumentLoop",
+    "ActionHandler",
+    "TCHandler",
+    "Loop (busy)"
+};
+
+StratoProfiler::StratoProfiler()
+{
+    for (uint8_t i = 0; i < NUM_PHASES; i++) {
+        budgets[i] = LOOP_BUDGET_US;
+    }
+
+    last_kick_us = micros();
+
+    Reset();
+}
+
+uint32_t StratoProfiler::Record(ProfilePhase_t phase, uint32_t start_us)
+{
+    uint32_t elapsed = micros() - start_us;
+    PhaseStats_t * stats = &phases[phase];
+    uint8_t bucket = 0;
+
+    if (stats->count == 0 || elapsed < stats->min_us) stats->min_us = elapsed;
+    if (elapsed > stats->max_us) stats->max_us = elapsed;
+    stats->total_us += elapsed;
+    stats->count++;
+
+    if (elapsed > budgets[phase]) stats->overruns++;
+
+    while (bucket < PROFILE_BUCKETS - 1 && elapsed >= bucket_limits[bucket]) bucket++;
+    stats->histogram[bucket]++;
+
+    // the top-level phases make up the loop's busy time
+    if (phase <= PHASE_INSTRUMENT) loop_busy_us += elapsed;
+
+    return elapsed;
+}
+
+void StratoProfiler::RecordMode(uint8_t mode, uint8_t substate, uint32_t elapsed_us)
+{
+    ModeStats_t * slot = ModeSlot(mode, substate);
+
+    if (NULL == slot) {
+        untracked_mode_calls++;
+        return;
+    }
+
+    slot->count++;
+    slot->total_us += elapsed_us;
+    if (elapsed_us > slot->max_us) slot->max_us = elapsed_us;
+}
+
+void StratoProfiler::RecordModeEntry(uint8_t mode, uint8_t substate)
+{
+    ModeStats_t * slot = ModeSlot(mode, substate);
+
+    if (NULL != slot) slot->entries++;
+}
+
+void StratoProfiler::RecordModeDwell(uint8_t mode, uint8_t substate, uint32_t dwell_ms)
+{
+    ModeStats_t * slot = ModeSlot(mode, substate);
+
+    if (NULL != slot) slot->dwell_ms += dwell_ms;
+}
+
+ModeStats_t * StratoProfiler::ModeSlot(uint8_t mode, uint8_t substate)
+{
+    uint8_t slot = 0;
+
+    // there are only a handful of pairs in practice, so a linear search is cheapest
+    while (slot < num_mode_slots && (mode_slots[slot].mode != mode || mode_slots[slot].substate != substate)) {
+        slot++;
+    }
+
+    if (slot == num_mode_slots) {
+        if (num_mode_slots >= PROFILE_MODE_SLOTS) return NULL;
+
+        num_mode_slots++;
+        mode_slots[slot] = {mode, substate, 0, 0, 0, 0, 0};
+    }
+
+    return &mode_slots[slot];
+}
+
+void StratoProfiler::EndLoop()
+{
+    uint32_t now_us = micros();
+    uint32_t interval = now_us - last_kick_us;
+
+    if (interval > max_kick_interval_us) max_kick_interval_us = interval;
+    last_kick_us = now_us;
+
+    // record the busy time as a phase that "started" that long ago
+    Record(PHASE_LOOP, now_us - loop_busy_us);
+    loop_busy_us = 0;
+}
+
+void StratoProfiler::SetBudget(ProfilePhase_t phase, uint32_t budget_us)
+{
+    if (phase < NUM_PHASES) budgets[phase] = budget_us;
+}
+
+void StratoProfiler::Reset()
+{
+    for (uint8_t i = 0; i < NUM_PHASES; i++) {
+        phases[i].count = 0;
+        phases[i].min_us = 0;
+        phases[i].max_us = 0;
+        phases[i].total_us = 0;
+        phases[i].overruns = 0;
+        for (uint8_t j = 0; j < PROFILE_BUCKETS; j++) {
+            phases[i].histogram[j] = 0;
+        }
+    }
+
+    num_mode_slots = 0;
+    untracked_mode_calls = 0;
+    loop_busy_us = 0;
+    max_kick_interval_us = 0;
+}
+
+const char * StratoProfiler::PhaseName(uint8_t phase)
+{
+    return (phase < NUM_PHASES) ? phase_names[phase] : "no phase";
+}
+
+void StratoProfiler::PrintProfile()
+{
+    debug_serial->println("Phase: count, min/mean/max us, overruns, histogram");
+    for (uint8_t i = 0; i < NUM_PHASES; i++) {
+        PhaseStats_t * stats = &phases[i];
+        debug_serial->print(phase_names[i]);
+        debug_serial->print(": ");
+        debug_serial->print(stats->count);
+        debug_serial->print(", ");
+        debug_serial->print(stats->min_us);
+        debug_serial->print("/");
+        debug_serial->print(stats->count ? (uint32_t) (stats->total_us / stats->count) : 0);
+        debug_serial->print("/");
+        debug_serial->print(stats->max_us);
+        debug_serial->print(", ");
+        debug_serial->print(stats->overruns);
+        debug_serial->print(",");
+        for (uint8_t j = 0; j < PROFILE_BUCKETS; j++) {
+            debug_serial->print(" ");
+            debug_serial->print(stats->histogram[j]);
+        }
+        debug_serial->println();
+    }
+
+    debug_serial->println("Mode,substate: count, mean/max us, entries, ms spent");
+    for (uint8_t i = 0; i < num_mode_slots; i++) {
+        debug_serial->print(mode_slots[i].mode);
+        debug_serial->print(",");
+        debug_serial->print(mode_slots[i].substate);
+        debug_serial->print(": ");
+        debug_serial->print(mode_slots[i].count);
+        debug_serial->print(", ");
+        debug_serial->print(mode_slots[i].count ? (uint32_t) (mode_slots[i].total_us / mode_slots[i].count) : 0);
+        debug_serial->print("/");
+        debug_serial->print(mode_slots[i].max_us);
+        debug_serial->print(", ");
+        debug_serial->print(mode_slots[i].entries);
+        debug_serial->print(", ");
+        debug_serial->println(mode_slots[i].dwell_ms);
+    }
+
+    debug_serial->print("Max kick interval us: ");
+    debug_serial->println(max_kick_interval_us);
+}
@@ -0,0 +1,111 @@
+/*
+ *  StratoProfiler.h
+ *  Author:  StratoCore contributors
+ *  Created: October 2026
+ *
+ *  This file declares a low-overhead profiler for the StratoCore loop phases,
+ *  based on micros(), that keeps min/max/mean, a fixed-bucket histogram, and
+ *  an overrun count for each phase and each mode/substate.
+ */
+
+#ifndef STRATOPROFILER_H
+#define STRATOPROFILER_H
+
+#include "Arduino.h"
+#include <stdint.h>
+
+// the loop period that the cyclic executive is designed around
+#define LOOP_BUDGET_US      1000000UL
+
+// histogram bucket upper limits in microseconds, the last bucket is everything above
+#define PROFILE_BUCKETS     8
+#define PROFILE_BUCKET_LIMITS   {100UL, 1000UL, 10000UL, 100000UL, 500000UL, 1000000UL, 5000000UL}
+
+// number of distinct mode/substate pairs that are tracked (later pairs are counted as untracked)
+#define PROFILE_MODE_SLOTS  32
+
+enum ProfilePhase_t {
+    PHASE_ROUTER = 0,   // RunRouter, including TCHandler
+    PHASE_MODE,         // RunMode, also broken down by mode and substate
+    PHASE_SCHEDULER,    // RunScheduler, including ActionHandler
+    PHASE_HIGHRES,      // RunHighResScheduler, including HighResActionHandler
+    PHASE_SD,           // RunSDWriter
+    PHASE_TASKS,        // RunTasks
+    PHASE_INSTRUMENT,   // InstrumentLoop (when called through RunInstrumentLoop)
+    PHASE_ACTION,       // each ActionHandler call
+    PHASE_TC,           // each TCHandler call
+    PHASE_LOOP,         // busy time of each loop: the sum of the top-level phases between watchdog kicks
+    NUM_PHASES
+};
+
+struct PhaseStats_t {
+    uint32_t count;
+    uint32_t min_us;
+    uint32_t max_us;
+    uint64_t total_us; // mean = total_us / count
+    uint32_t overruns; // calls over the phase budget
+    uint32_t histogram[PROFILE_BUCKETS];
+};
+
+struct ModeStats_t {
+    uint8_t mode;
+    uint8_t substate;
+    uint32_t count;
+    uint32_t max_us;
+    uint64_t total_us;
+    uint32_t entries; // times the mode/substate was entered from another
+    uint32_t dwell_ms; // time spent in the mode/substate, added when it's left
+};
+
+class StratoProfiler {
+public:
+    StratoProfiler();
+    ~StratoProfiler() { };
+
+    // record a phase that started at start_us (from micros()), returns the elapsed time
+    uint32_t Record(ProfilePhase_t phase, uint32_t start_us);
+
+    // record a mode function call in addition to the PHASE_MODE record
+    void RecordMode(uint8_t mode, uint8_t substate, uint32_t elapsed_us);
+
+    // record a mode/substate being entered, and the time spent in one that was just left
+    void RecordModeEntry(uint8_t mode, uint8_t substate);
+    void RecordModeDwell(uint8_t mode, uint8_t substate, uint32_t dwell_ms);
+
+    // called on every watchdog kick to close out the busy time of the loop
+    void EndLoop();
+
+    // calls longer than the budget count as overruns (LOOP_BUDGET_US by default)
+    void SetBudget(ProfilePhase_t phase, uint32_t budget_us);
+
+    void Reset();
+
+    // human-readable summary on the ground port
+    void PrintProfile();
+
+    // name of a ProfilePhase_t for logging
+    static const char * PhaseName(uint8_t phase);
+
+    const PhaseStats_t & GetPhase(ProfilePhase_t phase) { return phases[phase]; }
+    const ModeStats_t & GetModeSlot(uint8_t slot) { return mode_slots[slot]; }
+    uint8_t NumModeSlots() { return num_mode_slots; }
+    uint32_t UntrackedModeCalls() { return untracked_mode_calls; }
+    uint32_t MaxKickInterval() { return max_kick_interval_us; }
+
+private:
+    // the slot for a mode/substate pair, added if needed, NULL if there's no room
+    ModeStats_t * ModeSlot(uint8_t mode, uint8_t substate);
+
+    PhaseStats_t phases[NUM_PHASES];
+    uint32_t budgets[NUM_PHASES];
+
+    ModeStats_t mode_slots[PROFILE_MODE_SLOTS];
+    uint8_t num_mode_slots;
+    uint32_t untracked_mode_calls;
+
+    uint32_t loop_busy_us;
+    uint32_t last_kick_us;
+    uint32_t max_kick_interval_us;
+};
+
+#endif /* STRATOPROFILER_H */
@@ -8,14 +8,22 @@
 
 #include "StratoSD.h"
 #include "StratoGroundPort.h"
+#include "StratoClock.h"
 #include <SdFat.h>
 #include <SdFatConfig.h>
+#include <string.h>
 
 // globals for internal use
 bool sd_state = false;
 File file;
 SdFatSdio SD;
 
+// loggers drained by ServiceSDLoggers, in construction order
+static StratoSDLogger * sd_loggers[MAX_SD_LOGGERS];
+static uint8_t num_sd_loggers = 0;
+static uint8_t next_sd_logger = 0; // round-robin start so no logger is starved
+static SDWriteStats_t sd_write_stats;
+
 bool StartSD()
 {
     if (SD.begin()) {
@@ -39,10 +47,8 @@ bool FileWrite(const char * filename, const char * buffer, int buffer_size)
 
 	file = SD.open(filename, FILE_WRITE);
 
-	debug_serial->print("Filename: "); debug_serial->println(filename);
-
 	if (!file) {
-		debug_serial->println("File not ok");
+		log_error("File not ok");
 		return false;
 	}
 
@@ -50,7 +56,436 @@ bool FileWrite(const char * filename, const char * buffer, int buffer_size)
 
     file.close();
 
-	debug_serial->print("File write ok, bytes: "); debug_serial->println(bytes_written);
+	log_debug(filename);
 
 	return (bytes_written == buffer_size);
+}
+
+// SD logger ----------------------------------------------
+
+StratoSDLogger::StratoSDLogger(uint8_t * buffer, uint32_t buffer_size)
+{
+    // the buffer belongs to the derived class, don't touch it until it's used
+    ring = buffer;
+    capacity = buffer_size;
+    head = 0;
+    tail = 0;
+    buffered = 0;
+
+    file_open = false;
+    logging = false;
+    prefix[0] = '\0';
+    filename[0] = '\0';
+    file_size = 0;
+    file_position = 0;
+    file_number = 0;
+    rotate_seconds = 0;
+
+    assigned_file = 0;
+    assigned_bytes = 0;
+    assigned_start = 0;
+    boundary_pending = false;
+    boundary_remaining = 0;
+    last_write_offset = 0;
+
+    ResetStats();
+
+    if (num_sd_loggers < MAX_SD_LOGGERS) {
+        sd_loggers[num_sd_loggers++] = this;
+    } else {
+        log_error("Too many SD loggers to service");
+    }
+}
+
+StratoSDLogger::~StratoSDLogger()
+{
+    uint8_t i = 0;
+
+    while (i < num_sd_loggers && sd_loggers[i] != this) i++;
+    if (i == num_sd_loggers) return;
+
+    num_sd_loggers--;
+    for (; i < num_sd_loggers; i++) {
+        sd_loggers[i] = sd_loggers[i + 1];
+    }
+
+    next_sd_logger = 0;
+}
+
+bool StratoSDLogger::Open(const char * file_prefix, uint32_t size, uint32_t rotate_time)
+{
+    if (NULL == file_prefix || strlen(file_prefix) >= SD_LOG_PREFIX_SIZE || size == 0) return false;
+
+    if (logging) Close();
+
+    if (!sd_state) return false;
+
+    strcpy(prefix, file_prefix);
+    rotate_seconds = rotate_time;
+
+    // a file must hold at least a full buffer so that only one file boundary is ever waiting to be written
+    file_size = ((size + SD_SECTOR_SIZE - 1) / SD_SECTOR_SIZE) * SD_SECTOR_SIZE;
+    if (file_size < capacity) file_size = capacity;
+
+    file_number = 0;
+    assigned_file = 0;
+    assigned_bytes = 0;
+    boundary_pending = false;
+    logging = true;
+
+    // the file itself is created by the first flush, so that opening doesn't stall the caller
+    return true;
+}
+
+bool StratoSDLogger::Write(const void * header, uint32_t header_size, const void * data, uint32_t size)
+{
+    uint32_t total = header_size + size;
+
+    if ((NULL == header && header_size > 0) || (NULL == data && size > 0) || total == 0) return false;
+
+    if (!logging || total > capacity) {
+        Drop(total);
+        return false;
+    }
+
+    // the card is only written from the loop's SD phase, so if it can't keep up the record is dropped whole
+    if (capacity - buffered < total) {
+        Drop(total);
+        return false;
+    }
+
+    // a write never straddles two files: the next file starts here if this one is full or old enough
+    if (assigned_bytes > 0 && !boundary_pending
+        && (assigned_bytes + total > file_size
+            || (rotate_seconds > 0 && (uint32_t) StratoNow() - assigned_start >= rotate_seconds))) {
+        boundary_pending = true;
+        boundary_remaining = buffered;
+        assigned_file++;
+        assigned_bytes = 0;
+    }
+
+    if (assigned_bytes == 0) assigned_start = (uint32_t) StratoNow();
+
+    last_write_offset = assigned_bytes;
+    assigned_bytes += total;
+
+    CopyIn((const uint8_t *) header, header_size);
+    CopyIn((const uint8_t *) data, size);
+    stats.bytes_logged += total;
+
+    if (buffered > stats.max_buffered) stats.max_buffered = buffered;
+
+    return true;
+}
+
+bool StratoSDLogger::FlushStep(uint32_t max_bytes, uint32_t * bytes_written)
+{
+    // only the bytes before a file boundary go in the open file
+    uint32_t pending = boundary_pending ? boundary_remaining : buffered;
+    uint32_t size = pending - (pending % SD_SECTOR_SIZE);
+
+    if (NULL != bytes_written) *bytes_written = 0;
+
+    if (!logging) return false;
+
+    if (!file_open && !OpenNextFile()) return false;
+
+    // at least one sector per step so that a small budget still makes progress
+    if (max_bytes < SD_SECTOR_SIZE) max_bytes = SD_SECTOR_SIZE;
+    if (size > max_bytes) size = max_bytes - (max_bytes % SD_SECTOR_SIZE);
+
+    if (size > 0) {
+        if (!WriteFromBuffer(size)) return false;
+
+        Consume(size);
+        file_position += size;
+        stats.sectors_written += size / SD_SECTOR_SIZE;
+
+        FileWritten(file_number, filename, file_position);
+    }
+
+    // once everything for this file is written, finish it so that the next one can start
+    if (boundary_pending && boundary_remaining < SD_SECTOR_SIZE) {
+        size += CloseFile();
+    }
+
+    if (NULL != bytes_written) *bytes_written = size;
+
+    return true;
+}
+
+bool StratoSDLogger::Flush()
+{
+    do {
+        if (!FlushStep(capacity, NULL)) return false;
+    } while (boundary_pending || buffered >= SD_SECTOR_SIZE);
+
+    return true;
+}
+
+bool StratoSDLogger::Sync()
+{
+    if (!Flush()) return false;
+
+    if (!file_open) {
+        if (buffered == 0) return true;
+        if (!OpenNextFile()) return false;
+    }
+
+    // write the partial sector without consuming it, it's rewritten in place once it fills
+    if (buffered > 0) {
+        if (!WriteFromBuffer(buffered) || !file.seekSet(file_position)) return false;
+    }
+
+    if (!file.sync()) {
+        stats.write_errors++;
+        return false;
+    }
+
+    stats.syncs++;
+
+    FileSynced(file_number, filename);
+
+    return true;
+}
+
+void StratoSDLogger::Close()
+{
+    if (!logging) return;
+
+    Flush();
+    if (!file_open && buffered > 0) OpenNextFile();
+    if (file_open) CloseFile();
+
+    // anything left couldn't be written
+    Drop(buffered);
+    head = 0;
+    tail = 0;
+    buffered = 0;
+    boundary_pending = false;
+
+    logging = false;
+}
+
+void StratoSDLogger::ResetStats()
+{
+    stats.bytes_logged = 0;
+    stats.bytes_dropped = 0;
+    stats.sectors_written = 0;
+    stats.syncs = 0;
+    stats.files_opened = 0;
+    stats.write_errors = 0;
+    stats.max_buffered = buffered;
+}
+
+bool StratoSDLogger::OpenNextFile()
+{
+    uint32_t file_time = (uint32_t) StratoNow();
+    uint8_t attempt = 0;
+
+    file_open = false;
+
+    if (!sd_state) return false;
+
+    file_position = 0;
+
+    // another file may have been started this second
+    snprintf(filename, SD_LOG_NAME_SIZE, "%s_%lu.dat", prefix, (unsigned long) file_time);
+    while (SD.exists(filename)) {
+        if (++attempt > 9) {
+            log_error("Unable to name log file");
+            return false;
+        }
+        snprintf(filename, SD_LOG_NAME_SIZE, "%s_%lu_%u.dat", prefix, (unsigned long) file_time, attempt);
+    }
+
+    // pre-allocate a contiguous file so that writes never have to update the FAT, or fall back to a regular file
+    if (!file.createContiguous(filename, file_size)) {
+        log_error("Unable to pre-allocate log file");
+        file = SD.open(filename, FILE_WRITE);
+        if (!file) {
+            log_error("Unable to open log file");
+            return false;
+        }
+    }
+
+    log_debug(filename);
+
+    file_open = true;
+    stats.files_opened++;
+
+    FileOpened(file_number, filename);
+
+    return true;
+}
+
+// write this file's remaining partial sector, trim the pre-allocated space after the data and close,
+// returns the bytes written
+uint32_t StratoSDLogger::CloseFile()
+{
+    uint32_t pending = boundary_pending ? boundary_remaining : buffered;
+    uint32_t written = 0;
+
+    if (pending > 0 && pending < SD_SECTOR_SIZE) {
+        // on an error the file is already finished
+        if (!WriteFromBuffer(pending)) return 0;
+
+        file_position += pending;
+        Consume(pending);
+        written = pending;
+    }
+
+    FileClosing(file_number, filename, file_position);
+
+    if (file_position < file_size) file.truncate(file_position);
+
+    file.close();
+    file_open = false;
+
+    // the next file is the one new writes are going to
+    file_number++;
+    boundary_pending = false;
+
+    return written;
+}
+
+// after a write error, finish the file with the data that reached the card and drop the rest of its data, so
+// that the next file gets a new number and the offsets already assigned to the files after it stay right
+void StratoSDLogger::AbandonFile()
+{
+    uint32_t unwritten = boundary_pending ? boundary_remaining : buffered;
+
+    // only what was written (or synced before) is on the card
+    FileClosing(file_number, filename, file_position);
+
+    // the pre-allocation isn't trimmed, a synced partial sector past file_position is still good data
+    file.close();
+    file_open = false;
+
+    Consume(unwritten);
+    Drop(unwritten);
+
+    // without a boundary, everything buffered was for this file, so new writes start the next one
+    if (!boundary_pending) {
+        assigned_file++;
+        assigned_bytes = 0;
+    }
+
+    file_number++;
+    boundary_pending = false;
+}
+
+// write from the tail of the ring without consuming the data, finishes the file on an error
+bool StratoSDLogger::WriteFromBuffer(uint32_t size)
+{
+    uint32_t first = capacity - tail;
+    if (first > size) first = size;
+
+    if ((int) first != file.write(&ring[tail], first)
+        || (size > first && (int) (size - first) != file.write(ring, size - first))) {
+        log_error("SD log write failed");
+        stats.write_errors++;
+
+        // the next flush starts a new file
+        AbandonFile();
+        return false;
+    }
+
+    return true;
+}
+
+// copy in up to two pieces around the end of the ring, the space must already be checked
+void StratoSDLogger::CopyIn(const uint8_t * data, uint32_t size)
+{
+    uint32_t first = capacity - head;
+    if (first > size) first = size;
+
+    if (size == 0) return;
+
+    memcpy(&ring[head], data, first);
+    memcpy(ring, data + first, size - first);
+
+    head = (head + size) % capacity;
+    buffered += size;
+}
+
+void StratoSDLogger::Consume(uint32_t size)
+{
+    tail = (tail + size) % capacity;
+    buffered -= size;
+
+    if (boundary_pending) boundary_remaining -= size;
+}
+
+// counted in both totals, so resetting the logger's stats can't hide drops from the SD phase's reports
+void StratoSDLogger::Drop(uint32_t size)
+{
+    stats.bytes_dropped += size;
+    sd_write_stats.bytes_dropped += size;
+}
+
+// SD write phase -----------------------------------------
+
+uint32_t ServiceSDLoggers(uint32_t max_bytes, uint32_t max_us)
+{
+    uint32_t start_us = micros();
+    uint32_t total_written = 0;
+    uint32_t written = 0;
+    uint8_t idle = 0; // consecutive loggers with nothing to write
+    uint8_t index = next_sd_logger;
+    bool behind = false;
+
+    // one batch from each logger in turn until all are idle or a budget is spent
+    while (num_sd_loggers > 0 && idle < num_sd_loggers
+           && total_written < max_bytes && micros() - start_us < max_us) {
+        if (index >= num_sd_loggers) index = 0;
+
+        uint32_t batch = max_bytes - total_written;
+        if (batch > SD_WRITE_BATCH) batch = SD_WRITE_BATCH;
+
+        if (sd_loggers[index]->FlushStep(batch, &written) && written > 0) {
+            total_written += written;
+            idle = 0;
+        } else {
+            idle++;
+        }
+
+        index++;
+    }
+
+    next_sd_logger = (index >= num_sd_loggers) ? 0 : index;
+
+    // back-pressure: how much is waiting, and whether this phase ran out of budget with sectors still queued
+    sd_write_stats.queue_depth = 0;
+    for (uint8_t i = 0; i < num_sd_loggers; i++) {
+        sd_write_stats.queue_depth += sd_loggers[i]->Buffered();
+        if (sd_loggers[i]->IsLogging() && sd_loggers[i]->Buffered() >= SD_SECTOR_SIZE) behind = true;
+    }
+
+    if (sd_write_stats.queue_depth > sd_write_stats.max_queue_depth) {
+        sd_write_stats.max_queue_depth = sd_write_stats.queue_depth;
+    }
+
+    if (behind) sd_write_stats.budget_exhausted++;
+
+    sd_write_stats.phases++;
+    sd_write_stats.bytes_written += total_written;
+
+    return total_written;
+}
+
+bool SyncSDLoggers()
+{
+    bool synced = true;
+
+    for (uint8_t i = 0; i < num_sd_loggers; i++) {
+        if (sd_loggers[i]->IsLogging() && !sd_loggers[i]->Sync()) synced = false;
+    }
+
+    return synced;
+}
+
+const SDWriteStats_t & GetSDWriteStats()
+{
+    return sd_write_stats;
 }
\ No newline at end of file
@@ -9,8 +9,165 @@
 #ifndef STRATOSD_H
 #define STRATOSD_H
 
+#include <SdFat.h>
+#include <stdint.h>
+
+// the logger only ever writes whole sectors, except when explicitly synced or closed
+#define SD_SECTOR_SIZE          512
+
+// default size of pre-allocated log files, a new file is started when one fills (rounded up to whole sectors)
+#define SD_LOG_FILE_SIZE        (4UL * 1024UL * 1024UL)
+
+// maximum length of a log file prefix (e.g. "TM" in "TM_1561000000.dat"), and of a whole log file name
+#define SD_LOG_PREFIX_SIZE      16
+#define SD_LOG_NAME_SIZE        (SD_LOG_PREFIX_SIZE + 24)
+
+// maximum number of loggers serviced by ServiceSDLoggers
+#define MAX_SD_LOGGERS          8
+
+// default per-loop budget for writing logs to the card, and the largest write made at once
+#define SD_WRITE_BYTES_PER_LOOP (32UL * 1024UL)
+#define SD_WRITE_US_PER_LOOP    100000UL
+#define SD_WRITE_BATCH          (4UL * SD_SECTOR_SIZE)
+
+// the card, for modules that build on StratoSD
+extern SdFatSdio SD;
+extern bool sd_state;
+
 bool StartSD();
 
 bool FileWrite(const char * filename, const char * buffer, int buffer_size);
 
-#endif /* STRATOSD_H */
\ No newline at end of file
+// totals across all loggers for the SD write phase
+struct SDWriteStats_t {
+    uint32_t phases; // calls to ServiceSDLoggers
+    uint32_t bytes_written;
+    uint32_t budget_exhausted; // phases that ended with whole sectors still waiting
+    uint32_t queue_depth; // bytes buffered after the last phase
+    uint32_t max_queue_depth;
+    uint32_t bytes_dropped; // since boot, a logger's ResetStats doesn't clear it
+};
+
+// write buffered log data to the card, a batch from each logger in turn, until there is nothing
+// left to write or either budget is spent (checked between batches), returns the bytes written
+uint32_t ServiceSDLoggers(uint32_t max_bytes, uint32_t max_us);
+
+const SDWriteStats_t & GetSDWriteStats();
+
+// sync every logger that's logging, e.g. when a shutdown warning arrives, false if any sync failed
+bool SyncSDLoggers();
+
+struct SDLogStats_t {
+    uint32_t bytes_logged; // accepted into the buffer
+    uint32_t bytes_dropped; // rejected because the buffer was full or no file could be opened
+    uint32_t sectors_written;
+    uint32_t syncs;
+    uint32_t files_opened;
+    uint32_t write_errors;
+    uint32_t max_buffered; // high-water mark of the buffer
+};
+
+// Append-only logger that keeps a file open and buffers writes in a RAM ring buffer. Data
+// is written in whole 512 byte sectors at sector-aligned offsets into a pre-allocated,
+// contiguous file, so writes don't touch the FAT. Files are named <prefix>_<time>.dat and
+// rotated when full or after a set time, always between writes so that a write (e.g. a
+// record) is never split across two files. Every logger registers itself to be drained a
+// little at a time by ServiceSDLoggers, so writing a record never waits on the card.
+// Anything still buffered is lost on a reset, so Sync should be called whenever data must
+// reach the card (e.g. in MODE_SHUTDOWN).
+class StratoSDLogger {
+public:
+    virtual ~StratoSDLogger();
+
+    // start logging to a new file (created on the next flush), rotate_seconds of 0 rotates by size only
+    bool Open(const char * prefix, uint32_t file_size = SD_LOG_FILE_SIZE, uint32_t rotate_seconds = 0);
+
+    // all-or-nothing append to the buffer, dropped (and counted) if the buffer is full
+    bool Write(const void * data, uint32_t size) { return Write(NULL, 0, data, size); }
+
+    // append a header and data as one all-or-nothing record
+    bool Write(const void * header, uint32_t header_size, const void * data, uint32_t size);
+
+    // write up to max_bytes of whole sectors (at least one), opening or rotating the file if needed
+    bool FlushStep(uint32_t max_bytes, uint32_t * bytes_written);
+
+    // write all buffered whole sectors at once
+    bool Flush();
+
+    // write everything buffered (including a partial sector) and sync the file
+    bool Sync();
+
+    // sync, trim the unused pre-allocation, and close the file
+    void Close();
+
+    bool IsOpen() { return file_open; }
+    bool IsLogging() { return logging; }
+    const char * Prefix() { return prefix; }
+    uint32_t Buffered() { return buffered; }
+
+    const SDLogStats_t & GetStats() { return stats; }
+    void ResetStats();
+
+protected:
+    StratoSDLogger(uint8_t * buffer, uint32_t buffer_size);
+
+    // called from the SD phase as files are opened, synced, and about to be closed, numbered from 0 since Open;
+    // a file is closed with position bytes on the card, less than was logged to it after a write error
+    virtual void FileOpened(uint32_t number, const char * name) { (void) number; (void) name; }
+    virtual void FileSynced(uint32_t number, const char * name) { (void) number; (void) name; }
+    virtual void FileClosing(uint32_t number, const char * name, uint32_t position) { (void) number; (void) name; (void) position; }
+
+    // called from the SD phase after whole sectors are written, with the bytes of the file now on the card
+    virtual void FileWritten(uint32_t number, const char * name, uint32_t position) { (void) number; (void) name; (void) position; }
+
+    // where the last successful write will be in the files: its file number and byte offset
+    uint32_t LastWriteFile() { return assigned_file; }
+    uint32_t LastWriteOffset() { return last_write_offset; }
+
+private:
+    bool OpenNextFile();
+    uint32_t CloseFile();
+    void AbandonFile();
+    bool WriteFromBuffer(uint32_t size);
+    void CopyIn(const uint8_t * data, uint32_t size);
+    void Consume(uint32_t size);
+    void Drop(uint32_t size);
+
+    uint8_t * ring;
+    uint32_t capacity;
+    uint32_t head; // next byte written into the buffer
+    uint32_t tail; // next byte written to the card
+    uint32_t buffered;
+
+    File file;
+    bool file_open;
+    bool logging; // set by Open, cleared by Close
+    char prefix[SD_LOG_PREFIX_SIZE];
+    char filename[SD_LOG_NAME_SIZE];
+    uint32_t file_size;
+    uint32_t file_position; // always sector-aligned, a synced partial sector is rewritten when it fills
+    uint32_t file_number; // the file being written to the card
+    uint32_t rotate_seconds;
+
+    // new writes go to assigned_file, which is file_number or, once a boundary is set, the one after it
+    uint32_t assigned_file;
+    uint32_t assigned_bytes;
+    uint32_t assigned_start; // now() at the first write to the assigned file
+    bool boundary_pending;
+    uint32_t boundary_remaining; // buffered bytes that still belong to file_number
+    uint32_t last_write_offset;
+
+    SDLogStats_t stats;
+};
+
+// statically-allocated logger with a compile-time buffer size (a multiple of SD_SECTOR_SIZE)
+template <uint32_t BUFFER_SIZE>
+class StaticSDLogger : public StratoSDLogger {
+public:
+    StaticSDLogger() : StratoSDLogger(buffer_storage, BUFFER_SIZE) { }
+
+private:
+    uint8_t buffer_storage[BUFFER_SIZE];
+};
+
+#endif /* STRATOSD_H */
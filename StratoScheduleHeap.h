@@ -0,0 +1,238 @@
+/*
+ *  StratoScheduleHeap.h
+ *  Author:  StratoCore contributors
+ *  Created: October 2026
+ *
+ *  This file declares the item pool and binary min-heap shared by the
+ *  StratoScheduler and the StratoHighResScheduler, so that the two schedules
+ *  allocate, hand out, and order their actions the same way.
+ */
+
+#ifndef STRATOSCHEDULEHEAP_H
+#define STRATOSCHEDULEHEAP_H
+
+#include <stdint.h>
+
+// index value used to mark the end of the free list or an unqueued item
+#define NO_SCHEDULE_ITEM    ((uint16_t) 0xFFFF)
+
+// handle returned by AddAction to identify a scheduled action, evaluates to false if
+// invalid so that AddAction can still be checked like a bool (generation 0 is never used)
+struct ScheduleHandle_t {
+    ScheduleHandle_t() : index(NO_SCHEDULE_ITEM), generation(0) { }
+    ScheduleHandle_t(uint16_t item_index, uint16_t item_generation) : index(item_index), generation(item_generation) { }
+    operator bool() const { return generation != 0; }
+
+    uint16_t index;
+    uint16_t generation;
+};
+#define NO_SCHEDULE_HANDLE  ScheduleHandle_t()
+
+// orderings of scheduled times: plain for time_t, and wrap-safe for StratoMillis() values
+struct ScheduleTimeOrder {
+    template <typename TIME>
+    static bool Before(TIME a, TIME b) { return a < b; }
+};
+
+struct ScheduleMillisOrder {
+    static bool Before(uint32_t a, uint32_t b) { return (int32_t) (a - b) < 0; }
+};
+
+// Scheduled items with a free list threaded through their heap_index. Allocation and release
+// are O(1), and the generation of an item is incremented on release so that old handles are
+// rejected. ITEM must have heap_index, generation, and in_use members.
+template <typename ITEM>
+class SchedulePool {
+public:
+    // the storage belongs to the derived scheduler, don't touch it until it's used
+    void Init(ITEM * item_array, uint16_t max_size)
+    {
+        items = item_array;
+        capacity = max_size;
+        free_head = NO_SCHEDULE_ITEM;
+        items_used = 0;
+    }
+
+    uint16_t Allocate()
+    {
+        uint16_t index = NO_SCHEDULE_ITEM;
+
+        if (free_head != NO_SCHEDULE_ITEM) {
+            // reuse a released item
+            index = free_head;
+            free_head = items[index].heap_index;
+        } else if (items_used < capacity) {
+            // take a never-used item
+            index = items_used++;
+            items[index].generation = 1;
+        }
+
+        return index;
+    }
+
+    // invalidate outstanding handles (never 0) and push onto the free list
+    void Release(uint16_t index)
+    {
+        ITEM * item = &items[index];
+
+        item->generation++;
+        if (item->generation == 0) item->generation = 1;
+
+        item->in_use = false;
+        item->heap_index = free_head;
+        free_head = index;
+    }
+
+    // the item for a handle, or NO_SCHEDULE_ITEM if it already ran or was removed
+    uint16_t Find(ScheduleHandle_t handle)
+    {
+        if (handle.index >= items_used || !items[handle.index].in_use
+            || items[handle.index].generation != handle.generation) {
+            return NO_SCHEDULE_ITEM;
+        }
+
+        return handle.index;
+    }
+
+    ScheduleHandle_t Handle(uint16_t index) { return ScheduleHandle_t(index, items[index].generation); }
+
+    uint16_t Capacity() { return capacity; }
+
+private:
+    ITEM * items;
+    uint16_t capacity;
+    uint16_t free_head; // first item on the free list
+    uint16_t items_used; // items at or above this index have never been allocated
+};
+
+// A binary min-heap of item indices ordered by (time, sequence): earlier time first by ORDER,
+// then earlier insertion (wrap-safe) so that ties stay FIFO. Each item keeps its position in
+// heap_index, so any item can be removed or moved in O(log n). ITEM must have time, sequence,
+// heap_index, and action members.
+template <typename ITEM, typename ORDER>
+class ScheduleHeap {
+public:
+    // heap_array must hold one entry per item in the pool
+    void Init(ITEM * item_array, uint16_t * heap_array)
+    {
+        items = item_array;
+        heap = heap_array;
+        size = 0;
+    }
+
+    uint16_t Size() { return size; }
+    uint16_t Top() { return heap[0]; } // only valid if the heap isn't empty
+    uint16_t At(uint16_t position) { return heap[position]; }
+
+    bool ItemBefore(uint16_t a, uint16_t b)
+    {
+        if (items[a].time != items[b].time) return ORDER::Before(items[a].time, items[b].time);
+
+        return (int32_t) (items[a].sequence - items[b].sequence) < 0;
+    }
+
+    // place at the bottom of the heap and move it up into position
+    void Push(uint16_t index)
+    {
+        Place(size, index);
+        size++;
+        SiftUp(size - 1);
+    }
+
+    void Remove(uint16_t index)
+    {
+        uint16_t position = items[index].heap_index;
+
+        // move the last item into the hole and restore the heap in whichever direction it needs
+        size--;
+        if (position < size) {
+            Place(position, heap[size]);
+            Update(heap[position]);
+        }
+    }
+
+    // restore the heap after an item's time or sequence has changed
+    void Update(uint16_t index)
+    {
+        uint16_t position = items[index].heap_index;
+
+        if (position > 0 && ItemBefore(index, heap[(position - 1) / 2])) {
+            SiftUp(position);
+        } else {
+            SiftDown(position);
+        }
+    }
+
+    // remove every item for an action, releasing it to the pool, then rebuild the heap bottom-up (O(n))
+    uint16_t RemoveAction(uint8_t action, SchedulePool<ITEM> & pool)
+    {
+        uint16_t num_kept = 0;
+        uint16_t num_removed = 0;
+
+        for (uint16_t i = 0; i < size; i++) {
+            uint16_t index = heap[i];
+            if (items[index].action == action) {
+                pool.Release(index);
+                num_removed++;
+            } else {
+                Place(num_kept++, index);
+            }
+        }
+
+        size = num_kept;
+        for (uint16_t i = size / 2; i > 0; i--) {
+            SiftDown(i - 1);
+        }
+
+        return num_removed;
+    }
+
+    // empty the heap, the items must be released separately
+    void Clear() { size = 0; }
+
+private:
+    void Place(uint16_t position, uint16_t index)
+    {
+        heap[position] = index;
+        items[index].heap_index = position;
+    }
+
+    void SiftUp(uint16_t position)
+    {
+        uint16_t index = heap[position];
+
+        while (position > 0) {
+            uint16_t parent = (position - 1) / 2;
+            if (!ItemBefore(index, heap[parent])) break;
+            Place(position, heap[parent]);
+            position = parent;
+        }
+
+        Place(position, index);
+    }
+
+    void SiftDown(uint16_t position)
+    {
+        uint16_t index = heap[position];
+
+        while (true) {
+            uint32_t child = 2 * (uint32_t) position + 1;
+            if (child >= size) break;
+
+            // pick the earlier of the two children
+            if (child + 1 < size && ItemBefore(heap[child + 1], heap[child])) child++;
+
+            if (!ItemBefore(heap[child], index)) break;
+            Place(position, heap[child]);
+            position = (uint16_t) child;
+        }
+
+        Place(position, index);
+    }
+
+    ITEM * items;
+    uint16_t * heap; // heap[0] is the next action in this heap
+    uint16_t size;
+};
+
+#endif /* STRATOSCHEDULEHEAP_H */
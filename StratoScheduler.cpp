@@ -10,171 +10,307 @@
 #include "StratoScheduler.h"
 #include "StratoGroundPort.h"
 
-StratoScheduler::StratoScheduler()
+StratoScheduler::StratoScheduler(ScheduleItem_t * items, uint16_t * heap_array, uint16_t max_size)
 {
+    // the storage belongs to the derived class, don't touch it until it's used
+    item_array = items;
+    pool.Init(items, max_size);
+    heaps[0].Init(items, heap_array);
+    heaps[1].Init(items, heap_array + max_size);
+
+    relative_offset = 0;
+
     schedule_size = 0;
-    schedule_top = NULL;
+    next_sequence = 0;
+
+    for (uint16_t i = 0; i < 256; i++) {
+        action_head[i] = NO_SCHEDULE_ITEM;
+    }
 }
 
 uint8_t StratoScheduler::CheckSchedule()
 {
     uint8_t action = NO_SCHEDULED_ACTION;
 
-    // if it's time for the top action, set it and remove it from the queue
-    if (schedule_size > 0 && schedule_top->time <= now()) {
-        action = schedule_top->action;
-        SchedulePop();
+    time_t current_time = StratoNow();
+    uint16_t index = NextItem();
+
+    // if it's time for the next action, set it and remove it from the queue (or re-arm it if periodic)
+    if (index != NO_SCHEDULE_ITEM && ItemTime(index) <= current_time) {
+        ScheduleItem_t * item = &item_array[index];
+        action = item->action;
+
+        if (item->period == 0 || item->runs_remaining == 1) {
+            ScheduleRemove(index);
+        } else {
+            ScheduleRearm(index, current_time);
+        }
     }
 
     return action;
 }
 
-bool StratoScheduler::AddAction(uint8_t action, time_t seconds_from_now)
+ScheduleHandle_t StratoScheduler::AddAction(uint8_t action, time_t seconds_from_now)
 {
     // enforce a software size limit to avoid accidentally filling memory
-    if (schedule_size >= MAX_SCHEDULE_SIZE) {
+    if (schedule_size >= pool.Capacity()) {
         log_error("Schedule queue full");
-        return false;
+        return NO_SCHEDULE_HANDLE;
     }
 
     // calculate the time_t value given the current time, place on the queue
-    return SchedulePush(action, now() + seconds_from_now, false);
+    return SchedulePush(action, StratoNow() + seconds_from_now, false);
 }
 
-bool StratoScheduler::AddAction(uint8_t action, TimeElements exact_time)
+ScheduleHandle_t StratoScheduler::AddAction(uint8_t action, TimeElements exact_time)
 {
     // enforce a software size limit to avoid accidentally filling memory
-    if (schedule_size >= MAX_SCHEDULE_SIZE) {
+    if (schedule_size >= pool.Capacity()) {
         log_error("Schedule queue full");
-        return false;
+        return NO_SCHEDULE_HANDLE;
     }
 
     // place on the queue
     return SchedulePush(action, makeTime(exact_time), true);
 }
 
-void StratoScheduler::ClearSchedule()
+ScheduleHandle_t StratoScheduler::AddPeriodicAction(uint8_t action, uint32_t period, time_t seconds_from_now, uint16_t count)
 {
-    while (schedule_size > 0) {
-        SchedulePop();
+    if (period == 0) return NO_SCHEDULE_HANDLE;
+
+    // enforce a software size limit to avoid accidentally filling memory
+    if (schedule_size >= pool.Capacity()) {
+        log_error("Schedule queue full");
+        return NO_SCHEDULE_HANDLE;
     }
+
+    return SchedulePush(action, StratoNow() + seconds_from_now, false, period, count);
 }
 
-void StratoScheduler::PrintSchedule()
+ScheduleHandle_t StratoScheduler::AddPeriodicAction(uint8_t action, uint32_t period, TimeElements exact_time, uint16_t count)
 {
-    ScheduleItem_t * itr = schedule_top;
+    if (period == 0) return NO_SCHEDULE_HANDLE;
 
-    // adjust each item
-    while (itr != NULL) {
-        debug_serial->print(itr->action);
-        debug_serial->print(",");
-        debug_serial->println(itr->time);
-        itr = itr->next;
+    // enforce a software size limit to avoid accidentally filling memory
+    if (schedule_size >= pool.Capacity()) {
+        log_error("Schedule queue full");
+        return NO_SCHEDULE_HANDLE;
     }
+
+    return SchedulePush(action, makeTime(exact_time), true, period, count);
 }
 
-void StratoScheduler::UpdateScheduleTime(int32_t seconds_adjustment)
+bool StratoScheduler::CancelAction(ScheduleHandle_t handle)
+{
+    uint16_t index = pool.Find(handle);
+
+    if (index == NO_SCHEDULE_ITEM) return false;
+
+    ScheduleRemove(index);
+
+    return true;
+}
+
+uint16_t StratoScheduler::CancelAction(uint8_t action)
 {
-    ScheduleItem_t * itr = schedule_top;
+    uint16_t num_removed = 0;
 
-    // adjust each item
-    while (itr != NULL) {
-        // adjust only if scheduled relatively
-        if (!itr->exact_time) {
-            itr->time += seconds_adjustment;
+    // removing an item unlinks it, so keep taking the head of the list
+    while (action_head[action] != NO_SCHEDULE_ITEM) {
+        ScheduleRemove(action_head[action]);
+        num_removed++;
+    }
+
+    return num_removed;
+}
+
+bool StratoScheduler::Reschedule(ScheduleHandle_t handle, time_t seconds_from_now)
+{
+    return RescheduleItem(handle, StratoNow() + seconds_from_now, false);
+}
+
+bool StratoScheduler::Reschedule(ScheduleHandle_t handle, TimeElements exact_time)
+{
+    return RescheduleItem(handle, makeTime(exact_time), true);
+}
+
+bool StratoScheduler::IsPending(ScheduleHandle_t handle)
+{
+    return pool.Find(handle) != NO_SCHEDULE_ITEM;
+}
+
+bool StratoScheduler::TimeUntilNext(time_t * seconds)
+{
+    uint16_t index = NextItem();
+
+    if (index == NO_SCHEDULE_ITEM || NULL == seconds) return false;
+
+    time_t current_time = StratoNow();
+    time_t next_time = ItemTime(index);
+
+    *seconds = (next_time > current_time) ? next_time - current_time : 0;
+
+    return true;
+}
+
+void StratoScheduler::ClearSchedule()
+{
+    // release every queued item (the heaps are emptied afterwards, so order doesn't matter)
+    for (uint8_t h = 0; h < 2; h++) {
+        for (uint16_t i = 0; i < heaps[h].Size(); i++) {
+            ReleaseItem(heaps[h].At(i));
         }
-        itr = itr->next;
+        heaps[h].Clear();
     }
+
+    schedule_size = 0;
+
+    // nothing is stored against the relative base anymore
+    relative_offset = 0;
+}
+
+void StratoScheduler::PrintSchedule()
+{
+    // print each item in heap order (only the first of each heap is guaranteed to be its next action)
+    for (uint8_t h = 0; h < 2; h++) {
+        for (uint16_t i = 0; i < heaps[h].Size(); i++) {
+            debug_serial->print(item_array[heaps[h].At(i)].action);
+            debug_serial->print(",");
+            debug_serial->print(ItemTime(heaps[h].At(i)));
+            debug_serial->println(h ? ",exact" : ",relative");
+        }
+    }
+}
+
+void StratoScheduler::UpdateScheduleTime(int32_t seconds_adjustment)
+{
+    // every relative item moves together, so only the base changes
+    relative_offset += seconds_adjustment;
 }
 
 // ------- schedule queue functions -------
-ScheduleItem_t * StratoScheduler::GetFreeItem()
+// unlink from the action list and push onto the free list
+void StratoScheduler::ReleaseItem(uint16_t index)
 {
-    // if we know the schedule is full, return NULL
-    if (schedule_size == MAX_SCHEDULE_SIZE) return NULL;
+    ScheduleItem_t * item = &item_array[index];
 
-    // iterate through and find a free item
-    int i = 0;
-    for (i = 0; i < MAX_SCHEDULE_SIZE; i++) {
-        if (!item_array[i].in_use) break; // found a free one
+    if (item->action_prev != NO_SCHEDULE_ITEM) {
+        item_array[item->action_prev].action_next = item->action_next;
+    } else {
+        action_head[item->action] = item->action_next;
     }
 
-    // make sure there wasn't some unexpected error
-    if (item_array[i].in_use) {
-        return NULL;
-    } else {
-        return &(item_array[i]);
+    if (item->action_next != NO_SCHEDULE_ITEM) {
+        item_array[item->action_next].action_prev = item->action_prev;
+    }
+
+    pool.Release(index);
+}
+
+uint16_t StratoScheduler::NextItem()
+{
+    if (heaps[0].Size() == 0) return (heaps[1].Size() == 0) ? NO_SCHEDULE_ITEM : heaps[1].Top();
+    if (heaps[1].Size() == 0) return heaps[0].Top();
+
+    uint16_t relative = heaps[0].Top();
+    uint16_t exact = heaps[1].Top();
+    time_t relative_time = ItemTime(relative);
+    time_t exact_time = ItemTime(exact);
+
+    if (relative_time != exact_time) {
+        return (relative_time < exact_time) ? relative : exact;
     }
+
+    // ties stay FIFO across the heaps too
+    return ((int32_t) (item_array[relative].sequence - item_array[exact].sequence) < 0) ? relative : exact;
+}
+
+time_t StratoScheduler::ItemTime(uint16_t index)
+{
+    if (item_array[index].exact_time) return item_array[index].time;
+
+    return item_array[index].time + relative_offset;
 }
 
-bool StratoScheduler::SchedulePush(uint8_t action, time_t schedule_time, bool exact)
+ScheduleHandle_t StratoScheduler::SchedulePush(uint8_t action, time_t schedule_time, bool exact, uint32_t period, uint16_t count)
 {
-    if (schedule_size >= MAX_SCHEDULE_SIZE) return false;
+    if (schedule_size >= pool.Capacity()) return NO_SCHEDULE_HANDLE;
 
     // create the new action
-    ScheduleItem_t * new_item = GetFreeItem();
+    uint16_t index = pool.Allocate();
 
     // check that it's good
-    if (new_item == NULL) return false;
+    if (index == NO_SCHEDULE_ITEM) return NO_SCHEDULE_HANDLE;
 
     // set the values for the new item
+    ScheduleItem_t * new_item = &item_array[index];
     new_item->action = action;
     new_item->exact_time = exact;
-    new_item->time = schedule_time;
-    new_item->next = NULL;
-    new_item->prev = NULL;
+    new_item->period = period;
+    new_item->runs_remaining = count;
     new_item->in_use = true;
 
+    // link at the front of the list for this action
+    new_item->action_prev = NO_SCHEDULE_ITEM;
+    new_item->action_next = action_head[action];
+    if (action_head[action] != NO_SCHEDULE_ITEM) {
+        item_array[action_head[action]].action_prev = index;
+    }
+    action_head[action] = index;
+
+    HeapInsert(index, schedule_time);
     schedule_size++;
 
-    // if empty, create in place
-    if (schedule_top == NULL) {
-        schedule_top = new_item;
-        return true;
-    }
+    return pool.Handle(index);
+}
 
-    // create an iterator for moving through the queue, starting with the first element
-    ScheduleItem_t * cur = schedule_top;
+// re-arm a periodic item in place (it keeps its handle) at its next slot after the current time
+void StratoScheduler::ScheduleRearm(uint16_t index, time_t current_time)
+{
+    ScheduleItem_t * item = &item_array[index];
 
-    // move through the queue until either the end is reach, or the insertion spot is found
-    while (new_item->time > cur->time && cur->next != NULL) {
-        cur = cur->next;
-    }
+    // phase-locked: step from the scheduled time, skipping any slots that were missed
+    uint32_t missed = (uint32_t) ((current_time - ItemTime(index)) / (time_t) item->period);
+    item->time += (time_t) (missed + 1) * (time_t) item->period;
 
-    // place
-    if (new_item->time <= cur->time) {
-        if (cur->prev == NULL) {
-            schedule_top = new_item;
-            cur->prev = new_item;
-            new_item->next = cur;
-        } else {
-            new_item->prev = cur->prev;
-            cur->prev->next = new_item;
-            cur->prev = new_item;
-            new_item->next = cur;
-        }
-    } else {
-        cur->next = new_item;
-        new_item->prev = cur;
-    }
+    if (item->runs_remaining > 1) item->runs_remaining--;
 
-    return true;
+    // treat it as newly added for the purposes of tie ordering, it can only move later
+    item->sequence = next_sequence++;
+    ItemHeap(index)->Update(index);
 }
 
-// remove and delete the first item
-void StratoScheduler::SchedulePop()
+// remove and free an item from anywhere in the schedule
+void StratoScheduler::ScheduleRemove(uint16_t index)
 {
-    if (schedule_size == 0) return;
+    ItemHeap(index)->Remove(index);
+    schedule_size--;
 
-    ScheduleItem_t * tmp = schedule_top;
+    ReleaseItem(index);
+}
 
-    schedule_top = tmp->next;
+bool StratoScheduler::RescheduleItem(ScheduleHandle_t handle, time_t schedule_time, bool exact)
+{
+    uint16_t index = pool.Find(handle);
 
-    if (NULL != schedule_top) schedule_top->prev = NULL;
+    if (index == NO_SCHEDULE_ITEM) return false;
 
-    tmp->in_use = false;
-    tmp->prev = NULL;
-    tmp->next = NULL;
+    // the item may be changing heaps, so take it out and put it back in
+    ItemHeap(index)->Remove(index);
+    item_array[index].exact_time = exact;
+    HeapInsert(index, schedule_time);
 
-    schedule_size--;
-}
\ No newline at end of file
+    return true;
+}
+
+// ------- heap functions -------
+// place an item in its heap given its scheduled time in the current time base
+void StratoScheduler::HeapInsert(uint16_t index, time_t schedule_time)
+{
+    ScheduleItem_t * item = &item_array[index];
+
+    item->time = item->exact_time ? schedule_time : schedule_time - relative_offset;
+    item->sequence = next_sequence++;
+
+    ItemHeap(index)->Push(index);
+}
@@ -10,37 +10,84 @@
 #ifndef STRATOSCHEDULER_H
 #define STRATOSCHEDULER_H
 
+#include "StratoClock.h"
+#include "StratoScheduleHeap.h"
 #include <TimeLib.h>
 #include <stdint.h>
 
 #define NO_SCHEDULED_ACTION 0
-#define MAX_SCHEDULE_SIZE   ((uint8_t) 32) // must be 0-255
+
+// default capacity of the StratoCore schedule, can be overridden at compile time
+#ifndef MAX_SCHEDULE_SIZE
+#define MAX_SCHEDULE_SIZE   ((uint16_t) 256) // must be 1-65534
+#endif
 
 // define a struct for use only as a container for scheduled actions
 struct ScheduleItem_t {
-    // data
-    ScheduleItem_t * prev;
-    ScheduleItem_t * next;
-    time_t time;
+    time_t time; // exact time, or for relative items, time in the relative base (see below)
+    uint32_t sequence; // insertion order, keeps ties FIFO
+    uint32_t period; // seconds between runs of a periodic action, 0 for a one-time action
+    uint16_t runs_remaining; // for periodic actions, 0 runs forever
+    uint16_t heap_index; // position in its heap, or next free item if not in use
+    uint16_t generation; // incremented on release so that old handles are rejected
+    uint16_t action_prev; // list of queued items with the same action
+    uint16_t action_next;
     uint8_t action;
     bool exact_time; // scheduled exact or relative?
     bool in_use;
 };
 
+typedef ScheduleHeap<ScheduleItem_t, ScheduleTimeOrder> ScheduleHeap_t;
+
+// The schedule is kept in two binary min-heaps, one for actions scheduled at exact times and
+// one for actions scheduled relatively, sharing a pool of items with a free list (see
+// StratoScheduleHeap.h). Push and pop are O(log n), allocation is O(1). Queued items are also linked per action ID so that they
+// can be cancelled without a search.
+//
+// Relative items are stored against their own time base: the scheduled time is the stored
+// time plus relative_offset. A time correction only changes the offset, so it is O(1) and
+// can never reorder either heap; the next action is the earlier of the two heap tops.
+//
+// The storage is provided by a derived class so that the capacity is a compile-time
+// parameter (see StaticScheduler below) without duplicating the implementation.
 class StratoScheduler {
 public:
-    // empty constructors and destructors
-    StratoScheduler();
     ~StratoScheduler() { };
 
     // returns 0 if no action ready, or the id if one is ready
     uint8_t CheckSchedule();
 
-    // overloaded method for scheduling actions, returns based on schedule push success
-    bool AddAction(uint8_t action, time_t seconds_from_now);
-    bool AddAction(uint8_t action, TimeElements exact_time);
+    // overloaded method for scheduling actions, returns a handle to the action or
+    // NO_SCHEDULE_HANDLE (false) if the push failed
+    ScheduleHandle_t AddAction(uint8_t action, time_t seconds_from_now);
+    ScheduleHandle_t AddAction(uint8_t action, TimeElements exact_time);
+
+    // overloaded method for scheduling periodic actions: the first run is at the given time, and
+    // each following run is one period after the previous scheduled time (not the time it ran),
+    // so the action stays phase-locked without drift. If runs are missed (e.g. after a time
+    // correction), the action runs once and then skips ahead to its next future slot. A count
+    // of 0 runs until cancelled. Periodic actions scheduled relatively are adjusted with time
+    // corrections, those scheduled at an exact time stay locked to absolute time.
+    ScheduleHandle_t AddPeriodicAction(uint8_t action, uint32_t period, time_t seconds_from_now, uint16_t count = 0);
+    ScheduleHandle_t AddPeriodicAction(uint8_t action, uint32_t period, TimeElements exact_time, uint16_t count = 0);
+
+    // remove a single pending action by handle, returns false if it already ran or was removed
+    bool CancelAction(ScheduleHandle_t handle);
 
-    // changes the scheduled times according to a number of seconds to adjust
+    // remove every pending instance of an action ID, returns the number removed
+    uint16_t CancelAction(uint8_t action);
+
+    // move a pending action to a new time, it keeps its handle
+    bool Reschedule(ScheduleHandle_t handle, time_t seconds_from_now);
+    bool Reschedule(ScheduleHandle_t handle, TimeElements exact_time);
+
+    // true if the action for this handle is still waiting to run
+    bool IsPending(ScheduleHandle_t handle);
+
+    // seconds until the next action is due (0 if overdue), false if nothing is scheduled
+    bool TimeUntilNext(time_t * seconds);
+
+    // shifts relatively-scheduled actions by a number of seconds to adjust (O(1))
     void UpdateScheduleTime(int32_t seconds_adjustment);
 
     // called after every mode switch
@@ -48,15 +95,49 @@ public:
 
     void PrintSchedule();
 
+    uint16_t ScheduleSize() { return schedule_size; }
+    uint16_t ScheduleCapacity() { return pool.Capacity(); }
+
+protected:
+    // heap_array must hold 2 * max_size entries
+    StratoScheduler(ScheduleItem_t * items, uint16_t * heap_array, uint16_t max_size);
+
 private:
-    ScheduleItem_t * GetFreeItem();
-    bool SchedulePush(uint8_t action, time_t schedule_time, bool exact);
-    void SchedulePop(); // remove (and delete!) the first item
+    ScheduleHandle_t SchedulePush(uint8_t action, time_t schedule_time, bool exact, uint32_t period = 0, uint16_t count = 0);
+    void ScheduleRearm(uint16_t index, time_t current_time); // move a periodic item to its next run
+    void ScheduleRemove(uint16_t index); // remove (and free!) an item
+    bool RescheduleItem(ScheduleHandle_t handle, time_t schedule_time, bool exact);
+    void ReleaseItem(uint16_t index);
+    uint16_t NextItem(); // earliest item across both heaps
+    time_t ItemTime(uint16_t index); // scheduled time in the current time base
+
+    // heap helpers
+    ScheduleHeap_t * ItemHeap(uint16_t index) { return &heaps[item_array[index].exact_time ? 1 : 0]; }
+    void HeapInsert(uint16_t index, time_t schedule_time);
+
+    ScheduleItem_t * item_array;
+    SchedulePool<ScheduleItem_t> pool;
+    ScheduleHeap_t heaps[2]; // [0]: relative items, [1]: exact items
 
-    ScheduleItem_t item_array[MAX_SCHEDULE_SIZE] = {{0}};
+    // added to the stored time of relative items to get their scheduled time
+    time_t relative_offset;
 
-    uint8_t schedule_size; // num items in schedule
-    ScheduleItem_t * schedule_top; // pointer to first element
+    uint16_t schedule_size; // num items in schedule
+    uint32_t next_sequence;
+
+    // first queued item for each action ID
+    uint16_t action_head[256];
+};
+
+// statically-allocated scheduler with a compile-time capacity
+template <uint16_t MAX_SIZE>
+class StaticScheduler : public StratoScheduler {
+public:
+    StaticScheduler() : StratoScheduler(items, heap_storage, MAX_SIZE) { }
+
+private:
+    ScheduleItem_t items[MAX_SIZE];
+    uint16_t heap_storage[2 * MAX_SIZE];
 };
 
 #endif
@@ -0,0 +1,103 @@
+/*
+ *  StratoTCDispatch.cpp
+ *  Author:  StratoCore contributors
+ *  Created: October 2026
+ *
+ *  This file implements a table mapping telecommand numbers to registered
+ *  handlers
+ */
+
+#include "StratoTCDispatch.h"
+#include <stddef.h>
+#include <string.h>
+
+StratoTCDispatch::StratoTCDispatch()
+{
+    num_entries = 0;
+    untracked = 0;
+
+    memset(index, 0, sizeof(index));
+}
+
+bool StratoTCDispatch::Register(uint16_t telecommand, TCMethod_t handler, const char * params)
+{
+    uint8_t entry = NO_TC_ENTRY;
+
+    if (NULL == handler || NULL == params || strlen(params) > MAX_TC_PARAMS) return false;
+    if (strspn(params, "ufs") != strlen(params)) return false;
+
+    // a stats-only entry can still be claimed by a handler
+    entry = Track(telecommand);
+    if (NO_TC_ENTRY == entry || NULL != entries[entry].handler) return false;
+
+    entries[entry].handler = handler;
+    entries[entry].params = params;
+
+    return true;
+}
+
+uint8_t StratoTCDispatch::Find(uint16_t telecommand)
+{
+    if (telecommand >= TC_DISPATCH_MAX_TC || 0 == index[telecommand]) return NO_TC_ENTRY;
+
+    return index[telecommand] - 1;
+}
+
+uint8_t StratoTCDispatch::Track(uint16_t telecommand)
+{
+    uint8_t entry = Find(telecommand);
+
+    if (NO_TC_ENTRY != entry) return entry;
+
+    return Add(telecommand);
+}
+
+uint8_t StratoTCDispatch::Add(uint16_t telecommand)
+{
+    TCEntry_t * entry = NULL;
+
+    if (telecommand >= TC_DISPATCH_MAX_TC || num_entries >= TC_DISPATCH_SIZE) return NO_TC_ENTRY;
+
+    entry = &entries[num_entries];
+    entry->handler = NULL;
+    entry->params = "";
+    entry->stats = {telecommand, 0, 0, 0, 0};
+
+    index[telecommand] = ++num_entries;
+
+    return num_entries - 1;
+}
+
+bool StratoTCDispatch::ParseArgs(uint8_t entry, StratoTCQueue & queue, TCArg_t * args)
+{
+    const char * params = entries[entry].params;
+    bool valid = true;
+
+    for (uint8_t i = 0; valid && '\0' != params[i]; i++) {
+        switch (params[i]) {
+        case 'u':
+            valid = queue.GetTCParam(i, &args[i].u);
+            break;
+        case 'f':
+            valid = queue.GetTCParam(i, &args[i].f);
+            break;
+        default:
+            args[i].s = queue.GetTCParam(i);
+            valid = (NULL != args[i].s);
+            break;
+        }
+    }
+
+    if (!valid) entries[entry].stats.param_errors++;
+
+    return valid;
+}
+
+void StratoTCDispatch::Record(uint8_t entry, uint32_t elapsed_us)
+{
+    TCStats_t * stats = &entries[entry].stats;
+
+    stats->count++;
+    stats->total_us += elapsed_us;
+    if (elapsed_us > stats->max_us) stats->max_us = elapsed_us;
+}
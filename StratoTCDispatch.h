@@ -0,0 +1,98 @@
+/*
+ *  StratoTCDispatch.h
+ *  Author:  StratoCore contributors
+ *  Created: October 2026
+ *
+ *  This file declares a table mapping telecommand numbers to registered
+ *  handlers, with constant-time lookup and per-TC count and timing stats
+ */
+
+#ifndef STRATOTCDISPATCH_H
+#define STRATOTCDISPATCH_H
+
+#include "StratoTCQueue.h"
+#include <stdint.h>
+
+// TC numbers below this can be registered, each costs one byte of index (others always go to TCHandler)
+#ifndef TC_DISPATCH_MAX_TC
+#define TC_DISPATCH_MAX_TC  512
+#endif
+
+// entries for registered TCs and for TCs only counted on their way to TCHandler, must be under 255
+#ifndef TC_DISPATCH_SIZE
+#define TC_DISPATCH_SIZE    48
+#endif
+
+#define NO_TC_ENTRY         ((uint8_t) 0xFF)
+
+class StratoCore;
+
+// a TC parameter, parsed as given by the registration's format string
+union TCArg_t {
+    uint32_t u; // 'u'
+    float f; // 'f'
+    const char * s; // 's', valid until the next TC
+};
+
+// registered handlers are StratoCore or instrument methods, see StratoCore::RegisterTC
+typedef void (StratoCore::*TCMethod_t)(const TCArg_t * args);
+
+struct TCStats_t {
+    uint16_t telecommand;
+    uint32_t count; // run, including TCHandler TCs
+    uint32_t param_errors; // not run, the parameters didn't match the format
+    uint32_t max_us;
+    uint64_t total_us; // mean = total_us / count
+};
+
+// Entries are added in registration order and never removed. A TC without a registered handler
+// gets a stats-only entry the first time it runs, while there is room.
+class StratoTCDispatch {
+public:
+    StratoTCDispatch();
+    ~StratoTCDispatch() { };
+
+    // params is a format of up to MAX_TC_PARAMS characters ('u', 'f' or 's'), one per required parameter;
+    // false if the TC is already registered or out of range, the format is invalid, or the table is full
+    bool Register(uint16_t telecommand, TCMethod_t handler, const char * params);
+
+    // entry for the TC, or NO_TC_ENTRY
+    uint8_t Find(uint16_t telecommand);
+
+    // entry for the TC, adding a stats-only entry if needed, or NO_TC_ENTRY if there's no room
+    uint8_t Track(uint16_t telecommand);
+
+    // NULL for a stats-only entry
+    TCMethod_t Handler(uint8_t entry) { return entries[entry].handler; }
+
+    // fills args from the queue's current TC, false (and counted) if they don't match the format
+    bool ParseArgs(uint8_t entry, StratoTCQueue & queue, TCArg_t * args);
+
+    void Record(uint8_t entry, uint32_t elapsed_us);
+
+    uint8_t NumEntries() { return num_entries; }
+    const TCStats_t & GetStats(uint8_t entry) { return entries[entry].stats; }
+
+    // TCs run that had no entry and no room for one
+    uint32_t Untracked() { return untracked; }
+    void CountUntracked() { untracked++; }
+
+private:
+    struct TCEntry_t {
+        TCMethod_t handler;
+        const char * params;
+        TCStats_t stats;
+    };
+
+    uint8_t Add(uint16_t telecommand);
+
+    TCEntry_t entries[TC_DISPATCH_SIZE];
+    uint8_t num_entries;
+
+    // entry index + 1 for each TC number, 0 if none
+    uint8_t index[TC_DISPATCH_MAX_TC];
+
+    uint32_t untracked;
+};
+
+#endif /* STRATOTCDISPATCH_H */
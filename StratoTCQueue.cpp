@@ -0,0 +1,143 @@
+/*
+ *  StratoTCQueue.cpp
+ *  Author:  StratoCore contributors
+ *  Created: October 2026
+ *
+ *  This file implements a bounded queue of received telecommands
+ */
+
+#include "StratoTCQueue.h"
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+StratoTCQueue::StratoTCQueue()
+{
+    enabled = false;
+
+    head = 0;
+    used = 0;
+    count = 0;
+
+    tc_text[0] = '\0';
+    num_tc_params = 0;
+    tc_number = 0;
+
+    max_per_loop = TC_PER_LOOP;
+    max_us = TC_US_PER_LOOP;
+
+    stats = {0, 0, 0, 0, 0, 0};
+}
+
+bool StratoTCQueue::PushBatch(const char * tcs, uint16_t length, uint8_t batch_count)
+{
+    if (NULL == tcs || 0 == batch_count) return false;
+
+    if (length > TC_QUEUE_SIZE - used) {
+        stats.batches_rejected++;
+        return false;
+    }
+
+    for (uint16_t i = 0; i < length; i++) {
+        ring[(head + used + i) % TC_QUEUE_SIZE] = tcs[i];
+    }
+
+    used += length;
+    count += batch_count;
+
+    stats.batches_queued++;
+    stats.tcs_queued += batch_count;
+    if (count > stats.max_queued) stats.max_queued = count;
+
+    return true;
+}
+
+bool StratoTCQueue::Pop()
+{
+    uint16_t length = 0;
+
+    if (0 == count) return false;
+
+    // the TC is removed even if it's too long, so a bad entry can't block the queue (StratoCore doesn't queue them)
+    while (used > 0) {
+        char c = ring[head];
+        head = (head + 1) % TC_QUEUE_SIZE;
+        used--;
+
+        if (';' == c) break;
+        if (length + 1 < TC_TEXT_SIZE) tc_text[length++] = c;
+    }
+
+    tc_text[length] = '\0';
+    count--;
+
+    SplitCurrent();
+
+    return true;
+}
+
+void StratoTCQueue::SetCurrent(const char * tc)
+{
+    if (NULL == tc) tc = "";
+
+    strncpy(tc_text, tc, TC_TEXT_SIZE - 1);
+    tc_text[TC_TEXT_SIZE - 1] = '\0';
+
+    SplitCurrent();
+}
+
+// "<tc>[,<param>...]", split at the commas
+void StratoTCQueue::SplitCurrent()
+{
+    char * itr = tc_text;
+
+    tc_number = (uint16_t) strtoul(tc_text, NULL, 10);
+    num_tc_params = 0;
+
+    while (NULL != (itr = strchr(itr, ','))) {
+        *itr++ = '\0';
+        if (num_tc_params < MAX_TC_PARAMS) tc_params[num_tc_params++] = itr;
+    }
+}
+
+bool StratoTCQueue::GetTCParam(uint8_t index, uint32_t * value)
+{
+    char * end;
+
+    if (index >= num_tc_params || NULL == value) return false;
+
+    *value = (uint32_t) strtoul(tc_params[index], &end, 10);
+
+    return (end != tc_params[index] && '\0' == *end);
+}
+
+bool StratoTCQueue::GetTCParam(uint8_t index, float * value)
+{
+    char * end;
+
+    if (index >= num_tc_params || NULL == value) return false;
+
+    *value = strtof(tc_params[index], &end);
+
+    return (end != tc_params[index] && '\0' == *end);
+}
+
+const char * StratoTCQueue::GetTCParam(uint8_t index)
+{
+    if (index >= num_tc_params) return NULL;
+
+    return tc_params[index];
+}
+
+void StratoTCQueue::Clear()
+{
+    head = 0;
+    used = 0;
+    count = 0;
+}
+
+void StratoTCQueue::SetPolicy(uint8_t max_tcs, uint32_t max_micros)
+{
+    max_per_loop = max_tcs;
+    max_us = max_micros;
+}
@@ -0,0 +1,113 @@
+/*
+ *  StratoTCQueue.h
+ *  Author:  StratoCore contributors
+ *  Created: October 2026
+ *
+ *  This file declares a bounded queue of received telecommands, so that a
+ *  TC message arriving before the last batch has run doesn't replace it
+ *
+ *  The TC text and parameters are taken from XMLReader's zephyr_tc,
+ *  num_tc_params and GetTCParam(), as declared by the host stand-in in
+ *  host/stubs/XMLReader_v5.h, which is the reader API this file relies on.
+ */
+
+#ifndef STRATOTCQUEUE_H
+#define STRATOTCQUEUE_H
+
+#include "XMLReader_v5.h"
+#include <stdint.h>
+
+// RAM for queued telecommands, held as text ("<tc>[,<param>...];" each)
+#ifndef TC_QUEUE_SIZE
+#define TC_QUEUE_SIZE   1024
+#endif
+
+// longest single TC (its number and parameters as text) that can be queued
+#ifndef TC_TEXT_SIZE
+#define TC_TEXT_SIZE    256
+#endif
+
+// default per-loop execution limits, at least one TC is run each loop that any are queued
+#define TC_PER_LOOP     8
+#define TC_US_PER_LOOP  100000
+
+struct TCQueueStats_t {
+    uint32_t batches_queued;
+    uint32_t batches_rejected; // didn't fit in the queue or the batch buffer, NAKed
+    uint32_t tcs_queued;
+    uint32_t tcs_run;
+    uint32_t loops_limited; // loops that ended with TCs still queued because of the limits
+    uint16_t max_queued; // TCs
+};
+
+// The queue is off unless an instrument enables it. Off, each TC message's TCs run straight from
+// XMLReader as they're parsed, as StratoCore always did, so TCHandler can read their parameters from
+// zephyrRX; a TC message that arrives before the last one's TCs have all run replaces them. On,
+// received TC batches are queued whole or not at all, and run in order across loops within the
+// per-loop limits (see StratoCore::RunTelecommands), and since by then the reader may already hold a
+// later message, TCHandler must read the parameters of the current TC from the queue. Either way,
+// the TC being run is the current TC, whose parameters are read the same way as from XMLReader.
+class StratoTCQueue {
+public:
+    StratoTCQueue();
+    ~StratoTCQueue() { };
+
+    // queue a batch of count TCs (text, each ending with ';'), false if it doesn't fit
+    bool PushBatch(const char * tcs, uint16_t length, uint8_t count);
+
+    // queue received TCs rather than running them from XMLReader (see above)
+    void Enable(bool enable) { enabled = enable; }
+    bool Enabled() { return enabled; }
+
+    // remove the next TC and make it the current TC, false if none are queued
+    bool Pop();
+
+    // make a TC (text, without the ';') the current TC without queuing it
+    void SetCurrent(const char * tc);
+
+    // the current TC
+    uint16_t Telecommand() { return tc_number; }
+    uint8_t NumTCParams() { return num_tc_params; }
+    bool GetTCParam(uint8_t index, uint32_t * value);
+    bool GetTCParam(uint8_t index, float * value);
+    const char * GetTCParam(uint8_t index);
+
+    void Clear();
+
+    uint16_t Count() { return count; }
+
+    // limits on each loop's TCs, 0 for no limit
+    void SetPolicy(uint8_t max_per_loop, uint32_t max_us);
+    uint8_t MaxPerLoop() { return max_per_loop; }
+    uint32_t MaxMicros() { return max_us; }
+
+    // for the run phase's counters
+    void TCRun() { stats.tcs_run++; }
+    void LoopLimited() { stats.loops_limited++; }
+    void BatchRejected() { stats.batches_rejected++; }
+
+    const TCQueueStats_t & GetStats() { return stats; }
+
+private:
+    void SplitCurrent();
+
+    bool enabled;
+
+    char ring[TC_QUEUE_SIZE];
+    uint16_t head; // next character popped
+    uint16_t used;
+    uint16_t count; // TCs
+
+    // the current TC's text, split in place into its parameters
+    char tc_text[TC_TEXT_SIZE];
+    const char * tc_params[MAX_TC_PARAMS];
+    uint8_t num_tc_params;
+    uint16_t tc_number;
+
+    uint8_t max_per_loop;
+    uint32_t max_us;
+
+    TCQueueStats_t stats;
+};
+
+#endif /* STRATOTCQUEUE_H */
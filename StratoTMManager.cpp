@@ -0,0 +1,353 @@
+/*
+ *  StratoTMManager.cpp
+ *  Author:  StratoCore contributors
+ *  Created: October 2026
+ *
+ *  This file implements the TM buffers that StratoCore sends TMs from
+ */
+
+#include "StratoTMManager.h"
+#include <stddef.h>
+#include <string.h>
+
+StratoTMManager::StratoTMManager(TMSlot_t * slot_array, uint8_t * data_array, uint8_t num_slots, uint16_t size,
+                                 uint8_t num_text_slots)
+{
+    slots = slot_array;
+    data = data_array;
+    capacity = num_slots + num_text_slots;
+    data_slots = num_slots;
+    slot_size = size;
+
+    for (uint8_t i = 0; i < capacity; i++) {
+        slots[i].handle = NO_TM_HANDLE;
+        slots[i].status = TM_NONE;
+    }
+
+    in_flight = NO_TM_SLOT;
+    next_handle = 1;
+
+    ack_timeout_ms = TM_ACK_TIMEOUT_MS;
+    default_retries = TM_MAX_RETRIES;
+
+    stats = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+}
+
+TMHandle_t StratoTMManager::Queue(const uint8_t * tm_data, uint16_t size, uint8_t flag, const char * details, bool text,
+                                  uint8_t max_retries, bool keep)
+{
+    uint8_t slot = NO_TM_SLOT;
+    uint8_t queued = Queued();
+
+    // e.g. a warning repeated each loop is sent once per TMAck
+    if (text && !keep && NULL != details) {
+        for (uint8_t i = 0; i < capacity; i++) {
+            if (TM_QUEUED == slots[i].status && slots[i].text && !slots[i].keep && flag == slots[i].flag
+                && 0 == strncmp(details, slots[i].details, TM_DETAILS_SIZE - 1)) {
+                stats.merged++;
+                return slots[i].handle;
+            }
+        }
+    }
+
+    // a text TM needs no buffer, so it only takes a data slot if the text slots are full
+    if (text) slot = FreeSlot(data_slots, capacity);
+    if (NO_TM_SLOT == slot) slot = FreeSlot(0, data_slots);
+
+    if (NO_TM_SLOT == slot || size > slot_size || (size > 0 && (NULL == tm_data || slot >= data_slots))) {
+        stats.rejected++;
+        return NO_TM_HANDLE;
+    }
+
+    if (size > 0) memcpy(&data[(uint32_t) slot * slot_size], tm_data, size);
+
+    Fill(slot, size, flag, details, text, max_retries, keep);
+
+    if (queued + 1 > stats.max_queued) stats.max_queued = queued + 1;
+
+    return slots[slot].handle;
+}
+
+bool StratoTMManager::Build(TMBuilder & builder)
+{
+    uint8_t slot = FreeSlot(0, data_slots);
+
+    if (NO_TM_SLOT == slot) return false;
+
+    // a handle keeps the slot from being taken, the TM gets a new one when it's queued so it's sent in order
+    slots[slot].handle = next_handle++;
+    if (NO_TM_HANDLE == next_handle) next_handle = 1;
+    slots[slot].status = TM_BUILDING;
+    slots[slot].keep = false;
+
+    builder.buffer = &data[(uint32_t) slot * slot_size];
+    builder.capacity = slot_size;
+    builder.size = 0;
+    builder.slot = slot;
+    builder.overflow = false;
+
+    return true;
+}
+
+TMHandle_t StratoTMManager::Queue(TMBuilder & builder, uint8_t flag, const char * details, uint8_t max_retries, bool keep)
+{
+    uint8_t slot = builder.slot;
+    uint8_t queued = Queued();
+
+    if (NO_TM_SLOT == slot || TM_BUILDING != slots[slot].status) return NO_TM_HANDLE;
+
+    if (builder.overflow) {
+        stats.rejected++;
+        Discard(builder);
+        return NO_TM_HANDLE;
+    }
+
+    Fill(slot, builder.size, flag, details, false, max_retries, keep);
+    builder.slot = NO_TM_SLOT;
+
+    if (queued + 1 > stats.max_queued) stats.max_queued = queued + 1;
+
+    return slots[slot].handle;
+}
+
+void StratoTMManager::Discard(TMBuilder & builder)
+{
+    if (NO_TM_SLOT != builder.slot && TM_BUILDING == slots[builder.slot].status) {
+        slots[builder.slot].handle = NO_TM_HANDLE;
+        slots[builder.slot].status = TM_NONE;
+    }
+
+    builder.slot = NO_TM_SLOT;
+}
+
+void StratoTMManager::SwapData(uint8_t slot, uint8_t * buffer, uint16_t size)
+{
+    uint8_t * slot_data = &data[(uint32_t) slot * slot_size];
+    uint8_t temp = 0;
+
+    if (slot >= data_slots || NULL == buffer || size > slot_size) return;
+
+    for (uint16_t i = 0; i < size; i++) {
+        temp = slot_data[i];
+        slot_data[i] = buffer[i];
+        buffer[i] = temp;
+    }
+}
+
+void StratoTMManager::Fill(uint8_t slot, uint16_t size, uint8_t flag, const char * details, bool text,
+                           uint8_t max_retries, bool keep)
+{
+    TMSlot_t & tm = slots[slot];
+    tm.handle = next_handle++;
+    if (NO_TM_HANDLE == next_handle) next_handle = 1;
+
+    tm.sent_ms = 0;
+    tm.size = size;
+    tm.status = TM_QUEUED;
+    tm.tries = 0;
+    tm.max_retries = max_retries;
+    tm.flag = flag;
+    tm.text = text;
+    tm.keep = keep;
+
+    tm.details[0] = '\0';
+    if (NULL != details) {
+        strncpy(tm.details, details, TM_DETAILS_SIZE - 1);
+        tm.details[TM_DETAILS_SIZE - 1] = '\0';
+    }
+}
+
+uint8_t StratoTMManager::NextToSend(uint32_t now_ms)
+{
+    uint8_t next = NO_TM_SLOT;
+
+    if (NO_TM_SLOT != in_flight) return NO_TM_SLOT;
+
+    // the oldest waiting TM, which is a resend if one was NAKed or timed out
+    for (uint8_t i = 0; i < capacity; i++) {
+        if (TM_QUEUED == slots[i].status && (NO_TM_SLOT == next || slots[i].handle - slots[next].handle > 0x80000000UL)) {
+            next = i;
+        }
+    }
+
+    if (NO_TM_SLOT == next) return NO_TM_SLOT;
+
+    if (0 == slots[next].tries) {
+        stats.sent++;
+    } else {
+        stats.retried++;
+    }
+
+    slots[next].tries++;
+    slots[next].sent_ms = now_ms;
+    slots[next].status = TM_IN_FLIGHT;
+    in_flight = next;
+
+    return next;
+}
+
+void StratoTMManager::Ack(bool ack)
+{
+    if (NO_TM_SLOT == in_flight) {
+        stats.unmatched_acks++;
+        return;
+    }
+
+    if (ack) {
+        stats.acked++;
+        Finish(in_flight, TM_ACKED);
+    } else {
+        stats.naks++;
+        Retry(in_flight);
+    }
+}
+
+void StratoTMManager::CheckTimeout(uint32_t now_ms)
+{
+    if (NO_TM_SLOT == in_flight || now_ms - slots[in_flight].sent_ms < ack_timeout_ms) return;
+
+    stats.timeouts++;
+    Retry(in_flight);
+}
+
+void StratoTMManager::Retry(uint8_t slot)
+{
+    if (slots[slot].tries > slots[slot].max_retries) {
+        stats.dropped++;
+        Finish(slot, TM_DROPPED);
+        return;
+    }
+
+    slots[slot].status = TM_QUEUED;
+    in_flight = NO_TM_SLOT;
+}
+
+void StratoTMManager::Finish(uint8_t slot, TMStatus_t status)
+{
+    if (slot == in_flight) in_flight = NO_TM_SLOT;
+
+    if (slots[slot].keep) {
+        slots[slot].status = status;
+    } else {
+        slots[slot].handle = NO_TM_HANDLE;
+        slots[slot].status = TM_NONE;
+    }
+}
+
+TMStatus_t StratoTMManager::Status(TMHandle_t handle)
+{
+    uint8_t slot = FindSlot(handle);
+
+    return (NO_TM_SLOT != slot) ? (TMStatus_t) slots[slot].status : TM_NONE;
+}
+
+uint8_t StratoTMManager::Tries(TMHandle_t handle)
+{
+    uint8_t slot = FindSlot(handle);
+
+    return (NO_TM_SLOT != slot) ? slots[slot].tries : 0;
+}
+
+void StratoTMManager::Release(TMHandle_t handle)
+{
+    uint8_t slot = FindSlot(handle);
+
+    if (NO_TM_SLOT == slot) return;
+
+    if (TM_ACKED == slots[slot].status || TM_DROPPED == slots[slot].status) {
+        slots[slot].handle = NO_TM_HANDLE;
+        slots[slot].status = TM_NONE;
+    } else {
+        slots[slot].keep = false;
+    }
+}
+
+uint8_t StratoTMManager::Queued()
+{
+    uint8_t queued = 0;
+
+    for (uint8_t i = 0; i < capacity; i++) {
+        if (TM_QUEUED == slots[i].status || TM_IN_FLIGHT == slots[i].status) queued++;
+    }
+
+    return queued;
+}
+
+void StratoTMManager::SetPolicy(uint32_t timeout_ms, uint8_t max_retries)
+{
+    ack_timeout_ms = timeout_ms;
+    default_retries = max_retries;
+}
+
+uint8_t StratoTMManager::FreeSlot(uint8_t first, uint8_t last)
+{
+    for (uint8_t i = first; i < last; i++) {
+        if (NO_TM_HANDLE == slots[i].handle) return i;
+    }
+
+    return NO_TM_SLOT;
+}
+
+uint8_t StratoTMManager::FindSlot(TMHandle_t handle)
+{
+    if (NO_TM_HANDLE == handle) return NO_TM_SLOT;
+
+    for (uint8_t i = 0; i < capacity; i++) {
+        if (handle == slots[i].handle) return i;
+    }
+
+    return NO_TM_SLOT;
+}
+
+bool TMBuilder::Add(uint8_t value)
+{
+    if (NULL == buffer || size + 1 > capacity) {
+        overflow = true;
+        return false;
+    }
+
+    buffer[size++] = value;
+
+    return true;
+}
+
+bool TMBuilder::Add(uint16_t value)
+{
+    if (NULL == buffer || size + 2 > capacity) {
+        overflow = true;
+        return false;
+    }
+
+    buffer[size++] = (uint8_t) (value >> 8);
+    buffer[size++] = (uint8_t) value;
+
+    return true;
+}
+
+bool TMBuilder::Add(uint32_t value)
+{
+    if (NULL == buffer || size + 4 > capacity) {
+        overflow = true;
+        return false;
+    }
+
+    buffer[size++] = (uint8_t) (value >> 24);
+    buffer[size++] = (uint8_t) (value >> 16);
+    buffer[size++] = (uint8_t) (value >> 8);
+    buffer[size++] = (uint8_t) value;
+
+    return true;
+}
+
+bool TMBuilder::Add(const uint8_t * data, uint16_t length)
+{
+    if (NULL == buffer || NULL == data || (uint32_t) size + length > capacity) {
+        overflow = true;
+        return false;
+    }
+
+    memcpy(buffer + size, data, length);
+    size += length;
+
+    return true;
+}
@@ -0,0 +1,200 @@
+/*
+ *  StratoTMManager.h
+ *  Author:  StratoCore contributors
+ *  Created: October 2026
+ *
+ *  This file declares the TM buffers that StratoCore sends TMs from, so that
+ *  a TM waiting for its TMAck can be resent on a NAK or timeout while the
+ *  next one is being filled and queued
+ */
+
+#ifndef STRATOTMMANAGER_H
+#define STRATOTMMANAGER_H
+
+#include "XMLWriter_v5.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// number of TM buffers and the largest TM each holds, can be overridden at compile time (StratoCore
+// requires room for a whole XMLWriter TM buffer)
+#ifndef TM_SLOTS
+#define TM_SLOTS        2 // at least 2, so one can be filled while another waits for its TMAck
+#endif
+#ifndef TM_SLOT_SIZE
+#define TM_SLOT_SIZE    TM_BUFFER_SIZE
+#endif
+
+// slots for text TMs (the ZephyrLog functions), which need no buffer, so logs don't compete with data TMs
+#ifndef TM_TEXT_SLOTS
+#define TM_TEXT_SLOTS   8
+#endif
+
+// state message kept for each TM (room for a full log_array message)
+#define TM_DETAILS_SIZE 101
+
+// default ms to wait for a TMAck, and resends of a TM after a NAK or timeout before it's dropped
+#define TM_ACK_TIMEOUT_MS   30000
+#define TM_MAX_RETRIES      3
+
+// identifies a queued TM to a sender that wants its result, 0 is never used
+typedef uint32_t TMHandle_t;
+#define NO_TM_HANDLE    ((TMHandle_t) 0)
+
+#define NO_TM_SLOT      ((uint8_t) 0xFF)
+
+enum TMStatus_t {
+    TM_NONE = 0, // unknown handle, or already released
+    TM_QUEUED, // waiting to be sent or resent
+    TM_IN_FLIGHT, // sent, waiting for the TMAck
+    TM_ACKED,
+    TM_DROPPED, // NAKed or timed out on every try
+    TM_BUILDING // reserved by Build, not yet queued
+};
+
+struct TMSlot_t {
+    TMHandle_t handle; // NO_TM_HANDLE if the slot is free
+    uint32_t sent_ms; // StratoMillis() of the last send
+    uint16_t size;
+    uint8_t status; // TMStatus_t
+    uint8_t tries; // sends so far
+    uint8_t max_retries;
+    uint8_t flag; // StateFlag_t of state flag 1, the others are unused
+    bool text; // sent with TM_String, no TM buffer
+    bool keep; // kept after it's acked or dropped until the sender releases it
+    char details[TM_DETAILS_SIZE];
+};
+
+struct TMStats_t {
+    uint32_t sent; // TMs sent for the first time
+    uint32_t acked;
+    uint32_t retried; // resends after a NAK or timeout
+    uint32_t dropped; // given up on after the last retry
+    uint32_t rejected; // every buffer was in use, or the TM was larger than TM_SLOT_SIZE
+    uint32_t merged; // text TMs identical to one already waiting, which is sent once for both
+    uint32_t naks;
+    uint32_t timeouts;
+    uint32_t unmatched_acks; // TMAcks with no TM in flight, e.g. for TMs sent directly with zephyrTX.TM()
+    uint8_t max_queued;
+};
+
+// a TM composed in place in a free TM buffer (see StratoTMManager::Build), with the same byte order as
+// XMLWriter::addTm; a value that doesn't fit isn't added and marks the TM as overflowed, which the
+// manager rejects when it's queued
+class TMBuilder {
+public:
+    TMBuilder() : buffer(NULL), capacity(0), size(0), slot(NO_TM_SLOT), overflow(false) { }
+
+    bool Add(uint8_t value);
+    bool Add(uint16_t value);
+    bool Add(uint32_t value);
+    bool Add(const uint8_t * data, uint16_t length);
+
+    uint16_t Size() { return size; }
+    bool Overflowed() { return overflow; }
+
+private:
+    friend class StratoTMManager;
+
+    uint8_t * buffer;
+    uint16_t capacity;
+    uint16_t size;
+    uint8_t slot;
+    bool overflow;
+};
+
+// TMAcks don't say which TM they're for, so one TM is in flight at a time and the rest wait in
+// order; a TM that's NAKed or times out is resent before any TM queued after it. Text TMs have
+// their own slots (and use a data slot only if those are full), so a burst of log messages doesn't
+// crowd out data TMs or the other way around. The buffers are provided by a derived class so that
+// their number and size are compile-time parameters (see StaticTMManager below). The manager only
+// keeps the TMs, StratoCore sends them (see StratoCore::SendTM).
+class StratoTMManager {
+public:
+    ~StratoTMManager() { };
+
+    // copy a TM into a free buffer, returns NO_TM_HANDLE if none is free or it's too large. With keep,
+    // the result is held for Status() until Release(). A text TM the same as one still waiting (and not
+    // kept) isn't queued again, the handle of the waiting one is returned.
+    TMHandle_t Queue(const uint8_t * data, uint16_t size, uint8_t flag, const char * details, bool text,
+                     uint8_t max_retries, bool keep = false);
+
+    // reserve a free data buffer to compose a TM in, false if none is free. The TM is sent once it's
+    // given to Queue below, or the buffer is returned by Discard.
+    bool Build(TMBuilder & builder);
+    TMHandle_t Queue(TMBuilder & builder, uint8_t flag, const char * details, uint8_t max_retries, bool keep = false);
+    void Discard(TMBuilder & builder);
+
+    // exchange the first size bytes of a data slot with a buffer, so that a TM can be sent from a
+    // writer's TM buffer and what the writer held put back afterwards without a copy of either
+    void SwapData(uint8_t slot, uint8_t * buffer, uint16_t size);
+    uint16_t SlotSize() { return slot_size; }
+
+    // the slot to send now, if nothing is in flight, marked in flight (NO_TM_SLOT if there isn't one)
+    uint8_t NextToSend(uint32_t now_ms);
+
+    // a TMAck for the TM in flight
+    void Ack(bool ack);
+
+    // resend (or drop) the TM in flight if its TMAck is overdue
+    void CheckTimeout(uint32_t now_ms);
+
+    TMStatus_t Status(TMHandle_t handle);
+    uint8_t Tries(TMHandle_t handle);
+
+    // the sender is done with a kept TM, which is freed now if it's finished or once it is
+    void Release(TMHandle_t handle);
+
+    const TMSlot_t & Slot(uint8_t slot) { return slots[slot]; }
+    const uint8_t * Data(uint8_t slot) { return &data[(uint32_t) slot * slot_size]; } // data slots only
+
+    // TMs queued or in flight
+    uint8_t Queued();
+    bool InFlight() { return NO_TM_SLOT != in_flight; }
+
+    void SetPolicy(uint32_t ack_timeout_ms, uint8_t max_retries);
+    uint32_t AckTimeout() { return ack_timeout_ms; }
+    uint8_t MaxRetries() { return default_retries; }
+
+    const TMStats_t & GetStats() { return stats; }
+
+protected:
+    // slot_array must hold num_slots + num_text_slots entries, data must hold num_slots * size bytes
+    StratoTMManager(TMSlot_t * slot_array, uint8_t * data_array, uint8_t num_slots, uint16_t size, uint8_t num_text_slots);
+
+private:
+    uint8_t FindSlot(TMHandle_t handle);
+    uint8_t FreeSlot(uint8_t first, uint8_t last);
+    void Fill(uint8_t slot, uint16_t size, uint8_t flag, const char * details, bool text, uint8_t max_retries, bool keep);
+    void Finish(uint8_t slot, TMStatus_t status); // acked or dropped
+    void Retry(uint8_t slot); // after a NAK or timeout
+
+    TMSlot_t * slots; // data slots, then text slots
+    uint8_t * data;
+    uint8_t capacity;
+    uint8_t data_slots;
+    uint16_t slot_size;
+
+    uint8_t in_flight; // slot, or NO_TM_SLOT
+    TMHandle_t next_handle;
+
+    uint32_t ack_timeout_ms;
+    uint8_t default_retries;
+
+    TMStats_t stats;
+};
+
+// statically-allocated TM buffers
+template <uint8_t SLOTS, uint16_t SIZE, uint8_t TEXT_SLOTS = TM_TEXT_SLOTS>
+class StaticTMManager : public StratoTMManager {
+public:
+    StaticTMManager() : StratoTMManager(slot_storage, data_storage, SLOTS, SIZE, TEXT_SLOTS) { }
+
+private:
+    static_assert(SLOTS >= 2, "a TM can't be filled while another waits for its TMAck with fewer than 2 buffers");
+    static_assert(SLOTS + TEXT_SLOTS < NO_TM_SLOT, "too many TM slots to number");
+
+    TMSlot_t slot_storage[SLOTS + TEXT_SLOTS];
+    uint8_t data_storage[(uint32_t) SLOTS * SIZE];
+};
+
+#endif /* STRATOTMMANAGER_H */
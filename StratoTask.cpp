@@ -0,0 +1,121 @@
+/*
+ *  StratoTask.cpp
+ *  Author:  StratoCore contributors
+ *  Created: October 2026
+ *
+ *  This file implements the task control blocks for StratoCore's cooperative
+ *  tasks
+ */
+
+#include "StratoTask.h"
+#include <string.h>
+
+StratoTaskList::StratoTaskList()
+{
+    memset(tasks, 0, sizeof(tasks));
+    active = 0;
+
+    running = NO_TASK;
+    running_generation = 0;
+
+    first = 0;
+    scanned = TASK_SLOTS;
+    next_first = 0;
+
+    stats = {0, 0, 0, 0, 0, 0};
+}
+
+uint8_t StratoTaskList::Start(TaskMethod_t method, uint32_t arg)
+{
+    if (NULL == method) return NO_TASK;
+
+    for (uint8_t i = 0; i < TASK_SLOTS; i++) {
+        if (NULL == tasks[i].method && i != running) {
+            uint16_t generation = tasks[i].generation + 1;
+
+            memset(&tasks[i], 0, sizeof(TaskControl_t));
+            tasks[i].method = method;
+            tasks[i].arg = arg;
+            tasks[i].generation = generation;
+
+            active++;
+            stats.started++;
+            if (active > stats.max_active) stats.max_active = active;
+
+            return i;
+        }
+    }
+
+    stats.rejected++;
+    return NO_TASK;
+}
+
+void StratoTaskList::Stop(uint8_t task)
+{
+    if (!IsRunning(task)) return;
+
+    tasks[task].method = NULL;
+    active--;
+    stats.stopped++;
+}
+
+void StratoTaskList::Clear()
+{
+    for (uint8_t i = 0; i < TASK_SLOTS; i++) {
+        Stop(i);
+    }
+}
+
+void StratoTaskList::BeginLoop()
+{
+    first = next_first;
+    scanned = 0;
+}
+
+uint8_t StratoTaskList::NextReady()
+{
+    uint8_t task = 0;
+
+    while (scanned < TASK_SLOTS) {
+        task = (first + scanned++) % TASK_SLOTS;
+
+        if (NULL == tasks[task].method) continue;
+
+        if (0 != tasks[task].wait_ms) {
+            if (StratoMillis() - tasks[task].wait_start_ms < tasks[task].wait_ms) continue;
+            tasks[task].wait_ms = 0;
+        }
+
+        return task;
+    }
+
+    return NO_TASK;
+}
+
+TaskControl_t * StratoTaskList::Begin(uint8_t task)
+{
+    running = task;
+    running_generation = tasks[task].generation;
+
+    return &tasks[task];
+}
+
+void StratoTaskList::Finish(uint8_t task, TaskResult_t result, uint32_t elapsed_us)
+{
+    TaskControl_t * control = &tasks[task];
+
+    running = NO_TASK;
+    next_first = (task + 1) % TASK_SLOTS;
+
+    // a task stopped while it ran has already been counted, and its block is free
+    if (NULL == control->method || running_generation != control->generation) return;
+
+    control->runs++;
+    if (elapsed_us > control->max_us) control->max_us = elapsed_us;
+
+    if (TASK_DONE == result) {
+        control->method = NULL;
+        active--;
+        stats.finished++;
+    }
+}
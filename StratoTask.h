@@ -0,0 +1,143 @@
+/*
+ *  StratoTask.h
+ *  Author:  StratoCore contributors
+ *  Created: October 2026
+ *
+ *  This file declares stackless cooperative tasks (protothreads) with static
+ *  task control blocks, run by StratoCore each loop within a time budget, so
+ *  that long operations can be written straight through with yields instead
+ *  of being split into substates by hand.
+ */
+
+#ifndef STRATOTASK_H
+#define STRATOTASK_H
+
+#include "StratoClock.h"
+#include "Arduino.h"
+#include <stdint.h>
+
+// number of task control blocks, the most tasks that can run at once
+#ifndef TASK_SLOTS
+#define TASK_SLOTS      8
+#endif
+
+// values kept in each task control block across yields (a task's own local variables are not)
+#define TASK_LOCALS     4
+
+// default per-loop limit on task run time, at least one ready task is run each loop
+#define TASK_US_PER_LOOP    100000
+
+#define NO_TASK         ((uint8_t) 0xFF)
+
+enum TaskResult_t {
+    TASK_YIELDED = 0,
+    TASK_DONE
+};
+
+class StratoCore;
+struct TaskControl_t;
+
+// tasks are StratoCore or instrument methods, see StratoCore::StartTask
+typedef TaskResult_t (StratoCore::*TaskMethod_t)(TaskControl_t * task);
+
+struct TaskControl_t {
+    TaskMethod_t method; // NULL if the block is free
+    uint16_t resume; // line to resume at, 0 to start from the top
+    uint32_t wait_start_ms;
+    uint32_t wait_ms; // not run until this long after wait_start_ms
+    uint32_t arg; // given to StartTask
+    uint32_t locals[TASK_LOCALS];
+    uint32_t runs;
+    uint32_t max_us;
+    uint16_t generation; // counts the tasks started in this block
+};
+
+struct TaskStats_t {
+    uint32_t started;
+    uint32_t rejected; // no free control block
+    uint32_t finished;
+    uint32_t stopped; // by StopTask or a mode change
+    uint32_t loops_limited; // loops that ended with tasks still ready because of the time limit
+    uint8_t max_active;
+};
+
+// A task body is wrapped in TASK_BEGIN/TASK_END, and each TASK_YIELD, TASK_DELAY or TASK_WAIT_UNTIL
+// returns to StratoCore and resumes at that point in a later loop. Because the resume point is a
+// case label, a task can't yield from inside its own switch statement, and its local variables are
+// lost at each yield (use task->locals or instrument members instead). A task may stop itself and
+// start tasks (including another run of itself) before it returns: its block isn't reused until the
+// run ends, so the macros' writes to it on the way out can't reach the new task.
+#define TASK_BEGIN(task)    switch ((task)->resume) { case 0:
+
+#define TASK_END(task)      } (task)->resume = 0; return TASK_DONE
+
+// marks an intended fall through into a resume point for -Wimplicit-fallthrough, since a
+// fall-through comment doesn't survive macro expansion
+#if defined(__GNUC__) && __GNUC__ >= 7
+#define TASK_FALLTHROUGH    __attribute__((fallthrough))
+#else
+#define TASK_FALLTHROUGH    do { } while (0)
+#endif
+
+// resume in the next loop
+#define TASK_YIELD(task) \
+    do { (task)->resume = __LINE__; return TASK_YIELDED; case __LINE__: ; } while (0)
+
+// resume once ms milliseconds have passed, in the first loop after that
+#define TASK_DELAY(task, ms) \
+    do { (task)->wait_start_ms = StratoMillis(); (task)->wait_ms = (ms); TASK_YIELD(task); } while (0)
+
+// check cond once per loop, and continue when it's true (the first check falls through into the resume point)
+#define TASK_WAIT_UNTIL(task, cond) \
+    do { (task)->resume = __LINE__; TASK_FALLTHROUGH; case __LINE__: if (!(cond)) return TASK_YIELDED; } while (0)
+
+// end the task early
+#define TASK_EXIT(task)     do { (task)->resume = 0; return TASK_DONE; } while (0)
+
+// The task control blocks, and round-robin selection of the tasks to run each loop (see StratoCore::RunTasks)
+class StratoTaskList {
+public:
+    StratoTaskList();
+    ~StratoTaskList() { };
+
+    // returns the task's number, or NO_TASK if all of the control blocks are in use
+    uint8_t Start(TaskMethod_t method, uint32_t arg);
+
+    void Stop(uint8_t task);
+    void Clear();
+
+    bool IsRunning(uint8_t task) { return task < TASK_SLOTS && NULL != tasks[task].method; }
+    uint8_t Active() { return active; }
+
+    // call before the first NextReady of each loop, which then returns each ready task once
+    void BeginLoop();
+    uint8_t NextReady();
+
+    TaskControl_t * Control(uint8_t task) { return &tasks[task]; }
+
+    // mark a task returned by NextReady as running, then record the run, which only counts for the same
+    // task (by generation) if it wasn't stopped meanwhile
+    TaskControl_t * Begin(uint8_t task);
+    void Finish(uint8_t task, TaskResult_t result, uint32_t elapsed_us);
+
+    void LoopLimited() { stats.loops_limited++; }
+
+    const TaskStats_t & GetStats() { return stats; }
+
+private:
+    TaskControl_t tasks[TASK_SLOTS];
+    uint8_t active;
+
+    // the task being run and its generation when it was called, its block isn't given to Start meanwhile
+    uint8_t running;
+    uint16_t running_generation;
+
+    // where this loop's scan started and how far it has gone, the next loop starts after the last task run
+    uint8_t first;
+    uint8_t scanned;
+    uint8_t next_first;
+
+    TaskStats_t stats;
+};
+
+#endif /* STRATOTASK_H */
@@ -0,0 +1,123 @@
+/*
+ *  StratoWatchdog.cpp
+ *  Author:  StratoCore contributors
+ *  Created: October 2026
+ *
+ *  This file implements a monitor for the loop's watchdog budget and the
+ *  reset-surviving breadcrumb
+ */
+
+#include "StratoWatchdog.h"
+
+// not zeroed by the startup code, so it holds the state at the time of a watchdog reset
+static Breadcrumb_t breadcrumb STRATO_NOINIT;
+
+static const uint32_t default_thresholds[WATCHDOG_WARN_LEVELS] = WATCHDOG_WARN_DEFAULTS;
+
+StratoWatchdog::StratoWatchdog()
+{
+    for (uint8_t i = 0; i < WATCHDOG_WARN_LEVELS; i++) {
+        thresholds[i] = default_thresholds[i];
+        warnings[i] = 0;
+    }
+
+    next_level = 0;
+    loop_start_ms = 0;
+    kick_ms = 0;
+    max_loop_ms = 0;
+
+    // the breadcrumb from before the reset must not be touched until Start
+    started = false;
+}
+
+bool StratoWatchdog::Start(Breadcrumb_t * last)
+{
+    bool valid = (BREADCRUMB_MAGIC == breadcrumb.magic);
+
+    if (valid && NULL != last) *last = breadcrumb;
+
+    breadcrumb.magic = BREADCRUMB_MAGIC;
+    breadcrumb.loop_count = 0;
+    breadcrumb.loop_ms = 0;
+    breadcrumb.tc = 0;
+    breadcrumb.phase = BREADCRUMB_NO_PHASE;
+    breadcrumb.mode = 0;
+    breadcrumb.substate = 0;
+    breadcrumb.action = 0;
+
+    loop_start_ms = StratoMillis();
+    kick_ms = loop_start_ms;
+    next_level = 0;
+    started = true;
+
+    return valid;
+}
+
+uint8_t StratoWatchdog::EnterPhase(uint8_t phase)
+{
+    if (!started) return 0;
+
+    uint32_t elapsed = StratoMillis() - loop_start_ms;
+
+    breadcrumb.phase = phase;
+    breadcrumb.loop_ms = elapsed;
+
+    return CheckBudget(elapsed);
+}
+
+void StratoWatchdog::SetMode(uint8_t mode, uint8_t substate)
+{
+    breadcrumb.mode = mode;
+    breadcrumb.substate = substate;
+}
+
+void StratoWatchdog::SetTC(uint16_t tc)
+{
+    breadcrumb.tc = tc;
+}
+
+void StratoWatchdog::SetAction(uint8_t action)
+{
+    breadcrumb.action = action;
+}
+
+uint8_t StratoWatchdog::Kick()
+{
+    if (!started) return 0;
+
+    uint32_t now_ms = StratoMillis();
+    uint32_t elapsed = now_ms - loop_start_ms;
+    uint8_t level = CheckBudget(elapsed);
+
+    if (elapsed > max_loop_ms) max_loop_ms = elapsed;
+
+    // start the next loop
+    loop_start_ms = now_ms;
+    kick_ms = now_ms;
+    next_level = 0;
+
+    breadcrumb.loop_count++;
+    breadcrumb.loop_ms = 0;
+    breadcrumb.phase = BREADCRUMB_NO_PHASE;
+
+    return level;
+}
+
+void StratoWatchdog::SetThreshold(uint8_t level, uint32_t threshold_ms)
+{
+    if (level > 0 && level <= WATCHDOG_WARN_LEVELS) thresholds[level - 1] = threshold_ms;
+}
+
+// report only the highest threshold newly crossed, each level is reported once per loop
+uint8_t StratoWatchdog::CheckBudget(uint32_t elapsed_ms)
+{
+    uint8_t level = 0;
+
+    while (next_level < WATCHDOG_WARN_LEVELS && elapsed_ms >= thresholds[next_level]) {
+        warnings[next_level]++;
+        next_level++;
+        level = next_level;
+    }
+
+    return level;
+}
@@ -0,0 +1,96 @@
+/*
+ *  StratoWatchdog.h
+ *  Author:  StratoCore contributors
+ *  Created: October 2026
+ *
+ *  This file declares a monitor for the loop's watchdog budget that warns
+ *  when a loop nears the watchdog period, and keeps a breadcrumb of what was
+ *  running in RAM that survives a watchdog reset.
+ */
+
+#ifndef STRATOWATCHDOG_H
+#define STRATOWATCHDOG_H
+
+#include "StratoProfiler.h"
+#include "StratoClock.h"
+#include "Arduino.h"
+#include <stdint.h>
+
+// the breadcrumb is placed in RAM that isn't cleared at startup (override for other linker scripts)
+#ifndef STRATO_NOINIT
+#define STRATO_NOINIT   __attribute__ ((section(".noinit")))
+#endif
+
+// the watchdog period set in InitializeWatchdog
+#define WATCHDOG_PERIOD_MS  10000
+
+// loops running longer than each of these thresholds (ms since the last kick) are warned about once
+#define WATCHDOG_WARN_LEVELS    2
+#define WATCHDOG_WARN_DEFAULTS  {1000, 5000}
+
+// marks a breadcrumb as written by this software rather than left over from power-up
+#define BREADCRUMB_MAGIC    0x57444F47 // "WDOG"
+
+// phase value for time outside of the StratoCore phases (e.g. waiting for the next loop)
+#define BREADCRUMB_NO_PHASE NUM_PHASES
+
+struct Breadcrumb_t {
+    uint32_t magic;
+    uint32_t loop_count; // watchdog kicks since boot
+    uint32_t loop_ms; // how far into the loop the current phase was entered
+    uint16_t tc; // last telecommand started
+    uint8_t phase; // ProfilePhase_t or BREADCRUMB_NO_PHASE
+    uint8_t mode;
+    uint8_t substate;
+    uint8_t action; // last scheduled action started
+};
+
+class StratoWatchdog {
+public:
+    StratoWatchdog();
+    ~StratoWatchdog() { };
+
+    // copy out the breadcrumb left before the reset (returns false if there isn't one), then start a new one
+    bool Start(Breadcrumb_t * last);
+
+    // mark the phase that is starting, returns the warning level (1-based) if a threshold was newly crossed, else 0
+    uint8_t EnterPhase(uint8_t phase);
+
+    void SetMode(uint8_t mode, uint8_t substate);
+    void SetTC(uint16_t tc);
+    void SetAction(uint8_t action);
+
+    // called on every watchdog kick, returns a newly crossed warning level (as above) for the loop just ended
+    uint8_t Kick();
+
+    // set a 1-based warning level's threshold, thresholds must stay in increasing order
+    void SetThreshold(uint8_t level, uint32_t threshold_ms);
+
+    // for a 1-based warning level from EnterPhase or Kick
+    uint32_t GetThreshold(uint8_t level) { return (level > 0 && level <= WATCHDOG_WARN_LEVELS) ? thresholds[level - 1] : 0; }
+    uint32_t GetWarnings(uint8_t level) { return (level > 0 && level <= WATCHDOG_WARN_LEVELS) ? warnings[level - 1] : 0; }
+
+    uint32_t LoopElapsed() { return StratoMillis() - loop_start_ms; }
+
+    // time since the hardware watchdog was last kicked, idle time included
+    uint32_t SinceKick() { return StratoMillis() - kick_ms; }
+
+    // leave time spent in StratoCore::Idle out of the loop budget (the hardware watchdog still counts it)
+    void ExcludeIdle(uint32_t idle_ms) { loop_start_ms += idle_ms; }
+    uint32_t MaxLoop() { return max_loop_ms; }
+
+private:
+    uint8_t CheckBudget(uint32_t elapsed_ms);
+
+    uint32_t thresholds[WATCHDOG_WARN_LEVELS];
+    uint32_t warnings[WATCHDOG_WARN_LEVELS];
+    uint8_t next_level; // first threshold not yet crossed this loop
+
+    uint32_t loop_start_ms;
+    uint32_t kick_ms;
+    uint32_t max_loop_ms;
+
+    bool started;
+};
+
+#endif /* STRATOWATCHDOG_H */
@@ -0,0 +1,187 @@
+/*
+ *  CodecBench.cpp
+ *  Author:  StratoCore contributors
+ *  Created: October 2026
+ *
+ *  This file implements a host-side benchmark of the TM codec. Representative
+ *  TM buffers are encoded with each codec, and the compression ratio and the
+ *  encode and decode times are reported. Every encoding is decoded and checked.
+ *
+ *  Usage: strato_codec_bench [-n iterations] [-s buffer size]
+ */
+
+#include "StratoCodec.h"
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define MAX_BUFFER_SIZE     8192
+
+static StaticCodec<MAX_BUFFER_SIZE + CODEC_HEADER_SIZE> codec;
+static uint8_t buffer[MAX_BUFFER_SIZE];
+static uint8_t decoded[MAX_BUFFER_SIZE];
+static uint8_t scratch[2 * MAX_BUFFER_SIZE];
+
+static uint64_t nanos()
+{
+    return (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void PutBig(uint8_t * data, uint8_t width, uint32_t value)
+{
+    for (uint8_t i = width; i > 0; i--) {
+        data[i - 1] = (uint8_t) value;
+        value >>= 8;
+    }
+}
+
+// Representative buffers -------------------------------------
+
+struct Dataset_t {
+    const char * name;
+    uint8_t width;  // delta parameters that suit the data
+    uint8_t stride;
+    void (*fill)(uint16_t size);
+};
+
+// four interleaved uint16_t ADC channels: slow signals with a few counts of noise
+static void FillADC(uint16_t size)
+{
+    for (uint16_t i = 0; i + 2 <= size; i += 2) {
+        uint16_t sample = i / 8;
+        uint16_t channel = (i / 2) % 4;
+        double signal = 20000.0 + 3000.0 * channel + 1500.0 * sin(sample / (40.0 + 10.0 * channel));
+        PutBig(&buffer[i], 2, (uint32_t) (signal + rand() % 7));
+    }
+}
+
+// uint32_t millisecond timestamps with jitter, as for event times
+static void FillTimestamps(uint16_t size)
+{
+    uint32_t time = 1561000000;
+    for (uint16_t i = 0; i + 4 <= size; i += 4) {
+        time += 100 + rand() % 5;
+        PutBig(&buffer[i], 4, time);
+    }
+}
+
+// a housekeeping record (time, mode, temperatures, voltages, flags) repeated with small changes
+static void FillHousekeeping(uint16_t size)
+{
+    for (uint16_t i = 0; i < size; i++) buffer[i] = 0;
+
+    for (uint16_t i = 0, n = 0; i + 32 <= size; i += 32, n++) {
+        PutBig(&buffer[i], 4, 1561000000 + n);
+        buffer[i + 4] = 1;
+        buffer[i + 5] = 3;
+        for (uint8_t t = 0; t < 6; t++) PutBig(&buffer[i + 6 + 2 * t], 2, 2950 + t * 10 + (n / 16) % 3);
+        for (uint8_t v = 0; v < 4; v++) PutBig(&buffer[i + 18 + 2 * v], 2, 5000 - v * 1700);
+        PutBig(&buffer[i + 26], 4, (n % 64 == 0) ? 0x10 : 0);
+    }
+}
+
+// ASCII status text, like a log dump
+static void FillText(uint16_t size)
+{
+    static const char * lines[] = {
+        "Motor at position 1205, current 312 mA\n",
+        "Profile complete, 512 samples\n",
+        "Heater on, temperature 21.5 C\n",
+        "Pump off\n"
+    };
+    uint16_t i = 0;
+
+    while (i < size) {
+        const char * line = lines[rand() % 4];
+        while (*line && i < size) buffer[i++] = (uint8_t) *line++;
+    }
+}
+
+// compressed or encrypted data can't be made smaller
+static void FillRandom(uint16_t size)
+{
+    for (uint16_t i = 0; i < size; i++) buffer[i] = (uint8_t) rand();
+}
+
+static const Dataset_t datasets[] = {
+    {"4-ch uint16 ADC", 2, 4, FillADC},
+    {"uint32 timestamps", 4, 1, FillTimestamps},
+    {"housekeeping", 2, 16, FillHousekeeping},
+    {"ASCII text", 1, 1, FillText},
+    {"random", 1, 1, FillRandom}
+};
+
+static const struct {
+    const char * name;
+    uint8_t flags;
+} codecs[] = {
+    {"delta", CODEC_DELTA},
+    {"LZ", CODEC_LZ},
+    {"delta+LZ", CODEC_DELTA | CODEC_LZ}
+};
+
+int main(int argc, char ** argv)
+{
+    uint32_t iterations = 200;
+    uint16_t size = 4096;
+    int opt;
+
+    while (-1 != (opt = getopt(argc, argv, "n:s:"))) {
+        switch (opt) {
+        case 'n':
+            iterations = (uint32_t) strtoul(optarg, NULL, 10);
+            break;
+        case 's':
+            size = (uint16_t) strtoul(optarg, NULL, 10);
+            break;
+        default:
+            printf("Usage: %s [-n iterations] [-s buffer size]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (0 == iterations || 0 == size || size > MAX_BUFFER_SIZE) {
+        printf("iterations must be > 0 and the buffer size 1-%u\n", MAX_BUFFER_SIZE);
+        return 1;
+    }
+
+    printf("%u byte buffers, %lu iterations (host times, scale for the Teensy)\n\n", size, (unsigned long) iterations);
+    printf("%-18s %-9s %8s %7s %12s %12s\n", "data", "codec", "bytes", "ratio", "encode us", "decode us");
+
+    int errors = 0;
+    for (const Dataset_t & dataset : datasets) {
+        srand(1);
+        dataset.fill(size);
+
+        for (const auto & entry : codecs) {
+            uint16_t encoded_size = 0;
+            uint16_t decoded_size = 0;
+
+            uint64_t start = nanos();
+            for (uint32_t i = 0; i < iterations; i++) {
+                encoded_size = codec.Encode(entry.flags, dataset.width, dataset.stride, buffer, size);
+            }
+            uint64_t encode_ns = (nanos() - start) / iterations;
+
+            bool ok = (0 != encoded_size);
+            start = nanos();
+            for (uint32_t i = 0; ok && i < iterations; i++) {
+                ok = CodecDecode(codec.Output(), encoded_size, decoded, sizeof(decoded), &decoded_size, scratch, sizeof(scratch));
+            }
+            uint64_t decode_ns = (nanos() - start) / iterations;
+
+            ok = ok && decoded_size == size && 0 == memcmp(buffer, decoded, size);
+            if (!ok) errors++;
+
+            printf("%-18s %-9s %8u %7.2f %12.1f %12.1f%s%s\n", dataset.name, entry.name, encoded_size,
+                   encoded_size ? (double) size / encoded_size : 0.0, encode_ns / 1000.0, decode_ns / 1000.0,
+                   (CODEC_NONE == codec.Output()[0]) ? " (sent raw)" : "", ok ? "" : " DECODE ERROR");
+        }
+    }
+
+    return errors ? 1 : 0;
+}
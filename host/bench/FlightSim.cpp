@@ -0,0 +1,551 @@
+/*
+ *  FlightSim.cpp
+ *  Author:  StratoCore contributors
+ *  Created: October 2026
+ *
+ *  This file implements a fast-forward flight simulation on the host. StratoCore
+ *  runs on a virtual clock that Idle advances instantly, so days of a flight
+ *  profile (day/night mode changes, GPS with a drifting onboard clock, a daily
+ *  comm outage, TCs and TMAcks) run in seconds, and the timing of the modes,
+ *  schedules, substate timeouts and tasks is checked against the true time.
+ *
+ *  Usage: strato_sim [-d days] [-p drift ppm] [-w capture] [-v]
+ */
+
+#include "StratoCore.h"
+#include "HostStream.h"
+#include <chrono>
+#include <stdarg.h>
+
+#define FLIGHT_START        ((time_t) 1561000000) // 2019-06-20 03:06:40 UTC, the night before the first day
+
+#define GPS_INTERVAL_S      60
+#define IM_INTERVAL_S       900     // the commanded mode is repeated, as well as sent on a change
+#define TC_INTERVAL_S       3600
+#define DAY_START_HOUR      6       // flight mode by day, low power at night
+#define DAY_END_HOUR        18
+#define OUTAGE_START_S      (20 * 3600L) // a daily comm outage longer than the Zephyr timeout
+#define OUTAGE_END_S        (21 * 3600L + 15 * 60L)
+
+#define HK_PERIOD_S         60
+#define HK_LOG_EVERY        10      // HK records written to the SD archive
+#define WARMUP_TIMEOUT_S    600
+#define SAMPLE_PERIOD_MS    5000
+#define HIGHRES_PERIOD_MS   250
+
+#define LOOP_MS             1000
+#define LOOP_SLACK_MS       1100    // timing is checked to within a loop
+#define CORRECTION_SLACK_MS 1000    // setting the time restarts the second, so schedules can also move by one
+
+#define MAX_REPORTED_FAILURES   20
+
+enum SimAction_t {
+    ACTION_NONE = NO_SCHEDULED_ACTION,
+    ACTION_HK,
+    ACTION_PULSE
+};
+
+enum FLStates_t : uint8_t {
+    FL_WARMUP = MODE_ENTRY + 1,
+    FL_MEASURE
+};
+
+static HostStream zephyr_stream;
+static HostStream debug_stream;
+static VirtualClock sim_clock;
+
+static uint32_t failures = 0;
+static bool verbose = false;
+
+static void Fail(const char * format, ...)
+{
+    va_list args;
+
+    if (++failures > MAX_REPORTED_FAILURES) return;
+
+    printf("  FAIL at %.1f h: ", (double) sim_clock.ElapsedMicros() / 3.6e9);
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+    printf("\n");
+}
+
+// the time the gondola keeps, which the onboard clock drifts from
+static time_t TrueTime()
+{
+    return FLIGHT_START + (time_t) (sim_clock.ElapsedMicros() / 1000000ULL);
+}
+
+// Simulated instrument -------------------------------------
+
+class SimInstrument : public StratoCore {
+public:
+    SimInstrument() : StratoCore(&zephyr_stream, RACHUTS, &debug_stream) { }
+
+    void InstrumentSetup()
+    {
+        static constexpr SubstateEntry_t flight_table[] = {
+            SUBSTATE(MODE_ENTRY, SimInstrument::FlightEntry, 0, MODE_ENTRY, MODE_ERROR),
+            SUBSTATE(FL_WARMUP, SimInstrument::FlightWarmup, WARMUP_TIMEOUT_S, FL_MEASURE, MODE_ERROR),
+            SUBSTATE(FL_MEASURE, SimInstrument::FlightMeasure, 0, FL_MEASURE, MODE_ERROR),
+            SUBSTATE(MODE_ERROR, SimInstrument::FlightError, 0, MODE_ERROR, MODE_ERROR),
+        };
+        static_assert(SubstateTableValid(flight_table), "flight substate table");
+
+        SetModeTable(MODE_FLIGHT, flight_table);
+    }
+
+    void InstrumentLoop()
+    {
+        // one HK record in ten goes to the SD archive
+        if (hk_to_log) {
+            hk_to_log = false;
+            zephyrTX.clearTm();
+            zephyrTX.addTm((uint32_t) hk_count);
+            zephyrTX.addTm((uint32_t) samples);
+            WriteFileTM("SIM");
+        }
+    }
+
+    StratoProfiler & Profiler() { return profiler; }
+
+    InstMode_t running_mode = MODE_STANDBY; // the mode whose function or table ran last
+    uint32_t mode_switches = 0;
+    uint32_t safety_entries = 0;
+    time_t safety_entered = 0; // true time
+    uint32_t tc_count = 0;
+    uint32_t hk_count = 0;
+    uint32_t hk_rejected = 0; // no free TM buffer, e.g. during a comm outage
+    uint32_t warmups = 0;
+    uint32_t samples = 0;
+    uint32_t pulses = 0;
+    uint32_t late_pulses = 0;
+
+private:
+    void StandbyMode() { ModeBody(MODE_STANDBY); }
+    void LowPowerMode() { ModeBody(MODE_LOWPOWER); }
+    void EndOfFlightMode() { ModeBody(MODE_EOF); }
+
+    void SafetyMode()
+    {
+        if (MODE_ENTRY == inst_substate) {
+            safety_entries++;
+            safety_entered = TrueTime();
+        }
+
+        ModeBody(MODE_SAFETY);
+    }
+
+    // only MODE_SHUTDOWN and MODE_EXIT reach the mode function, the table runs the rest
+    void FlightMode() { running_mode = MODE_FLIGHT; }
+
+    void ModeBody(InstMode_t mode)
+    {
+        running_mode = mode;
+
+        if (MODE_ENTRY == inst_substate) {
+            StartHousekeeping();
+            inst_substate = 1;
+        }
+    }
+
+    void StartHousekeeping()
+    {
+        mode_switches++;
+        last_hk_ms = 0;
+        scheduler.AddPeriodicAction(ACTION_HK, HK_PERIOD_S, HK_PERIOD_S);
+    }
+
+    uint8_t FlightEntry()
+    {
+        running_mode = MODE_FLIGHT;
+        StartHousekeeping();
+
+        highres_scheduler.AddPeriodicAction(ACTION_PULSE, HIGHRES_PERIOD_MS, HIGHRES_PERIOD_MS);
+        last_sample_ms = StratoMillis();
+        StartTask(&SimInstrument::SampleTask);
+
+        warmup_start_ms = 0;
+        return FL_WARMUP;
+    }
+
+    uint8_t FlightWarmup()
+    {
+        running_mode = MODE_FLIGHT;
+        if (0 == warmup_start_ms) warmup_start_ms = StratoMillis();
+        return FL_WARMUP;
+    }
+
+    uint8_t FlightMeasure()
+    {
+        running_mode = MODE_FLIGHT;
+
+        // first call, in the loop after the warmup timed out
+        if (0 != warmup_start_ms) {
+            uint32_t warmup_ms = StratoMillis() - warmup_start_ms;
+            if (warmup_ms < WARMUP_TIMEOUT_S * 1000UL || warmup_ms > WARMUP_TIMEOUT_S * 1000UL + LOOP_MS + LOOP_SLACK_MS) {
+                Fail("warmup took %u ms", warmup_ms);
+            }
+            warmups++;
+            warmup_start_ms = 0;
+        }
+
+        return FL_MEASURE;
+    }
+
+    uint8_t FlightError()
+    {
+        running_mode = MODE_FLIGHT;
+        Fail("flight substate error");
+        return MODE_ERROR;
+    }
+
+    TaskResult_t SampleTask(TaskControl_t * task)
+    {
+        TASK_BEGIN(task);
+
+        while (true) {
+            TASK_DELAY(task, SAMPLE_PERIOD_MS);
+
+            uint32_t interval_ms = StratoMillis() - last_sample_ms;
+            if (interval_ms < SAMPLE_PERIOD_MS || interval_ms > SAMPLE_PERIOD_MS + LOOP_SLACK_MS) {
+                Fail("sample task ran after %u ms", interval_ms);
+            }
+            last_sample_ms = StratoMillis();
+            samples++;
+        }
+
+        TASK_END(task);
+    }
+
+    void TCHandler(Telecommand_t telecommand)
+    {
+        (void) telecommand;
+        tc_count++;
+    }
+
+    void ActionHandler(uint8_t action)
+    {
+        if (ACTION_HK != action) return;
+
+        // relative schedules move with time corrections, so HK stays a minute apart on the ms clock
+        uint32_t now_ms = StratoMillis();
+        if (0 != last_hk_ms && (now_ms - last_hk_ms < HK_PERIOD_S * 1000UL - LOOP_SLACK_MS - CORRECTION_SLACK_MS
+                                || now_ms - last_hk_ms > HK_PERIOD_S * 1000UL + LOOP_SLACK_MS + CORRECTION_SLACK_MS)) {
+            Fail("HK interval of %u ms", now_ms - last_hk_ms);
+        }
+        last_hk_ms = now_ms;
+
+        hk_count++;
+        zephyrTX.clearTm();
+        zephyrTX.addTm((uint32_t) hk_count);
+        if (!SendTM(FINE, "HK")) hk_rejected++;
+
+        if (0 == hk_count % HK_LOG_EVERY) hk_to_log = true;
+    }
+
+    void HighResActionHandler(uint8_t action, uint32_t lateness_ms)
+    {
+        (void) action;
+
+        // Idle wakes exactly on the deadline in virtual time
+        pulses++;
+        if (0 != lateness_ms) late_pulses++;
+    }
+
+    uint32_t last_hk_ms = 0;
+    uint32_t warmup_start_ms = 0;
+    uint32_t last_sample_ms = 0;
+    bool hk_to_log = false;
+};
+
+// Simulated gondola ----------------------------------------
+
+class Gondola {
+public:
+    // inject the messages due at the start of a loop
+    void Service(time_t true_time)
+    {
+        long time_of_day = (long) (true_time % SECS_PER_DAY);
+        long hour = time_of_day / 3600;
+        bool contact = time_of_day < OUTAGE_START_S || time_of_day >= OUTAGE_END_S;
+        InstMode_t mode = (hour >= DAY_START_HOUR && hour < DAY_END_HOUR) ? MODE_FLIGHT : MODE_LOWPOWER;
+
+        gps_sent = false;
+        loops_since_im++;
+
+        if (!contact) {
+            if (in_contact) {
+                outage_start = true_time;
+                if (verbose) printf("  %.1f h: comm outage\n", (double) sim_clock.ElapsedMicros() / 3.6e9);
+            }
+            in_contact = false;
+            pending_acks = 0;
+            return;
+        }
+
+        // back in contact: the instrument should have timed out to safety on its own
+        if (!in_contact) {
+            outages++;
+            in_contact = true;
+            last_im = 0;
+        }
+
+        if (0 == last_gps || true_time - last_gps >= GPS_INTERVAL_S) {
+            InjectGPS(true_time);
+            last_gps = true_time;
+            gps_sent = true;
+        }
+
+        if (mode != commanded || 0 == last_im || true_time - last_im >= IM_INTERVAL_S) {
+            if (verbose && mode != commanded) printf("  %.1f h: commanding %s\n", (double) sim_clock.ElapsedMicros() / 3.6e9,
+                                                     (MODE_FLIGHT == mode) ? "FL" : "LP");
+            commanded = mode;
+            InjectIM(mode);
+            last_im = true_time;
+            loops_since_im = 0;
+        }
+
+        if (0 == last_tc || true_time - last_tc >= TC_INTERVAL_S) {
+            InjectTC("1;");
+            last_tc = true_time;
+            tcs_sent++;
+        }
+
+        while (pending_acks > 0) {
+            InjectAck();
+            pending_acks--;
+            tms_acked++;
+        }
+    }
+
+    // collect the TMs sent in a loop, to be acknowledged at the start of the next
+    void CollectTM()
+    {
+        size_t pos = 0;
+
+        while (std::string::npos != (pos = zephyr_stream.tx_data.find("<TM>", pos))) {
+            tms_received++;
+            if (in_contact) pending_acks++;
+            pos += 4;
+        }
+
+        zephyr_stream.tx_data.clear();
+    }
+
+    // record the traffic as a capture for strato_replay
+    FILE * capture = NULL;
+
+    bool in_contact = true;
+    bool gps_sent = false;
+    InstMode_t commanded = MODE_STANDBY;
+    uint32_t loops_since_im = 0;
+    time_t outage_start = 0;
+    uint32_t outages = 0;
+    uint32_t tcs_sent = 0;
+    uint32_t tms_received = 0;
+    uint32_t tms_acked = 0;
+
+private:
+    void Send(const char * msg)
+    {
+        zephyr_stream.Inject(msg);
+
+        if (NULL == capture) return;
+
+        uint32_t capture_ms = (uint32_t) (sim_clock.ElapsedMicros() / 1000ULL);
+        if (capture_ms != last_capture_ms) fprintf(capture, "@%u\n", capture_ms);
+        last_capture_ms = capture_ms;
+        fputs(msg, capture);
+    }
+
+    void InjectGPS(time_t gps_time)
+    {
+        char msg[256];
+        TimeElements tm;
+        breakTime(gps_time, tm);
+        snprintf(msg, sizeof(msg), "<GPS><Msg>%u</Msg><Date>%u/%u/%u</Date><Time>%u:%u:%u</Time>"
+                 "<Lon>-105.2</Lon><Lat>40.0</Lat><Alt>18500.0</Alt><SZA>45.5</SZA><Quality>3</Quality></GPS><CRC>0</CRC><END>\n",
+                 ++msg_id, tm.Year + 1970, tm.Month, tm.Day, tm.Hour, tm.Minute, tm.Second);
+        Send(msg);
+    }
+
+    void InjectIM(InstMode_t mode)
+    {
+        char msg[128];
+        snprintf(msg, sizeof(msg), "<IM><Msg>%u</Msg><Inst>RACHuTS</Inst><Mode>%s</Mode></IM><CRC>0</CRC><END>\n",
+                 ++msg_id, (MODE_FLIGHT == mode) ? "FL" : "LP");
+        Send(msg);
+    }
+
+    void InjectTC(const char * payload)
+    {
+        char msg[256];
+        snprintf(msg, sizeof(msg), "<TC><Msg>%u</Msg><Inst>RACHuTS</Inst><Length>%u</Length></TC><CRC>0</CRC>"
+                 "<START>%s</START><CRC>0</CRC><END>\n", ++msg_id, (unsigned) strlen(payload), payload);
+        Send(msg);
+    }
+
+    void InjectAck()
+    {
+        char msg[128];
+        snprintf(msg, sizeof(msg), "<TMAck><Msg>%u</Msg><Inst>RACHuTS</Inst><Ack>ACK</Ack></TMAck><CRC>0</CRC><END>\n", ++msg_id);
+        Send(msg);
+    }
+
+    time_t last_gps = 0;
+    time_t last_im = 0;
+    time_t last_tc = 0;
+    uint32_t pending_acks = 0;
+    uint32_t msg_id = 0;
+    uint32_t last_capture_ms = 0xFFFFFFFF;
+};
+
+// Simulation -----------------------------------------------
+
+static uint64_t nanos()
+{
+    return (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int main(int argc, char ** argv)
+{
+    uint32_t days = 3;
+    int32_t drift_ppm = 250;
+    const char * capture_file = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (0 == strcmp(argv[i], "-d") && i + 1 < argc) {
+            days = (uint32_t) strtoul(argv[++i], NULL, 10);
+        } else if (0 == strcmp(argv[i], "-p") && i + 1 < argc) {
+            drift_ppm = (int32_t) strtol(argv[++i], NULL, 10);
+        } else if (0 == strcmp(argv[i], "-w") && i + 1 < argc) {
+            capture_file = argv[++i];
+        } else if (0 == strcmp(argv[i], "-v")) {
+            verbose = true;
+        } else {
+            printf("usage: %s [-d days] [-p drift ppm] [-w capture] [-v]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    // the onboard clock starts right and drifts until GPS corrects it
+    sim_clock.SetTime(FLIGHT_START);
+    sim_clock.SetDrift(drift_ppm);
+    SetStratoClock(&sim_clock);
+
+    setenv("STRATO_SD_ROOT", "flight_sim_sd", 1);
+
+    SimInstrument inst;
+    Gondola gondola;
+    uint64_t end_us = (uint64_t) days * SECS_PER_DAY * 1000000ULL;
+    uint32_t loops = 0;
+    uint32_t corrections = 0;
+    uint32_t safety_checked = 0;
+
+    if (NULL != capture_file && NULL == (gondola.capture = fopen(capture_file, "w"))) {
+        printf("can't write %s\n", capture_file);
+        return 1;
+    }
+
+    inst.InitializeCore();
+    inst.InstrumentSetup();
+    zephyr_stream.capture = true;
+
+    uint64_t wall_start = nanos();
+
+    while (sim_clock.ElapsedMicros() < end_us) {
+        uint32_t loop_start = StratoMillis();
+        uint32_t elapsed = 0;
+        time_t true_time = TrueTime();
+        time_t before = 0;
+        IdleWake_t wake = IDLE_WAKE_TIMEOUT;
+
+        loops++;
+        gondola.Service(true_time);
+
+        before = StratoNow();
+        inst.RunRouter();
+        if (StratoNow() != before) corrections++;
+
+        // a GPS message leaves the onboard clock within the allowed drift
+        if (gondola.gps_sent && (StratoNow() - true_time > MAX_TIME_DRIFT + 1 || true_time - StratoNow() > MAX_TIME_DRIFT + 1)) {
+            Fail("onboard time off by %ld s after GPS", (long) (StratoNow() - true_time));
+        }
+
+        inst.RunMode();
+        inst.RunScheduler();
+        inst.RunTasks();
+        inst.RunSDWriter();
+        inst.RunInstrumentLoop();
+        inst.KickWatchdog();
+
+        gondola.CollectTM();
+
+        // the commanded mode is running once the IM has been routed and the mode switched
+        if (gondola.in_contact && gondola.loops_since_im >= 2 && inst.running_mode != gondola.commanded) {
+            Fail("mode %u running, %u commanded", inst.running_mode, gondola.commanded);
+        }
+
+        // each outage ends in safety mode, entered at the Zephyr timeout (the last message was up to a GPS interval earlier)
+        if (inst.safety_entries > safety_checked) {
+            time_t since_outage = inst.safety_entered - gondola.outage_start;
+            safety_checked = inst.safety_entries;
+
+            if (gondola.in_contact || since_outage < ZEPHYR_TIMEOUT - GPS_INTERVAL_S - MAX_TIME_DRIFT - 1
+                || since_outage > ZEPHYR_TIMEOUT + MAX_TIME_DRIFT + 1) {
+                Fail("safety mode entered %ld s into the outage", (long) since_outage);
+            }
+        }
+
+        // sleep out the loop period, waking for high-res actions and starting the next loop for anything else
+        while ((elapsed = StratoMillis() - loop_start) < LOOP_MS) {
+            wake = inst.Idle(LOOP_MS - elapsed);
+            if (IDLE_WAKE_HIGHRES == wake) {
+                inst.RunHighResScheduler();
+            } else if (IDLE_WAKE_TIMEOUT != wake) {
+                break;
+            }
+        }
+    }
+
+    double wall_s = (double) (nanos() - wall_start) / 1e9;
+    double sim_s = (double) sim_clock.ElapsedMicros() / 1e6;
+    const PhaseStats_t & busy = inst.Profiler().GetPhase(PHASE_LOOP);
+
+    if (inst.safety_entries != gondola.outages) Fail("%u safety entries for %u outages", inst.safety_entries, gondola.outages);
+    if (inst.tc_count != gondola.tcs_sent) Fail("%u TCs run of %u sent", inst.tc_count, gondola.tcs_sent);
+    if (0 == inst.warmups || 0 == inst.samples || 0 == inst.pulses) Fail("flight mode never measured");
+    if (0 != inst.late_pulses) Fail("%u late high-res actions", inst.late_pulses);
+
+    // every TM goes through the TM manager, with one in flight, so every ack matches a TM
+    const TMStats_t & tm = inst.GetTMStats();
+    if (tm.sent + tm.retried != gondola.tms_received) Fail("%u TMs received of %u sent", gondola.tms_received, tm.sent + tm.retried);
+    if (tm.acked != gondola.tms_acked || 0 != tm.unmatched_acks) Fail("%u TMs acked of %u acks", tm.acked, gondola.tms_acked);
+
+    printf("Flight simulation: %u days, clock drift %d ppm\n", days, drift_ppm);
+    printf("  %.0f s simulated in %.3f s (%.0fx real time), %u loops (%.0f loops/s)\n",
+           sim_s, wall_s, wall_s > 0 ? sim_s / wall_s : 0.0, loops, wall_s > 0 ? loops / wall_s : 0.0);
+    printf("  modes: %u switches, %u safety timeouts for %u outages, %u flight warmups\n",
+           inst.mode_switches, inst.safety_entries, gondola.outages, inst.warmups);
+    printf("  time: %u corrections\n", corrections);
+    printf("  actions: %u HK, %u samples, %u high-res (%u late)\n", inst.hk_count, inst.samples, inst.pulses, inst.late_pulses);
+    printf("  zephyr: %u TCs run of %u, %u TMs received, %u acked\n",
+           inst.tc_count, gondola.tcs_sent, gondola.tms_received, gondola.tms_acked);
+    printf("  TM manager: %u sent, %u retried (%u timeouts), %u dropped, %u rejected (%u HK), max %u queued\n",
+           tm.sent, tm.retried, tm.timeouts, tm.dropped, tm.rejected, inst.hk_rejected, (unsigned int) tm.max_queued);
+    printf("  busy per loop: mean %.1f us, max %u us\n",
+           busy.count ? (double) busy.total_us / busy.count : 0.0, busy.max_us);
+
+    SetStratoClock(NULL);
+    if (NULL != gondola.capture) fclose(gondola.capture);
+
+    if (failures) {
+        printf("%u check(s) failed\n", failures);
+        return 1;
+    }
+
+    printf("all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,579 @@
+/*
+ *  StratoBench.cpp
+ *  Author:  StratoCore contributors
+ *  Created: October 2026
+ *
+ *  This file implements a host-side benchmark of the StratoCore control loop.
+ *  A dummy instrument derived from StratoCore is driven with synthetic Zephyr
+ *  traffic, and the cost of each public loop function is reported per call
+ *  and per loop phase against the 1 s loop and 10 s watchdog budgets.
+ *
+ *  Usage: strato_bench [-n iterations] [-l loops] [-r high-res ms] [-i idle ms]
+ */
+
+#include "StratoCore.h"
+#include "HostStream.h"
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#define LOOP_PERIOD_US      1000000ULL  // 1 Hz cyclic executive
+#define WATCHDOG_PERIOD_US  10000000ULL // 10 s watchdog
+
+// actions used by the dummy instrument
+enum BenchAction_t {
+    ACTION_NONE = NO_SCHEDULED_ACTION,
+    ACTION_HOUSEKEEPING,
+    ACTION_FAR_FUTURE,
+    ACTION_SAMPLE,
+    ACTION_MOTOR
+};
+
+static HostStream zephyr_stream;
+static HostStream debug_stream;
+
+static uint64_t nanos()
+{
+    return (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Dummy instrument -----------------------------------------
+
+class BenchInstrument : public StratoCore {
+public:
+    BenchInstrument() : StratoCore(&zephyr_stream, RACHUTS, &debug_stream) { }
+
+    void InstrumentSetup() { }
+
+    void InstrumentLoop()
+    {
+        loop_count++;
+
+        // a 1 kB TM record to the SD log, as a science instrument would
+        if (log_tm) {
+            zephyrTX.clearTm();
+            for (uint16_t i = 0; i < 256; i++) {
+                zephyrTX.addTm((uint32_t) (loop_count + i));
+            }
+            WriteFileTM("BENCH");
+        }
+    }
+
+    // expose protected members for the benchmark
+    StratoScheduler & Scheduler() { return scheduler; }
+    StratoHighResScheduler & HighResScheduler() { return highres_scheduler; }
+    StratoProfiler & Profiler() { return profiler; }
+    StratoIdle & IdleStats() { return idle; }
+
+    uint32_t loop_count = 0;
+    uint32_t action_count = 0;
+    uint32_t tc_count = 0;
+    uint32_t highres_count = 0;
+    bool log_tm = false;
+
+private:
+    // each mode walks through a couple of substates, as real instruments do
+    void StandbyMode() { ModeBody(); }
+    void FlightMode() { ModeBody(); }
+    void LowPowerMode() { ModeBody(); }
+    void SafetyMode() { ModeBody(); }
+    void EndOfFlightMode() { ModeBody(); }
+
+    void ModeBody()
+    {
+        switch (inst_substate) {
+        case MODE_ENTRY:
+            inst_substate = 1;
+            break;
+        case 1:
+            inst_substate = 2;
+            break;
+        case MODE_SHUTDOWN:
+        case MODE_EXIT:
+        default:
+            break;
+        }
+    }
+
+    void TCHandler(Telecommand_t telecommand)
+    {
+        (void) telecommand;
+        tc_count++;
+    }
+
+    void ActionHandler(uint8_t action)
+    {
+        (void) action;
+        action_count++;
+    }
+
+    void HighResActionHandler(uint8_t action, uint32_t lateness_ms)
+    {
+        (void) action;
+        (void) lateness_ms;
+        highres_count++;
+    }
+};
+
+// Statistics ---------------------------------------------
+
+struct Samples {
+    std::vector<uint64_t> ns;
+
+    void Add(uint64_t sample) { ns.push_back(sample); }
+
+    uint64_t Percentile(double p)
+    {
+        if (ns.empty()) return 0;
+        std::vector<uint64_t> sorted(ns);
+        std::sort(sorted.begin(), sorted.end());
+        size_t index = (size_t) (p * (sorted.size() - 1));
+        return sorted[index];
+    }
+
+    double Mean()
+    {
+        if (ns.empty()) return 0;
+        double sum = 0;
+        for (size_t i = 0; i < ns.size(); i++) sum += (double) ns[i];
+        return sum / ns.size();
+    }
+
+    uint64_t Max() { return ns.empty() ? 0 : *std::max_element(ns.begin(), ns.end()); }
+};
+
+static void PrintHeader(const char * title)
+{
+    printf("\n%s\n", title);
+    printf("  %-36s %10s %10s %10s %10s\n", "call", "mean(ns)", "p50(ns)", "p99(ns)", "max(ns)");
+}
+
+static void PrintRow(const char * name, Samples & samples)
+{
+    printf("  %-36s %10.0f %10llu %10llu %10llu\n", name, samples.Mean(),
+           (unsigned long long) samples.Percentile(0.50),
+           (unsigned long long) samples.Percentile(0.99),
+           (unsigned long long) samples.Max());
+}
+
+// Zephyr traffic -----------------------------------------
+
+static uint32_t msg_id = 0;
+
+static void InjectIM(const char * mode)
+{
+    char msg[128];
+    snprintf(msg, sizeof(msg), "<IM><Msg>%u</Msg><Inst>RACHuTS</Inst><Mode>%s</Mode></IM><CRC>0</CRC><END>\n",
+             ++msg_id, mode);
+    zephyr_stream.Inject(msg);
+}
+
+static void InjectGPS(time_t gps_time)
+{
+    char msg[256];
+    TimeElements tm;
+    breakTime(gps_time, tm);
+    snprintf(msg, sizeof(msg), "<GPS><Msg>%u</Msg><Date>%u/%u/%u</Date><Time>%u:%u:%u</Time>"
+             "<Lon>-105.2</Lon><Lat>40.0</Lat><Alt>18500.0</Alt><SZA>45.5</SZA><Quality>3</Quality></GPS><CRC>0</CRC><END>\n",
+             ++msg_id, tm.Year + 1970, tm.Month, tm.Day, tm.Hour, tm.Minute, tm.Second);
+    zephyr_stream.Inject(msg);
+}
+
+static void InjectTC(const char * payload)
+{
+    char msg[256];
+    snprintf(msg, sizeof(msg), "<TC><Msg>%u</Msg><Inst>RACHuTS</Inst><Length>%u</Length></TC><CRC>0</CRC>"
+             "<START>%s</START><CRC>0</CRC><END>\n", ++msg_id, (unsigned) strlen(payload), payload);
+    zephyr_stream.Inject(msg);
+}
+
+static void InjectAck(const char * type, bool ack)
+{
+    char msg[128];
+    snprintf(msg, sizeof(msg), "<%s><Msg>%u</Msg><Inst>RACHuTS</Inst><Ack>%s</Ack></%s><CRC>0</CRC><END>\n",
+             type, ++msg_id, ack ? "ACK" : "NAK", type);
+    zephyr_stream.Inject(msg);
+}
+
+// Benchmarks ---------------------------------------------
+
+static void BenchRouter(BenchInstrument & inst, uint32_t iterations)
+{
+    Samples idle, gps, im, tc, ack;
+
+    PrintHeader("RunRouter per-call latency");
+
+    for (uint32_t i = 0; i < iterations; i++) {
+        uint64_t start = nanos();
+        inst.RunRouter();
+        idle.Add(nanos() - start);
+    }
+    PrintRow("RunRouter (no input)", idle);
+
+    for (uint32_t i = 0; i < iterations; i++) {
+        InjectGPS(now());
+        uint64_t start = nanos();
+        inst.RunRouter();
+        gps.Add(nanos() - start);
+    }
+    PrintRow("RunRouter (GPS, no drift)", gps);
+
+    for (uint32_t i = 0; i < iterations; i++) {
+        InjectIM((i % 2) ? "SB" : "FL");
+        uint64_t start = nanos();
+        inst.RunRouter();
+        im.Add(nanos() - start);
+        inst.RunMode();
+    }
+    PrintRow("RunRouter (IM + IMAck)", im);
+
+    for (uint32_t i = 0; i < iterations; i++) {
+        InjectTC("1,2.5;");
+        uint64_t start = nanos();
+        inst.RunRouter();
+        tc.Add(nanos() - start);
+    }
+    PrintRow("RunRouter (TC + TCAck + dispatch)", tc);
+
+    for (uint32_t i = 0; i < iterations; i++) {
+        InjectAck("TMAck", true);
+        uint64_t start = nanos();
+        inst.RunRouter();
+        ack.Add(nanos() - start);
+    }
+    PrintRow("RunRouter (TMAck)", ack);
+}
+
+static void BenchMode(BenchInstrument & inst, uint32_t iterations)
+{
+    Samples steady, change;
+
+    PrintHeader("RunMode per-call latency");
+
+    for (uint32_t i = 0; i < iterations; i++) {
+        uint64_t start = nanos();
+        inst.RunMode();
+        steady.Add(nanos() - start);
+    }
+    PrintRow("RunMode (steady state)", steady);
+
+    for (uint32_t i = 0; i < iterations; i++) {
+        InjectIM((i % 2) ? "SB" : "FL");
+        inst.RunRouter();
+        uint64_t start = nanos();
+        inst.RunMode();
+        change.Add(nanos() - start);
+    }
+    PrintRow("RunMode (mode switch)", change);
+}
+
+static void BenchScheduler(BenchInstrument & inst, uint32_t iterations)
+{
+    StratoScheduler & scheduler = inst.Scheduler();
+    const uint16_t depths[] = {0, MAX_SCHEDULE_SIZE / 2, MAX_SCHEDULE_SIZE - 1};
+    char name[64];
+
+    PrintHeader("Scheduler per-call latency");
+
+    for (uint8_t d = 0; d < sizeof(depths) / sizeof(depths[0]); d++) {
+        Samples add, add_last, run, empty, cancel, cancel_id, reschedule, update;
+        uint16_t depth = depths[d];
+
+        scheduler.ClearSchedule();
+        for (uint16_t i = 0; i < depth; i++) {
+            scheduler.AddAction(ACTION_FAR_FUTURE, (time_t) (100000 + i));
+        }
+
+        for (uint32_t i = 0; i < iterations; i++) {
+            uint64_t start = nanos();
+            scheduler.AddAction(ACTION_HOUSEKEEPING, (time_t) 0);
+            add.Add(nanos() - start);
+
+            start = nanos();
+            inst.RunScheduler();
+            run.Add(nanos() - start);
+
+            start = nanos();
+            inst.RunScheduler();
+            empty.Add(nanos() - start);
+        }
+
+        // worst case for a sorted insert: the new action is later than everything queued
+        for (uint32_t i = 0; i < iterations; i++) {
+            scheduler.ClearSchedule();
+            for (uint16_t j = 0; j < depth; j++) {
+                scheduler.AddAction(ACTION_FAR_FUTURE, (time_t) (100000 + j));
+            }
+
+            uint64_t start = nanos();
+            scheduler.AddAction(ACTION_FAR_FUTURE, (time_t) 200000);
+            add_last.Add(nanos() - start);
+        }
+
+        // cancel and reschedule an action in the middle of the schedule
+        scheduler.ClearSchedule();
+        for (uint16_t j = 0; j < depth; j++) {
+            scheduler.AddAction(ACTION_FAR_FUTURE, (time_t) (100000 + j));
+        }
+
+        for (uint32_t i = 0; i < iterations; i++) {
+            ScheduleHandle_t handle = scheduler.AddAction(ACTION_HOUSEKEEPING, (time_t) (100000 + depth / 2));
+
+            uint64_t start = nanos();
+            scheduler.Reschedule(handle, (time_t) (100000 + depth / 4));
+            reschedule.Add(nanos() - start);
+
+            start = nanos();
+            scheduler.CancelAction(handle);
+            cancel.Add(nanos() - start);
+
+            scheduler.AddAction(ACTION_HOUSEKEEPING, (time_t) (100000 + depth / 2));
+
+            start = nanos();
+            scheduler.CancelAction((uint8_t) ACTION_HOUSEKEEPING);
+            cancel_id.Add(nanos() - start);
+        }
+
+        // GPS time correction
+        for (uint32_t i = 0; i < iterations; i++) {
+            uint64_t start = nanos();
+            scheduler.UpdateScheduleTime((i % 2) ? -5 : 5);
+            update.Add(nanos() - start);
+        }
+
+        snprintf(name, sizeof(name), "AddAction (first, depth %u)", depth);
+        PrintRow(name, add);
+        snprintf(name, sizeof(name), "AddAction (last, depth %u)", depth);
+        PrintRow(name, add_last);
+        snprintf(name, sizeof(name), "Reschedule (handle, depth %u)", depth);
+        PrintRow(name, reschedule);
+        snprintf(name, sizeof(name), "CancelAction (handle, depth %u)", depth);
+        PrintRow(name, cancel);
+        snprintf(name, sizeof(name), "CancelAction (action ID, depth %u)", depth);
+        PrintRow(name, cancel_id);
+        snprintf(name, sizeof(name), "UpdateScheduleTime (depth %u)", depth);
+        PrintRow(name, update);
+        snprintf(name, sizeof(name), "RunScheduler (1 due, depth %u)", depth);
+        PrintRow(name, run);
+        snprintf(name, sizeof(name), "RunScheduler (none due, depth %u)", depth);
+        PrintRow(name, empty);
+    }
+
+    scheduler.ClearSchedule();
+}
+
+// service 100 Hz and 20 Hz high-res actions in a tight loop between 1 Hz phases (real time)
+static void BenchHighRes(BenchInstrument & inst, uint32_t duration_ms)
+{
+    StratoHighResScheduler & highres = inst.HighResScheduler();
+    Samples idle, service;
+
+    highres.ClearSchedule();
+    highres.ResetStats();
+    highres.AddPeriodicAction(ACTION_SAMPLE, 10, 10);
+    highres.AddPeriodicAction(ACTION_MOTOR, 50, 5);
+
+    uint32_t start_ms = millis();
+    uint32_t last_loop = start_ms;
+    while (millis() - start_ms < duration_ms) {
+        uint32_t before = inst.highres_count;
+        uint64_t start = nanos();
+        inst.RunHighResScheduler();
+        uint64_t elapsed = nanos() - start;
+
+        if (inst.highres_count != before) {
+            service.Add(elapsed);
+        } else if (idle.ns.size() < 100000) {
+            idle.Add(elapsed);
+        }
+
+        // the 1 Hz phases every second, as in the main loop
+        if (millis() - last_loop >= 1000) {
+            last_loop += 1000;
+            inst.RunRouter();
+            inst.RunMode();
+            inst.RunScheduler();
+            inst.RunTasks();
+            inst.RunSDWriter();
+            inst.RunInstrumentLoop();
+            inst.KickWatchdog();
+        }
+    }
+
+    const HighResStats_t & stats = highres.GetStats();
+
+    PrintHeader("High-res scheduler (100 Hz + 20 Hz periodic actions)");
+    PrintRow("RunHighResScheduler (none due)", idle);
+    PrintRow("RunHighResScheduler (action due)", service);
+    printf("\n  fired: %u in %u ms, late (>%u ms): %u, mean lateness: %.3f ms, max: %u ms (action %u)\n",
+           stats.fired, duration_ms, HIGHRES_LATE_MS, stats.late,
+           stats.fired ? (double) stats.lateness_total / stats.fired : 0.0,
+           stats.lateness_max, stats.lateness_max_action);
+
+    highres.ClearSchedule();
+}
+
+// the same 1 Hz loop and high-res actions, sleeping in Idle between them instead of spinning (real time)
+static void BenchIdle(BenchInstrument & inst, uint32_t duration_ms)
+{
+    StratoHighResScheduler & highres = inst.HighResScheduler();
+    uint32_t loops = 0;
+
+    highres.ClearSchedule();
+    highres.ResetStats();
+    highres.AddPeriodicAction(ACTION_SAMPLE, 10, 10);
+    highres.AddPeriodicAction(ACTION_MOTOR, 50, 5);
+    inst.IdleStats().Reset();
+
+    uint32_t start_ms = millis();
+    uint32_t last_loop = start_ms;
+    while (millis() - start_ms < duration_ms) {
+        if (millis() - last_loop >= 1000) {
+            last_loop += 1000;
+            loops++;
+            inst.RunRouter();
+            inst.RunMode();
+            inst.RunScheduler();
+            inst.RunTasks();
+            inst.RunSDWriter();
+            inst.RunInstrumentLoop();
+            inst.KickWatchdog();
+        }
+
+        inst.RunHighResScheduler();
+
+        uint32_t since_loop = millis() - last_loop;
+        inst.Idle((since_loop < 1000) ? 1000 - since_loop : 0);
+    }
+
+    const HighResStats_t & stats = highres.GetStats();
+    const IdleStats_t & idle_stats = inst.GetIdleStats();
+    uint16_t duty_cycle = inst.IdleStats().DutyCycle();
+
+    printf("\nIdle between phases (100 Hz + 20 Hz periodic actions, %u loops in %u ms)\n", loops, duration_ms);
+    printf("  awake %u.%u%% of the time, %u sleeps, max %u ms\n", duty_cycle / 10, duty_cycle % 10,
+           idle_stats.sleeps, idle_stats.max_sleep_ms);
+    printf("  wakes:");
+    for (uint8_t i = 0; i < NUM_IDLE_WAKES; i++) {
+        printf(" %u %s%s", idle_stats.wakes[i], StratoIdle::WakeName(i), (i + 1 < NUM_IDLE_WAKES) ? "," : "\n");
+    }
+    printf("  fired: %u, late (>%u ms): %u, mean lateness: %.3f ms, max: %u ms\n",
+           stats.fired, HIGHRES_LATE_MS, stats.late,
+           stats.fired ? (double) stats.lateness_total / stats.fired : 0.0, stats.lateness_max);
+
+    highres.ClearSchedule();
+}
+
+// simulate the main loop with representative traffic and time each phase
+static void BenchLoop(BenchInstrument & inst, uint32_t loops)
+{
+    enum { BENCH_ROUTER, BENCH_MODE, BENCH_SCHEDULER, BENCH_TASKS, BENCH_SD, BENCH_INSTRUMENT, BENCH_WATCHDOG, NUM_BENCH_PHASES };
+    const char * phase_names[NUM_BENCH_PHASES] = {"RunRouter", "RunMode", "RunScheduler", "RunTasks (none)", "RunSDWriter", "InstrumentLoop (1 kB TM log)", "KickWatchdog"};
+    Samples phases[NUM_BENCH_PHASES];
+    Samples total;
+
+    inst.Profiler().Reset();
+    inst.log_tm = true;
+
+    for (uint32_t i = 0; i < loops; i++) {
+        // a GPS every 10 loops, a TC every 7, a mode change every 60, housekeeping every 5
+        if (0 == i % 10) InjectGPS(now());
+        if (0 == i % 7) InjectTC("0;1,5;");
+        if (0 == i % 60) InjectIM((i / 60) % 2 ? "SB" : "FL");
+        if (0 == i % 5) inst.Scheduler().AddAction(ACTION_HOUSEKEEPING, (time_t) 0);
+
+        uint64_t t0 = nanos();
+        inst.RunRouter();
+        uint64_t t1 = nanos();
+        inst.RunMode();
+        uint64_t t2 = nanos();
+        inst.RunScheduler();
+        uint64_t t3 = nanos();
+        inst.RunTasks();
+        uint64_t t4 = nanos();
+        inst.RunSDWriter();
+        uint64_t t5 = nanos();
+        inst.RunInstrumentLoop();
+        uint64_t t6 = nanos();
+        inst.KickWatchdog();
+        uint64_t t7 = nanos();
+
+        phases[BENCH_ROUTER].Add(t1 - t0);
+        phases[BENCH_MODE].Add(t2 - t1);
+        phases[BENCH_SCHEDULER].Add(t3 - t2);
+        phases[BENCH_TASKS].Add(t4 - t3);
+        phases[BENCH_SD].Add(t5 - t4);
+        phases[BENCH_INSTRUMENT].Add(t6 - t5);
+        phases[BENCH_WATCHDOG].Add(t7 - t6);
+        total.Add(t7 - t0);
+    }
+
+    inst.log_tm = false;
+
+    printf("\nLoop-phase timing over %u simulated loops\n", loops);
+    printf("  %-36s %10s %10s %10s %10s\n", "phase", "mean(ns)", "p50(ns)", "p99(ns)", "max(ns)");
+    for (int p = 0; p < NUM_BENCH_PHASES; p++) {
+        PrintRow(phase_names[p], phases[p]);
+    }
+    PrintRow("total loop", total);
+
+    // the built-in profiler's view of the same loops (microsecond resolution)
+    const PhaseStats_t & busy = inst.Profiler().GetPhase(PHASE_LOOP);
+    printf("\n  profiler: %u loops, busy mean %u us, max %u us, max kick interval %u us\n",
+           busy.count, busy.count ? (uint32_t) (busy.total_us / busy.count) : 0,
+           busy.max_us, inst.Profiler().MaxKickInterval());
+
+    const SDWriteStats_t & sd_stats = GetSDWriteStats();
+    printf("  SD writer: %u bytes written, max queue %u bytes, %u phases over budget, %u bytes dropped\n",
+           sd_stats.bytes_written, sd_stats.max_queue_depth, sd_stats.budget_exhausted, sd_stats.bytes_dropped);
+
+    printf("\n  worst loop: %.4f%% of the 1 s loop budget, %.5f%% of the 10 s watchdog\n",
+           100.0 * total.Max() / (LOOP_PERIOD_US * 1000.0),
+           100.0 * total.Max() / (WATCHDOG_PERIOD_US * 1000.0));
+}
+
+int main(int argc, char ** argv)
+{
+    uint32_t iterations = 10000;
+    uint32_t loops = 3600;
+    uint32_t highres_ms = 2000;
+    uint32_t idle_ms = 3000;
+
+    for (int i = 1; i < argc; i++) {
+        if (0 == strcmp(argv[i], "-n") && i + 1 < argc) {
+            iterations = (uint32_t) strtoul(argv[++i], NULL, 10);
+        } else if (0 == strcmp(argv[i], "-l") && i + 1 < argc) {
+            loops = (uint32_t) strtoul(argv[++i], NULL, 10);
+        } else if (0 == strcmp(argv[i], "-r") && i + 1 < argc) {
+            highres_ms = (uint32_t) strtoul(argv[++i], NULL, 10);
+        } else if (0 == strcmp(argv[i], "-i") && i + 1 < argc) {
+            idle_ms = (uint32_t) strtoul(argv[++i], NULL, 10);
+        } else {
+            printf("usage: %s [-n iterations] [-l loops] [-r high-res ms] [-i idle ms]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    // start from a realistic GPS time so drift corrections aren't triggered by the benchmark
+    setTime(1561000000);
+
+    BenchInstrument inst;
+    inst.InitializeCore();
+    inst.InstrumentSetup();
+
+    printf("StratoCore host benchmark: %u iterations per call, %u loops\n", iterations, loops);
+
+    BenchRouter(inst, iterations);
+    BenchMode(inst, iterations);
+    BenchScheduler(inst, iterations);
+    BenchHighRes(inst, highres_ms);
+    BenchIdle(inst, idle_ms);
+    BenchLoop(inst, loops);
+
+    printf("\n  zephyr bytes out: %llu, ground port bytes out: %llu\n",
+           (unsigned long long) zephyr_stream.bytes_written,
+           (unsigned long long) debug_stream.bytes_written);
+
+    return 0;
+}
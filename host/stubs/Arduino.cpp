@@ -0,0 +1,141 @@
+/*
+ *  Arduino.cpp (host stand-in)
+ *  Author:  StratoCore contributors
+ *  Created: October 2026
+ *
+ *  This file implements the host replacement for the Teensyduino core
+ */
+
+#include "Arduino.h"
+#include "HardwareSerial.h"
+#include <stdarg.h>
+#include <time.h>
+
+HostSerial Serial;
+
+volatile uint8_t RCM_SRS0 = 0;
+volatile uint16_t WDOG_UNLOCK = 0;
+volatile uint16_t WDOG_PRESC = 0;
+volatile uint16_t WDOG_TOVALH = 0;
+volatile uint16_t WDOG_TOVALL = 0;
+volatile uint16_t WDOG_STCTRLH = 0;
+volatile uint16_t WDOG_REFRESH = 0;
+volatile uint32_t SCB_AIRCR = 0;
+
+// Timing -------------------------------------------------
+
+static uint64_t monotonic_us()
+{
+    static uint64_t start_us = 0;
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    uint64_t us = (uint64_t) ts.tv_sec * 1000000ULL + (uint64_t) ts.tv_nsec / 1000ULL;
+
+    // like the Teensy, count from "boot"
+    if (0 == start_us) start_us = us;
+
+    return us - start_us;
+}
+
+uint32_t millis()
+{
+    return (uint32_t) (monotonic_us() / 1000ULL);
+}
+
+uint32_t micros()
+{
+    return (uint32_t) monotonic_us();
+}
+
+void delay(uint32_t ms)
+{
+    delayMicroseconds(ms * 1000);
+}
+
+void delayMicroseconds(uint32_t us)
+{
+    struct timespec ts;
+    ts.tv_sec = us / 1000000;
+    ts.tv_nsec = (long) (us % 1000000) * 1000L;
+    nanosleep(&ts, NULL);
+}
+
+void hostIdleWait(uint32_t max_ms)
+{
+    if (0 == max_ms) return;
+
+    delayMicroseconds(1000 - micros() % 1000);
+}
+
+// Print --------------------------------------------------
+
+size_t Print::write(const uint8_t * buffer, size_t size)
+{
+    size_t count = 0;
+    while (size--) count += write(*buffer++);
+    return count;
+}
+
+size_t Print::print(long n, int base)
+{
+    if (n < 0 && DEC == base) {
+        return print('-') + print((unsigned long) -n, base);
+    }
+    return print((unsigned long) n, base);
+}
+
+size_t Print::print(unsigned long n, int base)
+{
+    char buf[8 * sizeof(long) + 1];
+    char * str = &buf[sizeof(buf) - 1];
+
+    if (base < 2) base = DEC;
+
+    *str = '\0';
+    do {
+        unsigned long digit = n % base;
+        n /= base;
+        *--str = (char) ((digit < 10) ? digit + '0' : digit + 'A' - 10);
+    } while (n);
+
+    return write(str);
+}
+
+size_t Print::print(double n, int digits)
+{
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%.*f", digits, n);
+    return write(buf);
+}
+
+int Print::printf(const char * format, ...)
+{
+    char buf[256];
+    va_list args;
+
+    va_start(args, format);
+    int len = vsnprintf(buf, sizeof(buf), format, args);
+    va_end(args);
+
+    if (len < 0) return len;
+    if (len >= (int) sizeof(buf)) len = sizeof(buf) - 1;
+
+    return (int) write((const uint8_t *) buf, len);
+}
+
+// HostSerial ---------------------------------------------
+
+size_t HostSerial::write(uint8_t b)
+{
+    bytes_written++;
+    if (echo) fputc(b, stdout);
+    return 1;
+}
+
+size_t HostSerial::write(const uint8_t * buffer, size_t size)
+{
+    bytes_written += size;
+    if (echo) fwrite(buffer, 1, size, stdout);
+    return size;
+}
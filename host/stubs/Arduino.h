@@ -0,0 +1,90 @@
+/*
+ *  Arduino.h (host stand-in)
+ *  Author:  StratoCore contributors
+ *  Created: October 2026
+ *
+ *  This file declares a minimal host-side replacement for the Teensyduino
+ *  core so that StratoCore can be compiled and benchmarked on Linux. Only
+ *  the subset of the Arduino/Teensy API used by StratoCore is provided.
+ */
+
+#ifndef ARDUINO_H
+#define ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+// timing
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+
+// stands in for the Teensy's wait for interrupt in StratoCore::Idle: sleeps to the next 1 ms "systick"
+void hostIdleWait(uint32_t max_ms);
+#define STRATO_IDLE_WAIT(max_ms)    hostIdleWait(max_ms)
+
+// interrupts are meaningless on the host, but the calls must exist
+inline void noInterrupts() { }
+inline void interrupts() { }
+
+// Teensy 3.6 registers touched by StratoCore, backed by plain variables on the host
+extern volatile uint8_t RCM_SRS0;
+extern volatile uint16_t WDOG_UNLOCK;
+extern volatile uint16_t WDOG_PRESC;
+extern volatile uint16_t WDOG_TOVALH;
+extern volatile uint16_t WDOG_TOVALL;
+extern volatile uint16_t WDOG_STCTRLH;
+extern volatile uint16_t WDOG_REFRESH;
+extern volatile uint32_t SCB_AIRCR;
+
+#define RCM_SRS0_WDOG       ((uint8_t) 0x20)
+#define WDOG_UNLOCK_SEQ1    ((uint16_t) 0xC520)
+#define WDOG_UNLOCK_SEQ2    ((uint16_t) 0xD928)
+
+// simplified Print class (Teensyduino Print.h)
+class Print {
+public:
+    virtual ~Print() { }
+
+    virtual size_t write(uint8_t b) = 0;
+    virtual size_t write(const uint8_t * buffer, size_t size);
+    size_t write(const char * str) { return (NULL == str) ? 0 : write((const uint8_t *) str, strlen(str)); }
+
+    virtual int availableForWrite() { return 0; }
+    virtual void flush() { }
+
+    size_t print(const char * str) { return write(str); }
+    size_t print(char c) { return write((uint8_t) c); }
+    size_t print(int n, int base = DEC) { return print((long) n, base); }
+    size_t print(unsigned int n, int base = DEC) { return print((unsigned long) n, base); }
+    size_t print(long n, int base = DEC);
+    size_t print(unsigned long n, int base = DEC);
+    size_t print(long long n, int base = DEC) { return print((long) n, base); }
+    size_t print(unsigned long long n, int base = DEC) { return print((unsigned long) n, base); }
+    size_t print(double n, int digits = 2);
+
+    size_t println() { return write((const uint8_t *) "\r\n", 2); }
+    template <typename T> size_t println(T arg) { size_t n = print(arg); return n + println(); }
+    template <typename T> size_t println(T arg, int fmt) { size_t n = print(arg, fmt); return n + println(); }
+
+    int printf(const char * format, ...) __attribute__ ((format (printf, 2, 3)));
+};
+
+// simplified Stream class (Teensyduino Stream.h)
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+};
+
+#endif /* ARDUINO_H */
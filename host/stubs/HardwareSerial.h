@@ -0,0 +1,35 @@
+/*
+ *  HardwareSerial.h (host stand-in)
+ *  Author:  StratoCore contributors
+ *  Created: October 2026
+ *
+ *  This file declares the host replacement for the Teensy USB serial port.
+ *  Output is discarded unless echo is enabled, in which case it goes to stdout.
+ */
+
+#ifndef HARDWARESERIAL_H
+#define HARDWARESERIAL_H
+
+#include "Arduino.h"
+
+class HostSerial : public Stream {
+public:
+    HostSerial() : echo(false), bytes_written(0) { }
+
+    size_t write(uint8_t b);
+    size_t write(const uint8_t * buffer, size_t size);
+    using Print::write;
+
+    int availableForWrite() { return 64; }
+
+    int available() { return 0; }
+    int read() { return -1; }
+    int peek() { return -1; }
+
+    bool echo;
+    uint32_t bytes_written;
+};
+
+extern HostSerial Serial;
+
+#endif /* HARDWARESERIAL_H */
@@ -0,0 +1,67 @@
+/*
+ *  HostStream.h
+ *  Author:  StratoCore contributors
+ *  Created: October 2026
+ *
+ *  This file declares an in-memory Stream for host builds. Bytes queued with
+ *  Inject are returned by read(), and everything written is counted and
+ *  optionally captured, so a StratoCore instance can be driven without a
+ *  Zephyr or OBC Simulator attached.
+ */
+
+#ifndef HOSTSTREAM_H
+#define HOSTSTREAM_H
+
+#include "Arduino.h"
+#include <string>
+
+class HostStream : public Stream {
+public:
+    HostStream() : capture(false), bytes_written(0), rx_index(0) { }
+
+    // queue bytes to be read back by the consumer of the stream
+    void Inject(const char * data) { rx_data.append(data); }
+    void Inject(const char * data, size_t size) { rx_data.append(data, size); }
+
+    // discard any queued and captured data
+    void Clear() { rx_data.clear(); rx_index = 0; tx_data.clear(); bytes_written = 0; }
+
+    size_t write(uint8_t b)
+    {
+        bytes_written++;
+        if (capture) tx_data.push_back((char) b);
+        return 1;
+    }
+
+    size_t write(const uint8_t * buffer, size_t size)
+    {
+        bytes_written += size;
+        if (capture) tx_data.append((const char *) buffer, size);
+        return size;
+    }
+    using Print::write;
+
+    int availableForWrite() { return 4096; }
+
+    int available() { return (int) (rx_data.size() - rx_index); }
+
+    int read()
+    {
+        if (rx_index >= rx_data.size()) return -1;
+        int c = (uint8_t) rx_data[rx_index++];
+        if (rx_index == rx_data.size()) { rx_data.clear(); rx_index = 0; }
+        return c;
+    }
+
+    int peek() { return (rx_index < rx_data.size()) ? (uint8_t) rx_data[rx_index] : -1; }
+
+    bool capture;
+    uint64_t bytes_written;
+    std::string tx_data;
+
+private:
+    std::string rx_data;
+    size_t rx_index;
+};
+
+#endif /* HOSTSTREAM_H */
@@ -0,0 +1,235 @@
+/*
+ *  SdFat.cpp (host stand-in)
+ *  Author:  StratoCore contributors
+ *  Created: October 2026
+ *
+ *  This file implements the host replacement for the SdFat library
+ */
+
+#include "SdFat.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// the build directory, so that the card doesn't land in the source tree
+#ifndef STRATO_HOST_OUTPUT_DIR
+#define STRATO_HOST_OUTPUT_DIR  "."
+#endif
+
+const char * SdHostPath(const char * path, char * out, size_t out_size)
+{
+    const char * root = getenv("STRATO_SD_ROOT");
+    if (NULL == root) root = STRATO_HOST_OUTPUT_DIR "/sd";
+
+    while ('/' == *path) path++;
+
+    if ((int) out_size <= snprintf(out, out_size, "%s/%s", root, path)) return NULL;
+
+    return out;
+}
+
+// File ---------------------------------------------------
+
+bool File::open(const char * path, oflag_t oflag)
+{
+    char host_path[256];
+    const char * mode = "rb";
+
+    if (NULL != fp || NULL == SdHostPath(path, host_path, sizeof(host_path))) return false;
+
+    bool exists = (0 == access(host_path, F_OK));
+
+    if ((oflag & O_CREAT) && (oflag & O_EXCL) && exists) return false;
+    if (!(oflag & O_CREAT) && !exists) return false;
+
+    if (oflag & O_WRITE) {
+        if (!exists || (oflag & O_TRUNC)) {
+            mode = "w+b";
+        } else {
+            mode = "r+b";
+        }
+    }
+
+    fp = fopen(host_path, mode);
+    if (NULL == fp) return false;
+
+    if (oflag & (O_AT_END | O_APPEND)) fseek(fp, 0, SEEK_END);
+
+    return true;
+}
+
+bool File::close()
+{
+    if (NULL == fp) return false;
+
+    bool ok = (0 == fclose(fp));
+    fp = NULL;
+
+    return ok;
+}
+
+bool File::sync()
+{
+    return (NULL != fp) && (0 == fflush(fp));
+}
+
+static uint32_t fail_writes = 0;
+
+void SdHostFailWrites(uint32_t count)
+{
+    fail_writes = count;
+}
+
+int File::write(const void * buf, size_t nbyte)
+{
+    if (NULL == fp) return -1;
+
+    if (fail_writes > 0) {
+        fail_writes--;
+        return -1;
+    }
+
+    return (int) fwrite(buf, 1, nbyte, fp);
+}
+
+int File::read()
+{
+    if (NULL == fp) return -1;
+
+    int c = fgetc(fp);
+
+    return (EOF == c) ? -1 : c;
+}
+
+int File::read(void * buf, size_t nbyte)
+{
+    if (NULL == fp) return -1;
+
+    return (int) fread(buf, 1, nbyte, fp);
+}
+
+int File::available()
+{
+    if (NULL == fp) return 0;
+
+    return (int) (fileSize() - curPosition());
+}
+
+bool File::seekSet(uint32_t pos)
+{
+    return (NULL != fp) && (0 == fseek(fp, (long) pos, SEEK_SET));
+}
+
+bool File::seekEnd(int32_t offset)
+{
+    return (NULL != fp) && (0 == fseek(fp, (long) offset, SEEK_END));
+}
+
+uint32_t File::curPosition()
+{
+    if (NULL == fp) return 0;
+
+    return (uint32_t) ftell(fp);
+}
+
+uint32_t File::fileSize()
+{
+    if (NULL == fp) return 0;
+
+    long pos = ftell(fp);
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fseek(fp, pos, SEEK_SET);
+
+    return (uint32_t) size;
+}
+
+bool File::truncate(uint32_t length)
+{
+    if (NULL == fp) return false;
+
+    fflush(fp);
+    if (0 != ftruncate(fileno(fp), (off_t) length)) return false;
+
+    if (curPosition() > length) seekSet(length);
+
+    return true;
+}
+
+bool File::createContiguous(const char * path, uint32_t size)
+{
+    if (!open(path, O_RDWR | O_CREAT | O_EXCL)) return false;
+
+    fflush(fp);
+    if (0 != ftruncate(fileno(fp), (off_t) size)) {
+        close();
+        return false;
+    }
+
+    return seekSet(0);
+}
+
+// SdFatSdio ----------------------------------------------
+
+bool SdFatSdio::begin()
+{
+    char host_path[256];
+
+    if (NULL == SdHostPath("", host_path, sizeof(host_path))) return false;
+
+    // the root directory stands in for the card, create it if needed
+    if (0 != ::mkdir(host_path, 0755) && EEXIST != errno) return false;
+
+    started = true;
+
+    return true;
+}
+
+File SdFatSdio::open(const char * path, oflag_t oflag)
+{
+    File file;
+
+    if (started) file.open(path, oflag);
+
+    return file;
+}
+
+bool SdFatSdio::exists(const char * path)
+{
+    char host_path[256];
+
+    if (!started || NULL == SdHostPath(path, host_path, sizeof(host_path))) return false;
+
+    return 0 == access(host_path, F_OK);
+}
+
+bool SdFatSdio::remove(const char * path)
+{
+    char host_path[256];
+
+    if (!started || NULL == SdHostPath(path, host_path, sizeof(host_path))) return false;
+
+    return 0 == ::remove(host_path);
+}
+
+bool SdFatSdio::rename(const char * old_path, const char * new_path)
+{
+    char old_host[256];
+    char new_host[256];
+
+    if (!started || NULL == SdHostPath(old_path, old_host, sizeof(old_host))
+        || NULL == SdHostPath(new_path, new_host, sizeof(new_host))) return false;
+
+    return 0 == ::rename(old_host, new_host);
+}
+
+bool SdFatSdio::mkdir(const char * path)
+{
+    char host_path[256];
+
+    if (!started || NULL == SdHostPath(path, host_path, sizeof(host_path))) return false;
+
+    return 0 == ::mkdir(host_path, 0755) || EEXIST == errno;
+}
@@ -0,0 +1,88 @@
+/*
+ *  SdFat.h (host stand-in)
+ *  Author:  StratoCore contributors
+ *  Created: October 2026
+ *
+ *  This file declares the subset of the SdFat library used by StratoCore,
+ *  backed by stdio files in a directory on the host (sd in the build directory
+ *  by default, or the STRATO_SD_ROOT environment variable). As with SdFat, copying a File copies
+ *  the handle: closing any copy closes the underlying file.
+ */
+
+#ifndef SDFAT_H
+#define SDFAT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+
+typedef int oflag_t;
+
+#define O_READ      0x01
+#define O_WRITE     0x02
+#define O_RDWR      (O_READ | O_WRITE)
+#define O_APPEND    0x04
+#define O_CREAT     0x10
+#define O_EXCL      0x20
+#define O_TRUNC     0x40
+#define O_AT_END    0x80
+
+#define FILE_READ   O_READ
+#define FILE_WRITE  (O_RDWR | O_CREAT | O_AT_END)
+
+class File {
+public:
+    File() : fp(NULL) { }
+
+    operator bool() const { return NULL != fp; }
+    bool isOpen() const { return NULL != fp; }
+
+    bool open(const char * path, oflag_t oflag = O_READ);
+    bool close();
+    bool sync();
+
+    int write(const void * buf, size_t nbyte);
+    size_t write(uint8_t b) { return (1 == write(&b, 1)) ? 1 : 0; }
+
+    int read();
+    int read(void * buf, size_t nbyte);
+    int available();
+
+    bool seekSet(uint32_t pos);
+    bool seekEnd(int32_t offset = 0);
+    uint32_t curPosition();
+    uint32_t fileSize();
+    uint32_t size() { return fileSize(); }
+
+    bool truncate(uint32_t length);
+
+    // creates a new file of the given size with the data area allocated up front
+    bool createContiguous(const char * path, uint32_t size);
+
+private:
+    FILE * fp;
+};
+
+class SdFatSdio {
+public:
+    SdFatSdio() : started(false) { }
+
+    bool begin();
+
+    File open(const char * path, oflag_t oflag = O_READ);
+    bool exists(const char * path);
+    bool remove(const char * path);
+    bool rename(const char * old_path, const char * new_path);
+    bool mkdir(const char * path);
+
+private:
+    bool started;
+};
+
+// maps an SD path onto the host directory standing in for the card
+const char * SdHostPath(const char * path, char * out, size_t out_size);
+
+// make the next count File::write calls fail, as a card error would
+void SdHostFailWrites(uint32_t count);
+
+#endif /* SDFAT_H */
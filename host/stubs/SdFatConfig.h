@@ -0,0 +1,12 @@
+/*
+ *  SdFatConfig.h (host stand-in)
+ *  Author:  StratoCore contributors
+ *  Created: October 2026
+ *
+ *  Placeholder for the SdFat configuration header, nothing to configure on the host
+ */
+
+#ifndef SDFATCONFIG_H
+#define SDFATCONFIG_H
+
+#endif /* SDFATCONFIG_H */
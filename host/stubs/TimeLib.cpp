@@ -0,0 +1,147 @@
+/*
+ *  TimeLib.cpp (host stand-in)
+ *  Author:  StratoCore contributors
+ *  Created: October 2026
+ *
+ *  This file implements the subset of the Arduino TimeLib used by StratoCore
+ */
+
+#include "TimeLib.h"
+#include "Arduino.h"
+
+static time_t sys_time = 0;
+static uint32_t prev_millis = 0;
+static timeStatus_t status = timeNotSet;
+
+static const uint8_t month_days[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+
+#define LEAP_YEAR(Y) (((1970 + (Y)) > 0) && !((1970 + (Y)) % 4) && (((1970 + (Y)) % 100) || !((1970 + (Y)) % 400)))
+
+time_t now()
+{
+    // advance the system time by whole seconds of millis(), as TimeLib does
+    while (millis() - prev_millis >= 1000) {
+        sys_time++;
+        prev_millis += 1000;
+    }
+
+    return sys_time;
+}
+
+void setTime(time_t t)
+{
+    sys_time = t;
+    prev_millis = millis();
+    status = timeSet;
+}
+
+void setTime(int hr, int min, int sec, int dy, int mnth, int yr)
+{
+    tmElements_t tm;
+
+    if (yr > 99) {
+        yr = yr - 1970;
+    } else {
+        yr += 30;
+    }
+
+    tm.Year = (uint8_t) yr;
+    tm.Month = (uint8_t) mnth;
+    tm.Day = (uint8_t) dy;
+    tm.Hour = (uint8_t) hr;
+    tm.Minute = (uint8_t) min;
+    tm.Second = (uint8_t) sec;
+
+    setTime(makeTime(tm));
+}
+
+void adjustTime(long adjustment)
+{
+    sys_time += adjustment;
+}
+
+timeStatus_t timeStatus()
+{
+    now();
+    return status;
+}
+
+int hour()   { tmElements_t tm; breakTime(now(), tm); return tm.Hour; }
+int minute() { tmElements_t tm; breakTime(now(), tm); return tm.Minute; }
+int second() { tmElements_t tm; breakTime(now(), tm); return tm.Second; }
+int day()    { tmElements_t tm; breakTime(now(), tm); return tm.Day; }
+int month()  { tmElements_t tm; breakTime(now(), tm); return tm.Month; }
+int year()   { tmElements_t tm; breakTime(now(), tm); return tmYearToCalendar(tm.Year); }
+
+void breakTime(time_t time_input, tmElements_t &tm)
+{
+    uint8_t yr;
+    uint8_t mnth, mnth_length;
+    uint32_t time;
+    unsigned long days;
+
+    time = (uint32_t) time_input;
+    tm.Second = time % 60;
+    time /= 60;
+    tm.Minute = time % 60;
+    time /= 60;
+    tm.Hour = time % 24;
+    time /= 24;
+    tm.Wday = ((time + 4) % 7) + 1;
+
+    yr = 0;
+    days = 0;
+    while ((unsigned) (days += (LEAP_YEAR(yr) ? 366 : 365)) <= time) {
+        yr++;
+    }
+    tm.Year = yr;
+
+    days -= LEAP_YEAR(yr) ? 366 : 365;
+    time -= days;
+
+    days = 0;
+    mnth = 0;
+    mnth_length = 0;
+    for (mnth = 0; mnth < 12; mnth++) {
+        if (mnth == 1) {
+            mnth_length = LEAP_YEAR(yr) ? 29 : 28;
+        } else {
+            mnth_length = month_days[mnth];
+        }
+
+        if (time >= mnth_length) {
+            time -= mnth_length;
+        } else {
+            break;
+        }
+    }
+    tm.Month = mnth + 1;
+    tm.Day = time + 1;
+}
+
+time_t makeTime(const tmElements_t &tm)
+{
+    int i;
+    uint32_t seconds;
+
+    seconds = tm.Year * (SECS_PER_DAY * 365);
+    for (i = 0; i < tm.Year; i++) {
+        if (LEAP_YEAR(i)) {
+            seconds += SECS_PER_DAY;
+        }
+    }
+
+    for (i = 1; i < tm.Month; i++) {
+        if ((i == 2) && LEAP_YEAR(tm.Year)) {
+            seconds += SECS_PER_DAY * 29;
+        } else {
+            seconds += SECS_PER_DAY * month_days[i - 1];
+        }
+    }
+    seconds += (tm.Day - 1) * SECS_PER_DAY;
+    seconds += tm.Hour * SECS_PER_HOUR;
+    seconds += tm.Minute * SECS_PER_MIN;
+    seconds += tm.Second;
+
+    return (time_t) seconds;
+}
@@ -0,0 +1,51 @@
+/*
+ *  TimeLib.h (host stand-in)
+ *  Author:  StratoCore contributors
+ *  Created: October 2026
+ *
+ *  This file declares the subset of the Arduino TimeLib used by StratoCore.
+ *  As on the Teensy, the clock starts at zero at boot and is driven by millis().
+ */
+
+#ifndef TIMELIB_H
+#define TIMELIB_H
+
+#include <stdint.h>
+#include <time.h>
+
+typedef enum { timeNotSet, timeNeedsSync, timeSet } timeStatus_t;
+
+typedef struct {
+    uint8_t Second;
+    uint8_t Minute;
+    uint8_t Hour;
+    uint8_t Wday; // day of week, sunday is day 1
+    uint8_t Day;
+    uint8_t Month;
+    uint8_t Year; // offset from 1970
+} tmElements_t, TimeElements, *tmElementsPtr_t;
+
+#define SECS_PER_MIN  ((time_t)(60UL))
+#define SECS_PER_HOUR ((time_t)(3600UL))
+#define SECS_PER_DAY  ((time_t)(SECS_PER_HOUR * 24UL))
+
+#define tmYearToCalendar(Y) ((Y) + 1970)
+#define CalendarYrToTm(Y)   ((Y) - 1970)
+
+time_t now();
+void setTime(time_t t);
+void setTime(int hr, int min, int sec, int day, int month, int yr);
+void adjustTime(long adjustment);
+timeStatus_t timeStatus();
+
+int hour();
+int minute();
+int second();
+int day();
+int month();
+int year();
+
+void breakTime(time_t time, tmElements_t &tm);
+time_t makeTime(const tmElements_t &tm);
+
+#endif /* TIMELIB_H */
@@ -0,0 +1,15 @@
+/*
+ *  WProgram.h (host stand-in)
+ *  Author:  StratoCore contributors
+ *  Created: October 2026
+ *
+ *  Teensyduino compatibility header, forwards to the host Arduino stand-in
+ */
+
+#ifndef WPROGRAM_H
+#define WPROGRAM_H
+
+#include "Arduino.h"
+#include "HardwareSerial.h"
+
+#endif /* WPROGRAM_H */
@@ -0,0 +1,246 @@
+/*
+ *  XMLReader_v5.cpp (host stand-in)
+ *  Author:  StratoCore contributors
+ *  Created: October 2026
+ *
+ *  This file implements a host replacement for the StrateoleXML XMLReader
+ */
+
+#include "XMLReader_v5.h"
+
+#define MSG_TERMINATOR      "<END>"
+#define MSG_TERMINATOR_LEN  5
+
+XMLReader::XMLReader(Stream * rxstream, Instrument_t inst)
+{
+    rx_stream = rxstream;
+    instrument = inst;
+
+    zephyr_message = NO_ZEPHYR_MSG;
+    zephyr_mode = MODE_STANDBY;
+    zephyr_ack = 0;
+    memset(&zephyr_gps, 0, sizeof(zephyr_gps));
+
+    zephyr_tc = NULL_TELECOMMAND;
+    num_tcs = 0;
+    curr_tc = 0;
+    num_tc_params = 0;
+    parse_errors = 0;
+
+    buffer_size = 0;
+    tc_payload[0] = '\0';
+    tc_index = 0;
+}
+
+bool XMLReader::GetNewMessage()
+{
+    while (rx_stream->available() > 0) {
+        int c = rx_stream->read();
+        if (c < 0) break;
+
+        // drop leading whitespace between messages
+        if (0 == buffer_size && ('\n' == c || '\r' == c || ' ' == c)) continue;
+
+        if (buffer_size >= READER_BUFFER_SIZE - 1) {
+            // overflow: discard and resynchronize on the next message
+            buffer_size = 0;
+            parse_errors++;
+            continue;
+        }
+
+        buffer[buffer_size++] = (char) c;
+        buffer[buffer_size] = '\0';
+
+        if (buffer_size >= MSG_TERMINATOR_LEN
+            && 0 == strncmp(buffer + buffer_size - MSG_TERMINATOR_LEN, MSG_TERMINATOR, MSG_TERMINATOR_LEN)) {
+            bool parsed = ParseMessage();
+            buffer_size = 0;
+            if (parsed) return true;
+        }
+    }
+
+    zephyr_message = NO_ZEPHYR_MSG;
+    return false;
+}
+
+bool XMLReader::ParseMessage()
+{
+    char value[TC_PAYLOAD_SIZE];
+    char type[16] = {0};
+    const char * close;
+
+    // message type is the first tag
+    if ('<' != buffer[0] || NULL == (close = strchr(buffer, '>')) || close - buffer - 1 >= (int) sizeof(type)) {
+        parse_errors++;
+        return false;
+    }
+    memcpy(type, buffer + 1, close - buffer - 1);
+
+    // ignore messages for other instruments
+    if (GetNode("Inst", value, sizeof(value)) && 0 != strcmp(value, InstrumentName(instrument))) {
+        return false;
+    }
+
+    if (0 == strcmp(type, "IM")) {
+        if (!GetNode("Mode", value, sizeof(value))) {
+            parse_errors++;
+            return false;
+        }
+
+        if (0 == strcmp(value, "SB")) zephyr_mode = MODE_STANDBY;
+        else if (0 == strcmp(value, "FL")) zephyr_mode = MODE_FLIGHT;
+        else if (0 == strcmp(value, "LP")) zephyr_mode = MODE_LOWPOWER;
+        else if (0 == strcmp(value, "SA")) zephyr_mode = MODE_SAFETY;
+        else if (0 == strcmp(value, "EF")) zephyr_mode = MODE_EOF;
+        else {
+            parse_errors++;
+            return false;
+        }
+
+        zephyr_message = IM;
+    } else if (0 == strcmp(type, "GPS")) {
+        unsigned int y, mo, d, h, mi, s;
+
+        if (!GetNode("Date", value, sizeof(value)) || 3 != sscanf(value, "%u/%u/%u", &y, &mo, &d)) {
+            parse_errors++;
+            return false;
+        }
+        zephyr_gps.year = (uint16_t) y;
+        zephyr_gps.month = (uint8_t) mo;
+        zephyr_gps.day = (uint8_t) d;
+
+        if (!GetNode("Time", value, sizeof(value)) || 3 != sscanf(value, "%u:%u:%u", &h, &mi, &s)) {
+            parse_errors++;
+            return false;
+        }
+        zephyr_gps.hour = (uint8_t) h;
+        zephyr_gps.minute = (uint8_t) mi;
+        zephyr_gps.second = (uint8_t) s;
+
+        if (GetNode("Lon", value, sizeof(value))) zephyr_gps.longitude = (float) atof(value);
+        if (GetNode("Lat", value, sizeof(value))) zephyr_gps.latitude = (float) atof(value);
+        if (GetNode("Alt", value, sizeof(value))) zephyr_gps.altitude = (float) atof(value);
+        if (GetNode("SZA", value, sizeof(value))) zephyr_gps.solar_zenith_angle = (float) atof(value);
+        if (GetNode("Quality", value, sizeof(value))) zephyr_gps.quality = (uint8_t) atoi(value);
+
+        zephyr_message = GPS;
+    } else if (0 == strcmp(type, "SW")) {
+        zephyr_message = SW;
+    } else if (0 == strcmp(type, "TC")) {
+        if (!GetNode("START", tc_payload, sizeof(tc_payload))) {
+            parse_errors++;
+            return false;
+        }
+
+        num_tcs = 0;
+        for (const char * itr = tc_payload; *itr != '\0'; itr++) {
+            if (';' == *itr) num_tcs++;
+        }
+
+        tc_index = 0;
+        curr_tc = 0;
+        zephyr_message = TC;
+    } else if (0 == strcmp(type, "SAck") || 0 == strcmp(type, "RAAck") || 0 == strcmp(type, "TMAck")) {
+        if (!GetNode("Ack", value, sizeof(value))) {
+            parse_errors++;
+            return false;
+        }
+
+        zephyr_ack = (0 == strcmp(value, "ACK")) ? 1 : 0;
+
+        if ('S' == type[0]) zephyr_message = SAck;
+        else if ('R' == type[0]) zephyr_message = RAAck;
+        else zephyr_message = TMAck;
+    } else {
+        zephyr_message = UNKNOWN;
+    }
+
+    return true;
+}
+
+bool XMLReader::GetNode(const char * tag, char * value, uint16_t value_size)
+{
+    char open_tag[24];
+    char close_tag[24];
+    const char * start;
+    const char * end;
+
+    snprintf(open_tag, sizeof(open_tag), "<%s>", tag);
+    snprintf(close_tag, sizeof(close_tag), "</%s>", tag);
+
+    if (NULL == (start = strstr(buffer, open_tag))) return false;
+    start += strlen(open_tag);
+
+    if (NULL == (end = strstr(start, close_tag)) || end - start >= value_size) return false;
+
+    memcpy(value, start, end - start);
+    value[end - start] = '\0';
+
+    return true;
+}
+
+TCParseStatus_t XMLReader::GetTelecommand()
+{
+    char tc_string[TC_PAYLOAD_SIZE];
+    uint16_t tc_length = 0;
+    char * token;
+    char * save;
+    char * end;
+
+    num_tc_params = 0;
+
+    if (curr_tc >= num_tcs || '\0' == tc_payload[tc_index]) return NO_TCs;
+
+    // copy out the next command up to its ';'
+    while ('\0' != tc_payload[tc_index] && ';' != tc_payload[tc_index]) {
+        tc_string[tc_length++] = tc_payload[tc_index++];
+    }
+    tc_string[tc_length] = '\0';
+    if (';' == tc_payload[tc_index]) tc_index++;
+    curr_tc++;
+
+    // the telecommand number
+    token = strtok_r(tc_string, ",", &save);
+    if (NULL == token) return TC_ERROR;
+
+    unsigned long tc_num = strtoul(token, &end, 10);
+    if (end == token || '\0' != *end || tc_num > 255) return TC_ERROR;
+    zephyr_tc = (Telecommand_t) tc_num;
+
+    // any parameters
+    while (NULL != (token = strtok_r(NULL, ",", &save))) {
+        if (num_tc_params >= MAX_TC_PARAMS || strlen(token) >= TC_PARAM_SIZE) return TC_ERROR;
+        strcpy(tc_params[num_tc_params++], token);
+    }
+
+    return READ_TC;
+}
+
+bool XMLReader::GetTCParam(uint8_t index, uint32_t * value)
+{
+    char * end;
+
+    if (index >= num_tc_params || NULL == value) return false;
+
+    *value = (uint32_t) strtoul(tc_params[index], &end, 10);
+
+    return (end != tc_params[index] && '\0' == *end);
+}
+
+bool XMLReader::GetTCParam(uint8_t index, float * value)
+{
+    char * end;
+
+    if (index >= num_tc_params || NULL == value) return false;
+
+    *value = strtof(tc_params[index], &end);
+
+    return (end != tc_params[index] && '\0' == *end);
+}
+
+const char * XMLReader::GetTCParam(uint8_t index)
+{
+    if (index >= num_tc_params) return NULL;
+
+    return tc_params[index];
+}
@@ -0,0 +1,123 @@
+/*
+ *  XMLReader_v5.h (host stand-in)
+ *  Author:  StratoCore contributors
+ *  Created: October 2026
+ *
+ *  This file declares a host replacement for the StrateoleXML XMLReader. It
+ *  parses a simplified form of the Zephyr XML messages, each terminated by
+ *  <END>, for example:
+ *
+ *    <IM><Msg>1</Msg><Inst>RACHuTS</Inst><Mode>FL</Mode></IM><CRC>0</CRC><END>
+ *    <GPS><Msg>2</Msg><Date>2019/06/20</Date><Time>12:00:00</Time><SZA>45.0</SZA></GPS><END>
+ *    <TC><Msg>3</Msg><Inst>RACHuTS</Inst><Length>6</Length></TC><START>0;203;</START><END>
+ *
+ *  CRCs are not checked. Messages addressed to another instrument are dropped.
+ */
+
+#ifndef XMLREADER_V5_H
+#define XMLREADER_V5_H
+
+#include "Arduino.h"
+#include "XMLWriter_v5.h"
+#include <stdint.h>
+
+#define READER_BUFFER_SIZE  1024
+#define TC_PAYLOAD_SIZE     512
+#define MAX_TC_PARAMS       8
+#define TC_PARAM_SIZE       32
+
+enum ZephyrMessage_t {
+    NO_ZEPHYR_MSG = 0,
+    IM,
+    GPS,
+    SW,
+    TC,
+    SAck,
+    RAAck,
+    TMAck,
+    UNKNOWN
+};
+
+enum InstMode_t {
+    MODE_STANDBY = 0,
+    MODE_FLIGHT,
+    MODE_LOWPOWER,
+    MODE_SAFETY,
+    MODE_EOF,
+    NUM_MODES
+};
+
+enum TCParseStatus_t {
+    NO_TCs = 0,
+    READ_TC,
+    TC_ERROR
+};
+
+// generic telecommands, instrument-specific values are cast from their number
+enum Telecommand_t {
+    NULL_TELECOMMAND = 0,
+    RESET_INST = 200,
+    EXITFLIGHT = 201,
+    GETTMBUFFER = 202,
+    SENDSTATE = 203
+};
+
+struct GPS_t {
+    float longitude;
+    float latitude;
+    float altitude;
+    float solar_zenith_angle;
+    uint16_t year;
+    uint8_t month;
+    uint8_t day;
+    uint8_t hour;
+    uint8_t minute;
+    uint8_t second;
+    uint8_t quality;
+};
+
+class XMLReader {
+public:
+    XMLReader(Stream * rxstream, Instrument_t inst);
+
+    // reads whatever is available on the stream, returns true if a full message was parsed
+    bool GetNewMessage();
+
+    // parses the next telecommand from the last TC message
+    TCParseStatus_t GetTelecommand();
+
+    // parameters of the last telecommand parsed by GetTelecommand
+    bool GetTCParam(uint8_t index, uint32_t * value);
+    bool GetTCParam(uint8_t index, float * value);
+    const char * GetTCParam(uint8_t index);
+
+    ZephyrMessage_t zephyr_message;
+    InstMode_t zephyr_mode;
+    uint8_t zephyr_ack;
+    GPS_t zephyr_gps;
+
+    Telecommand_t zephyr_tc;
+    uint8_t num_tcs;
+    uint8_t curr_tc;
+    uint8_t num_tc_params;
+
+    // count of messages that could not be parsed
+    uint32_t parse_errors;
+
+private:
+    bool ParseMessage();
+    bool GetNode(const char * tag, char * value, uint16_t value_size);
+
+    Stream * rx_stream;
+    Instrument_t instrument;
+
+    char buffer[READER_BUFFER_SIZE];
+    uint16_t buffer_size;
+
+    char tc_payload[TC_PAYLOAD_SIZE];
+    uint16_t tc_index;
+
+    char tc_params[MAX_TC_PARAMS][TC_PARAM_SIZE];
+};
+
+#endif /* XMLREADER_V5_H */
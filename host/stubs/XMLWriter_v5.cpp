@@ -0,0 +1,222 @@
+/*
+ *  XMLWriter_v5.cpp (host stand-in)
+ *  Author:  StratoCore contributors
+ *  Created: October 2026
+ *
+ *  This file implements a host replacement for the StrateoleXML XMLWriter
+ */
+
+#include "XMLWriter_v5.h"
+
+static const char * state_flag_names[] = {"FINE", "WARN", "CRIT", "NOMESS"};
+
+const char * InstrumentName(Instrument_t inst)
+{
+    switch (inst) {
+    case FLOATS:
+        return "FLOATS";
+    case RACHUTS:
+        return "RACHuTS";
+    case LPC:
+        return "LPC";
+    case NO_INST:
+    default:
+        return "NONE";
+    }
+}
+
+XMLWriter::XMLWriter(Stream * txstream, Instrument_t inst)
+{
+    tx_stream = txstream;
+    instrument = inst;
+    msg_id = 0;
+    tm_buffer_size = 0;
+
+    for (int i = 0; i < 3; i++) {
+        state_flags[i] = NOMESS;
+        state_details[i][0] = '\0';
+    }
+}
+
+void XMLWriter::IMR()
+{
+    WriteHeader("IMR");
+    WriteEnd("IMR");
+}
+
+void XMLWriter::IMAck(bool ack)
+{
+    WriteHeader("IMAck");
+    WriteNode("Ack", ack ? "ACK" : "NAK");
+    WriteEnd("IMAck");
+}
+
+void XMLWriter::TCAck(bool ack)
+{
+    WriteHeader("TCAck");
+    WriteNode("Ack", ack ? "ACK" : "NAK");
+    WriteEnd("TCAck");
+}
+
+void XMLWriter::S()
+{
+    WriteHeader("S");
+    WriteEnd("S");
+}
+
+void XMLWriter::RA()
+{
+    WriteHeader("RA");
+    WriteEnd("RA");
+}
+
+void XMLWriter::TM()
+{
+    char tag[16];
+
+    WriteHeader("TM");
+    for (int i = 0; i < 3; i++) {
+        snprintf(tag, sizeof(tag), "StateFlag%d", i + 1);
+        WriteNode(tag, state_flag_names[state_flags[i]]);
+        snprintf(tag, sizeof(tag), "StateMess%d", i + 1);
+        WriteNode(tag, state_details[i]);
+    }
+    WriteNode("Length", tm_buffer_size);
+    tx_stream->print("</TM>\n");
+    WriteNode("CRC", crc16((const uint8_t *) "TM", 2));
+
+    // binary section
+    tx_stream->print("<START>");
+    tx_stream->write(tm_buffer, tm_buffer_size);
+    tx_stream->print("</START>\n");
+    WriteNode("CRC", crc16(tm_buffer, tm_buffer_size));
+    tx_stream->print("<END>\n");
+}
+
+void XMLWriter::TM_String(StateFlag_t state_flag, const char * message)
+{
+    setStateFlagValue(1, state_flag);
+    setStateDetails(1, message);
+    setStateFlagValue(2, NOMESS);
+    setStateFlagValue(3, NOMESS);
+
+    clearTm();
+    TM();
+}
+
+bool XMLWriter::addTm(uint8_t data)
+{
+    if (tm_buffer_size >= TM_BUFFER_SIZE) return false;
+
+    tm_buffer[tm_buffer_size++] = data;
+
+    return true;
+}
+
+bool XMLWriter::addTm(uint16_t data)
+{
+    if (tm_buffer_size + 2 > TM_BUFFER_SIZE) return false;
+
+    tm_buffer[tm_buffer_size++] = (uint8_t) (data >> 8);
+    tm_buffer[tm_buffer_size++] = (uint8_t) data;
+
+    return true;
+}
+
+bool XMLWriter::addTm(uint32_t data)
+{
+    if (tm_buffer_size + 4 > TM_BUFFER_SIZE) return false;
+
+    tm_buffer[tm_buffer_size++] = (uint8_t) (data >> 24);
+    tm_buffer[tm_buffer_size++] = (uint8_t) (data >> 16);
+    tm_buffer[tm_buffer_size++] = (uint8_t) (data >> 8);
+    tm_buffer[tm_buffer_size++] = (uint8_t) data;
+
+    return true;
+}
+
+bool XMLWriter::addTm(const uint8_t * buffer, uint16_t size)
+{
+    if (NULL == buffer || tm_buffer_size + size > TM_BUFFER_SIZE) return false;
+
+    memcpy(tm_buffer + tm_buffer_size, buffer, size);
+    tm_buffer_size += size;
+
+    return true;
+}
+
+void XMLWriter::clearTm()
+{
+    tm_buffer_size = 0;
+}
+
+uint16_t XMLWriter::getTmBuffer(uint8_t ** buffer)
+{
+    *buffer = tm_buffer;
+    return tm_buffer_size;
+}
+
+void XMLWriter::setStateDetails(uint8_t flag_number, const char * details)
+{
+    if (flag_number < 1 || flag_number > 3 || NULL == details) return;
+
+    snprintf(state_details[flag_number - 1], STATE_DETAILS_SIZE, "%s", details);
+}
+
+void XMLWriter::setStateFlagValue(uint8_t flag_number, StateFlag_t flag_value)
+{
+    if (flag_number < 1 || flag_number > 3) return;
+
+    state_flags[flag_number - 1] = flag_value;
+}
+
+void XMLWriter::WriteHeader(const char * msg_type)
+{
+    tx_stream->print("<");
+    tx_stream->print(msg_type);
+    tx_stream->print(">");
+    WriteNode("Msg", ++msg_id);
+    WriteNode("Inst", InstrumentName(instrument));
+}
+
+void XMLWriter::WriteNode(const char * tag, const char * value)
+{
+    tx_stream->print("<");
+    tx_stream->print(tag);
+    tx_stream->print(">");
+    tx_stream->print(value);
+    tx_stream->print("</");
+    tx_stream->print(tag);
+    tx_stream->print(">");
+}
+
+void XMLWriter::WriteNode(const char * tag, uint32_t value)
+{
+    char buf[12];
+    snprintf(buf, sizeof(buf), "%lu", (unsigned long) value);
+    WriteNode(tag, buf);
+}
+
+void XMLWriter::WriteEnd(const char * msg_type)
+{
+    tx_stream->print("</");
+    tx_stream->print(msg_type);
+    tx_stream->print(">\n");
+    WriteNode("CRC", crc16((const uint8_t *) msg_type, (uint16_t) strlen(msg_type)));
+    tx_stream->print("<END>\n");
+}
+
+// CRC-16/CCITT, bitwise like the flight implementation
+uint16_t XMLWriter::crc16(const uint8_t * data, uint16_t size)
+{
+    uint16_t crc = 0xFFFF;
+
+    while (size--) {
+        crc ^= (uint16_t) (*data++) << 8;
+        for (int i = 0; i < 8; i++) {
+            crc = (crc & 0x8000) ? (uint16_t) ((crc << 1) ^ 0x1021) : (uint16_t) (crc << 1);
+        }
+    }
+
+    return crc;
+}
@@ -0,0 +1,81 @@
+/*
+ *  XMLWriter_v5.h (host stand-in)
+ *  Author:  StratoCore contributors
+ *  Created: October 2026
+ *
+ *  This file declares a host replacement for the StrateoleXML XMLWriter. It
+ *  produces Zephyr-style XML on the given stream so that serial bandwidth and
+ *  formatting cost are representative, but it is not a validated implementation
+ *  of the Zephyr interface.
+ */
+
+#ifndef XMLWRITER_V5_H
+#define XMLWRITER_V5_H
+
+#include "Arduino.h"
+#include <stdint.h>
+
+#define TM_BUFFER_SIZE  8192
+#define STATE_DETAILS_SIZE  64
+
+enum Instrument_t {
+    NO_INST = 0,
+    FLOATS,
+    RACHUTS,
+    LPC
+};
+
+enum StateFlag_t {
+    FINE = 0,
+    WARN,
+    CRIT,
+    NOMESS
+};
+
+// used by both the reader and the writer
+const char * InstrumentName(Instrument_t inst);
+
+class XMLWriter {
+public:
+    XMLWriter(Stream * txstream, Instrument_t inst);
+
+    // Zephyr messages
+    void IMR();
+    void IMAck(bool ack);
+    void TCAck(bool ack);
+    void S();
+    void RA();
+    void TM();
+    void TM_String(StateFlag_t state_flag, const char * message);
+
+    // TM buffer management
+    bool addTm(uint8_t data);
+    bool addTm(uint16_t data);
+    bool addTm(uint32_t data);
+    bool addTm(const uint8_t * buffer, uint16_t size);
+    void clearTm();
+    uint16_t getTmBuffer(uint8_t ** buffer);
+
+    // TM state flags (1-3)
+    void setStateDetails(uint8_t flag_number, const char * details);
+    void setStateFlagValue(uint8_t flag_number, StateFlag_t flag_value);
+
+private:
+    void WriteHeader(const char * msg_type);
+    void WriteNode(const char * tag, const char * value);
+    void WriteNode(const char * tag, uint32_t value);
+    void WriteEnd(const char * msg_type);
+    uint16_t crc16(const uint8_t * data, uint16_t size);
+
+    Stream * tx_stream;
+    Instrument_t instrument;
+    uint32_t msg_id;
+
+    uint8_t tm_buffer[TM_BUFFER_SIZE];
+    uint16_t tm_buffer_size;
+
+    StateFlag_t state_flags[3];
+    char state_details[3][STATE_DETAILS_SIZE];
+};
+
+#endif /* XMLWRITER_V5_H */
@@ -0,0 +1,344 @@
+/*
+ *  ArchiveTest.cpp
+ *  Author:  StratoCore contributors
+ *  Created: October 2026
+ *
+ *  This file implements host-side regression tests for StratoArchive: records
+ *  written through the budgeted SD phase with file rotation must read back
+ *  intact, and time lookups through the catalog and index must land on the
+ *  right record, including before a sync and after the RAM index fills.
+ */
+
+#include "StratoArchive.h"
+#include "TimeLib.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#define START_TIME      ((time_t) 1561000000)
+#define NUM_RECORDS     3000
+
+static int failures = 0;
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            printf("  FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            failures++; \
+        } \
+    } while (0)
+
+struct Written_t {
+    uint32_t time;
+    uint8_t type;
+    uint16_t length;
+    uint8_t seed;
+};
+
+static StaticArchive<4096> archive;
+static StaticArchive<16384> slow_archive;
+static std::vector<Written_t> written;
+static uint8_t data[2048];
+
+static void FillData(uint8_t seed, uint16_t length)
+{
+    for (uint16_t i = 0; i < length; i++) {
+        data[i] = (uint8_t) (seed + i * 7);
+    }
+}
+
+// read every record of every file in catalog order and compare against what was written
+static void TestReadBack()
+{
+    uint8_t entry[ARCHIVE_CATALOG_ENTRY_SIZE];
+    uint8_t header[ARCHIVE_HEADER_SIZE];
+    uint8_t buffer[2048];
+    ArchiveRecordHeader_t record;
+    size_t next = 0;
+    uint16_t files = 0;
+
+    printf("read back\n");
+
+    File catalog = SD.open("ARC.cat", O_READ);
+    CHECK(catalog);
+
+    while (ARCHIVE_CATALOG_ENTRY_SIZE == catalog.read(entry, ARCHIVE_CATALOG_ENTRY_SIZE)) {
+        File file = SD.open((const char *) &entry[4], O_READ);
+        CHECK(file);
+        files++;
+
+        // each file starts with a record, at the time in the catalog
+        bool first = true;
+        while (ARCHIVE_HEADER_SIZE == file.read(header, ARCHIVE_HEADER_SIZE)) {
+            CHECK(ArchiveUnpackHeader(header, &record));
+            CHECK((int) record.length == file.read(buffer, record.length));
+            CHECK(ArchiveCheckRecord(header, buffer));
+            if (first) CHECK(record.time == ArchiveGet32(entry));
+            first = false;
+
+            CHECK(next < written.size());
+            if (next >= written.size()) break;
+
+            FillData(written[next].seed, written[next].length);
+            CHECK(record.time == written[next].time);
+            CHECK(record.type == written[next].type);
+            CHECK(record.length == written[next].length);
+            CHECK(0 == memcmp(buffer, data, record.length));
+            next++;
+        }
+
+        file.close();
+    }
+
+    catalog.close();
+
+    CHECK(next == written.size());
+    CHECK(files > 1);
+    printf("  %u records in %u files\n", (uint32_t) next, files);
+}
+
+// every lookup must start at or before the first record at the time, in the right file
+static void TestLookup()
+{
+    char filename[ARCHIVE_CATALOG_NAME_SIZE];
+    uint8_t header[ARCHIVE_HEADER_SIZE];
+    ArchiveRecordHeader_t record;
+    uint32_t offset = 0;
+
+    printf("lookup\n");
+
+    for (uint32_t t = written.front().time; t <= written.back().time; t += 7) {
+        // the first record written at or after t
+        size_t target = 0;
+        while (target < written.size() && written[target].time < t) target++;
+        if (target == written.size()) break;
+
+        CHECK(ArchiveFindFile("ARC", t, filename, sizeof(filename)));
+        CHECK(ArchiveFindOffset(filename, t, &offset));
+
+        // scan forward from the offset to the target without passing it
+        File file = SD.open(filename, O_READ);
+        CHECK(file.seekSet(offset));
+        bool found = false;
+        while (!found && ARCHIVE_HEADER_SIZE == file.read(header, ARCHIVE_HEADER_SIZE)) {
+            CHECK(ArchiveUnpackHeader(header, &record));
+            CHECK(record.time <= written[target].time);
+            found = (record.time >= t);
+            file.seekSet(file.curPosition() + record.length);
+        }
+        file.close();
+
+        // the record may be at the start of the next file if the time falls between files
+        if (!found) {
+            CHECK(ArchiveFindFile("ARC", written[target].time, filename, sizeof(filename)));
+            CHECK(ArchiveFindOffset(filename, written[target].time, &offset));
+        }
+    }
+}
+
+// a failed write finishes the file with what reached the card, and later records start the next file
+static void TestWriteError()
+{
+    uint8_t entry[ARCHIVE_CATALOG_ENTRY_SIZE];
+    uint8_t header[ARCHIVE_HEADER_SIZE];
+    uint8_t buffer[2048];
+    char names[4][ARCHIVE_CATALOG_NAME_SIZE];
+    char index_name[ARCHIVE_CATALOG_NAME_SIZE];
+    uint32_t ends[4] = {0};
+    ArchiveRecordHeader_t record;
+    uint32_t records = 0;
+    uint16_t files = 0;
+
+    printf("write error\n");
+
+    CHECK(archive.Open("ERR", 256 * 1024, 0));
+
+    FillData(1, 1000);
+    for (uint8_t i = 0; i < 20; i++) {
+        CHECK(archive.WriteRecord(1, (uint32_t) now() + i, data, 1000));
+        ServiceSDLoggers(8192, 100000);
+    }
+    CHECK(archive.Sync());
+
+    // the next sector fails with records still buffered, each far enough apart to have an index entry
+    for (uint8_t i = 0; i < 3; i++) {
+        CHECK(archive.WriteRecord(1, (uint32_t) now() + (i + 1) * ARCHIVE_INDEX_SECONDS, data, 1000));
+    }
+    SdHostFailWrites(1);
+    CHECK(!archive.Flush());
+    CHECK(1 == archive.GetStats().write_errors);
+    CHECK(archive.GetStats().bytes_dropped > 0);
+
+    // the SD phase's total, which back-pressure reports are based on, survives a reset of the logger's stats
+    uint32_t dropped = GetSDWriteStats().bytes_dropped;
+    CHECK(dropped >= archive.GetStats().bytes_dropped);
+    archive.ResetStats();
+    CHECK(0 == archive.GetStats().bytes_dropped);
+    CHECK(dropped == GetSDWriteStats().bytes_dropped);
+
+    for (uint8_t i = 0; i < 20; i++) {
+        CHECK(archive.WriteRecord(1, (uint32_t) now() + 4 * ARCHIVE_INDEX_SECONDS + i, data, 1000));
+        ServiceSDLoggers(8192, 100000);
+    }
+    archive.Close();
+
+    // one catalog entry per file, and each file holds whole records from its start (the failed one up to its
+    // last sync, followed by unused pre-allocation)
+    File catalog = SD.open("ERR.cat", O_READ);
+    CHECK(catalog);
+
+    while (ARCHIVE_CATALOG_ENTRY_SIZE == catalog.read(entry, ARCHIVE_CATALOG_ENTRY_SIZE) && files < 4) {
+        strcpy(names[files], (const char *) &entry[4]);
+        for (uint16_t i = 0; i < files; i++) CHECK(0 != strcmp(names[i], names[files]));
+        files++;
+
+        File file = SD.open((const char *) &entry[4], O_READ);
+        CHECK(file);
+
+        bool first = true;
+        while (ARCHIVE_HEADER_SIZE == file.read(header, ARCHIVE_HEADER_SIZE) && ArchiveUnpackHeader(header, &record)) {
+            CHECK((int) record.length == file.read(buffer, record.length));
+            CHECK(ArchiveCheckRecord(header, buffer));
+            if (first) CHECK(record.time == ArchiveGet32(entry));
+            first = false;
+            records++;
+            ends[files - 1] = file.curPosition();
+        }
+
+        file.close();
+    }
+
+    catalog.close();
+
+    CHECK(2 == files);
+    CHECK(40 == records);
+
+    // the failed file's index has no entries for the dropped records
+    strcpy(index_name, names[0]);
+    strcpy(&index_name[strlen(index_name) - 4], ".idx");
+    File index_file = SD.open(index_name, O_READ);
+    CHECK(index_file);
+    CHECK(ARCHIVE_INDEX_HEADER_SIZE == index_file.read(buffer, ARCHIVE_INDEX_HEADER_SIZE));
+    uint32_t entries = ArchiveGet32(&buffer[8]);
+    CHECK(entries > 0);
+    for (uint32_t i = 0; i < entries; i++) {
+        CHECK(ARCHIVE_INDEX_ENTRY_SIZE == index_file.read(buffer, ARCHIVE_INDEX_ENTRY_SIZE));
+        CHECK(ArchiveGet32(&buffer[4]) < ends[0]);
+    }
+    index_file.close();
+}
+
+// the index is on the card as soon as the records it points to are, without a sync
+static void TestIndexBeforeSync()
+{
+    char filename[ARCHIVE_CATALOG_NAME_SIZE];
+    uint32_t start = (uint32_t) now();
+    uint32_t offset = 0;
+
+    printf("index before sync\n");
+
+    CHECK(archive.Open("INC", 256 * 1024, 0));
+
+    FillData(2, 1000);
+    for (uint32_t i = 0; i < 10; i++) {
+        CHECK(archive.WriteRecord(1, start + i * ARCHIVE_INDEX_SECONDS, data, 1000));
+        ServiceSDLoggers(8192, 100000);
+    }
+
+    // every record starts in a whole sector on the card, the end of the last is still buffered
+    CHECK(ArchiveFindFile("INC", start + 5 * ARCHIVE_INDEX_SECONDS, filename, sizeof(filename)));
+    CHECK(ArchiveFindOffset(filename, start + 5 * ARCHIVE_INDEX_SECONDS, &offset));
+    CHECK(5 * (ARCHIVE_HEADER_SIZE + 1000) == offset);
+    CHECK(ArchiveFindOffset(filename, start + 9 * ARCHIVE_INDEX_SECONDS, &offset));
+    CHECK(9 * (ARCHIVE_HEADER_SIZE + 1000) == offset);
+
+    archive.Close();
+}
+
+// with the card not keeping up, a full RAM index is thinned out rather than abandoned
+static void TestIndexDecimation()
+{
+    char filename[ARCHIVE_CATALOG_NAME_SIZE];
+    uint8_t header[ARCHIVE_HEADER_SIZE];
+    ArchiveRecordHeader_t record;
+    uint32_t start = (uint32_t) now();
+    uint32_t offset = 0;
+
+    printf("index decimation\n");
+
+    CHECK(slow_archive.Open("DEC", 256 * 1024, 0));
+
+    FillData(3, 4);
+    for (uint32_t i = 0; i < 3 * ARCHIVE_INDEX_ENTRIES; i++) {
+        CHECK(slow_archive.WriteRecord(1, start + i * ARCHIVE_INDEX_SECONDS, data, 4));
+    }
+
+    CHECK(slow_archive.IndexDecimations() > 0);
+    CHECK(slow_archive.Sync());
+
+    // every record is found from an entry within the final spacing before it, to the end of the file
+    CHECK(ArchiveFindFile("DEC", start, filename, sizeof(filename)));
+    File file = SD.open(filename, O_READ);
+    CHECK(file);
+
+    for (uint32_t i = 0; i < 3 * ARCHIVE_INDEX_ENTRIES; i++) {
+        uint32_t time = start + i * ARCHIVE_INDEX_SECONDS;
+
+        CHECK(ArchiveFindOffset(filename, time, &offset));
+        CHECK(offset <= i * (ARCHIVE_HEADER_SIZE + 4));
+        CHECK(file.seekSet(offset) && ARCHIVE_HEADER_SIZE == file.read(header, ARCHIVE_HEADER_SIZE));
+        CHECK(ArchiveUnpackHeader(header, &record));
+        CHECK(record.time <= time);
+        CHECK(time - record.time < ((uint32_t) ARCHIVE_INDEX_SECONDS << slow_archive.IndexDecimations()));
+    }
+
+    file.close();
+    slow_archive.Close();
+}
+
+int main()
+{
+    // start from an empty card each run
+    if (0 != system("rm -rf archive_test_sd")) return 1;
+    setenv("STRATO_SD_ROOT", "archive_test_sd", 1);
+
+    setTime(START_TIME);
+    if (!StartSD() || !archive.Open("ARC", 256 * 1024, 0)) {
+        printf("unable to start the archive\n");
+        return 1;
+    }
+
+    // records of varied sizes a few per second, with the SD phase run once a "loop"
+    srand(1);
+    for (uint32_t i = 0; i < NUM_RECORDS; i++) {
+        Written_t record;
+        record.time = (uint32_t) now();
+        record.type = (uint8_t) (1 + rand() % 3);
+        record.length = (uint16_t) (rand() % sizeof(data));
+        record.seed = (uint8_t) rand();
+
+        FillData(record.seed, record.length);
+        if (archive.WriteRecord(record.type, record.time, data, record.length)) written.push_back(record);
+
+        ServiceSDLoggers(8192, 100000);
+        if (0 == i % 3) setTime(now() + 1);
+        if (0 == i % 500) archive.Sync();
+    }
+
+    archive.Close();
+
+    TestReadBack();
+    TestLookup();
+    TestWriteError();
+    TestIndexBeforeSync();
+    TestIndexDecimation();
+
+    if (failures) {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+
+    printf("all tests passed\n");
+    return 0;
+}
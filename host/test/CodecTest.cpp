@@ -0,0 +1,167 @@
+/*
+ *  CodecTest.cpp
+ *  Author:  StratoCore contributors
+ *  Created: October 2026
+ *
+ *  This file implements host-side regression tests for StratoCodec: every
+ *  codec must round-trip any buffer exactly, fall back to raw data when it
+ *  doesn't help, and reject corrupted or truncated encodings.
+ */
+
+#include "StratoCodec.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_SIZE    4096
+
+static int failures = 0;
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            printf("  FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            failures++; \
+        } \
+    } while (0)
+
+static StaticCodec<MAX_SIZE + CODEC_HEADER_SIZE> codec;
+static StaticCodec<64> small_codec;
+static uint8_t buffer[MAX_SIZE];
+static uint8_t decoded[MAX_SIZE];
+static uint8_t scratch[2 * MAX_SIZE];
+
+static const uint8_t codecs[] = {CODEC_NONE, CODEC_DELTA, CODEC_LZ, CODEC_DELTA | CODEC_LZ};
+
+static bool RoundTrip(uint8_t flags, uint8_t width, uint8_t stride, uint16_t size)
+{
+    uint16_t decoded_size = 0;
+    uint16_t encoded_size = codec.Encode(flags, width, stride, buffer, size);
+
+    if (encoded_size < CODEC_HEADER_SIZE || encoded_size > size + CODEC_HEADER_SIZE) return false;
+
+    return CodecDecode(codec.Output(), encoded_size, decoded, sizeof(decoded), &decoded_size, scratch, sizeof(scratch))
+           && decoded_size == size && 0 == memcmp(buffer, decoded, size);
+}
+
+static void TestRoundTrip()
+{
+    printf("round trip\n");
+
+    // sizes that aren't multiples of the width, and every kind of content
+    static const uint16_t sizes[] = {0, 1, 2, 3, 5, 17, 255, 1000, 4093, MAX_SIZE};
+    srand(3);
+
+    for (uint16_t size : sizes) {
+        for (uint8_t content = 0; content < 4; content++) {
+            for (uint16_t i = 0; i < size; i++) {
+                switch (content) {
+                case 0: buffer[i] = 0; break;                                 // long runs
+                case 1: buffer[i] = (uint8_t) rand(); break;                  // incompressible
+                case 2: buffer[i] = (uint8_t) ((i / 2) * 3 + (rand() % 2)); break; // ramps
+                default: buffer[i] = (uint8_t) ("abcabcxyz"[rand() % 9]); break;  // repeats
+                }
+            }
+
+            for (uint8_t flags : codecs) {
+                for (uint8_t width = 1; width <= 4; width++) {
+                    for (uint8_t stride = 1; stride <= 5; stride += 2) {
+                        CHECK(RoundTrip(flags, width, stride, size));
+                    }
+                }
+            }
+        }
+    }
+
+    // full-scale steps between values wrap rather than overflow
+    for (uint16_t i = 0; i < 64; i++) buffer[i] = (i % 8 < 4) ? 0xFF : 0x00;
+    CHECK(RoundTrip(CODEC_DELTA, 4, 1, 64));
+    CHECK(RoundTrip(CODEC_DELTA, 2, 1, 64));
+}
+
+static void TestRatio()
+{
+    uint16_t encoded_size = 0;
+
+    printf("ratio and fallback\n");
+
+    // a slow uint16_t ramp: one byte per value with delta, then LZ on the repeated deltas
+    for (uint16_t i = 0; i < 1000; i++) {
+        buffer[2 * i] = (uint8_t) ((1000 + i) >> 8);
+        buffer[2 * i + 1] = (uint8_t) (1000 + i);
+    }
+
+    encoded_size = codec.Encode(CODEC_DELTA, 2, 1, buffer, 2000);
+    CHECK(CODEC_DELTA == codec.Output()[0]);
+    CHECK(CODEC_HEADER_SIZE + 1000 + 1 == encoded_size); // the first value needs two varint bytes
+
+    encoded_size = codec.Encode(CODEC_DELTA | CODEC_LZ, 2, 1, buffer, 2000);
+    CHECK((CODEC_DELTA | CODEC_LZ) == codec.Output()[0]);
+    CHECK(encoded_size < 40);
+
+    // random data is sent raw
+    for (uint16_t i = 0; i < 2000; i++) buffer[i] = (uint8_t) rand();
+    encoded_size = codec.Encode(CODEC_DELTA | CODEC_LZ, 1, 1, buffer, 2000);
+    CHECK(CODEC_NONE == codec.Output()[0]);
+    CHECK(CODEC_HEADER_SIZE + 2000 == encoded_size);
+
+    // invalid parameters and input that doesn't fit
+    CHECK(0 == codec.Encode(CODEC_DELTA, 0, 1, buffer, 100));
+    CHECK(0 == codec.Encode(CODEC_DELTA, 5, 1, buffer, 100));
+    CHECK(0 == codec.Encode(CODEC_DELTA, 2, 0, buffer, 100));
+    CHECK(0 == codec.Encode(0x80, 1, 1, buffer, 100));
+    CHECK(0 == small_codec.Encode(CODEC_LZ, 1, 1, buffer, 100));
+}
+
+static void TestCorruption()
+{
+    uint8_t encoded[MAX_SIZE + CODEC_HEADER_SIZE];
+    uint16_t decoded_size = 0;
+    uint16_t rejected = 0;
+
+    printf("corruption\n");
+
+    for (uint16_t i = 0; i < 2000; i++) buffer[i] = (uint8_t) ("status ok, motor 123\n"[i % 21] + (i / 500));
+
+    for (uint8_t flags : codecs) {
+        uint16_t encoded_size = codec.Encode(flags, 1, 1, buffer, 2000);
+        memcpy(encoded, codec.Output(), encoded_size);
+
+        // truncation is always caught
+        for (uint16_t cut = 1; cut < encoded_size; cut += 7) {
+            bool ok = CodecDecode(encoded, cut, decoded, sizeof(decoded), &decoded_size, scratch, sizeof(scratch));
+            CHECK(!ok || decoded_size != 2000 || 0 != memcmp(buffer, decoded, 2000));
+        }
+
+        // flipped bits must never write out of bounds (run under a sanitizer), most are also rejected
+        for (uint16_t trial = 0; trial < 200; trial++) {
+            memcpy(encoded, codec.Output(), encoded_size);
+            encoded[rand() % encoded_size] ^= (uint8_t) (1 << (rand() % 8));
+            if (!CodecDecode(encoded, encoded_size, decoded, sizeof(decoded), &decoded_size, scratch, sizeof(scratch))) {
+                rejected++;
+            }
+        }
+    }
+
+    CHECK(rejected > 0);
+
+    // the combined codec needs the scratch buffer
+    uint16_t encoded_size = codec.Encode(CODEC_DELTA | CODEC_LZ, 1, 1, buffer, 2000);
+    CHECK(!CodecDecode(codec.Output(), encoded_size, decoded, sizeof(decoded), &decoded_size));
+    CHECK(!CodecDecode(codec.Output(), encoded_size, decoded, 1999, &decoded_size, scratch, sizeof(scratch)));
+}
+
+int main()
+{
+    TestRoundTrip();
+    TestRatio();
+    TestCorruption();
+
+    if (failures) {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+
+    printf("all tests passed\n");
+    return 0;
+}
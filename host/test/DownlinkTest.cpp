@@ -0,0 +1,210 @@
+/*
+ *  DownlinkTest.cpp
+ *  Author:  StratoCore contributors
+ *  Created: October 2026
+ *
+ *  This file implements host-side regression tests for StratoDownlink: the
+ *  chunks of a file or archive range, with NAKed chunks and resumed
+ *  downlinks, must reassemble into exactly the data on the card.
+ */
+
+#include "StratoDownlink.h"
+#include "TimeLib.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#define START_TIME      ((time_t) 1561000000)
+#define NUM_RECORDS     1500
+
+static int failures = 0;
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            printf("  FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            failures++; \
+        } \
+    } while (0)
+
+static StaticArchive<4096> archive;
+static StratoDownlink downlink;
+static std::vector<uint32_t> record_times;
+static uint8_t data[1500];
+
+// run a started downlink to the end (or for max_chunks), NAKing every nak_every'th chunk, appending
+// the acknowledged data to stream; returns false if the chunk offsets aren't contiguous
+static bool RunDownlink(std::vector<uint8_t> & stream, uint32_t nak_every, uint32_t max_chunks = 0xFFFFFFFF)
+{
+    uint32_t sent = 0;
+    uint32_t acked = 0;
+    bool last = false;
+
+    while (downlink.IsActive() && acked < max_chunks) {
+        // a tiny budget forces chunks to be read over several calls
+        if (!downlink.Prepare(((sent % 3) == 0) ? 0 : DOWNLINK_US_PER_LOOP)) continue;
+
+        // a NAKed chunk stays prepared until it's acknowledged
+        sent++;
+        if (nak_every && 0 == sent % nak_every) continue;
+
+        if (downlink.ChunkStreamOffset() != stream.size()) return false;
+        stream.insert(stream.end(), downlink.Chunk(), downlink.Chunk() + downlink.ChunkSize());
+        last = (0 != (downlink.ChunkFlags() & DOWNLINK_FLAG_LAST));
+        downlink.Advance();
+        acked++;
+    }
+
+    return !downlink.IsActive() ? last : true;
+}
+
+static void TestFile()
+{
+    std::vector<uint8_t> stream;
+
+    printf("file\n");
+
+    // a file that isn't a multiple of the chunk size
+    File file = SD.open("raw.bin", O_WRITE | O_CREAT | O_TRUNC);
+    for (uint32_t i = 0; i < 5000; i++) {
+        uint8_t byte = (uint8_t) (i * 13 + (i >> 8));
+        file.write(&byte, 1);
+    }
+    file.close();
+
+    CHECK(!downlink.StartFile("missing.bin"));
+    CHECK(!downlink.StartFile("raw.bin", 5001));
+
+    CHECK(downlink.StartFile("raw.bin"));
+    CHECK(RunDownlink(stream, 4));
+    CHECK(5000 == stream.size());
+    CHECK(5000 == downlink.GetStats().bytes_acked);
+
+    bool intact = true;
+    for (uint32_t i = 0; i < stream.size(); i++) {
+        if (stream[i] != (uint8_t) (i * 13 + (i >> 8))) intact = false;
+    }
+    CHECK(intact);
+
+    // stop partway and resume from the reported offset
+    std::vector<uint8_t> resumed;
+    CHECK(downlink.StartFile("raw.bin"));
+    CHECK(RunDownlink(resumed, 0, 2));
+    downlink.Stop();
+    CHECK(2 * DOWNLINK_CHUNK_SIZE == downlink.StreamOffset());
+
+    CHECK(downlink.StartFile("raw.bin", (uint32_t) resumed.size()));
+    CHECK(RunDownlink(resumed, 5));
+    CHECK(resumed == stream);
+
+    // an empty file is a single empty last chunk
+    file = SD.open("empty.bin", O_WRITE | O_CREAT | O_TRUNC);
+    file.close();
+    std::vector<uint8_t> empty;
+    CHECK(downlink.StartFile("empty.bin"));
+    CHECK(RunDownlink(empty, 0));
+    CHECK(empty.empty());
+    CHECK(1 == downlink.GetStats().chunks_acked);
+}
+
+// parse a downlinked archive stream and check it holds exactly the records in [start, end]
+static void CheckArchiveStream(const std::vector<uint8_t> & stream, uint32_t start, uint32_t end)
+{
+    ArchiveRecordHeader_t record;
+    uint32_t offset = 0;
+    size_t expected = 0;
+
+    while (expected < record_times.size() && record_times[expected] < start) expected++;
+
+    while (offset + ARCHIVE_HEADER_SIZE <= stream.size()) {
+        CHECK(ArchiveUnpackHeader(&stream[offset], &record));
+        CHECK(offset + ARCHIVE_HEADER_SIZE + record.length <= stream.size());
+        if (offset + ARCHIVE_HEADER_SIZE + record.length > stream.size()) return;
+        CHECK(ArchiveCheckRecord(&stream[offset], &stream[offset + ARCHIVE_HEADER_SIZE]));
+        CHECK(expected < record_times.size() && record.time == record_times[expected]);
+        offset += ARCHIVE_HEADER_SIZE + record.length;
+        expected++;
+    }
+
+    CHECK(offset == stream.size());
+    CHECK(expected == record_times.size() || record_times[expected] > end);
+}
+
+static void TestArchive()
+{
+    uint32_t start = (uint32_t) START_TIME + 100;
+    uint32_t end = (uint32_t) START_TIME + 400;
+
+    printf("archive range\n");
+
+    // records spread over several files, each a few per second
+    srand(2);
+    CHECK(archive.Open("DL", 64 * 1024, 0));
+    for (uint32_t i = 0; i < NUM_RECORDS; i++) {
+        uint16_t length = (uint16_t) (rand() % sizeof(data));
+        for (uint16_t j = 0; j < length; j++) data[j] = (uint8_t) rand();
+
+        if (archive.WriteRecord(ARCHIVE_TYPE_TM, (uint32_t) now(), data, length)) record_times.push_back((uint32_t) now());
+
+        ServiceSDLoggers(65536, 100000);
+        if (0 == i % 3) setTime(now() + 1);
+    }
+    archive.Close();
+
+    std::vector<uint8_t> stream;
+    CHECK(downlink.StartArchive("DL", start, end));
+    CHECK(RunDownlink(stream, 3));
+    CheckArchiveStream(stream, start, end);
+    CHECK(stream.size() > 0);
+
+    // the whole archive, from before the first record
+    std::vector<uint8_t> all;
+    CHECK(downlink.StartArchive("DL", 0, 0xFFFFFFFF));
+    CHECK(RunDownlink(all, 0));
+    CheckArchiveStream(all, 0, 0xFFFFFFFF);
+
+    // resume partway, the offset falls inside a record
+    std::vector<uint8_t> resumed;
+    CHECK(downlink.StartArchive("DL", start, end));
+    CHECK(RunDownlink(resumed, 0, 7));
+    downlink.Stop();
+    CHECK(resumed.size() == downlink.StreamOffset());
+
+    CHECK(downlink.StartArchive("DL", start, end, downlink.StreamOffset()));
+    CHECK(RunDownlink(resumed, 4));
+    CHECK(resumed == stream);
+
+    // an empty range still ends with a last chunk
+    std::vector<uint8_t> none;
+    CHECK(downlink.StartArchive("DL", (uint32_t) now() + 10, (uint32_t) now() + 20));
+    CHECK(RunDownlink(none, 0));
+    CHECK(none.empty());
+
+    CHECK(!downlink.StartArchive("NONE", start, end));
+    CHECK(!downlink.StartArchive("DL", end, start));
+}
+
+int main()
+{
+    // start from an empty card each run
+    if (0 != system("rm -rf downlink_test_sd")) return 1;
+    setenv("STRATO_SD_ROOT", "downlink_test_sd", 1);
+
+    setTime(START_TIME);
+    if (!StartSD()) {
+        printf("unable to start the card\n");
+        return 1;
+    }
+
+    TestFile();
+    TestArchive();
+
+    if (failures) {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+
+    printf("all tests passed\n");
+    return 0;
+}
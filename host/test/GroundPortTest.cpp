@@ -0,0 +1,228 @@
+/*
+ *  GroundPortTest.cpp
+ *  Author:  StratoCore contributors
+ *  Created: October 2026
+ *
+ *  This file implements host-side regression tests for the buffered ground
+ *  port: output must never wait on the port, lines must arrive whole and in
+ *  order, a full queue must give up debug lines before errors, and logs below
+ *  the module's level must compile out.
+ */
+
+#include "StratoGroundPort.h"
+#include <stdio.h>
+#include <string.h>
+#include <string>
+
+static int failures = 0;
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            printf("  FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            failures++; \
+        } \
+    } while (0)
+
+// a port that only accepts as many bytes as it's given room for
+class ThrottledStream : public Stream {
+public:
+    size_t write(uint8_t b) { return write(&b, 1); }
+    size_t write(const uint8_t * buffer, size_t size)
+    {
+        if ((int) size > room) overrun = true;
+        room -= (int) size;
+        output.append((const char *) buffer, size);
+        return size;
+    }
+    using Print::write;
+
+    int availableForWrite() { return room; }
+    int available() { return 0; }
+    int read() { return -1; }
+    int peek() { return -1; }
+
+    int room = 0;
+    bool overrun = false;
+    std::string output;
+};
+
+static ThrottledStream port;
+
+static uint32_t CountLines(const char * text)
+{
+    uint32_t count = 0;
+    size_t position = 0;
+
+    while (std::string::npos != (position = port.output.find(text, position))) {
+        count++;
+        position++;
+    }
+
+    return count;
+}
+
+static void TestPartialWrites()
+{
+    char message[64];
+    std::string expected;
+
+    printf("partial writes\n");
+
+    // a few bytes at a time, lines arrive whole and in order
+    port.output.clear();
+    for (uint16_t i = 0; i < 50; i++) {
+        snprintf(message, sizeof(message), "line %u", i);
+        log_nominal(message);
+        expected += "NOM: " + std::string(message) + "\r\n";
+
+        port.room = 7;
+        ground_port.Drain();
+    }
+
+    while (ground_port.Queued() > 0) {
+        port.room = 7;
+        ground_port.Drain();
+    }
+
+    CHECK(port.output == expected);
+    CHECK(!port.overrun);
+
+    // a line longer than GROUND_PORT_LINE_SIZE is split but complete
+    std::string long_line(2 * GROUND_PORT_LINE_SIZE + 10, 'x');
+    port.output.clear();
+    port.room = 100000;
+    log_nominal(long_line.c_str());
+    CHECK(port.output == "NOM: " + long_line + "\r\n");
+}
+
+static int Counted(int * count)
+{
+    return ++(*count);
+}
+
+static void TestFormatted()
+{
+    int evaluated = 0;
+
+    printf("formatted and filtered\n");
+
+    port.output.clear();
+    port.room = 100000;
+
+    log_nominalf("motor %u at %d, %s", 3u, -1205, "ok");
+    log_errorf("%d", Counted(&evaluated));
+    CHECK(port.output == "NOM: motor 3 at -1205, ok\r\nERR: 1\r\n");
+
+    // below the module level, the arguments aren't even evaluated
+    port.output.clear();
+    log_debug("not shown");
+    log_debugf("%d", Counted(&evaluated));
+    CHECK(port.output.empty());
+    CHECK(1 == evaluated);
+
+    // a long formatted line is truncated to one line, and the next line is unaffected
+    std::string long_line(2 * GROUND_PORT_LINE_SIZE, 'y');
+    log_nominalf("%s", long_line.c_str());
+    log_nominalf("next");
+    CHECK(port.output.size() == GROUND_PORT_LINE_SIZE + strlen("NOM: next\r\n"));
+    CHECK(0 == port.output.compare(GROUND_PORT_LINE_SIZE - 2, std::string::npos, "\r\nNOM: next\r\n"));
+}
+
+// a module can opt in to its debug output
+#undef LOG_MODULE_LEVEL
+#define LOG_MODULE_LEVEL LOG_DEBUG
+
+static void TestModuleLevel()
+{
+    printf("module level\n");
+
+    port.output.clear();
+    port.room = 100000;
+    log_debugf("value %u", 7u);
+    CHECK(port.output == "DBG: value 7\r\n");
+}
+
+static void TestPriority()
+{
+    char message[64];
+
+    printf("priority\n");
+
+    // the terminal stalls: nothing may be written
+    port.room = 0;
+    port.output.clear();
+    GroundPortStats_t before = ground_port.GetStats();
+
+    for (uint16_t i = 0; i < 110; i++) {
+        snprintf(message, sizeof(message), "debug %03u ......................", i);
+        ground_port.BeginLine(LOG_DEBUG);
+        debug_serial->println(message);
+    }
+    CHECK(port.output.empty());
+    CHECK(ground_port.Queued() > GROUND_PORT_BUFFER_SIZE - 64);
+
+    // errors push out the debug lines, oldest first
+    for (uint16_t i = 0; i < 50; i++) {
+        snprintf(message, sizeof(message), "error %03u ......................", i);
+        log_error(message);
+    }
+
+    // more debug output can't displace errors
+    for (uint16_t i = 200; i < 220; i++) {
+        snprintf(message, sizeof(message), "debug %03u ......................", i);
+        ground_port.BeginLine(LOG_DEBUG);
+        debug_serial->println(message);
+    }
+
+    const GroundPortStats_t & stats = ground_port.GetStats();
+    CHECK(0 == stats.lines_dropped[LOG_ERROR] - before.lines_dropped[LOG_ERROR]);
+    CHECK(stats.lines_dropped[LOG_DEBUG] - before.lines_dropped[LOG_DEBUG] >= 50);
+
+    // the port recovers
+    port.room = 100000;
+    ground_port.Drain();
+    CHECK(50 == CountLines("ERR: error"));
+    CHECK(0 == CountLines("debug 000"));
+    CHECK(0 == CountLines("debug 219"));
+    CHECK(1 == CountLines("debug 109"));
+    CHECK(1 == CountLines("ground port dropped"));
+
+    // the errors are in order and the surviving debug lines came before them
+    CHECK(port.output.find("error 000") < port.output.find("error 049"));
+    CHECK(port.output.find("debug 109") < port.output.find("error 000"));
+    CHECK(0 == ground_port.Queued());
+
+    // with only errors queued, new errors are dropped rather than old ones
+    port.room = 0;
+    port.output.clear();
+    before = ground_port.GetStats();
+    for (uint16_t i = 0; i < 200; i++) {
+        snprintf(message, sizeof(message), "error %03u ......................", i);
+        log_error(message);
+    }
+    CHECK(ground_port.GetStats().lines_dropped[LOG_ERROR] > before.lines_dropped[LOG_ERROR]);
+
+    port.room = 100000;
+    ground_port.Drain();
+    CHECK(1 == CountLines("error 000"));
+    CHECK(0 == CountLines("error 199"));
+}
+
+int main()
+{
+    ground_port.SetPort(&port);
+
+    TestPartialWrites();
+    TestFormatted();
+    TestModuleLevel();
+    TestPriority();
+
+    if (failures) {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+
+    printf("all tests passed\n");
+    return 0;
+}
@@ -0,0 +1,228 @@
+/*
+ *  HighResSchedulerTest.cpp
+ *  Author:  StratoCore contributors
+ *  Created: October 2026
+ *
+ *  This file implements host-side regression tests for
+ *  StratoHighResScheduler: ordering across a millis() wrap, phase-locked
+ *  periodic actions, lateness statistics, cancellation, and use of the
+ *  shared pool and heap alongside the 1 Hz StratoScheduler.
+ */
+
+#include "StratoHighResScheduler.h"
+#include <stdio.h>
+
+static int failures = 0;
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            printf("  FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            failures++; \
+        } \
+    } while (0)
+
+struct Fired_t {
+    uint8_t action;
+    uint32_t time; // StratoMillis()
+    uint32_t lateness;
+};
+
+static VirtualClock test_clock(1561000000);
+static StaticHighResScheduler<16> scheduler;
+static Fired_t fired[256];
+static uint16_t num_fired = 0;
+
+// advance the clock step_ms at a time, recording every action as it fires
+static void RunFor(uint32_t ms, uint32_t step_ms = 1)
+{
+    uint32_t start = StratoMillis();
+
+    while (true) {
+        uint8_t action;
+        uint32_t lateness = 0;
+        while (NO_SCHEDULED_ACTION != (action = scheduler.CheckSchedule(&lateness))) {
+            if (num_fired < 256) {
+                fired[num_fired].action = action;
+                fired[num_fired].time = StratoMillis();
+                fired[num_fired].lateness = lateness;
+                num_fired++;
+            }
+        }
+
+        if (StratoMillis() - start >= ms) break;
+        test_clock.Advance(step_ms);
+    }
+}
+
+static void Reset()
+{
+    scheduler.ClearSchedule();
+    scheduler.ResetStats();
+    num_fired = 0;
+}
+
+static void TestWrap()
+{
+    printf("ordering across the millis() wrap\n");
+    Reset();
+
+    // 50 ms before the wrap
+    test_clock.Advance(0xFFFFFFFFUL - StratoMillis() - 49);
+    uint32_t start = StratoMillis();
+
+    // due after the wrap, before it, and exactly at it
+    scheduler.AddAction(3, 100);
+    scheduler.AddAction(1, 20);
+    scheduler.AddAction(2, 50);
+
+    uint32_t ms = 0;
+    CHECK(scheduler.TimeUntilNext(&ms));
+    CHECK(20 == ms);
+
+    RunFor(150);
+
+    CHECK(3 == num_fired);
+    CHECK(1 == fired[0].action && start + 20 == fired[0].time);
+    CHECK(2 == fired[1].action && 0 == fired[1].time);
+    CHECK(3 == fired[2].action && start + 100 == fired[2].time);
+    CHECK(0 == scheduler.ScheduleSize());
+}
+
+static void TestPeriodic()
+{
+    printf("periodic without drift\n");
+    Reset();
+
+    uint32_t start = StratoMillis();
+    scheduler.AddPeriodicAction(1, 100, 100);
+
+    // serviced only every 30 ms, each run is still on its 100 ms slot, not the time it ran
+    RunFor(1000, 30);
+
+    CHECK(10 == num_fired);
+    for (uint16_t i = 0; i < num_fired; i++) {
+        CHECK(fired[i].time - fired[i].lateness == start + 100 * (i + 1));
+        CHECK(fired[i].lateness < 30);
+    }
+
+    // a stall longer than several periods runs once, then the next slot is back in phase
+    num_fired = 0;
+    test_clock.Advance(450);
+    RunFor(200);
+    CHECK(3 == num_fired);
+    CHECK(0 == (fired[1].time - start) % 100);
+    CHECK(100 == fired[2].time - fired[1].time);
+    CHECK(1 == scheduler.ScheduleSize());
+}
+
+static void TestLateness()
+{
+    printf("lateness stats\n");
+    Reset();
+
+    scheduler.AddAction(1, 10);
+    scheduler.AddAction(2, 20);
+    scheduler.AddAction(3, 30);
+
+    // 1 on time, 2 serviced 3 ms late, 3 serviced 12 ms late
+    test_clock.Advance(10);
+    CHECK(1 == scheduler.CheckSchedule());
+    test_clock.Advance(13);
+    CHECK(2 == scheduler.CheckSchedule());
+    test_clock.Advance(19);
+    uint32_t lateness = 0;
+    CHECK(3 == scheduler.CheckSchedule(&lateness));
+    CHECK(12 == lateness);
+
+    const HighResStats_t & stats = scheduler.GetStats();
+    CHECK(3 == stats.fired);
+    CHECK(1 == stats.late); // only 3 is past HIGHRES_LATE_MS
+    CHECK(15 == stats.lateness_total);
+    CHECK(12 == stats.lateness_max);
+    CHECK(3 == stats.lateness_max_action);
+
+    scheduler.ResetStats();
+    CHECK(0 == stats.fired && 0 == stats.lateness_max);
+}
+
+static void TestCancel()
+{
+    printf("cancel by handle and by action\n");
+    Reset();
+
+    ScheduleHandle_t first = scheduler.AddAction(1, 10);
+    ScheduleHandle_t second = scheduler.AddAction(2, 20);
+    scheduler.AddPeriodicAction(3, 5, 5);
+    scheduler.AddAction(3, 15);
+    ScheduleHandle_t fourth = scheduler.AddAction(4, 25);
+
+    // by handle: only that one, and only once
+    CHECK(scheduler.CancelAction(first));
+    CHECK(!scheduler.CancelAction(first));
+    CHECK(!scheduler.IsPending(first));
+    CHECK(scheduler.IsPending(second));
+
+    // by action: every pending instance, including a periodic one
+    CHECK(2 == scheduler.CancelAction((uint8_t) 3));
+    CHECK(0 == scheduler.CancelAction((uint8_t) 3));
+    CHECK(2 == scheduler.ScheduleSize());
+
+    RunFor(30);
+    CHECK(2 == num_fired);
+    CHECK(2 == fired[0].action && 4 == fired[1].action);
+
+    // the last item freed is reused first, and the handle from its last use is stale
+    ScheduleHandle_t reused = scheduler.AddAction(5, 10);
+    CHECK(reused.index == fourth.index);
+    CHECK(!scheduler.IsPending(fourth));
+    CHECK(!scheduler.CancelAction(fourth));
+    CHECK(scheduler.IsPending(reused));
+}
+
+static void TestSharedPool()
+{
+    printf("alongside the 1 Hz scheduler\n");
+    Reset();
+
+    StaticScheduler<4> slow;
+
+    // each schedule has its own pool from the shared implementation, filling one leaves the other free
+    for (uint16_t i = 0; i < scheduler.ScheduleCapacity(); i++) {
+        CHECK(scheduler.AddAction((uint8_t) (i + 1), 1000 + i));
+    }
+    CHECK(!scheduler.AddAction(99, 10));
+    CHECK(slow.AddAction(1, (time_t) 1));
+    CHECK(slow.AddPeriodicAction(2, 1, (time_t) 1, 2));
+
+    // cancelling an action ID in one leaves the same ID in the other
+    CHECK(1 == scheduler.CancelAction((uint8_t) 1));
+    CHECK(2 == slow.ScheduleSize());
+    CHECK(1 == slow.CancelAction((uint8_t) 2));
+    CHECK(scheduler.ScheduleSize() == scheduler.ScheduleCapacity() - 1);
+
+    // and the freed items are reused by their own schedule
+    CHECK(scheduler.AddAction(99, 10));
+    CHECK(!scheduler.AddAction(100, 10));
+    CHECK(slow.AddAction(3, (time_t) 1));
+    CHECK(2 == slow.ScheduleSize());
+
+    slow.ClearSchedule();
+}
+
+int main()
+{
+    SetStratoClock(&test_clock);
+
+    TestWrap();
+    TestPeriodic();
+    TestLateness();
+    TestCancel();
+    TestSharedPool();
+
+    SetStratoClock(NULL);
+
+    printf("%s: %d failure(s)\n", (0 == failures) ? "PASS" : "FAIL", failures);
+
+    return (0 == failures) ? 0 : 1;
+}
@@ -0,0 +1,159 @@
+/*
+ *  IdleTest.cpp
+ *  Author:  StratoCore contributors
+ *  Created: October 2026
+ *
+ *  This file implements host-side regression tests for Idle: it must sleep
+ *  until the earliest deadline, return at once when input or TCs are already
+ *  waiting, leave the sleep out of the watchdog budget, and count the time
+ *  and wake-ups in its statistics.
+ */
+
+#include "TestSupport.h"
+#include "TimeLib.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+class TestInstrument : public TestInstrumentBase {
+public:
+    StratoScheduler & Scheduler() { return scheduler; }
+    StratoHighResScheduler & HighResScheduler() { return highres_scheduler; }
+    StratoTCQueue & TCQueue() { return tc_queue; }
+    StratoWatchdog & Watchdog() { return watchdog_monitor; }
+    StratoIdle & IdleStats() { return idle; }
+};
+
+static TestInstrument inst;
+
+static void TestTimeout()
+{
+    printf("sleep for the time given\n");
+
+    inst.KickWatchdog();
+
+    uint32_t start = millis();
+    CHECK(IDLE_WAKE_TIMEOUT == inst.Idle(50));
+    uint32_t elapsed = millis() - start;
+
+    CHECK(elapsed >= 50);
+    CHECK(elapsed < 50 + 100);
+
+    // a zero-length idle doesn't sleep
+    start = millis();
+    CHECK(IDLE_WAKE_TIMEOUT == inst.Idle(0));
+    CHECK(millis() - start < 100);
+}
+
+static void TestDeadlines()
+{
+    printf("wake for the earliest deadline\n");
+
+    inst.KickWatchdog();
+
+    inst.HighResScheduler().AddAction(1, 30);
+    uint32_t start = millis();
+    CHECK(IDLE_WAKE_HIGHRES == inst.Idle(500));
+    uint32_t elapsed = millis() - start;
+    CHECK(elapsed >= 30);
+    CHECK(elapsed < 30 + 100);
+    inst.RunHighResScheduler();
+    CHECK(0 == inst.HighResScheduler().ScheduleSize());
+
+    // a due 1 Hz action ends the idle at once, one in the future only if it's sooner than the time given
+    inst.Scheduler().AddAction(2, (time_t) 0);
+    start = millis();
+    CHECK(IDLE_WAKE_SCHEDULE == inst.Idle(500));
+    CHECK(millis() - start < 100);
+    inst.RunScheduler();
+
+    inst.Scheduler().AddAction(3, (time_t) 60);
+    CHECK(IDLE_WAKE_TIMEOUT == inst.Idle(20));
+    inst.Scheduler().ClearSchedule();
+}
+
+static void TestWaitingWork()
+{
+    printf("no sleep with work waiting\n");
+
+    // input waiting to be routed
+    zephyr_stream.Inject("<GPS>");
+    uint32_t start = millis();
+    CHECK(IDLE_WAKE_INPUT == inst.Idle(500));
+    CHECK(millis() - start < 100);
+    zephyr_stream.Clear();
+
+    // TCs left by the per-loop limits
+    CHECK(inst.TCQueue().PushBatch("1;", 2, 1));
+    start = millis();
+    CHECK(IDLE_WAKE_TC == inst.Idle(500));
+    CHECK(millis() - start < 100);
+    inst.RunRouter();
+    CHECK(0 == inst.TCQueue().Count());
+}
+
+static void TestWatchdogBudget()
+{
+    printf("sleep left out of the watchdog budget\n");
+
+    inst.KickWatchdog();
+    uint32_t warnings = inst.Watchdog().GetWarnings(1);
+
+    // past the 1 s warning threshold, but asleep
+    CHECK(IDLE_WAKE_TIMEOUT == inst.Idle(1100));
+    CHECK(inst.Watchdog().SinceKick() >= 1100);
+    CHECK(inst.Watchdog().LoopElapsed() < 100);
+
+    inst.KickWatchdog();
+    CHECK(inst.Watchdog().GetWarnings(1) == warnings);
+}
+
+static void TestStats()
+{
+    printf("duty cycle statistics\n");
+
+    inst.IdleStats().Reset();
+
+    // awake for about 20 ms, asleep for about 80 ms
+    uint32_t start = millis();
+    while (millis() - start < 20) { }
+    inst.Idle(80);
+    zephyr_stream.Inject("<GPS>");
+    inst.Idle(80);
+    zephyr_stream.Clear();
+
+    const IdleStats_t & stats = inst.GetIdleStats();
+    CHECK(2 == stats.calls);
+    CHECK(1 == stats.sleeps);
+    CHECK(1 == stats.wakes[IDLE_WAKE_TIMEOUT]);
+    CHECK(1 == stats.wakes[IDLE_WAKE_INPUT]);
+    CHECK(stats.idle_us >= 79000); // the sleep ends on a whole ms, up to a ms short of 80 ms on micros()
+    CHECK(stats.max_sleep_ms >= 80);
+
+    uint16_t duty_cycle = inst.IdleStats().DutyCycle();
+    CHECK(duty_cycle >= 100);
+    CHECK(duty_cycle <= 500);
+}
+
+int main()
+{
+    setTime(1561000000);
+    setenv("STRATO_SD_ROOT", "idle_test_sd", 1);
+    inst.InitializeCore();
+
+    debug_stream.capture = true;
+
+    TestTimeout();
+    TestDeadlines();
+    TestWaitingWork();
+    TestWatchdogBudget();
+    TestStats();
+
+    if (failures) {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+
+    printf("all tests passed\n");
+    return 0;
+}
@@ -0,0 +1,222 @@
+/*
+ *  LogTokenTest.cpp
+ *  Author:  StratoCore contributors
+ *  Created: October 2026
+ *
+ *  This file implements host-side regression tests for tokenized logging:
+ *  the dictionary built from this file must expand every frame sent to the
+ *  ground port or the archive to exactly the text printf would have made.
+ */
+
+#define LOG_TOKENIZED
+#define LOG_MODULE_LEVEL LOG_DEBUG
+
+#include "StratoGroundPort.h"
+#include "StratoArchive.h"
+#include "LogTokenDecoder.h"
+#include "TimeLib.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+static int failures = 0;
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            printf("  FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            failures++; \
+        } \
+    } while (0)
+
+// collects the ground port's output
+class CaptureStream : public Stream {
+public:
+    size_t write(uint8_t b) { output += (char) b; return 1; }
+    size_t write(const uint8_t * buffer, size_t size) { output.append((const char *) buffer, size); return size; }
+    using Print::write;
+
+    int availableForWrite() { return 100000; }
+    int available() { return 0; }
+    int read() { return -1; }
+    int peek() { return -1; }
+
+    std::string output;
+};
+
+static CaptureStream port;
+static LogTokenDictionary dictionary;
+static StaticArchive<4096> archive;
+
+// expand the single captured line
+static std::string Expanded()
+{
+    std::string line = port.output;
+    port.output.clear();
+
+    if (line.size() < 2 || 0 != line.compare(line.size() - 2, 2, "\r\n")) return "<no line>";
+    line.resize(line.size() - 2);
+
+    return LogTokenExpandLine(dictionary, line);
+}
+
+static void TestDictionary()
+{
+    std::string error;
+
+    printf("dictionary\n");
+
+    CHECK(LogTokenScanSource(__FILE__, dictionary, error));
+    CHECK(error.empty());
+    CHECK(LOG_TOKEN("motor %u at %d") == LogTokenHashString("motor %u at %d"));
+    CHECK(dictionary.end() != dictionary.find(LOG_TOKEN("motor %u at %d")));
+
+    // escapes and concatenated literals hash as the compiler sees them
+    CHECK(dictionary.end() != dictionary.find(LOG_TOKEN("tab\there \"quoted\" 100%%")));
+    CHECK(dictionary.end() != dictionary.find(LOG_TOKEN("joined literal")));
+
+    // it survives a save and load
+    LogTokenDictionary loaded;
+    CHECK(LogTokenSaveDictionary("log_token_test_dict.txt", dictionary));
+    CHECK(LogTokenLoadDictionary("log_token_test_dict.txt", loaded));
+    CHECK(loaded == dictionary);
+}
+
+static void TestExpansion()
+{
+    char expected[256];
+
+    printf("expansion\n");
+
+    log_nominalf("motor %u at %d", 3u, -1205);
+    CHECK(Expanded() == "NOM: motor 3 at -1205");
+
+    log_debugf("tab\there \"quoted\" 100%%");
+    CHECK(Expanded() == "DBG: tab\there \"quoted\" 100%");
+
+    log_errorf("joined " "literal");
+    CHECK(Expanded() == "ERR: joined literal");
+
+    // every integer width and signedness, as the Teensy's printf would print them
+    int32_t negative = -123456;
+    uint32_t large = 4000000000UL;
+    int64_t wide = -5000000000LL;
+    uint8_t byte = 200;
+    snprintf(expected, sizeof(expected), "DBG: %d %u %x %lld %u %c %5.2f %-6s|%08X %hhd", (int) negative, (unsigned int) large,
+             (unsigned int) large, (long long) wide, byte, 'Z', 3.14159, "ab", 0xBEEFu, (signed char) -3);
+    log_debugf("%d %u %x %lld %u %c %5.2f %-6s|%08X %hhd", (int) negative, (unsigned int) large,
+               (unsigned int) large, (long long) wide, byte, 'Z', 3.14159, "ab", 0xBEEFu, (signed char) -3);
+    CHECK(Expanded() == expected);
+
+    // a negative value printed with %u wraps to 32 bits, as on the Teensy
+    log_debugf("%u", (unsigned int) -1);
+    CHECK(Expanded() == "DBG: 4294967295");
+
+    // * width and precision come from the arguments
+    log_debugf("[%*.*f]", 8, 3, 2.5);
+    CHECK(Expanded() == "DBG: [   2.500]");
+
+    // floats are sent as floats
+    log_nominalf("SZA: %f", 101.25);
+    CHECK(Expanded() == "NOM: SZA: 101.250000");
+
+    // a string that doesn't fit the frame is cut and marked
+    std::string long_string(2 * LOG_TOKEN_FRAME_SIZE, 's');
+    log_debugf("%s", long_string.c_str());
+    std::string line = Expanded();
+    CHECK(line.size() > 40 && line.size() < 10 + LOG_TOKEN_FRAME_SIZE);
+    CHECK(0 == line.compare(line.size() - 4, 4, "s..."));
+
+    // arguments after a full frame are shown as missing, not misread
+    log_debugf("%s %d", long_string.c_str(), 7);
+    line = Expanded();
+    CHECK(0 == line.compare(line.size() - 4, 4, " <?>"));
+
+    // an unknown token is reported, not dropped
+    log_debugf("not in the dictionary");
+    dictionary.erase(LOG_TOKEN("not in the dictionary"));
+    CHECK(std::string::npos != Expanded().find("unknown log token"));
+
+    // text lines pass through unchanged
+    CHECK(LogTokenExpandLine(dictionary, "NOM: plain text") == "NOM: plain text");
+}
+
+static void TestSize()
+{
+    char text[128];
+
+    printf("size\n");
+
+    // the GPS line from UpdateTime, as text and as a frame line
+    log_nominalf("%u:%u:%u %u/%u/%u, SZA: %f", 12, 34, 56, 10, 16, 2026, 87.5);
+    size_t frame_line = port.output.size();
+    int text_line = snprintf(text, sizeof(text), "NOM: %u:%u:%u %u/%u/%u, SZA: %f\r\n", 12, 34, 56, 10, 16, 2026, 87.5);
+    CHECK(Expanded() + "\r\n" == text);
+    CHECK(frame_line < (size_t) text_line);
+    printf("  GPS line: %d bytes as text, %u tokenized\n", text_line, (unsigned int) frame_line);
+}
+
+static void TestArchive()
+{
+    uint8_t header[ARCHIVE_HEADER_SIZE];
+    uint8_t data[256];
+    ArchiveRecordHeader_t record;
+    std::vector<std::string> lines;
+
+    printf("archive\n");
+
+    if (0 != system("rm -rf log_token_test_sd")) return;
+    setenv("STRATO_SD_ROOT", "log_token_test_sd", 1);
+    setTime(1561000000);
+
+    CHECK(StartSD());
+    CHECK(archive.Open("LOG"));
+
+    // to the archive only
+    LogTokenOutputs(LOG_TOKEN_ARCHIVE, &archive);
+    for (int i = 0; i < 20; i++) {
+        log_errorf("archived %d of %s", i, "twenty");
+    }
+    CHECK(port.output.empty());
+
+    LogTokenOutputs(LOG_TOKEN_GROUND_PORT);
+    CHECK(archive.Sync());
+    archive.Close();
+
+    File file = SD.open("LOG_1561000000.dat", O_READ);
+    while (ARCHIVE_HEADER_SIZE == file.read(header, ARCHIVE_HEADER_SIZE) && ArchiveUnpackHeader(header, &record)) {
+        if ((int) record.length != file.read(data, record.length)) break;
+
+        CHECK(ARCHIVE_TYPE_LOG == record.type);
+        CHECK(ArchiveCheckRecord(header, data));
+        CHECK(LOG_ERROR == data[0]);
+        lines.push_back(LogTokenExpandFrame(dictionary, &data[1], record.length - 1));
+    }
+    file.close();
+
+    CHECK(20 == lines.size());
+    if (20 == lines.size()) {
+        CHECK(lines[0] == "archived 0 of twenty");
+        CHECK(lines[19] == "archived 19 of twenty");
+    }
+}
+
+int main()
+{
+    ground_port.SetPort(&port);
+
+    TestDictionary();
+    TestExpansion();
+    TestSize();
+    TestArchive();
+
+    if (failures) {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+
+    printf("all tests passed\n");
+    return 0;
+}
@@ -0,0 +1,190 @@
+/*
+ *  ModeTableTest.cpp
+ *  Author:  StratoCore contributors
+ *  Created: October 2026
+ *
+ *  This file implements host-side regression tests for substate tables:
+ *  handler results, timeouts and errors must lead to the table's substates,
+ *  substates outside the table must still reach the mode function (and a
+ *  shutdown warning must sync every SD logger), and the profile must count
+ *  entries and time spent in each substate.
+ */
+
+#include "TestSupport.h"
+#include "TimeLib.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+#define FL_WAIT     1
+#define FL_MEASURE  2
+
+class TestInstrument : public TestInstrumentBase {
+public:
+    void InstrumentSetup()
+    {
+        static constexpr SubstateEntry_t flight_table[] = {
+            SUBSTATE(MODE_ENTRY, TestInstrument::FlightEntry, 0, MODE_ENTRY, MODE_ERROR),
+            SUBSTATE(FL_WAIT, TestInstrument::FlightWait, 1, FL_MEASURE, MODE_ERROR),
+            SUBSTATE(FL_MEASURE, TestInstrument::FlightMeasure, 0, FL_MEASURE, MODE_ERROR),
+            SUBSTATE(MODE_ERROR, TestInstrument::FlightError, 0, MODE_ERROR, MODE_ERROR),
+        };
+        static_assert(SubstateTableValid(flight_table), "flight substate table");
+
+        SetModeTable(MODE_FLIGHT, flight_table);
+    }
+
+    uint8_t Substate() { return inst_substate; }
+
+    // an instrument's own log, synced on a shutdown warning
+    StaticSDLogger<4096> data_log;
+    StratoProfiler & Profiler() { return profiler; }
+
+    // substates seen by FlightMode, which only gets those outside the table
+    uint8_t mode_function_substate = 0;
+    uint32_t mode_function_calls = 0;
+    uint32_t measurements = 0;
+    bool fail = false;
+
+    uint8_t FlightEntry() { return FL_WAIT; }
+    uint8_t FlightWait() { return FL_WAIT; }
+    uint8_t FlightMeasure() { measurements++; return fail ? MODE_ERROR : FL_MEASURE; }
+    uint8_t FlightError() { return MODE_ERROR; }
+
+private:
+    void FlightMode() { mode_function_substate = inst_substate; mode_function_calls++; }
+};
+
+// tables that must fail the compile-time check
+static constexpr SubstateEntry_t no_entry[] = {
+    SUBSTATE(FL_WAIT, TestInstrument::FlightWait, 0, FL_WAIT, FL_WAIT),
+};
+static_assert(!SubstateTableValid(no_entry), "a table needs MODE_ENTRY");
+
+static constexpr SubstateEntry_t duplicate[] = {
+    SUBSTATE(MODE_ENTRY, TestInstrument::FlightEntry, 0, MODE_ENTRY, MODE_ENTRY),
+    SUBSTATE(MODE_ENTRY, TestInstrument::FlightWait, 0, MODE_ENTRY, MODE_ENTRY),
+};
+static_assert(!SubstateTableValid(duplicate), "substates must be unique");
+
+static constexpr SubstateEntry_t dangling[] = {
+    SUBSTATE(MODE_ENTRY, TestInstrument::FlightEntry, 5, FL_MEASURE, MODE_ENTRY),
+};
+static_assert(!SubstateTableValid(dangling), "transitions must stay in the table");
+
+static TestInstrument inst;
+
+static void SetMode(const char * mode)
+{
+    char msg[200];
+    snprintf(msg, sizeof(msg), "<IM><Msg>1</Msg><Inst>RACHuTS</Inst><Mode>%s</Mode></IM><CRC>0</CRC><END>", mode);
+    zephyr_stream.Inject(msg);
+    inst.RunRouter();
+}
+
+static const ModeStats_t * Slot(uint8_t mode, uint8_t substate)
+{
+    for (uint8_t i = 0; i < inst.Profiler().NumModeSlots(); i++) {
+        const ModeStats_t & slot = inst.Profiler().GetModeSlot(i);
+        if (slot.mode == mode && slot.substate == substate) return &slot;
+    }
+
+    return NULL;
+}
+
+static void TestTransitions()
+{
+    printf("transitions\n");
+
+    SetMode("FL");
+    inst.RunMode(); // standby exit, flight entry
+    CHECK(FL_WAIT == inst.Substate());
+    CHECK(0 == inst.mode_function_calls);
+
+    inst.RunMode();
+    CHECK(FL_WAIT == inst.Substate());
+
+    // the wait substate times out into measurement
+    delay(1000);
+    inst.RunMode();
+    CHECK(FL_MEASURE == inst.Substate());
+    CHECK(std::string(debug_stream.tx_data).find("Mode 1 substate 1 timed out") != std::string::npos);
+
+    inst.RunMode();
+    inst.RunMode();
+    CHECK(2 == inst.measurements);
+
+    // an error result takes the table's error transition
+    inst.fail = true;
+    inst.RunMode();
+    CHECK(MODE_ERROR == inst.Substate());
+    inst.RunMode();
+    CHECK(MODE_ERROR == inst.Substate());
+    CHECK(0 == inst.mode_function_calls);
+}
+
+static void TestFallback()
+{
+    printf("mode function fallback\n");
+
+    // a shutdown warning isn't in the table, so the mode function handles it
+    CHECK(inst.data_log.Open("SWL"));
+    CHECK(inst.data_log.Write("buffered", 8));
+    zephyr_stream.Inject("<SW><Msg>1</Msg><Inst>RACHuTS</Inst></SW><CRC>0</CRC><END>");
+    inst.RunRouter();
+    CHECK(1 == inst.data_log.GetStats().syncs);
+    inst.RunMode();
+    CHECK(1 == inst.mode_function_calls);
+    CHECK(MODE_SHUTDOWN == inst.mode_function_substate);
+    inst.data_log.Close();
+
+    // so does the exit
+    SetMode("SB");
+    inst.RunMode();
+    CHECK(2 == inst.mode_function_calls);
+    CHECK(MODE_EXIT == inst.mode_function_substate);
+}
+
+static void TestProfile()
+{
+    printf("profile\n");
+
+    const ModeStats_t * wait = Slot(MODE_FLIGHT, FL_WAIT);
+    const ModeStats_t * measure = Slot(MODE_FLIGHT, FL_MEASURE);
+    const ModeStats_t * error = Slot(MODE_FLIGHT, MODE_ERROR);
+
+    CHECK(NULL != wait && NULL != measure && NULL != error);
+    if (NULL == wait || NULL == measure || NULL == error) return;
+
+    CHECK(1 == wait->entries);
+    CHECK(2 == wait->count);
+    CHECK(wait->dwell_ms >= 1000 && wait->dwell_ms < 2000);
+    CHECK(1 == measure->entries);
+    CHECK(3 == measure->count);
+    CHECK(1 == error->entries);
+    CHECK(1 == error->count);
+}
+
+int main()
+{
+    setTime(1561000000);
+    setenv("STRATO_SD_ROOT", "mode_table_test_sd", 1);
+    inst.InitializeCore();
+    inst.InstrumentSetup();
+
+    zephyr_stream.capture = true;
+    debug_stream.capture = true;
+
+    TestTransitions();
+    TestFallback();
+    TestProfile();
+
+    if (failures) {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+
+    printf("all tests passed\n");
+    return 0;
+}
@@ -0,0 +1,158 @@
+/*
+ *  ReplayTest.cpp
+ *  Author:  StratoCore contributors
+ *  Created: October 2026
+ *
+ *  This file implements host-side regression tests for the Zephyr replay
+ *  source: splitting a capture into timestamped messages, routing them one
+ *  at a time with parse and routing errors attributed to the right message,
+ *  and pacing them by their capture times on a virtual clock.
+ */
+
+#include "TestSupport.h"
+#include "ZephyrReplay.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static ReplayStream replay_stream;
+static VirtualClock test_clock(1561000000);
+
+class TestInstrument : public TestInstrumentBase {
+public:
+    TestInstrument() : TestInstrumentBase(&replay_stream) { }
+
+    void InstrumentLoop() { loops++; }
+
+    uint32_t tc_count = 0;
+    uint32_t loops = 0;
+    InstMode_t running_mode = MODE_STANDBY;
+
+private:
+    void StandbyMode() { running_mode = MODE_STANDBY; }
+    void FlightMode() { running_mode = MODE_FLIGHT; }
+    void LowPowerMode() { running_mode = MODE_LOWPOWER; }
+    void SafetyMode() { running_mode = MODE_SAFETY; }
+    void EndOfFlightMode() { running_mode = MODE_EOF; }
+    void TCHandler(Telecommand_t telecommand) { (void) telecommand; tc_count++; }
+};
+
+static const char capture[] =
+    "@0\r\n"
+    "<IM><Msg>1</Msg><Inst>RACHuTS</Inst><Mode>FL</Mode></IM><CRC>0</CRC><END>\r\n"
+    "<GPS><Msg>2</Msg><Date>2019/6/20</Date><Time>3:6:40</Time><Lon>-105.2</Lon><Lat>40.0</Lat><Alt>18500.0</Alt>"
+    "<SZA>45.5</SZA><Quality>3</Quality></GPS><CRC>0</CRC><END>\r\n"
+    "@2500\n"
+    "<TC><Msg>3</Msg><Inst>RACHuTS</Inst><Length>4</Length></TC><CRC>0</CRC><START>1;2;</START><CRC>0</CRC><END>\n"
+    "<IM><Msg>4</Msg><Inst>LPC</Inst><Mode>LP</Mode></IM><CRC>0</CRC><END>\n"
+    "<GPS><Msg>5</Msg><Date>2019/6/20</Date></GPS><CRC>0</CRC><END>\n"
+    "@10000\n"
+    "<XYZ><Msg>6</Msg><Inst>RACHuTS</Inst></XYZ><CRC>0</CRC><END>\n"
+    "<TMAck><Msg>7</Msg><Inst>RACHuTS</Inst><Ack>ACK</Ack></TMAck><CRC>0</CRC><END>";
+
+static void TestLoad()
+{
+    printf("split a capture into messages\n");
+
+    replay_stream.LoadString(capture, strlen(capture));
+
+    CHECK(7 == replay_stream.Count());
+    CHECK(REPLAY_IM == replay_stream.Message(0).type);
+    CHECK(REPLAY_GPS == replay_stream.Message(1).type);
+    CHECK(REPLAY_TC == replay_stream.Message(2).type);
+    CHECK(REPLAY_OTHER == replay_stream.Message(5).type);
+    CHECK(REPLAY_TMACK == replay_stream.Message(6).type);
+
+    CHECK(0 == replay_stream.Message(1).time_ms);
+    CHECK(2500 == replay_stream.Message(2).time_ms);
+    CHECK(2500 == replay_stream.Message(4).time_ms);
+    CHECK(10000 == replay_stream.Message(6).time_ms);
+
+    // timestamps aren't replayed, but each message keeps its line ending
+    CHECK(0 == replay_stream.MessageText(0).find("<IM>"));
+    CHECK(replay_stream.MessageText(0).find("<END>\r\n") == replay_stream.MessageText(0).size() - 7);
+    CHECK(std::string::npos == replay_stream.MessageText(2).find("@"));
+
+    // nothing can be read until it's released, then only that message
+    CHECK(0 == replay_stream.available());
+    CHECK(replay_stream.ReleaseNext());
+    CHECK((int) replay_stream.Message(0).size == replay_stream.available());
+    CHECK('<' == replay_stream.read());
+}
+
+static void TestMaxRate(TestInstrument & inst)
+{
+    printf("route at the maximum rate\n");
+
+    ZephyrReplay replay(&inst, &replay_stream, "RACHuTS");
+
+    replay_stream.LoadString(capture, strlen(capture));
+    ReplayReport_t report = replay.Run(false);
+
+    CHECK(7 == report.messages);
+    CHECK(5 == report.routed);
+    CHECK(1 == report.ignored);
+    CHECK(1 == report.parse_errors);
+    CHECK(1 == report.route_errors);
+    CHECK(0 == report.loops);
+
+    CHECK(2 == report.types[REPLAY_IM].count);
+    CHECK(1 == report.types[REPLAY_IM].routed);
+    CHECK(2 == report.types[REPLAY_GPS].count);
+    CHECK(1 == report.types[REPLAY_GPS].errors);
+    CHECK(1 == report.types[REPLAY_OTHER].errors);
+    CHECK(1 == report.types[REPLAY_TC].routed);
+    CHECK(0 == report.types[REPLAY_TC].errors);
+    CHECK(report.max_us >= report.p99_us && report.p99_us >= report.p50_us);
+
+    // the messages took effect: the TC batch ran and the IM changed the mode
+    CHECK(2 == inst.tc_count);
+    CHECK(MODE_FLIGHT == inst.running_mode);
+}
+
+static void TestPaced(TestInstrument & inst)
+{
+    printf("route at the capture's pace\n");
+
+    ZephyrReplay replay(&inst, &replay_stream, "RACHuTS");
+    uint32_t start_ms = StratoMillis();
+    uint32_t loops = inst.loops;
+
+    replay_stream.LoadString(capture, strlen(capture));
+    ReplayReport_t report = replay.Run(true);
+
+    // the last message is due 10 s in, with the 1 Hz loop run in the meantime
+    CHECK(StratoMillis() - start_ms >= 10000);
+    CHECK(StratoMillis() - start_ms < 11000);
+    CHECK(report.loops >= 9 && report.loops <= 11);
+    CHECK(inst.loops - loops == report.loops);
+    CHECK(0 == report.max_lag_ms);
+
+    CHECK(7 == report.messages);
+    CHECK(5 == report.routed);
+    CHECK(1 == report.parse_errors);
+    CHECK(1 == report.route_errors);
+}
+
+int main()
+{
+    SetStratoClock(&test_clock);
+    setenv("STRATO_SD_ROOT", "replay_test_sd", 1);
+
+    TestInstrument inst;
+    inst.InitializeCore();
+
+    TestLoad();
+    TestMaxRate(inst);
+    TestPaced(inst);
+
+    SetStratoClock(NULL);
+
+    if (failures) {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+
+    printf("all tests passed\n");
+    return 0;
+}
@@ -0,0 +1,127 @@
+/*
+ *  RouterTest.cpp
+ *  Author:  StratoCore contributors
+ *  Created: October 2026
+ *
+ *  This file implements host-side regression tests for the message router's
+ *  per-loop limits: a burst must be routed across loops in order without
+ *  losing any message, and the per-type, unknown and deferred counters must
+ *  match what was sent.
+ */
+
+#include "TestSupport.h"
+#include "TimeLib.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+class TestInstrument : public TestInstrumentBase {
+public:
+    bool TMAcked() { return ACK == TM_ack_flag; }
+};
+
+static TestInstrument inst;
+
+static void InjectGPS()
+{
+    char msg[200];
+    snprintf(msg, sizeof(msg), "<GPS><Msg>%u</Msg><Date>2019/06/20</Date><Time>03:06:40</Time><SZA>45.0</SZA></GPS>"
+             "<CRC>0</CRC><END>", ++msg_id);
+    zephyr_stream.Inject(msg);
+}
+
+static void TestBurst()
+{
+    printf("burst across loops\n");
+
+    RouterStats_t before = inst.GetRouterStats();
+
+    // 40 GPS messages followed by a NAK then an ACK, the last one routed must win
+    for (int i = 0; i < 40; i++) InjectGPS();
+    InjectTMAck(false);
+    InjectTMAck(true);
+
+    inst.RunRouter(16, 0);
+    CHECK(inst.GetRouterStats().routed[GPS] == before.routed[GPS] + 16);
+    CHECK(zephyr_stream.available() > 0);
+    CHECK(inst.GetRouterStats().loops_deferred == before.loops_deferred + 1);
+
+    inst.RunRouter(16, 0);
+    CHECK(inst.GetRouterStats().routed[GPS] == before.routed[GPS] + 32);
+
+    // the rest fits, so the last loop isn't deferred
+    inst.RunRouter(16, 0);
+    CHECK(inst.GetRouterStats().routed[GPS] == before.routed[GPS] + 40);
+    CHECK(inst.GetRouterStats().routed[TMAck] == before.routed[TMAck] + 2);
+    CHECK(inst.GetRouterStats().loops_deferred == before.loops_deferred + 2);
+    CHECK(inst.TMAcked());
+    CHECK(0 == zephyr_stream.available());
+    CHECK(16 == inst.GetRouterStats().max_per_loop);
+
+    // nothing waiting, nothing deferred
+    inst.RunRouter(16, 0);
+    CHECK(inst.GetRouterStats().loops_deferred == before.loops_deferred + 2);
+}
+
+static void TestTimeLimit()
+{
+    printf("time limit\n");
+
+    RouterStats_t before = inst.GetRouterStats();
+
+    for (int i = 0; i < 20; i++) InjectGPS();
+
+    // a 1 us budget still routes one message per loop
+    inst.RunRouter(0, 1);
+    CHECK(inst.GetRouterStats().routed[GPS] == before.routed[GPS] + 1);
+
+    int loops = 1;
+    while (zephyr_stream.available() > 0 && loops < 100) {
+        inst.RunRouter(0, 1);
+        loops++;
+    }
+
+    CHECK(inst.GetRouterStats().routed[GPS] == before.routed[GPS] + 20);
+    CHECK(20 == loops);
+    CHECK(inst.GetRouterStats().loops_deferred == before.loops_deferred + 19);
+}
+
+static void TestUnknown()
+{
+    printf("unknown messages\n");
+
+    RouterStats_t before = inst.GetRouterStats();
+    debug_stream.tx_data.clear();
+
+    zephyr_stream.Inject("<XYZ><Msg>1</Msg></XYZ><CRC>0</CRC><END>");
+    InjectGPS();
+    inst.RunRouter();
+
+    CHECK(inst.GetRouterStats().unknown == before.unknown + 1);
+    CHECK(inst.GetRouterStats().routed[UNKNOWN] == before.routed[UNKNOWN] + 1);
+    CHECK(inst.GetRouterStats().routed[GPS] == before.routed[GPS] + 1);
+    CHECK(std::string::npos != debug_stream.tx_data.find("Unknown message to route"));
+}
+
+int main()
+{
+    setTime(1561000000);
+    setenv("STRATO_SD_ROOT", "router_test_sd", 1);
+    inst.InitializeCore();
+
+    zephyr_stream.capture = true;
+    debug_stream.capture = true;
+
+    TestBurst();
+    TestTimeLimit();
+    TestUnknown();
+
+    if (failures) {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+
+    printf("all tests passed\n");
+    return 0;
+}
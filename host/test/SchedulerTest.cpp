@@ -0,0 +1,469 @@
+/*
+ *  SchedulerTest.cpp
+ *  Author:  StratoCore contributors
+ *  Created: October 2026
+ *
+ *  This file implements host-side regression tests for StratoScheduler,
+ *  focused on firing order and time corrections (GPS time steps), on
+ *  cancellation and stale handles, on count-limited periodic actions, and on
+ *  the capacity and free list of its item pool.
+ */
+
+#include "StratoScheduler.h"
+#include <stdio.h>
+
+#define START_TIME      ((time_t) 1561000000)
+#define LARGE_STEP      ((int32_t) 864000) // 10 days
+
+static int failures = 0;
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            printf("  FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            failures++; \
+        } \
+    } while (0)
+
+struct Fired_t {
+    uint8_t action;
+    time_t time;
+};
+
+static StaticScheduler<64> scheduler;
+static Fired_t fired[256];
+static uint16_t num_fired = 0;
+
+// apply a GPS time correction the same way StratoCore::UpdateTime does
+static void TimeStep(int32_t difference)
+{
+    setTime(now() + difference);
+    scheduler.UpdateScheduleTime(difference);
+}
+
+// advance the clock one second at a time, recording every action as it fires
+static void RunFor(time_t seconds)
+{
+    time_t end = now() + seconds;
+
+    while (true) {
+        uint8_t action;
+        while (NO_SCHEDULED_ACTION != (action = scheduler.CheckSchedule())) {
+            if (num_fired < 256) {
+                fired[num_fired].action = action;
+                fired[num_fired].time = now();
+                num_fired++;
+            }
+        }
+
+        if (now() >= end) break;
+        setTime(now() + 1);
+    }
+}
+
+static void Reset()
+{
+    scheduler.ClearSchedule();
+    num_fired = 0;
+    setTime(START_TIME);
+}
+
+static TimeElements ExactTime(time_t t)
+{
+    TimeElements tm;
+    breakTime(t, tm);
+    return tm;
+}
+
+static void TestForwardStep()
+{
+    printf("forward step\n");
+    Reset();
+
+    scheduler.AddAction(1, (time_t) 100);
+    scheduler.AddAction(2, ExactTime(START_TIME + 100));
+
+    // jump forward 10 days: the exact action is now in the past, the relative one is not
+    RunFor(10);
+    TimeStep(LARGE_STEP);
+    RunFor(0);
+
+    CHECK(1 == num_fired);
+    CHECK(2 == fired[0].action);
+    CHECK(START_TIME + 10 + LARGE_STEP == fired[0].time);
+
+    // the relative action keeps its spacing from when it was scheduled
+    RunFor(200);
+    CHECK(2 == num_fired);
+    CHECK(1 == fired[1].action);
+    CHECK(START_TIME + 100 + LARGE_STEP == fired[1].time);
+    CHECK(0 == scheduler.ScheduleSize());
+}
+
+static void TestBackwardStep()
+{
+    printf("backward step\n");
+    Reset();
+
+    scheduler.AddAction(1, (time_t) 100);
+    scheduler.AddAction(2, ExactTime(START_TIME + 100));
+
+    // jump backward 10 days: the relative action keeps its spacing, the exact one waits
+    RunFor(10);
+    TimeStep(-LARGE_STEP);
+    RunFor(200);
+
+    CHECK(1 == num_fired);
+    CHECK(1 == fired[0].action);
+    CHECK(START_TIME + 100 - LARGE_STEP == fired[0].time);
+
+    RunFor(LARGE_STEP);
+    CHECK(2 == num_fired);
+    CHECK(2 == fired[1].action);
+    CHECK(START_TIME + 100 == fired[1].time);
+}
+
+static void TestMixedOrdering()
+{
+    printf("mixed ordering\n");
+    Reset();
+
+    // interleave relative and exact actions 10 s apart
+    for (uint8_t i = 0; i < 10; i++) {
+        if (i % 2) {
+            scheduler.AddAction(10 + i, ExactTime(START_TIME + 10 * (i + 1)));
+        } else {
+            scheduler.AddAction(10 + i, (time_t) (10 * (i + 1)));
+        }
+    }
+
+    // a 35 s forward step moves every relative action after the exact ones up to 35 s later
+    TimeStep(35);
+    RunFor(200);
+
+    CHECK(10 == num_fired);
+    for (uint16_t i = 1; i < num_fired; i++) {
+        CHECK(fired[i - 1].time <= fired[i].time);
+    }
+
+    // exact 11 is in the past and runs immediately, then exact 13 at +40,
+    // relative 10 (moved from +10 to +45), exact 15 at +60, relative 12 (+30 to +65)
+    CHECK(11 == fired[0].action);
+    CHECK(START_TIME + 35 == fired[0].time);
+    CHECK(13 == fired[1].action);
+    CHECK(START_TIME + 40 == fired[1].time);
+    CHECK(10 == fired[2].action);
+    CHECK(START_TIME + 45 == fired[2].time);
+    CHECK(15 == fired[3].action);
+    CHECK(START_TIME + 60 == fired[3].time);
+    CHECK(12 == fired[4].action);
+    CHECK(START_TIME + 65 == fired[4].time);
+}
+
+static void TestFifoTies()
+{
+    printf("FIFO ties\n");
+    Reset();
+
+    // same effective time across both time bases after a step
+    scheduler.AddAction(1, (time_t) 20);
+    scheduler.AddAction(2, ExactTime(START_TIME + 30));
+    scheduler.AddAction(3, (time_t) 20);
+    TimeStep(10);
+    RunFor(30);
+
+    CHECK(3 == num_fired);
+    CHECK(1 == fired[0].action);
+    CHECK(2 == fired[1].action);
+    CHECK(3 == fired[2].action);
+    CHECK(fired[0].time == fired[2].time);
+}
+
+static void TestPeriodicAcrossSteps()
+{
+    printf("periodic across steps\n");
+    Reset();
+
+    scheduler.AddPeriodicAction(1, 60, (time_t) 0);
+    scheduler.AddPeriodicAction(2, 60, ExactTime(START_TIME + 30));
+
+    RunFor(119);
+    CHECK(4 == num_fired);
+
+    // forward step: the relative series keeps its spacing, the exact series runs once and
+    // then stays locked to absolute time without firing every missed slot
+    num_fired = 0;
+    TimeStep(LARGE_STEP + 7);
+    RunFor(120);
+
+    uint16_t relative_runs = 0;
+    uint16_t exact_runs = 0;
+    for (uint16_t i = 0; i < num_fired; i++) {
+        if (1 == fired[i].action) {
+            CHECK(0 == (fired[i].time - (START_TIME + LARGE_STEP + 7)) % 60);
+            relative_runs++;
+        } else {
+            if (exact_runs > 0) CHECK(0 == (fired[i].time - (START_TIME + 30)) % 60);
+            exact_runs++;
+        }
+    }
+    CHECK(2 == relative_runs || 3 == relative_runs);
+    CHECK(3 == exact_runs);
+
+    // backward step: nothing fires in a burst, both series continue at their period
+    num_fired = 0;
+    TimeStep(-2 * LARGE_STEP);
+    RunFor(600);
+    relative_runs = 0;
+    for (uint16_t i = 0; i < num_fired; i++) {
+        if (1 == fired[i].action) relative_runs++;
+    }
+    CHECK(10 == relative_runs);
+    CHECK(2 == scheduler.ScheduleSize());
+}
+
+static void TestCancelAfterStep()
+{
+    printf("cancel and reschedule after step\n");
+    Reset();
+
+    ScheduleHandle_t relative = scheduler.AddAction(1, (time_t) 100);
+    ScheduleHandle_t exact = scheduler.AddAction(2, ExactTime(START_TIME + 200));
+
+    TimeStep(-LARGE_STEP);
+    CHECK(scheduler.Reschedule(exact, (time_t) 5)); // now relative to the new time
+    CHECK(scheduler.CancelAction(relative));
+    CHECK(!scheduler.CancelAction(relative));
+
+    RunFor(10);
+    CHECK(1 == num_fired);
+    CHECK(2 == fired[0].action);
+    CHECK(START_TIME - LARGE_STEP + 5 == fired[0].time);
+    CHECK(!scheduler.IsPending(exact));
+}
+
+static void TestCancelByAction()
+{
+    printf("cancel by action across both heaps\n");
+    Reset();
+
+    // action 3 pending as relative, exact, periodic relative and periodic exact items
+    scheduler.AddAction(3, (time_t) 10);
+    scheduler.AddAction(1, (time_t) 20);
+    scheduler.AddAction(3, ExactTime(START_TIME + 15));
+    scheduler.AddAction(2, ExactTime(START_TIME + 25));
+    scheduler.AddPeriodicAction(3, 5, (time_t) 5);
+    scheduler.AddPeriodicAction(3, 7, ExactTime(START_TIME + 7));
+    CHECK(6 == scheduler.ScheduleSize());
+
+    CHECK(4 == scheduler.CancelAction((uint8_t) 3));
+    CHECK(0 == scheduler.CancelAction((uint8_t) 3));
+    CHECK(0 == scheduler.CancelAction((uint8_t) 4));
+    CHECK(2 == scheduler.ScheduleSize());
+
+    // the heaps are still ordered with items pulled from the middle
+    RunFor(30);
+    CHECK(2 == num_fired);
+    CHECK(1 == fired[0].action && START_TIME + 20 == fired[0].time);
+    CHECK(2 == fired[1].action && START_TIME + 25 == fired[1].time);
+    CHECK(0 == scheduler.ScheduleSize());
+}
+
+static void TestStaleHandle()
+{
+    printf("stale handle after slot reuse\n");
+    Reset();
+
+    // cancelled: the next add takes the same item, the old handle must not touch it
+    ScheduleHandle_t cancelled = scheduler.AddAction(1, (time_t) 10);
+    CHECK(scheduler.CancelAction(cancelled));
+    ScheduleHandle_t reused = scheduler.AddAction(2, (time_t) 20);
+    CHECK(reused.index == cancelled.index);
+    CHECK(!scheduler.IsPending(cancelled));
+    CHECK(!scheduler.CancelAction(cancelled));
+    CHECK(!scheduler.Reschedule(cancelled, (time_t) 1));
+    CHECK(!scheduler.Reschedule(cancelled, ExactTime(START_TIME + 1)));
+    CHECK(scheduler.IsPending(reused));
+
+    // fired: same again, through the exact heap
+    RunFor(20);
+    CHECK(1 == num_fired && 2 == fired[0].action && START_TIME + 20 == fired[0].time);
+    ScheduleHandle_t exact = scheduler.AddAction(3, ExactTime(START_TIME + 30));
+    CHECK(exact.index == reused.index);
+    CHECK(!scheduler.IsPending(reused));
+    CHECK(!scheduler.CancelAction(reused));
+    CHECK(!scheduler.Reschedule(reused, (time_t) 1));
+
+    RunFor(10);
+    CHECK(2 == num_fired);
+    CHECK(3 == fired[1].action && START_TIME + 30 == fired[1].time);
+}
+
+static void TestPeriodicCount()
+{
+    printf("count-limited periodic\n");
+    Reset();
+
+    ScheduleHandle_t relative = scheduler.AddPeriodicAction(1, 10, (time_t) 10, 3);
+    ScheduleHandle_t exact = scheduler.AddPeriodicAction(2, 7, ExactTime(START_TIME + 7), 4);
+    CHECK(2 == scheduler.ScheduleSize());
+
+    RunFor(100);
+
+    uint16_t relative_runs = 0;
+    uint16_t exact_runs = 0;
+    for (uint16_t i = 0; i < num_fired; i++) {
+        if (1 == fired[i].action) {
+            relative_runs++;
+            CHECK(START_TIME + 10 * relative_runs == fired[i].time);
+        } else if (2 == fired[i].action) {
+            exact_runs++;
+            CHECK(START_TIME + 7 * exact_runs == fired[i].time);
+        }
+    }
+    CHECK(3 == relative_runs);
+    CHECK(4 == exact_runs);
+
+    // both items are freed after their last run and can be taken again
+    CHECK(0 == scheduler.ScheduleSize());
+    CHECK(!scheduler.IsPending(relative));
+    CHECK(!scheduler.IsPending(exact));
+    for (uint16_t i = 0; i < scheduler.ScheduleCapacity(); i++) {
+        CHECK(scheduler.AddAction(3, (time_t) 1));
+    }
+    CHECK(!scheduler.AddAction(3, (time_t) 1));
+    scheduler.ClearSchedule();
+}
+
+static void TestCapacity()
+{
+    static StaticScheduler<MAX_SCHEDULE_SIZE> full;
+
+    printf("capacity\n");
+    Reset();
+
+    // both heaps draw on the one pool
+    for (uint16_t i = 0; i < MAX_SCHEDULE_SIZE; i++) {
+        if (i % 2) {
+            CHECK(full.AddAction((uint8_t) (i % 200 + 1), ExactTime(START_TIME + 100 + i)));
+        } else {
+            CHECK(full.AddAction((uint8_t) (i % 200 + 1), (time_t) (100 + i)));
+        }
+    }
+
+    CHECK(MAX_SCHEDULE_SIZE == full.ScheduleSize());
+    CHECK(MAX_SCHEDULE_SIZE == full.ScheduleCapacity());
+    CHECK(!full.AddAction(1, (time_t) 1));
+    CHECK(!full.AddAction(1, ExactTime(START_TIME + 1)));
+    CHECK(!full.AddPeriodicAction(1, 10, (time_t) 1));
+    CHECK(MAX_SCHEDULE_SIZE == full.ScheduleSize());
+
+    full.ClearSchedule();
+    CHECK(0 == full.ScheduleSize());
+    CHECK(full.AddAction(1, (time_t) 1));
+    full.ClearSchedule();
+}
+
+static void TestFreeListReuse()
+{
+    ScheduleHandle_t handles[64];
+
+    printf("free list reuse\n");
+    Reset();
+
+    for (uint16_t i = 0; i < 64; i++) {
+        handles[i] = scheduler.AddAction((uint8_t) (i + 1), (time_t) (i + 1));
+        CHECK(handles[i]);
+    }
+    CHECK(!scheduler.AddAction(100, (time_t) 1));
+
+    // 10 fire and 5 are cancelled, and exactly that many can be added again
+    RunFor(10);
+    CHECK(10 == num_fired);
+    for (uint16_t i = 20; i < 25; i++) CHECK(scheduler.CancelAction(handles[i]));
+    CHECK(49 == scheduler.ScheduleSize());
+
+    for (uint16_t i = 0; i < 15; i++) {
+        ScheduleHandle_t handle = scheduler.AddAction((uint8_t) (100 + i), (time_t) 100);
+        CHECK(handle);
+
+        // every new item is one that was freed, and the old handle to it is stale
+        uint16_t old = 0;
+        while (old < 64 && handles[old].index != handle.index) old++;
+        CHECK(old < 10 || (old >= 20 && old < 25));
+        CHECK(old < 64 && !scheduler.IsPending(handles[old]));
+    }
+    CHECK(!scheduler.AddAction(100, (time_t) 1));
+    CHECK(64 == scheduler.ScheduleSize());
+
+    // everything left still runs, in time order
+    num_fired = 0;
+    RunFor(100);
+    CHECK(64 == num_fired);
+    for (uint16_t i = 1; i < num_fired; i++) CHECK(fired[i - 1].time <= fired[i].time);
+    CHECK(0 == scheduler.ScheduleSize());
+}
+
+static void TestFifoAfterChurn()
+{
+    ScheduleHandle_t handles[40];
+    ScheduleHandle_t filler[20];
+
+    printf("FIFO after churn\n");
+    Reset();
+
+    // scattered times, some cancelled and some fired, so the heaps and free list are well mixed
+    for (uint16_t i = 0; i < 40; i++) {
+        handles[i] = scheduler.AddAction(1, (time_t) ((i * 37) % 41 + 1));
+    }
+    for (uint16_t i = 0; i < 40; i += 3) scheduler.CancelAction(handles[i]);
+    RunFor(20);
+    num_fired = 0;
+
+    // 20 actions due at the same time, in both time bases, interleaved with filler that is then cancelled
+    for (uint16_t i = 0; i < 20; i++) {
+        if (i % 2) {
+            CHECK(scheduler.AddAction((uint8_t) (100 + i), ExactTime(START_TIME + 60)));
+        } else {
+            CHECK(scheduler.AddAction((uint8_t) (100 + i), (time_t) 40));
+        }
+        filler[i] = scheduler.AddAction(2, (time_t) (i % 3 ? 30 : 50));
+    }
+    for (uint16_t i = 0; i < 20; i++) CHECK(scheduler.CancelAction(filler[i]));
+
+    RunFor(40);
+
+    // the rest of the scattered actions first, then the 20 in the order they were added
+    uint16_t tied = 0;
+    for (uint16_t i = 0; i < num_fired; i++) {
+        if (fired[i].action < 100) {
+            CHECK(0 == tied);
+            continue;
+        }
+        CHECK(100 + tied == fired[i].action);
+        CHECK(START_TIME + 60 == fired[i].time);
+        tied++;
+    }
+    CHECK(20 == tied);
+    CHECK(0 == scheduler.ScheduleSize());
+}
+
+int main()
+{
+    TestForwardStep();
+    TestBackwardStep();
+    TestMixedOrdering();
+    TestFifoTies();
+    TestPeriodicAcrossSteps();
+    TestCancelAfterStep();
+    TestCancelByAction();
+    TestStaleHandle();
+    TestPeriodicCount();
+    TestCapacity();
+    TestFreeListReuse();
+    TestFifoAfterChurn();
+
+    printf("%s: %d failure(s)\n", (0 == failures) ? "PASS" : "FAIL", failures);
+
+    return (0 == failures) ? 0 : 1;
+}
@@ -0,0 +1,211 @@
+/*
+ *  TCDispatchTest.cpp
+ *  Author:  StratoCore contributors
+ *  Created: October 2026
+ *
+ *  This file implements host-side regression tests for the telecommand
+ *  dispatch table: registered handlers must get their parsed parameters,
+ *  duplicate and invalid registrations must be refused, TCs without a handler
+ *  must still reach TCHandler, the per-TC stats must match what ran, and
+ *  report TCs must leave the instrument's TM buffer alone.
+ */
+
+#include "TestSupport.h"
+#include "TimeLib.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#define SETPOINT    ((Telecommand_t) 220)
+#define LABEL       ((Telecommand_t) 221)
+#define LEGACY      ((Telecommand_t) 222)
+
+class TestInstrument : public TestInstrumentBase {
+public:
+    void InstrumentSetup()
+    {
+        registered = RegisterTC(SETPOINT, &TestInstrument::SetSetpoint, "uf")
+                     && RegisterTC(LABEL, &TestInstrument::SetLabel, "s");
+    }
+
+    bool Register(Telecommand_t telecommand, const char * params)
+    {
+        return RegisterTC(telecommand, &TestInstrument::SetLabel, params);
+    }
+
+    StratoTCDispatch & Dispatch() { return tc_dispatch; }
+    uint8_t TMsWaiting() { return tm_manager.Queued(); }
+
+    bool registered = false;
+
+    // handlers run, with their parameters
+    std::vector<std::string> run;
+
+private:
+    void SetSetpoint(const TCArg_t * args)
+    {
+        char entry[64];
+        snprintf(entry, sizeof(entry), "setpoint %lu %.2f", (unsigned long) args[0].u, (double) args[1].f);
+        run.push_back(entry);
+    }
+
+    void SetLabel(const TCArg_t * args)
+    {
+        run.push_back(std::string("label ") + args[0].s);
+    }
+
+    void TCHandler(Telecommand_t telecommand)
+    {
+        run.push_back("handler " + std::to_string((unsigned int) telecommand));
+    }
+};
+
+static TestInstrument inst;
+
+static void RunTC(const char * payload)
+{
+    char msg[TC_PAYLOAD_SIZE + 200];
+    snprintf(msg, sizeof(msg), "<TC><Msg>%u</Msg><Inst>RACHuTS</Inst><Length>%u</Length></TC><CRC>0</CRC>"
+             "<START>%s</START><CRC>0</CRC><END>", ++msg_id, (unsigned) strlen(payload), payload);
+    zephyr_stream.Inject(msg);
+    inst.RunRouter();
+}
+
+// ack every TM waiting in the TM manager, so the next TM is sent at once
+static void AckTMs()
+{
+    while (inst.TMsWaiting() > 0) {
+        InjectTMAck(true);
+        inst.RunRouter();
+    }
+}
+
+static const TCStats_t * Stats(Telecommand_t telecommand)
+{
+    uint8_t entry = inst.Dispatch().Find((uint16_t) telecommand);
+
+    return (NO_TC_ENTRY == entry) ? NULL : &inst.Dispatch().GetStats(entry);
+}
+
+static void TestRegistration()
+{
+    printf("registration\n");
+
+    CHECK(inst.registered);
+
+    debug_stream.tx_data.clear();
+    CHECK(!inst.Register(SETPOINT, ""));
+    CHECK(!inst.Register(GETPROFILE, ""));
+    CHECK(std::string::npos != debug_stream.tx_data.find("TC 220 registered twice"));
+    CHECK(std::string::npos != debug_stream.tx_data.find("TC 204 registered twice"));
+
+    CHECK(!inst.Register((Telecommand_t) TC_DISPATCH_MAX_TC, ""));
+    CHECK(!inst.Register((Telecommand_t) 230, "ux"));
+    CHECK(!inst.Register((Telecommand_t) 230, "uuuuuuuuu"));
+    CHECK(NULL == Stats((Telecommand_t) 230));
+}
+
+static void TestDispatch()
+{
+    printf("dispatch\n");
+
+    inst.run.clear();
+    RunTC("220,15,2.5;221,abc;222,7;");
+
+    CHECK(3 == inst.run.size());
+    CHECK(inst.run.size() == 3 && "setpoint 15 2.50" == inst.run[0]);
+    CHECK(inst.run.size() == 3 && "label abc" == inst.run[1]);
+    CHECK(inst.run.size() == 3 && "handler 222" == inst.run[2]);
+}
+
+static void TestBadParams()
+{
+    printf("bad parameters\n");
+
+    inst.run.clear();
+    zephyr_stream.tx_data.clear();
+
+    // missing and non-numeric parameters, neither runs
+    RunTC("220,15;220,x,1.0;221;");
+
+    CHECK(0 == inst.run.size());
+    CHECK(2 == Stats(SETPOINT)->param_errors);
+    CHECK(1 == Stats(LABEL)->param_errors);
+    CHECK(std::string::npos != zephyr_stream.tx_data.find("Bad parameters for TC 220"));
+}
+
+static void TestStats()
+{
+    printf("stats\n");
+
+    uint32_t setpoints = Stats(SETPOINT)->count;
+    uint32_t legacy = Stats(LEGACY)->count;
+
+    RunTC("220,1,1.0;220,2,2.0;222;222;222;");
+
+    CHECK(Stats(SETPOINT)->count == setpoints + 2);
+    CHECK(Stats(LEGACY)->count == legacy + 3);
+    CHECK(Stats(LEGACY)->max_us <= Stats(LEGACY)->total_us);
+
+    AckTMs();
+    zephyr_stream.tx_data.clear();
+    debug_stream.tx_data.clear();
+    RunTC("208;");
+
+    CHECK(std::string::npos != zephyr_stream.tx_data.find("TC stats"));
+    CHECK(std::string::npos != debug_stream.tx_data.find("TC 222: 4 run"));
+    CHECK(1 == Stats(GETTCSTATS)->count);
+}
+
+static void TestReports()
+{
+    printf("reports leave the TM buffer alone\n");
+
+    AckTMs();
+    zephyr_stream.tx_data.clear();
+    debug_stream.tx_data.clear();
+
+    // the profile is sent while the instrument is part way through filling a TM
+    inst.FillData("half a TM");
+    RunTC("204;");
+    CHECK(std::string::npos != zephyr_stream.tx_data.find("Loop profile"));
+    CHECK(std::string::npos != debug_stream.tx_data.find(" rejected, 0 merged, "));
+    CHECK(inst.TMBufferHolds("half a TM"));
+    RunTC("208;");
+    AckTMs();
+    CHECK(std::string::npos != zephyr_stream.tx_data.find("TC stats"));
+    CHECK(inst.TMBufferHolds("half a TM"));
+
+    // and while it waits for the TM ahead of it to be acked
+    RunTC("204;");
+    inst.FillData("the other half");
+    AckTMs();
+    CHECK(inst.TMBufferHolds("the other half"));
+}
+
+int main()
+{
+    setTime(1561000000);
+    setenv("STRATO_SD_ROOT", "tc_dispatch_test_sd", 1);
+    inst.InitializeCore();
+    inst.InstrumentSetup();
+
+    zephyr_stream.capture = true;
+    debug_stream.capture = true;
+
+    TestRegistration();
+    TestDispatch();
+    TestBadParams();
+    TestStats();
+    TestReports();
+
+    if (failures) {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+
+    printf("all tests passed\n");
+    return 0;
+}
@@ -0,0 +1,264 @@
+/*
+ *  TCQueueTest.cpp
+ *  Author:  StratoCore contributors
+ *  Created: October 2026
+ *
+ *  This file implements host-side regression tests for the telecommand
+ *  queue: by default TCs must run straight from the reader with their
+ *  parameters still in zephyrRX; once the queue is enabled, batches
+ *  arriving faster than they run must all run in order with their
+ *  parameters, within the per-loop limits and null-TC spacing, and a batch
+ *  that doesn't fit must be NAKed rather than lost silently.
+ */
+
+#include "TestSupport.h"
+#include "TimeLib.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+class TestInstrument : public TestInstrumentBase {
+public:
+    StratoTCQueue & Queue() { return tc_queue; }
+
+    // TCs run, with their first parameter if any, and the first parameter as zephyrRX has it
+    std::vector<std::string> run;
+    std::vector<std::string> reader_params;
+    uint32_t tc_us = 0;
+
+private:
+    void TCHandler(Telecommand_t telecommand)
+    {
+        std::string entry = std::to_string((unsigned int) telecommand);
+        if (tc_queue.NumTCParams() > 0) entry += std::string(",") + tc_queue.GetTCParam(0);
+        run.push_back(entry);
+        reader_params.push_back(zephyrRX.num_tc_params > 0 ? zephyrRX.GetTCParam(0) : "");
+
+        if (tc_us > 0) {
+            uint32_t start = micros();
+            while (micros() - start < tc_us);
+        }
+    }
+};
+
+static TestInstrument inst;
+
+static void InjectTC(const char * payload)
+{
+    char msg[TC_PAYLOAD_SIZE + 200];
+    snprintf(msg, sizeof(msg), "<TC><Msg>%u</Msg><Inst>RACHuTS</Inst><Length>%u</Length></TC><CRC>0</CRC>"
+             "<START>%s</START><CRC>0</CRC><END>\n", ++msg_id, (unsigned) strlen(payload), payload);
+    zephyr_stream.Inject(msg);
+}
+
+static uint32_t Count(const std::string & text, const char * pattern)
+{
+    uint32_t count = 0;
+
+    for (size_t position = text.find(pattern); std::string::npos != position; position = text.find(pattern, position + 1)) {
+        count++;
+    }
+
+    return count;
+}
+
+static std::string Joined()
+{
+    std::string joined;
+
+    for (const std::string & entry : inst.run) joined += entry + ";";
+
+    return joined;
+}
+
+static void TestUnqueued()
+{
+    printf("unqueued TCs\n");
+
+    inst.run.clear();
+    inst.reader_params.clear();
+    inst.Queue().SetPolicy(TC_PER_LOOP, 0);
+
+    // each message's TCs run before the next message is read, while zephyrRX still holds their parameters
+    InjectTC("210,a;211,b;");
+    InjectTC("212,c;");
+    inst.RunRouter();
+    CHECK(Joined() == "210,a;211,b;");
+    inst.RunRouter();
+    CHECK(Joined() == "210,a;211,b;212,c;");
+    CHECK(3 == inst.reader_params.size());
+    CHECK(inst.reader_params.size() == 3 && "a" == inst.reader_params[0] && "c" == inst.reader_params[2]);
+    CHECK(0 == inst.Queue().GetStats().tcs_queued);
+
+    // TCs left past the per-loop limit are replaced by the next message, as before the queue
+    inst.run.clear();
+    debug_stream.tx_data.clear();
+    inst.Queue().SetPolicy(1, 0);
+    InjectTC("220;221;222;");
+    inst.RunRouter();
+    InjectTC("223;");
+    inst.RunRouter();
+    inst.RunRouter();
+    CHECK(Joined() == "220;223;");
+    CHECK(std::string::npos != debug_stream.tx_data.find("TC received too quickly"));
+}
+
+static void TestNoneLost()
+{
+    printf("none lost\n");
+
+    inst.run.clear();
+    inst.Queue().SetPolicy(TC_PER_LOOP, 0);
+
+    // two batches before the first has run, which used to overwrite the first
+    InjectTC("210,a;211,b;212;");
+    InjectTC("213,c;214,d;");
+    inst.RunRouter();
+
+    CHECK(Joined() == "210,a;211,b;212;213,c;214,d;");
+    CHECK(0 == inst.Queue().Count());
+    CHECK(2 == Count(zephyr_stream.tx_data, "<Ack>ACK</Ack>"));
+}
+
+static void TestCountLimit()
+{
+    std::string batch;
+
+    printf("count limit\n");
+
+    inst.run.clear();
+    inst.Queue().SetPolicy(8, 0);
+
+    for (int i = 0; i < 20; i++) batch += std::to_string(220 + i) + ";";
+    InjectTC(batch.c_str());
+
+    inst.RunRouter();
+    CHECK(8 == inst.run.size());
+    inst.RunRouter();
+    CHECK(16 == inst.run.size());
+    inst.RunRouter();
+    CHECK(20 == inst.run.size());
+    CHECK(Joined() == batch);
+
+    // one per loop, as before the queue
+    inst.run.clear();
+    inst.Queue().SetPolicy(1, 0);
+    InjectTC("230;231;");
+    inst.RunRouter();
+    CHECK(1 == inst.run.size());
+    inst.RunRouter();
+    CHECK(2 == inst.run.size());
+}
+
+static void TestNullSpacing()
+{
+    printf("null TC spacing\n");
+
+    inst.run.clear();
+    inst.Queue().SetPolicy(TC_PER_LOOP, 0);
+
+    InjectTC("210;0;211;0;0;212;");
+    inst.RunRouter();
+    CHECK(Joined() == "210;");
+    inst.RunRouter();
+    CHECK(Joined() == "210;211;");
+    inst.RunRouter();
+    CHECK(Joined() == "210;211;");
+    inst.RunRouter();
+    CHECK(Joined() == "210;211;212;");
+}
+
+static void TestTimeLimit()
+{
+    std::string batch;
+
+    printf("time limit\n");
+
+    inst.run.clear();
+    inst.tc_us = 2000;
+    inst.Queue().SetPolicy(0, 5000);
+
+    for (int i = 0; i < 12; i++) batch += "215;";
+    InjectTC(batch.c_str());
+
+    // each loop runs TCs until 5 ms have passed, at 2 ms each, so at most 3 (fewer if the test is preempted,
+    // since the limit is on real time)
+    inst.RunRouter();
+    CHECK(inst.run.size() >= 1 && inst.run.size() <= 3);
+
+    // at least 3 more loops for the other 9 or more, all but the last ending at the limit
+    uint32_t limited = inst.Queue().GetStats().loops_limited;
+    while (inst.Queue().Count() > 0) inst.RunRouter();
+    CHECK(12 == inst.run.size());
+    CHECK(inst.Queue().GetStats().loops_limited >= limited + 2);
+
+    inst.tc_us = 0;
+}
+
+static void TestFull()
+{
+    std::string batch;
+
+    printf("full queue\n");
+
+    inst.run.clear();
+    inst.Queue().SetPolicy(1, 0);
+    zephyr_stream.tx_data.clear();
+
+    // batches of about 200 characters, until one doesn't fit
+    for (int i = 0; i < 20; i++) batch += "216,abcdef;";
+    uint32_t accepted = 0;
+    uint32_t rejected = 0;
+    debug_stream.tx_data.clear();
+    for (int i = 0; i < 10; i++) {
+        uint32_t before = inst.Queue().GetStats().batches_rejected;
+        InjectTC(batch.c_str());
+        inst.RunRouter();
+        if (inst.Queue().GetStats().batches_rejected == before) {
+            accepted++;
+        } else {
+            rejected++;
+        }
+    }
+
+    CHECK(rejected > 0);
+    CHECK(accepted == Count(zephyr_stream.tx_data, "<Ack>ACK</Ack>"));
+    CHECK(rejected == Count(zephyr_stream.tx_data, "<Ack>NAK</Ack>"));
+    CHECK(rejected == Count(debug_stream.tx_data, "TC queue full"));
+
+    // everything accepted still runs
+    inst.Queue().SetPolicy(0, 0);
+    inst.RunRouter();
+    CHECK(20U * accepted == inst.run.size());
+}
+
+int main()
+{
+    setTime(1561000000);
+    setenv("STRATO_SD_ROOT", "tc_queue_test_sd", 1);
+    inst.InitializeCore();
+
+    zephyr_stream.capture = true;
+    debug_stream.capture = true;
+
+    TestUnqueued();
+
+    inst.Queue().Enable(true);
+    zephyr_stream.tx_data.clear();
+
+    TestNoneLost();
+    TestCountLimit();
+    TestNullSpacing();
+    TestTimeLimit();
+    TestFull();
+
+    if (failures) {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+
+    printf("all tests passed\n");
+    return 0;
+}
@@ -0,0 +1,415 @@
+/*
+ *  TMManagerTest.cpp
+ *  Author:  StratoCore contributors
+ *  Created: October 2026
+ *
+ *  This file implements host-side regression tests for the TM manager: a
+ *  second TM waits in its own buffer while the first waits for its TMAck,
+ *  a NAKed or timed-out TM is resent until its retries run out, full
+ *  buffers reject new TMs, logs queue in their own slots, TMs built in place
+ *  wait their turn, sends and resends leave the TM buffer alone and keep
+ *  one sequence of message IDs, and each outcome is counted in the
+ *  statistics.
+ */
+
+#include "TestSupport.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static VirtualClock test_clock(1561000000);
+static uint32_t last_tx_msg = 0;
+
+class TestInstrument : public TestInstrumentBase {
+public:
+    StratoTMManager & Manager() { return tm_manager; }
+
+    bool SendData(const char * data, const char * details)
+    {
+        zephyrTX.clearTm();
+        zephyrTX.addTm((const uint8_t *) data, (uint16_t) strlen(data));
+        return SendTM(FINE, details);
+    }
+
+    void LogFine(const char * message) { ZephyrLogFine(message); }
+};
+
+// each message written has the next message ID after the last one written
+static bool MsgIdsInOrder()
+{
+    size_t pos = 0;
+    bool in_order = true;
+
+    while (std::string::npos != (pos = zephyr_stream.tx_data.find("<Msg>", pos))) {
+        uint32_t id = (uint32_t) strtoul(zephyr_stream.tx_data.c_str() + pos + 5, NULL, 10);
+        if (0 != last_tx_msg && id != last_tx_msg + 1) in_order = false;
+        last_tx_msg = id;
+        pos += 5;
+    }
+
+    return in_order;
+}
+
+// the number of TMs written since the last call (with the given state message, if any)
+static uint32_t TMsSent(const char * details = NULL)
+{
+    uint32_t count = 0;
+    size_t pos = 0;
+    char mess[TM_DETAILS_SIZE + 32] = "";
+
+    CHECK(MsgIdsInOrder());
+
+    if (NULL != details) snprintf(mess, sizeof(mess), "<StateMess1>%s</StateMess1>", details);
+
+    while (std::string::npos != (pos = zephyr_stream.tx_data.find("<TM>", pos))) {
+        size_t end = zephyr_stream.tx_data.find("</TM>", pos);
+        if (std::string::npos != zephyr_stream.tx_data.substr(pos, end - pos).find(mess)) count++;
+        pos = end;
+    }
+
+    zephyr_stream.tx_data.clear();
+    return count;
+}
+
+// let the virtual clock run on, idle between loops as the instrument would be
+static void Wait(TestInstrument & inst, uint32_t ms)
+{
+    uint32_t start = StratoMillis();
+
+    while (StratoMillis() - start < ms) {
+        inst.Idle(ms - (StratoMillis() - start));
+        inst.KickWatchdog();
+    }
+}
+
+static void TestQueue()
+{
+    printf("queue, ack, and resend in the manager\n");
+
+    StaticTMManager<2, 16> manager;
+    const uint8_t data[16] = {1, 2, 3};
+    uint8_t slot = NO_TM_SLOT;
+
+    TMHandle_t first = manager.Queue(data, 3, FINE, "first", false, 1);
+    TMHandle_t second = manager.Queue(data, 16, FINE, "second", false, 1);
+
+    CHECK(NO_TM_HANDLE != first && NO_TM_HANDLE != second && first != second);
+    CHECK(2 == manager.Queued());
+
+    // both buffers are in use, and a TM larger than a buffer never fits
+    CHECK(NO_TM_HANDLE == manager.Queue(data, 3, FINE, "third", false, 1));
+    CHECK(1 == manager.GetStats().rejected);
+    CHECK(NO_TM_HANDLE == manager.Queue(data, 17, FINE, "too large", false, 1));
+    CHECK(2 == manager.GetStats().rejected);
+
+    // oldest first, and only one in flight
+    slot = manager.NextToSend(0);
+    CHECK(NO_TM_SLOT != slot);
+    CHECK(0 == strcmp("first", manager.Slot(slot).details));
+    CHECK(3 == manager.Slot(slot).size && 2 == manager.Data(slot)[1]);
+    CHECK(TM_IN_FLIGHT == manager.Status(first));
+    CHECK(NO_TM_SLOT == manager.NextToSend(0));
+
+    // a NAK resends the same TM before the next one
+    manager.Ack(false);
+    CHECK(TM_QUEUED == manager.Status(first));
+    slot = manager.NextToSend(10);
+    CHECK(0 == strcmp("first", manager.Slot(slot).details));
+    CHECK(2 == manager.Tries(first));
+
+    // an ACK frees its buffer for the next TM
+    manager.Ack(true);
+    CHECK(TM_NONE == manager.Status(first));
+    CHECK(1 == manager.Queued());
+    slot = manager.NextToSend(20);
+    CHECK(0 == strcmp("second", manager.Slot(slot).details));
+
+    // an overdue TMAck resends, and after its last retry the TM is dropped
+    manager.SetPolicy(1000, 3);
+    manager.CheckTimeout(1019);
+    CHECK(TM_IN_FLIGHT == manager.Status(second));
+    manager.CheckTimeout(1020);
+    CHECK(TM_QUEUED == manager.Status(second));
+    CHECK(NO_TM_SLOT != manager.NextToSend(1020));
+    manager.Ack(false);
+    CHECK(TM_NONE == manager.Status(second));
+    CHECK(0 == manager.Queued());
+
+    // an ack with nothing in flight belongs to a TM the manager didn't send
+    manager.Ack(true);
+
+    const TMStats_t & stats = manager.GetStats();
+    CHECK(2 == stats.sent);
+    CHECK(1 == stats.acked);
+    CHECK(2 == stats.retried);
+    CHECK(1 == stats.dropped);
+    CHECK(2 == stats.naks);
+    CHECK(1 == stats.timeouts);
+    CHECK(1 == stats.unmatched_acks);
+    CHECK(2 == stats.max_queued);
+}
+
+static void TestText()
+{
+    printf("text TMs in their own slots\n");
+
+    StaticTMManager<2, 16, 2> manager;
+    const uint8_t data[4] = {0};
+
+    // with both data buffers waiting, logs still queue
+    CHECK(NO_TM_HANDLE != manager.Queue(data, 4, FINE, "data 1", false, 1));
+    CHECK(NO_TM_HANDLE != manager.Queue(data, 4, FINE, "data 2", false, 1));
+    TMHandle_t log = manager.Queue(NULL, 0, WARN, "log 1", true, 1);
+    CHECK(NO_TM_HANDLE != log);
+    CHECK(NO_TM_HANDLE != manager.Queue(NULL, 0, WARN, "log 2", true, 1));
+    CHECK(4 == manager.Queued());
+    CHECK(0 == manager.GetStats().rejected);
+
+    // a repeat of a waiting log is merged with it, but a different level is a different message
+    CHECK(log == manager.Queue(NULL, 0, WARN, "log 1", true, 1));
+    CHECK(1 == manager.GetStats().merged);
+    CHECK(NO_TM_HANDLE == manager.Queue(NULL, 0, CRIT, "log 1", true, 1));
+    CHECK(1 == manager.GetStats().rejected);
+    CHECK(4 == manager.Queued());
+
+    // sent in the order queued, and once a log is in flight a repeat is queued again
+    uint8_t slot = manager.NextToSend(0);
+    CHECK(0 == strcmp("data 1", manager.Slot(slot).details));
+    manager.Ack(true);
+    slot = manager.NextToSend(0);
+    CHECK(0 == strcmp("data 2", manager.Slot(slot).details));
+    manager.Ack(true);
+    slot = manager.NextToSend(0);
+    CHECK(0 == strcmp("log 1", manager.Slot(slot).details));
+
+    // with the text slots full, a log takes a free data slot
+    CHECK(NO_TM_HANDLE != manager.Queue(NULL, 0, WARN, "log 1", true, 1));
+    CHECK(1 == manager.GetStats().merged);
+    CHECK(3 == manager.Queued());
+    CHECK(1 == manager.GetStats().rejected);
+}
+
+static void TestBuild()
+{
+    printf("build a TM in place\n");
+
+    StaticTMManager<2, 16> manager;
+    const uint8_t data[12] = {0};
+    TMBuilder builder;
+    TMBuilder second;
+    uint8_t slot = NO_TM_SLOT;
+
+    // nothing to add to until a buffer is reserved
+    CHECK(!builder.Add((uint8_t) 1));
+    CHECK(NO_TM_HANDLE == manager.Queue(builder, FINE, "none", 1));
+
+    // values are added in XMLWriter's (big-endian) byte order
+    CHECK(manager.Build(builder));
+    CHECK(builder.Add((uint8_t) 0x01));
+    CHECK(builder.Add((uint16_t) 0x0203));
+    CHECK(builder.Add((uint32_t) 0x04050607));
+    CHECK(7 == builder.Size());
+
+    // a reserved buffer isn't queued or sent, and a TM queued meanwhile is sent first
+    CHECK(0 == manager.Queued());
+    CHECK(NO_TM_SLOT == manager.NextToSend(0));
+    TMHandle_t other = manager.Queue(data, 4, FINE, "other", false, 1);
+    CHECK(NO_TM_HANDLE != other);
+    CHECK(!manager.Build(second));
+    TMHandle_t built = manager.Queue(builder, WARN, "built", 1);
+    CHECK(NO_TM_HANDLE != built && other != built);
+    CHECK(2 == manager.Queued());
+
+    slot = manager.NextToSend(0);
+    CHECK(0 == strcmp("other", manager.Slot(slot).details));
+    manager.Ack(true);
+    slot = manager.NextToSend(0);
+    CHECK(0 == strcmp("built", manager.Slot(slot).details));
+    CHECK(WARN == manager.Slot(slot).flag && !manager.Slot(slot).text);
+    CHECK(7 == manager.Slot(slot).size);
+    CHECK(0x01 == manager.Data(slot)[0] && 0x03 == manager.Data(slot)[2] && 0x07 == manager.Data(slot)[6]);
+    manager.Ack(true);
+
+    // a value that doesn't fit isn't added, and the TM is rejected when it's queued
+    CHECK(manager.Build(builder));
+    CHECK(builder.Add(data, 12));
+    CHECK(builder.Add((uint32_t) 1));
+    CHECK(!builder.Add((uint8_t) 1));
+    CHECK(builder.Overflowed() && 16 == builder.Size());
+    CHECK(NO_TM_HANDLE == manager.Queue(builder, FINE, "overflow", 1));
+    CHECK(1 == manager.GetStats().rejected);
+
+    // a discarded TM frees its buffer
+    CHECK(manager.Build(builder));
+    CHECK(manager.Build(second));
+    CHECK(!manager.Build(builder));
+    manager.Discard(second);
+    CHECK(manager.Build(second));
+    manager.Discard(builder);
+    manager.Discard(second);
+    CHECK(0 == manager.Queued());
+    CHECK(2 == manager.GetStats().sent);
+}
+
+static void TestSwap()
+{
+    printf("swap a slot with a TM buffer\n");
+
+    StaticTMManager<2, 8> manager;
+    uint8_t buffer[8] = {'b', 'u', 'f', 'f', 'e', 'r'};
+    const uint8_t data[3] = {'t', 'm', '!'};
+
+    manager.Queue(data, 3, FINE, "tm", false, 1);
+    uint8_t slot = manager.NextToSend(0);
+
+    manager.SwapData(slot, buffer, 6);
+    CHECK(0 == memcmp(buffer, "tm!", 3));
+    CHECK(0 == memcmp(manager.Data(slot), "buffer", 6));
+    manager.SwapData(slot, buffer, 6);
+    CHECK(0 == memcmp(buffer, "buffer", 6));
+    CHECK(0 == memcmp(manager.Data(slot), "tm!", 3));
+}
+
+static void TestKeep()
+{
+    printf("keep a result until it's released\n");
+
+    StaticTMManager<2, 16> manager;
+    const uint8_t data[4] = {0};
+
+    TMHandle_t kept = manager.Queue(data, 4, FINE, "kept", false, 0, true);
+    manager.NextToSend(0);
+    manager.Ack(false);
+
+    // no retries: dropped at the first NAK, but held for the sender
+    CHECK(TM_DROPPED == manager.Status(kept));
+    CHECK(1 == manager.Tries(kept));
+    CHECK(0 == manager.Queued());
+    manager.Release(kept);
+    CHECK(TM_NONE == manager.Status(kept));
+
+    // released before it's acked, it's freed once it is
+    kept = manager.Queue(data, 4, FINE, "kept", false, 0, true);
+    manager.NextToSend(0);
+    manager.Release(kept);
+    CHECK(TM_IN_FLIGHT == manager.Status(kept));
+    manager.Ack(true);
+    CHECK(TM_NONE == manager.Status(kept));
+}
+
+static void TestCore(TestInstrument & inst)
+{
+    printf("send, resend, and queue from StratoCore\n");
+
+    const TMStats_t & stats = inst.GetTMStats();
+    TMStats_t before = stats;
+
+    zephyr_stream.capture = true;
+    TMsSent();
+
+    // the first TM goes out at once, the second waits in the other buffer
+    CHECK(inst.SendData("first data", "first"));
+    CHECK(1 == TMsSent("first"));
+    CHECK(inst.SendData("second data", "second"));
+    CHECK(0 == TMsSent());
+    CHECK(2 == inst.Manager().Queued());
+
+    // with both buffers waiting a log message still queues behind them, and a repeat of it is merged
+    inst.LogFine("queued log");
+    inst.LogFine("queued log");
+    CHECK(0 == TMsSent());
+    CHECK(3 == inst.Manager().Queued());
+    CHECK(stats.rejected == before.rejected);
+    CHECK(stats.merged == before.merged + 1);
+
+    // a NAK resends the first TM with its own data, and leaves the TM buffer being filled alone
+    inst.FillData("next data");
+    InjectTMAck(false);
+    inst.RunRouter();
+    CHECK(std::string::npos != zephyr_stream.tx_data.find("first data"));
+    CHECK(1 == TMsSent("first"));
+    CHECK(inst.TMBufferHolds("next data"));
+
+    // each ACK sends the next
+    InjectTMAck(true);
+    inst.RunRouter();
+    CHECK(1 == TMsSent("second"));
+    CHECK(inst.TMBufferHolds("next data"));
+    InjectTMAck(true);
+    inst.RunRouter();
+    CHECK(1 == TMsSent("queued log"));
+    CHECK(inst.TMBufferHolds("next data"));
+
+    // a TM larger than the one being filled, and one smaller
+    inst.FillData("short");
+    CHECK(inst.SendData("a longer TM than the one after it", "longer"));
+    inst.FillData("a longer TM being filled");
+    CHECK(inst.SendData("tiny", "tiny"));
+    inst.FillData("held");
+    InjectTMAck(true);
+    inst.RunRouter();
+    CHECK(std::string::npos != zephyr_stream.tx_data.find("a longer TM than the one after it"));
+    CHECK(1 == TMsSent("longer"));
+    CHECK(inst.TMBufferHolds("held"));
+    inst.FillData("a longer TM being filled");
+    InjectTMAck(true);
+    inst.RunRouter();
+    CHECK(std::string::npos != zephyr_stream.tx_data.find("tiny"));
+    CHECK(1 == TMsSent("tiny"));
+    CHECK(inst.TMBufferHolds("a longer TM being filled"));
+
+    // a missing TMAck is resent from RunRouter after the timeout, then dropped
+    InjectTMAck(true);
+    inst.RunRouter();
+    inst.Manager().SetPolicy(5000, 1);
+    inst.LogFine("log message");
+    CHECK(1 == TMsSent("log message"));
+
+    Wait(inst, 4999);
+    inst.RunRouter();
+    CHECK(0 == TMsSent());
+    Wait(inst, 1);
+    inst.RunRouter();
+    CHECK(1 == TMsSent("log message"));
+
+    Wait(inst, 5000);
+    inst.RunRouter();
+    CHECK(0 == TMsSent());
+    CHECK(0 == inst.Manager().Queued());
+
+    CHECK(stats.sent == before.sent + 6);
+    CHECK(stats.acked == before.acked + 5);
+    CHECK(stats.retried == before.retried + 2);
+    CHECK(stats.dropped == before.dropped + 1);
+    CHECK(stats.naks == before.naks + 1);
+    CHECK(stats.timeouts == before.timeouts + 2);
+
+    inst.Manager().SetPolicy(TM_ACK_TIMEOUT_MS, TM_MAX_RETRIES);
+    zephyr_stream.capture = false;
+}
+
+int main()
+{
+    SetStratoClock(&test_clock);
+    setenv("STRATO_SD_ROOT", "tm_manager_test_sd", 1);
+
+    TestInstrument inst;
+    inst.InitializeCore();
+
+    TestQueue();
+    TestText();
+    TestBuild();
+    TestSwap();
+    TestKeep();
+    TestCore(inst);
+
+    SetStratoClock(NULL);
+
+    if (failures) {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+
+    printf("all tests passed\n");
+    return 0;
+}
@@ -0,0 +1,245 @@
+/*
+ *  TaskTest.cpp
+ *  Author:  StratoCore contributors
+ *  Created: October 2026
+ *
+ *  This file implements host-side regression tests for cooperative tasks:
+ *  yields, delays and waits must resume at the right point in later loops,
+ *  ready tasks must share the per-loop budget fairly, the control blocks
+ *  must be freed when tasks finish, are stopped, or the mode changes, and a
+ *  task that stops and restarts itself must not disturb the new run.
+ */
+
+#include "TestSupport.h"
+#include "TimeLib.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+class TestInstrument : public TestInstrumentBase {
+public:
+    StratoTaskList & Tasks() { return tasks; }
+
+    // steps of a sweep, one per loop
+    uint32_t sweep_steps = 0;
+    TaskResult_t Sweep(TaskControl_t * task)
+    {
+        TASK_BEGIN(task);
+        for (task->locals[0] = 0; task->locals[0] < task->arg; task->locals[0]++) {
+            sweep_steps++;
+            TASK_YIELD(task);
+        }
+        TASK_END(task);
+    }
+
+    // a delay between two steps
+    bool warmed_up = false;
+    bool measured = false;
+    TaskResult_t Warmup(TaskControl_t * task)
+    {
+        TASK_BEGIN(task);
+        warmed_up = true;
+        TASK_DELAY(task, 200);
+        measured = true;
+        TASK_END(task);
+    }
+
+    // waits for a flag set elsewhere
+    bool ready = false;
+    uint32_t waits = 0;
+    bool released = false;
+    TaskResult_t Waiter(TaskControl_t * task)
+    {
+        TASK_BEGIN(task);
+        TASK_WAIT_UNTIL(task, (waits++, ready));
+        released = true;
+        TASK_END(task);
+    }
+
+    // spins for arg microseconds per step, forever
+    uint32_t spins[TASK_SLOTS] = {0};
+    TaskResult_t Spinner(TaskControl_t * task)
+    {
+        TASK_BEGIN(task);
+        while (true) {
+            {
+                uint32_t start = micros();
+                while (micros() - start < task->arg);
+            }
+            spins[task - tasks.Control(0)]++;
+            TASK_YIELD(task);
+        }
+        TASK_END(task);
+    }
+
+    // stops itself and starts another run with one fewer restart left, then yields
+    uint32_t restart_starts = 0;
+    uint32_t restart_resumes = 0;
+    TaskResult_t Restarter(TaskControl_t * task)
+    {
+        TASK_BEGIN(task);
+        restart_starts++;
+        if (task->arg > 0) {
+            StopTask((uint8_t) (task - tasks.Control(0)));
+            CHECK(NO_TASK != StartTask(&TestInstrument::Restarter, task->arg - 1));
+        }
+        TASK_YIELD(task);
+        restart_resumes++;
+        TASK_END(task);
+    }
+
+    // stops itself, starts a sweep, and exits
+    TaskResult_t Handoff(TaskControl_t * task)
+    {
+        TASK_BEGIN(task);
+        StopTask((uint8_t) (task - tasks.Control(0)));
+        CHECK(NO_TASK != StartSweep(task->arg));
+        TASK_EXIT(task);
+        TASK_END(task);
+    }
+
+    uint8_t StartSweep(uint32_t steps) { return StartTask(&TestInstrument::Sweep, steps); }
+    uint8_t StartWarmup() { return StartTask(&TestInstrument::Warmup); }
+    uint8_t StartWaiter() { return StartTask(&TestInstrument::Waiter); }
+    uint8_t StartSpinner(uint32_t us) { return StartTask(&TestInstrument::Spinner, us); }
+    uint8_t StartRestarter(uint32_t restarts) { return StartTask(&TestInstrument::Restarter, restarts); }
+    uint8_t StartHandoff(uint32_t steps) { return StartTask(&TestInstrument::Handoff, steps); }
+};
+
+static TestInstrument inst;
+
+static void TestYield()
+{
+    printf("yield\n");
+
+    uint8_t task = inst.StartSweep(5);
+    CHECK(NO_TASK != task);
+
+    for (uint32_t i = 1; i <= 5; i++) {
+        inst.RunTasks();
+        CHECK(i == inst.sweep_steps);
+        CHECK(inst.Tasks().IsRunning(task));
+    }
+
+    // the loop ends and the task finishes on the next run
+    inst.RunTasks();
+    CHECK(5 == inst.sweep_steps);
+    CHECK(!inst.Tasks().IsRunning(task));
+    CHECK(0 == inst.Tasks().Active());
+}
+
+static void TestDelayAndWait()
+{
+    printf("delay and wait\n");
+
+    inst.StartWarmup();
+    inst.StartWaiter();
+
+    inst.RunTasks();
+    CHECK(inst.warmed_up && !inst.measured);
+    CHECK(!inst.released);
+
+    inst.RunTasks();
+    inst.RunTasks();
+    CHECK(!inst.measured);
+    CHECK(3 == inst.waits);
+
+    delay(200);
+    inst.ready = true;
+    inst.RunTasks();
+    CHECK(inst.measured);
+    CHECK(inst.released);
+    CHECK(0 == inst.Tasks().Active());
+}
+
+static void TestBudget()
+{
+    printf("budget\n");
+
+    uint32_t limited = inst.Tasks().GetStats().loops_limited;
+    uint8_t a = inst.StartSpinner(50000);
+    uint8_t b = inst.StartSpinner(50000);
+    uint8_t c = inst.StartSpinner(50000);
+
+    // a second 50 ms step starts within a 100 ms budget but a third can't, so the three tasks take turns
+    for (int i = 0; i < 3; i++) inst.RunTasks(100000);
+
+    CHECK(2 == inst.spins[a]);
+    CHECK(2 == inst.spins[b]);
+    CHECK(2 == inst.spins[c]);
+    CHECK(inst.Tasks().GetStats().loops_limited == limited + 3);
+
+    // without a limit, each ready task still runs only once per loop
+    inst.RunTasks(0);
+    CHECK(3 == inst.spins[a] && 3 == inst.spins[b] && 3 == inst.spins[c]);
+
+    inst.Tasks().Stop(b);
+    inst.RunTasks(0);
+    CHECK(4 == inst.spins[a] && 3 == inst.spins[b] && 4 == inst.spins[c]);
+}
+
+static void TestRestart()
+{
+    printf("restart from within a task\n");
+
+    TaskStats_t before = inst.Tasks().GetStats();
+    uint8_t active = inst.Tasks().Active(); // spinners from the budget test
+
+    // each new run starts from the top, the old run's yield doesn't resume it
+    CHECK(NO_TASK != inst.StartRestarter(2));
+    for (uint8_t i = 0; i < 6 && inst.Tasks().Active() > active; i++) inst.RunTasks(0);
+    CHECK(3 == inst.restart_starts);
+    CHECK(1 == inst.restart_resumes);
+    CHECK(active == inst.Tasks().Active());
+
+    // a task's exit doesn't finish the task it started
+    inst.sweep_steps = 0;
+    CHECK(NO_TASK != inst.StartHandoff(3));
+    for (uint8_t i = 0; i < 6 && inst.Tasks().Active() > active; i++) inst.RunTasks(0);
+    CHECK(3 == inst.sweep_steps);
+    CHECK(active == inst.Tasks().Active());
+
+    const TaskStats_t & stats = inst.Tasks().GetStats();
+    CHECK(stats.started == before.started + 5);
+    CHECK(stats.stopped == before.stopped + 3);
+    CHECK(stats.finished == before.finished + 2);
+}
+
+static void TestSlotsAndModeChange()
+{
+    printf("slots and mode change\n");
+
+    while (inst.Tasks().Active() < TASK_SLOTS) CHECK(NO_TASK != inst.StartSpinner(0));
+    CHECK(NO_TASK == inst.StartSweep(1));
+    CHECK(1 == inst.Tasks().GetStats().rejected);
+
+    zephyr_stream.Inject("<IM><Msg>1</Msg><Inst>RACHuTS</Inst><Mode>FL</Mode></IM><CRC>0</CRC><END>");
+    inst.RunRouter();
+    inst.RunMode();
+    CHECK(0 == inst.Tasks().Active());
+    CHECK(TASK_SLOTS == inst.Tasks().GetStats().max_active);
+}
+
+int main()
+{
+    setTime(1561000000);
+    setenv("STRATO_SD_ROOT", "task_test_sd", 1);
+    inst.InitializeCore();
+
+    zephyr_stream.capture = true;
+    debug_stream.capture = true;
+
+    TestYield();
+    TestDelayAndWait();
+    TestBudget();
+    TestRestart();
+    TestSlotsAndModeChange();
+
+    if (failures) {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+
+    printf("all tests passed\n");
+    return 0;
+}
@@ -0,0 +1,76 @@
+/*
+ *  TestSupport.h
+ *  Author:  StratoCore contributors
+ *  Created: October 2026
+ *
+ *  This file collects the pieces shared by the host-side StratoCore tests:
+ *  the CHECK macro, the Zephyr and debug streams, a TestInstrumentBase with
+ *  empty mode functions and handlers for each test's instrument to derive
+ *  from, and injection of Zephyr messages. Each test is its own executable,
+ *  so everything here is static to that test.
+ */
+
+#ifndef TESTSUPPORT_H
+#define TESTSUPPORT_H
+
+#include "StratoCore.h"
+#include "HostStream.h"
+#include <stdio.h>
+#include <string.h>
+
+static int failures = 0;
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            printf("  FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            failures++; \
+        } \
+    } while (0)
+
+static HostStream zephyr_stream;
+static HostStream debug_stream;
+
+// message IDs for everything injected as if from the Zephyr
+static uint32_t msg_id = 0;
+
+class TestInstrumentBase : public StratoCore {
+public:
+    TestInstrumentBase(Stream * zephyr_serial = &zephyr_stream) : StratoCore(zephyr_serial, RACHUTS, &debug_stream) { }
+
+    void InstrumentSetup() { }
+    void InstrumentLoop() { }
+
+    // start filling the TM buffer without sending it
+    void FillData(const char * data)
+    {
+        zephyrTX.clearTm();
+        zephyrTX.addTm((const uint8_t *) data, (uint16_t) strlen(data));
+    }
+
+    bool TMBufferHolds(const char * data)
+    {
+        uint8_t * buffer = NULL;
+        uint16_t size = zephyrTX.getTmBuffer(&buffer);
+        return size == strlen(data) && 0 == memcmp(buffer, data, size);
+    }
+
+protected:
+    void StandbyMode() { }
+    void FlightMode() { }
+    void LowPowerMode() { }
+    void SafetyMode() { }
+    void EndOfFlightMode() { }
+    void TCHandler(Telecommand_t telecommand) { (void) telecommand; }
+    void ActionHandler(uint8_t action) { (void) action; }
+};
+
+static inline void InjectTMAck(bool ack)
+{
+    char msg[200];
+    snprintf(msg, sizeof(msg), "<TMAck><Msg>%u</Msg><Inst>RACHuTS</Inst><Ack>%s</Ack></TMAck><CRC>0</CRC><END>",
+             ++msg_id, ack ? "ACK" : "NAK");
+    zephyr_stream.Inject(msg);
+}
+
+#endif /* TESTSUPPORT_H */
@@ -0,0 +1,307 @@
+/*
+ *  ArchiveTool.cpp
+ *  Author:  StratoCore contributors
+ *  Created: October 2026
+ *
+ *  This file implements a host-side reader and verifier for StratoArchive
+ *  files (e.g. the TM archives written by WriteFileTM), run against a copy
+ *  of the SD card.
+ *
+ *  Usage: strato_archive [-d sd_dir] verify <file.dat> ...
+ *         strato_archive [-d sd_dir] list <file.dat>
+ *         strato_archive [-d sd_dir] find <prefix> <start time> [end time]
+ */
+
+#include "StratoArchive.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+struct RecordInfo_t {
+    uint32_t offset;
+    uint32_t time;
+};
+
+static uint8_t data_buffer[65536];
+
+static void Usage()
+{
+    printf("usage: strato_archive [-d sd_dir] verify <file.dat> ...\n");
+    printf("       strato_archive [-d sd_dir] list <file.dat>\n");
+    printf("       strato_archive [-d sd_dir] find <prefix> <start time> [end time]\n");
+}
+
+// read the record at the file's current position, returns false at the end of the data
+static bool ReadRecord(File & file, uint32_t file_size, uint8_t * header, ArchiveRecordHeader_t * record, bool * crc_ok)
+{
+    uint32_t position = file.curPosition();
+
+    if (file_size - position < ARCHIVE_HEADER_SIZE) return false;
+    if (ARCHIVE_HEADER_SIZE != file.read(header, ARCHIVE_HEADER_SIZE)) return false;
+    if (!ArchiveUnpackHeader(header, record)) return false;
+    if (file_size - file.curPosition() < record->length) return false;
+    if ((int) record->length != file.read(data_buffer, record->length)) return false;
+
+    *crc_ok = ArchiveCheckRecord(header, data_buffer);
+
+    return true;
+}
+
+// true if everything from the position on is zero, as left by the pre-allocation after a reset
+static bool RestIsEmpty(File & file, uint32_t position)
+{
+    int c;
+
+    file.seekSet(position);
+    while (-1 != (c = file.read())) {
+        if (0 != c) return false;
+    }
+
+    return true;
+}
+
+// find the next valid record after a corrupt one, returns its offset or the file size
+static uint32_t Resync(File & file, uint32_t file_size, uint32_t position)
+{
+    uint8_t header[ARCHIVE_HEADER_SIZE];
+    ArchiveRecordHeader_t record;
+    bool crc_ok = false;
+
+    for (position++; position + ARCHIVE_HEADER_SIZE <= file_size; position++) {
+        file.seekSet(position);
+        if (ReadRecord(file, file_size, header, &record, &crc_ok) && crc_ok) return position;
+    }
+
+    return file_size;
+}
+
+static int Verify(const char * filename)
+{
+    uint8_t header[ARCHIVE_HEADER_SIZE];
+    ArchiveRecordHeader_t record;
+    std::vector<RecordInfo_t> records;
+    uint32_t errors = 0, out_of_order = 0, data_bytes = 0;
+    bool crc_ok = false;
+
+    File file = SD.open(filename, O_READ);
+    if (!file) {
+        printf("%s: unable to open\n", filename);
+        return 1;
+    }
+
+    uint32_t file_size = file.fileSize();
+    uint32_t position = 0;
+
+    while (position < file_size) {
+        file.seekSet(position);
+
+        if (!ReadRecord(file, file_size, header, &record, &crc_ok)) {
+            if (RestIsEmpty(file, position)) {
+                if (position + 1 < file_size) printf("  %u unused bytes after the last record\n", file_size - position);
+                break;
+            }
+
+            uint32_t next = Resync(file, file_size, position);
+            printf("  bad record header at %u, skipped %u bytes\n", position, next - position);
+            errors++;
+            position = next;
+            continue;
+        }
+
+        if (!crc_ok) {
+            printf("  CRC error in record at %u (time %u, type %u, %u bytes)\n", position, record.time, record.type, record.length);
+            errors++;
+        }
+
+        if (!records.empty() && record.time < records.back().time) out_of_order++;
+
+        RecordInfo_t info = {position, record.time};
+        records.push_back(info);
+        data_bytes += record.length;
+        position = file.curPosition();
+    }
+
+    file.close();
+
+    printf("%s: %u records, %u data bytes", filename, (uint32_t) records.size(), data_bytes);
+    if (!records.empty()) printf(", time %u to %u", records.front().time, records.back().time);
+    printf("\n");
+    if (out_of_order) printf("  %u records earlier than the one before (time corrections)\n", out_of_order);
+
+    // check the index: sorted, and every entry is a record start with the same time
+    char index_name[SD_LOG_NAME_SIZE + 8] = {0};
+    size_t name_length = strlen(filename);
+    snprintf(index_name, sizeof(index_name), "%.*s.idx", (int) (name_length > 4 ? name_length - 4 : name_length), filename);
+
+    File index_file = SD.open(index_name, O_READ);
+    if (!index_file) {
+        printf("  no index (%s), no sectors of the file were written\n", index_name);
+        return errors ? 1 : 0;
+    }
+
+    uint8_t buffer[ARCHIVE_INDEX_HEADER_SIZE];
+    if (ARCHIVE_INDEX_HEADER_SIZE != index_file.read(buffer, ARCHIVE_INDEX_HEADER_SIZE) || 0 != memcmp(buffer, ARCHIVE_INDEX_MAGIC, 4)
+        || ARCHIVE_INDEX_ENTRY_SIZE != ArchiveGet16(&buffer[6])) {
+        printf("  bad index header\n");
+        index_file.close();
+        return 1;
+    }
+
+    uint32_t entries = ArchiveGet32(&buffer[8]);
+    uint32_t index_errors = 0, last_time = 0;
+    size_t next_record = 0;
+
+    if (index_file.fileSize() != ARCHIVE_INDEX_HEADER_SIZE + entries * ARCHIVE_INDEX_ENTRY_SIZE) {
+        printf("  index size doesn't match its %u entries\n", entries);
+        index_errors++;
+    }
+
+    for (uint32_t i = 0; i < entries; i++) {
+        if (ARCHIVE_INDEX_ENTRY_SIZE != index_file.read(buffer, ARCHIVE_INDEX_ENTRY_SIZE)) break;
+
+        uint32_t time = ArchiveGet32(buffer);
+        uint32_t offset = ArchiveGet32(&buffer[4]);
+
+        if (i > 0 && time < last_time) {
+            printf("  index entry %u out of order\n", i);
+            index_errors++;
+        }
+        last_time = time;
+
+        while (next_record < records.size() && records[next_record].offset < offset) next_record++;
+        if (next_record == records.size() || records[next_record].offset != offset || records[next_record].time != time) {
+            printf("  index entry %u (time %u, offset %u) doesn't match a record\n", i, time, offset);
+            index_errors++;
+        }
+    }
+
+    index_file.close();
+
+    printf("  index: %u entries, %u errors\n", entries, index_errors);
+
+    return (errors || index_errors) ? 1 : 0;
+}
+
+static int List(const char * filename)
+{
+    uint8_t header[ARCHIVE_HEADER_SIZE];
+    ArchiveRecordHeader_t record;
+    bool crc_ok = false;
+
+    File file = SD.open(filename, O_READ);
+    if (!file) {
+        printf("%s: unable to open\n", filename);
+        return 1;
+    }
+
+    uint32_t file_size = file.fileSize();
+    uint32_t position = 0;
+
+    printf("%10s %10s %4s %6s %s\n", "offset", "time", "type", "length", "crc");
+    while (ReadRecord(file, file_size, header, &record, &crc_ok)) {
+        printf("%10u %10u %4u %6u %s\n", position, record.time, record.type, record.length, crc_ok ? "ok" : "BAD");
+        position = file.curPosition();
+    }
+
+    file.close();
+
+    return 0;
+}
+
+// print the records in a time range, across files, using the catalog and index to find the start
+static int Find(const char * prefix, uint32_t start, uint32_t end)
+{
+    char filename[ARCHIVE_CATALOG_NAME_SIZE] = {0};
+    char catalog_name[SD_LOG_PREFIX_SIZE + 8] = {0};
+    uint8_t header[ARCHIVE_HEADER_SIZE];
+    uint8_t entry[ARCHIVE_CATALOG_ENTRY_SIZE];
+    ArchiveRecordHeader_t record;
+    uint32_t offset = 0, found = 0;
+    bool crc_ok = false;
+
+    if (!ArchiveFindFile(prefix, start, filename, sizeof(filename))) {
+        printf("no catalog for %s\n", prefix);
+        return 1;
+    }
+
+    if (!ArchiveFindOffset(filename, start, &offset)) printf("no index for %s, reading from the start\n", filename);
+
+    printf("start: %s at offset %u\n", filename, offset);
+    printf("%-28s %10s %10s %4s %6s %s\n", "file", "offset", "time", "type", "length", "crc");
+
+    snprintf(catalog_name, sizeof(catalog_name), "%s.cat", prefix);
+    File catalog = SD.open(catalog_name, O_READ);
+
+    // move the catalog to the entry after the starting file
+    while (ARCHIVE_CATALOG_ENTRY_SIZE == catalog.read(entry, ARCHIVE_CATALOG_ENTRY_SIZE)
+           && 0 != strncmp((const char *) &entry[4], filename, ARCHIVE_CATALOG_NAME_SIZE));
+
+    while (true) {
+        File file = SD.open(filename, O_READ);
+        uint32_t file_size = file.fileSize();
+        uint32_t position = offset;
+        bool past_end = false;
+
+        file.seekSet(offset);
+        while (ReadRecord(file, file_size, header, &record, &crc_ok)) {
+            if (record.time > end) {
+                past_end = true;
+                break;
+            }
+            if (record.time >= start) {
+                printf("%-28s %10u %10u %4u %6u %s\n", filename, position, record.time, record.type, record.length, crc_ok ? "ok" : "BAD");
+                found++;
+            }
+            position = file.curPosition();
+        }
+
+        file.close();
+
+        if (past_end || ARCHIVE_CATALOG_ENTRY_SIZE != catalog.read(entry, ARCHIVE_CATALOG_ENTRY_SIZE)) break;
+
+        memcpy(filename, &entry[4], ARCHIVE_CATALOG_NAME_SIZE);
+        filename[ARCHIVE_CATALOG_NAME_SIZE - 1] = '\0';
+        offset = 0;
+    }
+
+    catalog.close();
+
+    printf("%u records\n", found);
+
+    return 0;
+}
+
+int main(int argc, char ** argv)
+{
+    int arg = 1;
+
+    if (arg + 1 < argc && 0 == strcmp(argv[arg], "-d")) {
+        setenv("STRATO_SD_ROOT", argv[arg + 1], 1);
+        arg += 2;
+    }
+
+    if (arg + 1 >= argc || !StartSD()) {
+        Usage();
+        return 2;
+    }
+
+    const char * command = argv[arg++];
+
+    if (0 == strcmp(command, "verify")) {
+        int result = 0;
+        for (; arg < argc; arg++) {
+            result |= Verify(argv[arg]);
+        }
+        return result;
+    } else if (0 == strcmp(command, "list")) {
+        return List(argv[arg]);
+    } else if (0 == strcmp(command, "find") && arg + 1 < argc) {
+        uint32_t start = (uint32_t) strtoul(argv[arg + 1], NULL, 10);
+        uint32_t end = (arg + 2 < argc) ? (uint32_t) strtoul(argv[arg + 2], NULL, 10) : start;
+        return Find(argv[arg], start, end);
+    }
+
+    Usage();
+    return 2;
+}
@@ -0,0 +1,130 @@
+/*
+ *  CodecTool.cpp
+ *  Author:  StratoCore contributors
+ *  Created: October 2026
+ *
+ *  This file implements the ground-side decoder for TM buffers encoded with
+ *  StratoCodec (EncodeTMBuffer), working on files that hold one TM payload.
+ *
+ *  Usage: strato_codec info <encoded>
+ *         strato_codec decode <encoded> <raw>
+ *         strato_codec encode <codec flags> <delta width> <delta stride> <raw> <encoded>
+ */
+
+#include "StratoCodec.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_SIZE    65535
+
+static StaticCodec<MAX_SIZE> codec;
+static uint8_t input[MAX_SIZE];
+static uint8_t output[MAX_SIZE];
+static uint8_t scratch[MAX_SIZE];
+
+static void Usage()
+{
+    printf("usage: strato_codec info <encoded>\n");
+    printf("       strato_codec decode <encoded> <raw>\n");
+    printf("       strato_codec encode <codec flags> <delta width> <delta stride> <raw> <encoded>\n");
+    printf("codec flags: %u = none, %u = delta, %u = LZ, %u = delta+LZ\n", CODEC_NONE, CODEC_DELTA, CODEC_LZ, CODEC_DELTA | CODEC_LZ);
+}
+
+static bool ReadFile(const char * name, uint16_t * size)
+{
+    FILE * file = fopen(name, "rb");
+    if (NULL == file) {
+        printf("unable to open %s\n", name);
+        return false;
+    }
+
+    size_t length = fread(input, 1, sizeof(input), file);
+    bool too_big = (EOF != fgetc(file));
+    fclose(file);
+
+    if (too_big) {
+        printf("%s is larger than %u bytes\n", name, MAX_SIZE);
+        return false;
+    }
+
+    *size = (uint16_t) length;
+    return true;
+}
+
+static bool WriteFile(const char * name, const uint8_t * data, uint16_t size)
+{
+    FILE * file = fopen(name, "wb");
+    if (NULL == file || size != fwrite(data, 1, size, file)) {
+        printf("unable to write %s\n", name);
+        if (NULL != file) fclose(file);
+        return false;
+    }
+
+    fclose(file);
+    return true;
+}
+
+static int Info(const char * name)
+{
+    uint16_t size = 0;
+
+    if (!ReadFile(name, &size)) return 1;
+
+    if (size < CODEC_HEADER_SIZE) {
+        printf("%s: too short for a codec header\n", name);
+        return 1;
+    }
+
+    uint16_t raw_size = (uint16_t) ((input[3] << 8) | input[4]);
+    printf("%s: codec 0x%02x%s%s, delta width %u, stride %u, %u bytes encoded, %u raw (ratio %.2f)\n", name, input[0],
+           (input[0] & CODEC_DELTA) ? " delta" : "", (input[0] & CODEC_LZ) ? " LZ" : "", input[1], input[2],
+           size, raw_size, size ? (double) raw_size / size : 0.0);
+
+    return 0;
+}
+
+static int Decode(const char * in_name, const char * out_name)
+{
+    uint16_t size = 0;
+    uint16_t decoded_size = 0;
+
+    if (!ReadFile(in_name, &size)) return 1;
+
+    if (!CodecDecode(input, size, output, sizeof(output), &decoded_size, scratch, sizeof(scratch))) {
+        printf("%s: invalid or corrupted encoding\n", in_name);
+        return 1;
+    }
+
+    return WriteFile(out_name, output, decoded_size) ? 0 : 1;
+}
+
+static int Encode(uint8_t flags, uint8_t width, uint8_t stride, const char * in_name, const char * out_name)
+{
+    uint16_t size = 0;
+
+    if (!ReadFile(in_name, &size)) return 1;
+
+    uint16_t encoded_size = codec.Encode(flags, width, stride, input, size);
+    if (0 == encoded_size) {
+        printf("unable to encode %s (check the codec and delta parameters)\n", in_name);
+        return 1;
+    }
+
+    return WriteFile(out_name, codec.Output(), encoded_size) ? 0 : 1;
+}
+
+int main(int argc, char ** argv)
+{
+    if (argc == 3 && 0 == strcmp(argv[1], "info")) {
+        return Info(argv[2]);
+    } else if (argc == 4 && 0 == strcmp(argv[1], "decode")) {
+        return Decode(argv[2], argv[3]);
+    } else if (argc == 7 && 0 == strcmp(argv[1], "encode")) {
+        return Encode((uint8_t) strtoul(argv[2], NULL, 0), (uint8_t) strtoul(argv[3], NULL, 10),
+                      (uint8_t) strtoul(argv[4], NULL, 10), argv[5], argv[6]);
+    }
+
+    Usage();
+    return 2;
+}
@@ -0,0 +1,442 @@
+/*
+ *  LogTokenDecoder.cpp
+ *  Author:  StratoCore contributors
+ *  Created: October 2026
+ *
+ *  This file implements the ground-side half of tokenized logging
+ */
+
+#include "LogTokenDecoder.h"
+#include "StratoLogToken.h"
+#include <ctype.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+// Dictionary ---------------------------------------------
+
+uint32_t LogTokenHashString(const std::string & format)
+{
+    uint32_t hash = 2166136261UL;
+
+    for (unsigned char c : format) {
+        hash = (hash ^ c) * 16777619UL;
+    }
+
+    return hash;
+}
+
+static bool ReadText(const char * filename, std::string & text)
+{
+    FILE * file = fopen(filename, "rb");
+    char buffer[4096];
+    size_t length = 0;
+
+    if (NULL == file) return false;
+
+    while (0 < (length = fread(buffer, 1, sizeof(buffer), file))) {
+        text.append(buffer, length);
+    }
+
+    fclose(file);
+    return true;
+}
+
+// parse one C string literal starting at the opening quote, position is left after the closing quote
+static bool ParseLiteral(const std::string & text, size_t & position, std::string & value)
+{
+    position++;
+
+    while (position < text.size() && '"' != text[position]) {
+        char c = text[position++];
+
+        if ('\n' == c) return false;
+        if ('\\' != c) {
+            value += c;
+            continue;
+        }
+
+        if (position >= text.size()) return false;
+        c = text[position++];
+
+        switch (c) {
+        case 'n': value += '\n'; break;
+        case 't': value += '\t'; break;
+        case 'r': value += '\r'; break;
+        case 'a': value += '\a'; break;
+        case 'b': value += '\b'; break;
+        case 'f': value += '\f'; break;
+        case 'v': value += '\v'; break;
+        case 'x': {
+            unsigned int code = 0;
+            while (position < text.size() && isxdigit((unsigned char) text[position])) {
+                code = code * 16 + (isdigit((unsigned char) text[position]) ? text[position] - '0' : (tolower(text[position]) - 'a' + 10));
+                position++;
+            }
+            value += (char) code;
+            break;
+        }
+        default:
+            if (c >= '0' && c <= '7') {
+                unsigned int code = (unsigned int) (c - '0');
+                for (int digits = 1; digits < 3 && position < text.size() && text[position] >= '0' && text[position] <= '7'; digits++) {
+                    code = code * 8 + (unsigned int) (text[position++] - '0');
+                }
+                value += (char) code;
+            } else {
+                value += c; // \" \' \\ \?
+            }
+            break;
+        }
+    }
+
+    if (position >= text.size()) return false;
+    position++;
+
+    return true;
+}
+
+bool LogTokenScanSource(const char * filename, LogTokenDictionary & dictionary, std::string & error)
+{
+    static const char * names[] = {"log_debugf", "log_nominalf", "log_errorf"};
+    std::string text;
+    bool success = true;
+
+    if (!ReadText(filename, text)) {
+        error += std::string("unable to read ") + filename + "\n";
+        return false;
+    }
+
+    for (const char * name : names) {
+        size_t length = strlen(name);
+
+        for (size_t found = text.find(name); std::string::npos != found; found = text.find(name, found + length)) {
+            // the whole identifier, followed by an argument list starting with literals
+            if (found > 0 && (isalnum((unsigned char) text[found - 1]) || '_' == text[found - 1])) continue;
+
+            size_t position = found + length;
+            while (position < text.size() && isspace((unsigned char) text[position])) position++;
+            if (position >= text.size() || '(' != text[position]) continue;
+            position++;
+
+            std::string format;
+            bool literal = false;
+            while (true) {
+                while (position < text.size() && isspace((unsigned char) text[position])) position++;
+                if (position >= text.size() || '"' != text[position]) break;
+                if (!ParseLiteral(text, position, format)) break;
+                literal = true;
+            }
+
+            // macro definitions and calls with a non-literal format (which won't compile tokenized)
+            if (!literal) continue;
+
+            uint32_t token = LogTokenHashString(format);
+            LogTokenDictionary::iterator existing = dictionary.find(token);
+            if (dictionary.end() != existing && existing->second != format) {
+                char hex[16];
+                snprintf(hex, sizeof(hex), "%08x", token);
+                error += std::string(filename) + ": token " + hex + " of \"" + format + "\" collides with another format\n";
+                success = false;
+                continue;
+            }
+
+            dictionary[token] = format;
+        }
+    }
+
+    return success;
+}
+
+bool LogTokenSaveDictionary(const char * filename, const LogTokenDictionary & dictionary)
+{
+    FILE * file = fopen(filename, "w");
+
+    if (NULL == file) return false;
+
+    for (const auto & entry : dictionary) {
+        fprintf(file, "%08x\t", entry.first);
+
+        for (unsigned char c : entry.second) {
+            switch (c) {
+            case '\\': fputs("\\\\", file); break;
+            case '\n': fputs("\\n", file); break;
+            case '\r': fputs("\\r", file); break;
+            case '\t': fputs("\\t", file); break;
+            default:
+                if (c < 0x20 || c >= 0x7F) {
+                    fprintf(file, "\\x%02x", c);
+                } else {
+                    fputc(c, file);
+                }
+                break;
+            }
+        }
+
+        fputc('\n', file);
+    }
+
+    return 0 == fclose(file);
+}
+
+bool LogTokenLoadDictionary(const char * filename, LogTokenDictionary & dictionary)
+{
+    std::string text;
+    size_t start = 0;
+
+    if (!ReadText(filename, text)) return false;
+
+    while (start < text.size()) {
+        size_t end = text.find('\n', start);
+        if (std::string::npos == end) end = text.size();
+
+        std::string line = text.substr(start, end - start);
+        start = end + 1;
+
+        size_t tab = line.find('\t');
+        if (std::string::npos == tab) continue;
+
+        uint32_t token = (uint32_t) strtoul(line.substr(0, tab).c_str(), NULL, 16);
+        std::string format;
+
+        for (size_t i = tab + 1; i < line.size(); i++) {
+            if ('\\' != line[i] || i + 1 >= line.size()) {
+                format += line[i];
+                continue;
+            }
+
+            char c = line[++i];
+            if ('n' == c) {
+                format += '\n';
+            } else if ('r' == c) {
+                format += '\r';
+            } else if ('t' == c) {
+                format += '\t';
+            } else if ('x' == c && i + 2 < line.size()) {
+                format += (char) strtoul(line.substr(i + 1, 2).c_str(), NULL, 16);
+                i += 2;
+            } else {
+                format += c;
+            }
+        }
+
+        dictionary[token] = format;
+    }
+
+    return true;
+}
+
+// Expansion ----------------------------------------------
+
+class FrameReader {
+public:
+    FrameReader(const uint8_t * frame, size_t frame_size) : data(frame), size(frame_size), position(0) { }
+
+    bool Integer(int64_t * value)
+    {
+        uint64_t zigzag = 0;
+
+        for (uint8_t shift = 0; shift < 70; shift += 7) {
+            if (position >= size) return false;
+            uint8_t byte = data[position++];
+            zigzag |= (uint64_t) (byte & 0x7F) << shift;
+            if (0 == (byte & 0x80)) {
+                *value = (int64_t) ((zigzag >> 1) ^ (0 - (zigzag & 1)));
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    bool Float(float * value)
+    {
+        if (size - position < 4) return false;
+
+        uint32_t bits = (uint32_t) data[position] | ((uint32_t) data[position + 1] << 8)
+                        | ((uint32_t) data[position + 2] << 16) | ((uint32_t) data[position + 3] << 24);
+        memcpy(value, &bits, 4);
+        position += 4;
+
+        return true;
+    }
+
+    bool String(std::string * value, bool * truncated)
+    {
+        if (position >= size) return false;
+
+        uint8_t length = data[position] & 0x7F;
+        *truncated = (0 != (data[position] & 0x80));
+        position++;
+
+        if (size - position < length) return false;
+        value->assign((const char *) &data[position], length);
+        position += length;
+
+        return true;
+    }
+
+private:
+    const uint8_t * data;
+    size_t size;
+    size_t position;
+};
+
+static std::string Format(const char * spec, ...) __attribute__((format(printf, 1, 2)));
+
+static std::string Format(const char * spec, ...)
+{
+    char buffer[512];
+    va_list args;
+
+    va_start(args, spec);
+    vsnprintf(buffer, sizeof(buffer), spec, args);
+    va_end(args);
+
+    return buffer;
+}
+
+std::string LogTokenExpandFrame(const LogTokenDictionary & dictionary, const uint8_t * frame, size_t size)
+{
+    if (size < 4) return "<short log frame>";
+
+    uint32_t token = (uint32_t) frame[0] | ((uint32_t) frame[1] << 8) | ((uint32_t) frame[2] << 16) | ((uint32_t) frame[3] << 24);
+    LogTokenDictionary::const_iterator entry = dictionary.find(token);
+
+    if (dictionary.end() == entry) return Format("<unknown log token %08x>", token);
+
+    const std::string & format = entry->second;
+    FrameReader reader(&frame[4], size - 4);
+    std::string output;
+
+    for (size_t i = 0; i < format.size(); i++) {
+        if ('%' != format[i]) {
+            output += format[i];
+            continue;
+        }
+
+        // %[flags][width][.precision][length]conversion, rebuilt without the length for the host's printf
+        std::string spec = "%";
+        std::string length;
+        int64_t value = 0;
+        bool missing = false;
+
+        for (i++; i < format.size() && strchr("-+ #0", format[i]); i++) spec += format[i];
+
+        for (int part = 0; part < 2; part++) {
+            if (1 == part) {
+                if (i >= format.size() || '.' != format[i]) break;
+                spec += format[i++];
+            }
+
+            if (i < format.size() && '*' == format[i]) {
+                missing |= !reader.Integer(&value);
+                spec += std::to_string((int32_t) value);
+                i++;
+            } else {
+                while (i < format.size() && isdigit((unsigned char) format[i])) spec += format[i++];
+            }
+        }
+
+        while (i < format.size() && strchr("hljztLq", format[i])) length += format[i++];
+
+        if (i >= format.size()) break;
+        char conversion = format[i];
+
+        if ('%' == conversion) {
+            output += '%';
+            continue;
+        }
+
+        if (strchr("diuoxXcp", conversion)) {
+            missing |= !reader.Integer(&value);
+            if (missing) {
+                output += "<?>";
+            } else if ('d' == conversion || 'i' == conversion) {
+                // narrow to the width the instrument passed, as printf would
+                if ("hh" == length) value = (int8_t) value;
+                else if ("h" == length) value = (int16_t) value;
+                else if ("ll" != length && "j" != length && "q" != length) value = (int32_t) value;
+                output += Format((spec + "lld").c_str(), (long long) value);
+            } else if ('c' == conversion) {
+                output += Format((spec + "c").c_str(), (int) (char) value);
+            } else if ('p' == conversion) {
+                output += "0x" + Format((spec + "llx").c_str(), (unsigned long long) (uint32_t) value);
+            } else {
+                uint64_t unsigned_value = (uint64_t) value;
+                if ("hh" == length) unsigned_value = (uint8_t) unsigned_value;
+                else if ("h" == length) unsigned_value = (uint16_t) unsigned_value;
+                else if ("ll" != length && "j" != length && "q" != length) unsigned_value = (uint32_t) unsigned_value;
+                output += Format((spec + "ll" + conversion).c_str(), (unsigned long long) unsigned_value);
+            }
+        } else if (strchr("fFeEgGaA", conversion)) {
+            float float_value = 0;
+            if (missing || !reader.Float(&float_value)) {
+                output += "<?>";
+            } else {
+                output += Format((spec + conversion).c_str(), (double) float_value);
+            }
+        } else if ('s' == conversion) {
+            std::string string_value;
+            bool truncated = false;
+            if (missing || !reader.String(&string_value, &truncated)) {
+                output += "<?>";
+            } else {
+                output += Format((spec + "s").c_str(), string_value.c_str());
+                if (truncated) output += "...";
+            }
+        }
+    }
+
+    return output;
+}
+
+static bool Base64Decode(const std::string & text, std::vector<uint8_t> & data)
+{
+    uint32_t group = 0;
+    int bits = 0;
+
+    for (char c : text) {
+        int value = 0;
+
+        if (c >= 'A' && c <= 'Z') value = c - 'A';
+        else if (c >= 'a' && c <= 'z') value = c - 'a' + 26;
+        else if (c >= '0' && c <= '9') value = c - '0' + 52;
+        else if ('+' == c) value = 62;
+        else if ('/' == c) value = 63;
+        else if ('=' == c) break;
+        else return false;
+
+        group = (group << 6) | (uint32_t) value;
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            data.push_back((uint8_t) (group >> bits));
+        }
+    }
+
+    return true;
+}
+
+std::string LogTokenExpandLine(const LogTokenDictionary & dictionary, const std::string & line)
+{
+    static const char * prefixes[] = {"DBG: ", "NOM: ", "ERR: "};
+    std::vector<uint8_t> frame;
+
+    for (const char * prefix : prefixes) {
+        size_t length = strlen(prefix);
+
+        if (0 != line.compare(0, length, prefix) || line.size() <= length || LOG_TOKEN_PREFIX != line[length]) continue;
+
+        std::string text = line.substr(length + 1);
+        while (!text.empty() && ('\r' == text.back() || '\n' == text.back())) text.pop_back();
+
+        if (!Base64Decode(text, frame)) return line;
+
+        return std::string(prefix) + LogTokenExpandFrame(dictionary, frame.data(), frame.size());
+    }
+
+    return line;
+}
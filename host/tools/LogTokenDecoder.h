@@ -0,0 +1,38 @@
+/*
+ *  LogTokenDecoder.h
+ *  Author:  StratoCore contributors
+ *  Created: October 2026
+ *
+ *  This file declares the ground-side half of tokenized logging (see
+ *  StratoLogToken.h): building the token dictionary from the sources and
+ *  expanding frames back into text
+ */
+
+#ifndef LOGTOKENDECODER_H
+#define LOGTOKENDECODER_H
+
+#include <stdint.h>
+#include <map>
+#include <string>
+
+typedef std::map<uint32_t, std::string> LogTokenDictionary;
+
+// the same hash the compiler computes for each log site
+uint32_t LogTokenHashString(const std::string & format);
+
+// add the literal formats of every log_xxxxf call in a source file, returns false if the
+// file can't be read or a token collides with a different format (described in error)
+bool LogTokenScanSource(const char * filename, LogTokenDictionary & dictionary, std::string & error);
+
+// the dictionary file has one "<token in hex>\t<format, C-escaped>" line per format
+bool LogTokenSaveDictionary(const char * filename, const LogTokenDictionary & dictionary);
+bool LogTokenLoadDictionary(const char * filename, LogTokenDictionary & dictionary);
+
+// format a frame (token and arguments) as the instrument would have, following the format's
+// conversions as compiled for the Teensy (int and long are 32 bits)
+std::string LogTokenExpandFrame(const LogTokenDictionary & dictionary, const uint8_t * frame, size_t size);
+
+// expand a ground port line holding a base64 frame after its level prefix, other lines are returned as they are
+std::string LogTokenExpandLine(const LogTokenDictionary & dictionary, const std::string & line);
+
+#endif /* LOGTOKENDECODER_H */
@@ -0,0 +1,142 @@
+/*
+ *  LogTokenTool.cpp
+ *  Author:  StratoCore contributors
+ *  Created: October 2026
+ *
+ *  This file implements the ground-side tool for tokenized logging: it
+ *  builds the token dictionary from the instrument's sources (run as a
+ *  build step), and expands ground port captures and archived log records.
+ *
+ *  Usage: strato_logtok dict <dictionary> <source> ...
+ *         strato_logtok expand <dictionary> [capture]
+ *         strato_logtok archive <dictionary> <file.dat> ...
+ */
+
+#include "LogTokenDecoder.h"
+#include "StratoArchive.h"
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+static void Usage()
+{
+    printf("usage: strato_logtok dict <dictionary> <source> ...\n");
+    printf("       strato_logtok expand <dictionary> [capture]\n");
+    printf("       strato_logtok archive <dictionary> <file.dat> ...\n");
+}
+
+static int Dictionary(const char * output, int count, char ** sources)
+{
+    LogTokenDictionary dictionary;
+    std::string error;
+    bool success = true;
+
+    for (int i = 0; i < count; i++) {
+        success &= LogTokenScanSource(sources[i], dictionary, error);
+    }
+
+    if (!success) {
+        fputs(error.c_str(), stderr);
+        return 1;
+    }
+
+    if (!LogTokenSaveDictionary(output, dictionary)) {
+        fprintf(stderr, "unable to write %s\n", output);
+        return 1;
+    }
+
+    printf("%u log formats in %s\n", (unsigned int) dictionary.size(), output);
+    return 0;
+}
+
+// expand the frame lines of a ground port capture, passing everything else through
+static int Expand(const LogTokenDictionary & dictionary, const char * capture)
+{
+    FILE * file = (NULL != capture) ? fopen(capture, "r") : stdin;
+    char buffer[1024];
+
+    if (NULL == file) {
+        fprintf(stderr, "unable to open %s\n", capture);
+        return 1;
+    }
+
+    std::string line;
+    while (NULL != fgets(buffer, sizeof(buffer), file)) {
+        line += buffer;
+        if ('\n' != line.back() && !feof(file)) continue;
+
+        std::string expanded = LogTokenExpandLine(dictionary, line);
+        fputs(expanded.c_str(), stdout);
+        if (expanded.empty() || '\n' != expanded.back()) fputc('\n', stdout);
+        line.clear();
+    }
+
+    if (stdin != file) fclose(file);
+    return 0;
+}
+
+// print the log records of archive data files, skipping other record types
+static int Archive(const LogTokenDictionary & dictionary, const char * filename)
+{
+    static const char * levels[] = {"DBG", "NOM", "ERR"};
+    uint8_t header[ARCHIVE_HEADER_SIZE];
+    std::vector<uint8_t> data;
+    ArchiveRecordHeader_t record;
+    int errors = 0;
+
+    FILE * file = fopen(filename, "rb");
+    if (NULL == file) {
+        fprintf(stderr, "unable to open %s\n", filename);
+        return 1;
+    }
+
+    while (ARCHIVE_HEADER_SIZE == fread(header, 1, ARCHIVE_HEADER_SIZE, file) && ArchiveUnpackHeader(header, &record)) {
+        data.resize(record.length);
+        if (record.length != fread(data.data(), 1, record.length, file)) break;
+
+        if (ARCHIVE_TYPE_LOG != record.type || record.length < 1) continue;
+
+        if (!ArchiveCheckRecord(header, data.data())) {
+            errors++;
+            continue;
+        }
+
+        printf("%10u %s: %s\n", record.time, (data[0] < 3) ? levels[data[0]] : "???",
+               LogTokenExpandFrame(dictionary, &data[1], data.size() - 1).c_str());
+    }
+
+    fclose(file);
+
+    if (errors) fprintf(stderr, "%s: %d log records with bad CRCs\n", filename, errors);
+    return errors ? 1 : 0;
+}
+
+int main(int argc, char ** argv)
+{
+    LogTokenDictionary dictionary;
+
+    if (argc >= 4 && 0 == strcmp(argv[1], "dict")) {
+        return Dictionary(argv[2], argc - 3, &argv[3]);
+    }
+
+    if (argc < 3 || (0 != strcmp(argv[1], "expand") && 0 != strcmp(argv[1], "archive"))) {
+        Usage();
+        return 2;
+    }
+
+    if (!LogTokenLoadDictionary(argv[2], dictionary)) {
+        fprintf(stderr, "unable to read %s\n", argv[2]);
+        return 1;
+    }
+
+    if (0 == strcmp(argv[1], "expand")) {
+        return Expand(dictionary, (argc > 3) ? argv[3] : NULL);
+    }
+
+    int result = 0;
+    for (int i = 3; i < argc; i++) {
+        result |= Archive(dictionary, argv[i]);
+    }
+
+    return result;
+}
@@ -0,0 +1,135 @@
+/*
+ *  ReplayTool.cpp
+ *  Author:  StratoCore contributors
+ *  Created: October 2026
+ *
+ *  This file implements a tool that replays a recorded Zephyr capture into
+ *  a dummy StratoCore instrument and reports the routing throughput, the
+ *  per-message latency by type, and any parse or routing errors, so that
+ *  captures from flights and tests can be kept as a regression corpus.
+ *
+ *  Usage: strato_replay [-r | -f] [-v] <capture>
+ *           -r  at the capture's pace in real time
+ *           -f  at the capture's pace, fast-forwarded on a virtual clock
+ *           -v  print each error
+ *         otherwise at the maximum rate. Returns 1 if any message had an error.
+ */
+
+#include "ZephyrReplay.h"
+#include "HostStream.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define REPLAY_INST_NAME    "RACHuTS"
+
+static ReplayStream replay_stream;
+static HostStream debug_stream;
+
+class ReplayInstrument : public StratoCore {
+public:
+    ReplayInstrument() : StratoCore(&replay_stream, RACHUTS, &debug_stream) { }
+
+    void InstrumentSetup() { }
+    void InstrumentLoop() { }
+
+    uint32_t tc_count = 0;
+
+private:
+    void StandbyMode() { ModeBody(); }
+    void FlightMode() { ModeBody(); }
+    void LowPowerMode() { ModeBody(); }
+    void SafetyMode() { ModeBody(); }
+    void EndOfFlightMode() { ModeBody(); }
+
+    void ModeBody()
+    {
+        if (MODE_ENTRY == inst_substate) inst_substate = 1;
+    }
+
+    void TCHandler(Telecommand_t telecommand)
+    {
+        (void) telecommand;
+        tc_count++;
+    }
+
+    void ActionHandler(uint8_t action) { (void) action; }
+};
+
+static void Usage()
+{
+    printf("usage: strato_replay [-r | -f] [-v] <capture>\n");
+    printf("         -r  at the capture's pace in real time\n");
+    printf("         -f  at the capture's pace, fast-forwarded on a virtual clock\n");
+    printf("         -v  print each error\n");
+}
+
+int main(int argc, char ** argv)
+{
+    const char * capture = NULL;
+    bool real_time = false;
+    bool fast_forward = false;
+    bool verbose = false;
+    VirtualClock virtual_clock;
+
+    for (int i = 1; i < argc; i++) {
+        if (0 == strcmp(argv[i], "-r")) {
+            real_time = true;
+        } else if (0 == strcmp(argv[i], "-f")) {
+            real_time = true;
+            fast_forward = true;
+        } else if (0 == strcmp(argv[i], "-v")) {
+            verbose = true;
+        } else if ('-' != argv[i][0] && NULL == capture) {
+            capture = argv[i];
+        } else {
+            Usage();
+            return 1;
+        }
+    }
+
+    if (NULL == capture) {
+        Usage();
+        return 1;
+    }
+
+    if (!replay_stream.Load(capture)) {
+        printf("can't read %s\n", capture);
+        return 1;
+    }
+
+    if (fast_forward) SetStratoClock(&virtual_clock);
+
+    setenv("STRATO_SD_ROOT", "replay_sd", 0);
+
+    ReplayInstrument inst;
+    ZephyrReplay replay(&inst, &replay_stream, REPLAY_INST_NAME);
+
+    inst.InitializeCore();
+    replay.SetVerbose(verbose);
+
+    ReplayReport_t report = replay.Run(real_time);
+
+    double seconds = (double) report.elapsed_us / 1e6;
+
+    printf("Replayed %u messages from %s (%s)\n", report.messages, capture,
+           fast_forward ? "capture pace, fast-forwarded" : real_time ? "capture pace" : "maximum rate");
+    printf("  routed %u, other instruments %u, parse errors %u, routing errors %u, TCs run %u\n",
+           report.routed, report.ignored, report.parse_errors, report.route_errors, inst.tc_count);
+    printf("  %.3f s, %.0f msgs/s", seconds, seconds > 0 ? report.messages / seconds : 0.0);
+    if (real_time) printf(", %u loops, max lag %u ms", report.loops, report.max_lag_ms);
+    printf("\n  latency: p50 %u us, p99 %u us, max %u us\n\n", report.p50_us, report.p99_us, report.max_us);
+
+    printf("  %-8s %10s %10s %8s %10s %10s\n", "type", "messages", "routed", "errors", "mean us", "max us");
+    for (uint8_t i = 0; i < NUM_REPLAY_TYPES; i++) {
+        const ReplayTypeStats_t & type = report.types[i];
+        if (0 == type.count) continue;
+
+        printf("  %-8s %10u %10u %8u %10.1f %10u\n", ZephyrReplay::TypeName(i), type.count, type.routed, type.errors,
+               type.routed ? (double) type.total_us / type.routed : 0.0, type.max_us);
+    }
+
+    SetStratoClock(NULL);
+
+    return (report.parse_errors || report.route_errors) ? 1 : 0;
+}
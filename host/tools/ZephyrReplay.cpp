@@ -0,0 +1,256 @@
+/*
+ *  ZephyrReplay.cpp
+ *  Author:  StratoCore contributors
+ *  Created: October 2026
+ *
+ *  This file implements the replay source for recorded Zephyr traffic
+ */
+
+#include "ZephyrReplay.h"
+#include <algorithm>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MSG_END             "<END>"
+#define MAX_ERRORS_SHOWN    20
+
+static uint64_t WallMicros()
+{
+    return (uint64_t) std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// ReplayStream -------------------------------------------
+
+bool ReplayStream::Load(const char * filename)
+{
+    std::string capture;
+    char chunk[4096];
+    size_t size = 0;
+    FILE * file = fopen(filename, "rb");
+
+    if (NULL == file) return false;
+
+    while (0 < (size = fread(chunk, 1, sizeof(chunk), file))) {
+        capture.append(chunk, size);
+    }
+
+    fclose(file);
+
+    LoadString(capture.data(), capture.size());
+    return true;
+}
+
+void ReplayStream::LoadString(const char * capture, size_t size)
+{
+    size_t pos = 0;
+    uint32_t time_ms = 0;
+
+    data.clear();
+    messages.clear();
+    read_pos = 0;
+    release_end = 0;
+    released = 0;
+
+    while (pos < size) {
+        // whitespace between messages isn't replayed
+        if ('\n' == capture[pos] || '\r' == capture[pos] || ' ' == capture[pos]) {
+            pos++;
+            continue;
+        }
+
+        // a timestamp line for the following messages
+        if ('@' == capture[pos]) {
+            time_ms = (uint32_t) strtoul(capture + pos + 1, NULL, 10);
+            while (pos < size && '\n' != capture[pos]) pos++;
+            continue;
+        }
+
+        // a message through its <END> and line ending, or a truncated one at the end of the capture
+        const char * end = std::search(capture + pos, capture + size, MSG_END, MSG_END + strlen(MSG_END));
+        size_t message_end = size;
+
+        if (capture + size != end) {
+            message_end = (end - capture) + strlen(MSG_END);
+            if (message_end < size && '\r' == capture[message_end]) message_end++;
+            if (message_end < size && '\n' == capture[message_end]) message_end++;
+        }
+
+        data.append(capture + pos, message_end - pos);
+        AddMessage(data.size() - (message_end - pos), message_end - pos, time_ms);
+        pos = message_end;
+    }
+}
+
+void ReplayStream::AddMessage(size_t offset, size_t size, uint32_t time_ms)
+{
+    static const char * tags[NUM_REPLAY_TYPES - 1] = {"<IM>", "<GPS>", "<SW>", "<TC>", "<SAck>", "<RAAck>", "<TMAck>"};
+    ReplayMessage_t message = {offset, size, time_ms, REPLAY_OTHER};
+
+    messages.push_back(message);
+
+    for (uint8_t i = 0; i < NUM_REPLAY_TYPES - 1; i++) {
+        if (0 == data.compare(offset, strlen(tags[i]), tags[i])) {
+            messages.back().type = i;
+            break;
+        }
+    }
+}
+
+bool ReplayStream::ReleaseNext()
+{
+    if (released >= messages.size()) return false;
+
+    release_end = messages[released].offset + messages[released].size;
+    released++;
+    return true;
+}
+
+// ZephyrReplay -------------------------------------------
+
+const char * ZephyrReplay::TypeName(uint8_t type)
+{
+    static const char * names[NUM_REPLAY_TYPES] = {"IM", "GPS", "SW", "TC", "SAck", "RAAck", "TMAck", "other"};
+
+    return (type < NUM_REPLAY_TYPES) ? names[type] : "?";
+}
+
+ReplayReport_t ZephyrReplay::Run(bool real_time)
+{
+    ReplayReport_t report = {};
+    std::vector<uint32_t> latencies;
+    uint32_t start_ms = StratoMillis();
+    uint32_t loop_start = start_ms;
+    uint32_t since_start = 0;
+    uint32_t since_loop = 0;
+    uint64_t start_us = WallMicros();
+
+    errors_shown = 0;
+    latencies.reserve(replay->Count());
+
+    for (size_t i = replay->Released(); i < replay->Count(); i++) {
+        const ReplayMessage_t & message = replay->Message(i);
+
+        if (real_time) {
+            // run the loop as the instrument would until the message is due
+            while ((since_start = StratoMillis() - start_ms) < message.time_ms) {
+                since_loop = StratoMillis() - loop_start;
+
+                if (since_loop >= 1000) {
+                    loop_start += 1000;
+                } else {
+                    uint32_t wait = std::min(message.time_ms - since_start, 1000 - since_loop);
+                    IdleWake_t wake = inst->Idle(wait);
+
+                    if (IDLE_WAKE_HIGHRES == wake) inst->RunHighResScheduler();
+                    if (IDLE_WAKE_TIMEOUT == wake || IDLE_WAKE_HIGHRES == wake) continue;
+
+                    // a due action starts the next loop early
+                    loop_start = StratoMillis();
+                }
+
+                inst->RunRouter();
+                inst->RunMode();
+                inst->RunScheduler();
+                inst->RunTasks();
+                inst->RunSDWriter();
+                inst->RunInstrumentLoop();
+                inst->KickWatchdog();
+                report.loops++;
+            }
+
+            if (since_start - message.time_ms > report.max_lag_ms) report.max_lag_ms = since_start - message.time_ms;
+
+            Route(i, report, latencies);
+        } else {
+            Route(i, report, latencies);
+            inst->RunMode();
+            inst->KickWatchdog();
+        }
+    }
+
+    report.elapsed_us = WallMicros() - start_us;
+
+    if (!latencies.empty()) {
+        std::sort(latencies.begin(), latencies.end());
+        report.p50_us = latencies[(latencies.size() - 1) / 2];
+        report.p99_us = latencies[(size_t) ((latencies.size() - 1) * 0.99)];
+        report.max_us = latencies.back();
+    }
+
+    return report;
+}
+
+void ZephyrReplay::Route(size_t index, ReplayReport_t & report, std::vector<uint32_t> & latencies)
+{
+    const ReplayMessage_t & message = replay->Message(index);
+    ReplayTypeStats_t & type = report.types[message.type];
+    const RouterStats_t & stats = inst->GetRouterStats();
+    uint32_t routed_before = 0;
+    uint32_t routed_after = 0;
+    uint32_t unknown_before = stats.unknown;
+    uint32_t start_us = 0;
+    uint32_t elapsed_us = 0;
+
+    for (uint8_t i = 0; i <= UNKNOWN; i++) routed_before += stats.routed[i];
+
+    replay->ClearReplies();
+    replay->ReleaseNext();
+
+    start_us = micros();
+    inst->RunRouter();
+    elapsed_us = micros() - start_us;
+
+    for (uint8_t i = 0; i <= UNKNOWN; i++) routed_after += stats.routed[i];
+
+    report.messages++;
+    type.count++;
+
+    if (routed_after == routed_before) {
+        // the reader drops messages for other instruments without routing them
+        std::string text = replay->MessageText(index);
+        size_t inst_start = text.find("<Inst>");
+        size_t inst_end = text.find("</Inst>");
+
+        if (std::string::npos != inst_start && std::string::npos != inst_end
+            && 0 != text.compare(inst_start + 6, inst_end - inst_start - 6, name)) {
+            report.ignored++;
+        } else {
+            report.parse_errors++;
+            type.errors++;
+            Error(index, "not parsed");
+        }
+        return;
+    }
+
+    report.routed++;
+    type.routed++;
+    type.total_us += elapsed_us;
+    if (elapsed_us > type.max_us) type.max_us = elapsed_us;
+    latencies.push_back(elapsed_us);
+
+    // routed, but not understood or rejected
+    size_t ack = replay->replies.find("<TCAck>");
+    if (stats.unknown != unknown_before) {
+        report.route_errors++;
+        type.errors++;
+        Error(index, "routed as unknown");
+    } else if (std::string::npos != ack && std::string::npos != replay->replies.find("NAK", ack)) {
+        report.route_errors++;
+        type.errors++;
+        Error(index, "TC batch NAKed");
+    }
+}
+
+void ZephyrReplay::Error(size_t index, const char * what)
+{
+    if (!verbose || errors_shown++ >= MAX_ERRORS_SHOWN) return;
+
+    std::string text = replay->MessageText(index);
+    while (!text.empty() && ('\n' == text.back() || '\r' == text.back())) text.pop_back();
+    if (text.size() > 120) text = text.substr(0, 117) + "...";
+
+    printf("  message %lu at %u ms %s: %s\n", (unsigned long) index + 1, replay->Message(index).time_ms, what, text.c_str());
+}
@@ -0,0 +1,138 @@
+/*
+ *  ZephyrReplay.h
+ *  Author:  StratoCore contributors
+ *  Created: October 2026
+ *
+ *  This file declares a replay source for recorded Zephyr traffic: a Stream
+ *  fed from a capture file, and an engine that routes it through a StratoCore
+ *  instance message by message, at the capture's pace or as fast as possible,
+ *  measuring the routing latency and counting parse and routing errors.
+ */
+
+#ifndef ZEPHYRREPLAY_H
+#define ZEPHYRREPLAY_H
+
+#include "StratoCore.h"
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// message types in the report, by the first tag of the message
+enum ReplayType_t {
+    REPLAY_IM = 0,
+    REPLAY_GPS,
+    REPLAY_SW,
+    REPLAY_TC,
+    REPLAY_SACK,
+    REPLAY_RAACK,
+    REPLAY_TMACK,
+    REPLAY_OTHER,
+    NUM_REPLAY_TYPES
+};
+
+struct ReplayMessage_t {
+    size_t offset; // in the replayed bytes
+    size_t size;
+    uint32_t time_ms; // capture time, from the last timestamp line
+    uint8_t type; // ReplayType_t
+};
+
+// A capture is the bytes the Zephyr sent, as recorded from the port: each message runs through its
+// <END>. A line "@<ms>" between messages gives the capture time (ms since the capture started) of the
+// messages that follow it, and is not replayed. Captures without timestamps replay as a single burst.
+//
+// Only released messages can be read, so that the engine controls when the instrument sees each one.
+// Whatever the instrument writes back (acks and TMs) is kept until cleared.
+class ReplayStream : public Stream {
+public:
+    ReplayStream() : bytes_written(0), read_pos(0), release_end(0), released(0) { }
+
+    bool Load(const char * filename);
+    void LoadString(const char * data, size_t size);
+
+    size_t Count() { return messages.size(); }
+    const ReplayMessage_t & Message(size_t index) { return messages[index]; }
+    std::string MessageText(size_t index) { return data.substr(messages[index].offset, messages[index].size); }
+
+    // make the next message readable, false if they have all been released
+    bool ReleaseNext();
+    size_t Released() { return released; }
+
+    // discard the replies so far
+    void ClearReplies() { replies.clear(); }
+
+    size_t write(uint8_t b) { bytes_written++; replies.push_back((char) b); return 1; }
+    size_t write(const uint8_t * buffer, size_t size) { bytes_written += size; replies.append((const char *) buffer, size); return size; }
+    using Print::write;
+
+    int availableForWrite() { return 4096; }
+
+    int available() { return (int) (release_end - read_pos); }
+    int read() { return (read_pos < release_end) ? (uint8_t) data[read_pos++] : -1; }
+    int peek() { return (read_pos < release_end) ? (uint8_t) data[read_pos] : -1; }
+
+    std::string replies;
+    uint64_t bytes_written;
+
+private:
+    void AddMessage(size_t offset, size_t size, uint32_t time_ms);
+
+    std::string data; // the messages without the timestamp lines
+    std::vector<ReplayMessage_t> messages;
+    size_t read_pos;
+    size_t release_end;
+    size_t released;
+};
+
+struct ReplayTypeStats_t {
+    uint32_t count;
+    uint32_t routed;
+    uint32_t errors;
+    uint64_t total_us; // routing latency of the routed messages, mean = total_us / routed
+    uint32_t max_us;
+};
+
+struct ReplayReport_t {
+    uint32_t messages;
+    uint32_t routed;
+    uint32_t ignored; // for other instruments
+    uint32_t parse_errors; // not routed
+    uint32_t route_errors; // routed as unknown, or a TC batch that was NAKed
+    uint32_t loops; // 1 Hz loops run between messages when replaying in real time
+    uint64_t elapsed_us; // wall time from the first message to the last
+    uint32_t max_lag_ms; // most a message was released after its capture time (real time only)
+    uint32_t p50_us; // routing latency percentiles over all routed messages
+    uint32_t p99_us;
+    uint32_t max_us;
+    ReplayTypeStats_t types[NUM_REPLAY_TYPES];
+};
+
+// Each message is released alone and routed with RunRouter (which includes running its TCs), and its
+// latency is the CPU time of that call. In real time, the messages are released at their capture times
+// on the StratoCore clock, with the 1 Hz loop phases and Idle run in between as in the main loop, so a
+// VirtualClock replays a long capture quickly. At the maximum rate, the mode is run after each message.
+class ZephyrReplay {
+public:
+    ZephyrReplay(StratoCore * instrument, ReplayStream * stream, const char * inst_name)
+        : inst(instrument), replay(stream), name(inst_name), errors_shown(0), verbose(false) { }
+
+    ReplayReport_t Run(bool real_time);
+
+    // name of a ReplayType_t for the report
+    static const char * TypeName(uint8_t type);
+
+    // print each parse and routing error (the first 20)
+    void SetVerbose(bool print_errors) { verbose = print_errors; }
+
+private:
+    void Route(size_t index, ReplayReport_t & report, std::vector<uint32_t> & latencies);
+    void Error(size_t index, const char * what);
+
+    StratoCore * inst;
+    ReplayStream * replay;
+    const char * name;
+    uint32_t errors_shown;
+    bool verbose;
+};
+
+#endif /* ZEPHYRREPLAY_H */